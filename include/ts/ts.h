@@ -1218,6 +1218,18 @@ tsapi TSReturnCode TSCacheKeyPinnedSet(TSCacheKey key, time_t pin_in_cache);
  */
 tsapi TSReturnCode TSCacheKeyDestroy(TSCacheKey key);
 
+/**
+    Estimates how many times the object for a cache key was recently
+    looked up. New objects are only written to the cache once this
+    reaches proxy.config.cache.admission.threshold.
+
+    @param key of the cached object.
+
+    @return the estimated lookup count, or -1 if @a key is not valid.
+
+ */
+tsapi int TSCacheAdmissionEstimate(TSCacheKey key);
+
 /* --------------------------------------------------------------------------
    cache url */
 tsapi TSReturnCode TSCacheUrlSet(TSHttpTxn txnp, const char *url, int length);
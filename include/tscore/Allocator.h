@@ -39,7 +39,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <new>
+#include <cstdio>
 #include <cstdlib>
 #include <utility>
 #include "tscore/ink_queue.h"
@@ -109,6 +111,20 @@ public:
     ink_freelist_madvise_init(&this->fl, name, element_size, chunk_size, alignment, advice);
   }
 
+  /// @return Bytes in the chunks allocated for the freelist.
+  size_t
+  allocated_size() const
+  {
+    return static_cast<size_t>(fl->allocated) * fl->type_size;
+  }
+
+  /// @return Bytes of the items handed out.
+  size_t
+  used_size() const
+  {
+    return static_cast<size_t>(fl->used) * fl->type_size;
+  }
+
   // Dummies
   void
   destroy_if_enabled(void *)
@@ -124,6 +140,102 @@ protected:
   InkFreeList *fl;
 };
 
+/**
+  Allocator for fixed size memory blocks with a pool on each NUMA node.
+
+  @c alloc_void and @c free_void use a pool that is not bound to any node,
+  the same as @c Allocator. @c alloc_void_numa takes a block from the pool
+  of the node the calling thread is bound to and returns that node, which
+  has to be passed back to @c free_void_numa. A block freed on another node
+  is handed back to its home pool, which takes it in the next time it runs
+  out of blocks.
+*/
+class NumaAllocator : public Allocator
+{
+public:
+  static constexpr int MAX_NODES = 8;
+
+  /**
+    Allocate a block from the pool of the calling thread's node.
+
+    @param node set to the node of the block, -1 if it is from the unbound pool.
+  */
+  void *
+  alloc_void_numa(int &node)
+  {
+    node = ink_freelist_thread_node();
+    if (node < 0 || node >= this->nodes) {
+      node = -1;
+      return this->alloc_void();
+    }
+    return ink_freelist_new(this->node_fl[node]);
+  }
+
+  /**
+    Deallocate a block allocated by @c alloc_void_numa.
+
+    @param ptr pointer to be freed.
+    @param node the node returned by @c alloc_void_numa.
+  */
+  void
+  free_void_numa(void *ptr, int node)
+  {
+    if (node < 0) {
+      this->free_void(ptr);
+    } else if (node == ink_freelist_thread_node()) {
+      ink_freelist_free(this->node_fl[node], ptr);
+    } else {
+      ink_freelist_free_remote(this->node_fl[node], ptr);
+    }
+  }
+
+  /**
+    Re-initialize the parameters of the allocator.
+
+    @param nodes number of NUMA nodes, there are no node pools if this is 1.
+  */
+  void
+  re_init(const char *name, unsigned int element_size, unsigned int chunk_size, unsigned int alignment, int advice, int nodes)
+  {
+    Allocator::re_init(name, element_size, chunk_size, alignment, advice);
+
+    this->nodes = nodes > 1 ? std::min(nodes, MAX_NODES) : 0;
+    for (int i = 0; i < this->nodes; ++i) {
+      // The names are kept by the freelists for the life of the process.
+      auto node_name = new char[64];
+      snprintf(node_name, 64, "%s/node%d", name, i);
+      ink_freelist_madvise_init(&this->node_fl[i], node_name, element_size, chunk_size, alignment, advice);
+      ink_freelist_bind_node(this->node_fl[i], i);
+    }
+  }
+
+  /// @return Bytes in the chunks allocated for all the pools.
+  size_t
+  allocated_size() const
+  {
+    size_t n = Allocator::allocated_size();
+    for (int i = 0; i < this->nodes; ++i) {
+      n += static_cast<size_t>(this->node_fl[i]->allocated) * this->node_fl[i]->type_size;
+    }
+    return n;
+  }
+
+  /// @return Bytes of the items of all the pools handed out.
+  size_t
+  used_size() const
+  {
+    size_t n = Allocator::used_size();
+    for (int i = 0; i < this->nodes; ++i) {
+      n += static_cast<size_t>(this->node_fl[i]->used) * this->node_fl[i]->type_size;
+    }
+    return n;
+  }
+
+protected:
+  int nodes = 0;
+  InkFreeList *node_fl[MAX_NODES];
+};
+
 /**
   Allocator for Class objects.
 
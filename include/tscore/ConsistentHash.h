@@ -25,7 +25,8 @@
 #include "Hash.h"
 #include <cstdint>
 #include <iostream>
-#include <map>
+#include <memory>
+#include <vector>
 
 /*
   Helper class to be extended to make ring nodes.
@@ -38,12 +39,17 @@ struct ATSConsistentHashNode {
 
 std::ostream &operator<<(std::ostream &os, ATSConsistentHashNode &thing);
 
-typedef std::map<uint64_t, ATSConsistentHashNode *>::iterator ATSConsistentHashIter;
+/// Position on the ring, an index in ring order.
+typedef size_t ATSConsistentHashIter;
 
 /*
   TSConsistentHash requires a TSHash64 object
 
   Caller is responsible for freeing ring node memory.
+
+  The ring is kept as a flat array of points sorted by hash, with a table indexed by the top bits
+  of the hash to narrow each search to a few points. Lookups are read only, the ring must not be
+  changed while it is in use.
  */
 
 struct ATSConsistentHash {
@@ -54,10 +60,40 @@ struct ATSConsistentHash {
   ATSConsistentHashNode *lookup_available(const char *url = nullptr, ATSConsistentHashIter *i = nullptr, bool *w = nullptr,
                                           ATSHash64 *h = nullptr);
   ATSConsistentHashNode *lookup_by_hashval(uint64_t hashval, ATSConsistentHashIter *i = nullptr, bool *w = nullptr);
+
+  /** Bound the share of recent lookups any one node gets.
+   *
+   * With a bound of @a epsilon greater than 0, @c lookup_by_hashval passes over nodes which
+   * already got more than (1 + @a epsilon) times the average number of recent lookups, so a hot
+   * key range spills to the following nodes on the ring. 0, the default, disables the bound.
+   */
+  void set_load_bound(float epsilon);
+
+  /// Number of points on the ring.
+  size_t
+  size() const
+  {
+    return keys.size();
+  }
+
   ~ATSConsistentHash();
 
 private:
+  size_t find(uint64_t hashval) const;
+  bool over_load(uint32_t slot) const;
+  void add_load(uint32_t slot);
+
   int replicas;
   ATSHash64 *hash;
-  std::map<uint64_t, ATSConsistentHashNode *> NodeMap;
+
+  std::vector<uint64_t> keys;                 ///< Hash of each point, sorted.
+  std::vector<uint32_t> slots;                ///< Node of each point, an index in @a nodes.
+  std::vector<ATSConsistentHashNode *> nodes; ///< Distinct nodes, in insertion order.
+  std::vector<uint32_t> buckets;              ///< First point of each range of top hash bits.
+  int bucket_shift = 64;                      ///< Shift from a hash to its bucket.
+
+  std::vector<uint32_t> points;                   ///< Number of points of each node.
+  float load_bound = 0;                           ///< Allowed excess load, 0 if unbounded.
+  std::unique_ptr<std::atomic<uint32_t>[]> loads; ///< Recent lookups of each node.
+  std::atomic<uint32_t> total_load{0};            ///< Recent lookups of all nodes.
 };
@@ -0,0 +1,98 @@
+/** @file
+
+  Approximate, aging access frequency counter (TinyLFU).
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/** Estimate how often keys have been seen recently.
+ *
+ * This is a count-min sketch of 4 bit counters in front of which sits a "doorkeeper" Bloom filter.
+ * The first sighting of a key only sets its doorkeeper bits, so keys seen once never take space in
+ * the sketch. After @a sample_size() increments every counter is halved and the doorkeeper is
+ * cleared, which ages out keys which are no longer popular.
+ *
+ * Keys are passed in as two 64 bit hashes, which are expected to be well mixed (e.g. the two halves
+ * of a @c CryptoHash).
+ *
+ * All methods are thread safe. Concurrent increments can occasionally be lost, which does not
+ * matter for an estimate.
+ */
+class FrequencySketch
+{
+public:
+  /// Largest value a counter can hold.
+  static constexpr int MAX_COUNT = 15;
+
+  /** Construct a sketch sized to track about @a capacity distinct keys.
+   *
+   * The sketch takes about 3 bytes per tracked key.
+   */
+  explicit FrequencySketch(uint64_t capacity);
+
+  /// Record one access to the key.
+  void increment(uint64_t h1, uint64_t h2);
+
+  /// Estimated recent accesses of the key, at most MAX_COUNT + 1.
+  int estimate(uint64_t h1, uint64_t h2) const;
+
+  /// Halve all counters and clear the doorkeeper.
+  void age();
+
+  /// Number of increments between aging.
+  uint64_t
+  sample_size() const
+  {
+    return _sample_size;
+  }
+
+  /// Number of counters in each row of the sketch.
+  uint64_t
+  width() const
+  {
+    return _width;
+  }
+
+protected:
+  static constexpr int DEPTH           = 4;  ///< Rows in the sketch.
+  static constexpr int COUNTER_BITS    = 4;  ///< Bits per counter.
+  static constexpr int COUNTERS_WORD   = 16; ///< Counters per 64 bit word.
+  static constexpr int DOORKEEPER_HASH = 3;  ///< Probes per key in the doorkeeper.
+
+  uint64_t index(uint64_t h1, uint64_t h2, int i) const;
+  int counter(uint64_t idx) const;
+  void increment_counter(uint64_t idx);
+  bool doorkeeper_test_and_set(uint64_t h1, uint64_t h2);
+  bool doorkeeper_test(uint64_t h1, uint64_t h2) const;
+
+  uint64_t _width;       ///< Counters per row, a power of 2.
+  uint64_t _mask;        ///< @a _width - 1.
+  uint64_t _dk_mask;     ///< Number of doorkeeper bits - 1.
+  uint64_t _sample_size; ///< Increments between aging.
+
+  std::unique_ptr<std::atomic<uint64_t>[]> _table;      ///< DEPTH rows of @a _width counters.
+  std::unique_ptr<std::atomic<uint64_t>[]> _doorkeeper; ///< Doorkeeper bits.
+  std::atomic<uint64_t> _additions{0};                  ///< Increments since the last aging.
+};
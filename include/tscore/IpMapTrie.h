@@ -0,0 +1,344 @@
+/** @file
+
+    Read optimized, immutable lookup structure compiled from an IpMap.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "tscore/ink_inet.h"
+#include "tscore/IpMap.h"
+
+namespace ts
+{
+namespace detail
+{
+  /// Key for IPv4 addresses, the address in host order.
+  struct Ip4TrieKey {
+    using Key                  = uint32_t;
+    static constexpr int WIDTH = 32;
+
+    static Key
+    key(sockaddr const *addr)
+    {
+      return ntohl(ats_ip4_addr_cast(addr));
+    }
+
+    /// @return The @a n bits of @a key starting @a offset bits from the top.
+    static unsigned
+    chunk(Key key, int offset, int n)
+    {
+      return (key >> (WIDTH - offset - n)) & ((1u << n) - 1);
+    }
+
+    /// @return @a prefix with the @a n bits starting @a offset bits from the top set to @a v.
+    static Key
+    place(Key prefix, unsigned v, int offset, int n)
+    {
+      return prefix | static_cast<Key>(v) << (WIDTH - offset - n);
+    }
+
+    /// @return @a prefix with all the bits past the first @a depth set.
+    static Key
+    fill(Key prefix, int depth)
+    {
+      return depth >= WIDTH ? prefix : prefix | (~Key(0) >> depth);
+    }
+  };
+
+  /// Key for IPv6 addresses, the address in host order split in two halves.
+  struct Ip6TrieKey {
+    struct Key {
+      uint64_t hi;
+      uint64_t lo;
+
+      bool
+      operator<(Key const &that) const
+      {
+        return hi < that.hi || (hi == that.hi && lo < that.lo);
+      }
+      bool
+      operator<=(Key const &that) const
+      {
+        return !(that < *this);
+      }
+    };
+    static constexpr int WIDTH = 128;
+
+    static Key
+    key(sockaddr const *addr)
+    {
+      uint8_t const *bytes = ats_ip_addr8_cast(addr);
+      Key key{0, 0};
+      for (int i = 0; i < 8; ++i) {
+        key.hi = key.hi << 8 | bytes[i];
+        key.lo = key.lo << 8 | bytes[i + 8];
+      }
+      return key;
+    }
+
+    static unsigned
+    chunk(Key const &key, int offset, int n)
+    {
+      int shift = WIDTH - offset - n; // of the lowest bit of the chunk
+      uint64_t v;
+      if (shift >= 64) {
+        v = key.hi >> (shift - 64);
+      } else if (shift == 0) {
+        v = key.lo;
+      } else {
+        v = key.lo >> shift | key.hi << (64 - shift);
+      }
+      return v & ((1u << n) - 1);
+    }
+
+    static Key
+    place(Key prefix, unsigned v, int offset, int n)
+    {
+      int shift = WIDTH - offset - n;
+      if (shift >= 64) {
+        prefix.hi |= static_cast<uint64_t>(v) << (shift - 64);
+      } else {
+        prefix.lo |= static_cast<uint64_t>(v) << shift;
+        if (shift > 0) {
+          prefix.hi |= static_cast<uint64_t>(v) >> (64 - shift);
+        }
+      }
+      return prefix;
+    }
+
+    static Key
+    fill(Key prefix, int depth)
+    {
+      if (depth < 64) {
+        prefix.hi |= depth == 0 ? ~uint64_t(0) : ~uint64_t(0) >> depth;
+        prefix.lo = ~uint64_t(0);
+      } else if (depth < 128) {
+        prefix.lo |= depth == 64 ? ~uint64_t(0) : ~uint64_t(0) >> (depth - 64);
+      }
+      return prefix;
+    }
+  };
+
+  /** Multibit trie in the style of poptrie.
+
+      The top bits of the key index a direct table, whose entries are
+      either a leaf or the root of a trie that takes @c STRIDE more bits
+      at each level.  A trie node does not store its children in full.
+      @c vector has a bit for each child that is a node, and the nodes
+      are packed in order starting at @c base1.  @c leafvec has a bit
+      for each child that starts a new run of equal leaves, and the runs
+      are packed in order starting at @c base0.  A child is found by
+      counting the bits below it.
+
+      A leaf is 0 for addresses not in the map, otherwise one more than
+      the index of the data for the address.
+  */
+  template <typename K> class IpTrie
+  {
+  public:
+    using Key = typename K::Key;
+
+    /// A range of addresses and its leaf, the ranges are disjoint and sorted.
+    struct Range {
+      Key min;
+      Key max;
+      uint32_t leaf;
+    };
+
+    /// Replace the contents with @a ranges.
+    void build(std::vector<Range> const &ranges);
+
+    /// @return The leaf for @a key.
+    uint32_t
+    lookup(Key const &key) const
+    {
+      uint32_t e = _direct[K::chunk(key, 0, _direct_bits)];
+      if (e & LEAF) {
+        return e & ~LEAF;
+      }
+      Node const *node = &_nodes[e];
+      int offset       = _direct_bits;
+      while (true) {
+        int n         = std::min(STRIDE, K::WIDTH - offset);
+        unsigned v    = K::chunk(key, offset, n);
+        uint64_t mask = (uint64_t(2) << v) - 1; // bits up to and including v
+        if (node->vector & (uint64_t(1) << v)) {
+          node = &_nodes[node->base1 + __builtin_popcountll(node->vector & mask) - 1];
+          offset += n;
+        } else {
+          return _leaves[node->base0 + __builtin_popcountll(node->leafvec & mask) - 1];
+        }
+      }
+    }
+
+    /// @return Bytes used by the trie.
+    size_t
+    size() const
+    {
+      return _direct.size() * sizeof(uint32_t) + _nodes.size() * sizeof(Node) + _leaves.size() * sizeof(uint32_t);
+    }
+
+  private:
+    /// Bits taken at each level, for 64 children with one bit each in the vectors of a node.
+    static constexpr int STRIDE = 6;
+    /// Bounds on the bits of the direct table, which grows with the number of ranges.
+    static constexpr int DIRECT_MIN = 4;
+    static constexpr int DIRECT_MAX = 16;
+    /// Marks a direct table entry as a leaf rather than a node index.
+    static constexpr uint32_t LEAF = 0x80000000;
+    /// A block not covered by a single leaf.
+    static constexpr uint32_t MIXED = ~uint32_t(0);
+
+    struct Node {
+      uint64_t vector;  ///< Children that are nodes.
+      uint64_t leafvec; ///< Children that start a run of leaves.
+      uint32_t base0;   ///< Index of the first leaf.
+      uint32_t base1;   ///< Index of the first child node.
+    };
+
+    uint32_t uniform(Key const &min, Key const &max, std::vector<Range> const &ranges, size_t first, size_t last) const;
+    void build_node(uint32_t idx, Key const &prefix, int depth, std::vector<Range> const &ranges, size_t first, size_t last);
+
+    int _direct_bits              = DIRECT_MIN;
+    std::vector<uint32_t> _direct = std::vector<uint32_t>(1 << DIRECT_MIN, LEAF);
+    std::vector<Node> _nodes;
+    std::vector<uint32_t> _leaves;
+  };
+} // namespace detail
+} // namespace ts
+
+/** Read optimized copy of an @c IpMap.
+
+    This is compiled from an @c IpMap once it is fully built and does
+    not change afterwards; it has to be compiled again for any change in
+    the map.  A lookup takes a direct table index and then a step for
+    each 6 bits of the address that are needed to tell the ranges of the
+    map apart, rather than a tree search, which makes it suitable for
+    large maps checked on every connection.
+*/
+class IpMapTrie
+{
+  using self_type = IpMapTrie; ///< Self reference type.
+
+public:
+  IpMapTrie() = default;
+  /// Compile @a map.
+  explicit IpMapTrie(IpMap const &map);
+
+  /// Replace the contents with a compilation of @a map.
+  self_type &assign(IpMap const &map);
+
+  /** Test for membership.
+
+      @return @c true if the address is in the map, @c false if not.
+      If the address is in the map and @a ptr is not @c nullptr, @c *ptr
+      is set to the client data for the address.
+  */
+  bool contains(sockaddr const *target, ///< Search target (network order).
+                void **ptr = nullptr    ///< Client data return.
+  ) const;
+
+  /// Test for membership, convenience overload for IPv4.
+  bool contains(in_addr_t target,    ///< Search target (network order).
+                void **ptr = nullptr ///< Client data return.
+  ) const;
+
+  /// Test for membership, convenience overload for @c IpEndpoint.
+  bool contains(IpEndpoint const *target, ///< Search target (network order).
+                void **ptr = nullptr      ///< Client data return.
+  ) const;
+
+  /// Test for membership, convenience overload for @c IpAddr.
+  bool contains(IpAddr const &target, ///< Search target (network order).
+                void **ptr = nullptr  ///< Client data return.
+  ) const;
+
+  /// @return Number of distinct ranges compiled.
+  size_t count() const;
+
+  /// @return Bytes used by the lookup tables.
+  size_t size() const;
+
+protected:
+  /// @return The result for @a leaf.
+  bool found(uint32_t leaf, void **ptr) const;
+
+  ts::detail::IpTrie<ts::detail::Ip4TrieKey> _t4; ///< IPv4 addresses.
+  ts::detail::IpTrie<ts::detail::Ip6TrieKey> _t6; ///< IPv6 addresses.
+  std::vector<void *> _data;                      ///< Distinct client data, indexed by leaf - 1.
+  size_t _count = 0;                              ///< Ranges in the compiled map.
+};
+
+inline bool
+IpMapTrie::found(uint32_t leaf, void **ptr) const
+{
+  if (leaf && ptr) {
+    *ptr = _data[leaf - 1];
+  }
+  return leaf != 0;
+}
+
+inline bool
+IpMapTrie::contains(in_addr_t target, void **ptr) const
+{
+  return this->found(_t4.lookup(ntohl(target)), ptr);
+}
+
+inline bool
+IpMapTrie::contains(sockaddr const *target, void **ptr) const
+{
+  if (ats_is_ip4(target)) {
+    return this->contains(ats_ip4_addr_cast(target), ptr);
+  } else if (ats_is_ip6(target)) {
+    return this->found(_t6.lookup(ts::detail::Ip6TrieKey::key(target)), ptr);
+  }
+  return false;
+}
+
+inline bool
+IpMapTrie::contains(IpEndpoint const *target, void **ptr) const
+{
+  return this->contains(&target->sa, ptr);
+}
+
+inline bool
+IpMapTrie::contains(IpAddr const &addr, void **ptr) const
+{
+  IpEndpoint ip;
+  ip.assign(addr);
+  return this->contains(&ip.sa, ptr);
+}
+
+inline size_t
+IpMapTrie::count() const
+{
+  return _count;
+}
+
+inline size_t
+IpMapTrie::size() const
+{
+  return _t4.size() + _t6.size();
+}
@@ -53,6 +53,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
 #include "tscore/ink_assert.h"
@@ -948,3 +949,50 @@ template <class C, class L> inline AtomicSLL<C, L>::AtomicSLL()
   // clang-analyzer gets upset, so we use 0x10 as the base and subtract it back afterwards.
   ink_atomiclist_init(&al, "AtomicSLL", reinterpret_cast<uintptr_t>(&L::next_link(reinterpret_cast<C *>(0x10))) - 0x10);
 }
+
+//
+// Multiple producer, single consumer queue.
+//
+// Any thread may push, only the consumer takes the elements, all of
+// them at once and oldest first. Because nothing is popped singly a
+// plain pointer CAS is enough, there is no ABA problem to version away
+// as there is in InkAtomicList.
+//
+
+template <class C, class L = typename C::Link_link> struct MPSCQueue {
+  /// Add @a c. @return @c true if the queue was empty.
+  bool
+  push(C *c)
+  {
+    C *h = _head.load(std::memory_order_relaxed);
+    do {
+      L::next_link(c) = h;
+    } while (!_head.compare_exchange_weak(h, c, std::memory_order_seq_cst, std::memory_order_relaxed));
+    return h == nullptr;
+  }
+
+  /// Take all the elements, in the order they were pushed. Consumer only.
+  SLL<C, L>
+  popall()
+  {
+    SLL<C, L> l;
+    C *c = _head.exchange(nullptr, std::memory_order_acquire);
+    while (c) {
+      C *n            = L::next_link(c);
+      L::next_link(c) = l.head;
+      l.head          = c;
+      c               = n;
+    }
+    return l;
+  }
+
+  bool
+  empty() const
+  {
+    return _head.load(std::memory_order_seq_cst) == nullptr;
+  }
+
+  std::atomic<C *> _head{nullptr};
+};
+
+#define MPSCQ(_c, _l) MPSCQueue<_c, _c::Link##_##_l>
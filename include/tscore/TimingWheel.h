@@ -0,0 +1,317 @@
+/** @file
+
+  Hierarchical timing wheel.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "tscore/ink_assert.h"
+#include "tscore/List.h"
+
+/** Hierarchical timing wheel.
+
+    Elements are kept in slots by the tick they are due, so that both
+    inserting and removing one is constant time. Level 0 has a slot for
+    each of the next 64 ticks, level 1 a slot for each of the next 64
+    spans of 64 ticks, and so on. As time advances the slots of the
+    upper levels are cascaded down. Elements due beyond the top level
+    wait in its farthest slot and are placed again when it cascades.
+    Elements that are due are moved to the expired queue, from which
+    the owner takes them.
+
+    Elements are linked through @a L, as for @c Queue. @a D describes
+    them to the wheel:
+    - @c static int64_t due_of(C const *c), the time @a c is due. It is
+      read when @a c is inserted and again when it is cascaded, so it
+      may move later while @a c is in the wheel, but not earlier.
+    - @c static uint32_t slot_of(C const *c) and
+      @c static void set_slot(C *c, uint32_t slot), to keep the slot of
+      @a c in it. The slot is 0 if @a c is not in the wheel and never
+      more than @c EXPIRED.
+
+    Times are in any unit, the same as @a tick.
+*/
+template <class C, class L, class D> class TimingWheel
+{
+public:
+  static constexpr int BITS          = 6;
+  static constexpr int SLOTS         = 1 << BITS; ///< Slots in each level.
+  static constexpr int LEVELS        = 5;
+  static constexpr uint32_t EXPIRED  = LEVELS * SLOTS + 1; ///< Slot of the elements in the expired queue.
+  static constexpr int64_t MAX_TICKS = (int64_t(1) << (BITS * LEVELS)) - 1;
+
+  /// A wheel of @a tick resolution starting at @a now.
+  TimingWheel(int64_t tick, int64_t now) : _tick(tick), _now(now / tick) {}
+
+  /// Add @a c, which must not be in the wheel. If it is already due it goes straight to the expired queue.
+  void insert(C *c);
+  /// Remove @a c, which must be in the wheel or the expired queue.
+  void remove(C *c);
+
+  bool
+  in(C const *c) const
+  {
+    return D::slot_of(c) != 0;
+  }
+
+  /** Move the elements due by @a now to the expired queue.
+
+      @a drop is called for each element as it is cascaded, and if it
+      returns @c true the element is taken out of the wheel. This lets
+      the owner discard elements that will never be used without
+      waiting until they are due.
+  */
+  template <typename F> void advance(int64_t now, F &&drop);
+
+  void
+  advance(int64_t now)
+  {
+    this->advance(now, [](C *) { return false; });
+  }
+
+  /// Take the next expired element, @c nullptr if there are none.
+  C *pop_expired();
+
+  /// @return The earliest time an element may be due, @c INT64_MAX if the wheel is empty.
+  int64_t next_due() const;
+
+  /// @return The number of elements in the wheel, including the expired queue.
+  size_t
+  count() const
+  {
+    return _count;
+  }
+
+  bool
+  empty() const
+  {
+    return _count == 0;
+  }
+
+private:
+  /// @return The tick @a c is due, rounded up so that it is never early.
+  int64_t _due_tick(C const *c) const;
+  /// Put @a c in the slot for @a due, a tick after the current one.
+  void _place(C *c, int64_t due);
+  /// Place again the elements in slot @a idx of @a level.
+  template <typename F> void _cascade(int level, int idx, F &&drop);
+  /// Move slot @a idx of level 0 to the expired queue.
+  void _expire(int idx);
+  /// @return The next tick with elements due or to cascade, @c INT64_MAX if there is none.
+  int64_t _next_tick() const;
+
+  int64_t _tick;   ///< Time per tick.
+  int64_t _now;    ///< Current tick, all earlier ones are expired.
+  size_t _count = 0;
+
+  uint64_t _bits[LEVELS] = {}; ///< Non-empty slots, a bit for each.
+  Queue<C, L> _slots[LEVELS][SLOTS];
+  Queue<C, L> _expired;
+};
+
+template <class C, class L, class D>
+int64_t
+TimingWheel<C, L, D>::_due_tick(C const *c) const
+{
+  int64_t when = D::due_of(c);
+  return when / _tick + (when % _tick > 0 ? 1 : 0);
+}
+
+template <class C, class L, class D>
+void
+TimingWheel<C, L, D>::insert(C *c)
+{
+  ink_assert(!this->in(c));
+  ++_count;
+  int64_t due = this->_due_tick(c);
+  if (due <= _now) {
+    _expired.enqueue(c);
+    D::set_slot(c, EXPIRED);
+  } else {
+    this->_place(c, due);
+  }
+}
+
+template <class C, class L, class D>
+void
+TimingWheel<C, L, D>::_place(C *c, int64_t due)
+{
+  int64_t delta = due - _now;
+  if (delta > MAX_TICKS) {
+    delta = MAX_TICKS;
+    due   = _now + delta;
+  }
+  int level = (63 - __builtin_clzll(delta)) / BITS;
+  int idx   = (due >> (BITS * level)) & (SLOTS - 1);
+
+  _slots[level][idx].enqueue(c);
+  _bits[level] |= uint64_t(1) << idx;
+  D::set_slot(c, level * SLOTS + idx + 1);
+}
+
+template <class C, class L, class D>
+void
+TimingWheel<C, L, D>::remove(C *c)
+{
+  uint32_t slot = D::slot_of(c);
+  ink_assert(slot != 0 && slot <= EXPIRED);
+  if (slot == EXPIRED) {
+    _expired.remove(c);
+  } else {
+    int level = (slot - 1) / SLOTS;
+    int idx   = (slot - 1) % SLOTS;
+    _slots[level][idx].remove(c);
+    if (_slots[level][idx].empty()) {
+      _bits[level] &= ~(uint64_t(1) << idx);
+    }
+  }
+  D::set_slot(c, 0);
+  --_count;
+}
+
+template <class C, class L, class D>
+C *
+TimingWheel<C, L, D>::pop_expired()
+{
+  C *c = _expired.dequeue();
+  if (c) {
+    D::set_slot(c, 0);
+    --_count;
+  }
+  return c;
+}
+
+template <class C, class L, class D>
+void
+TimingWheel<C, L, D>::_expire(int idx)
+{
+  C *c;
+  while ((c = _slots[0][idx].dequeue())) {
+    _expired.enqueue(c);
+    D::set_slot(c, EXPIRED);
+  }
+  _bits[0] &= ~(uint64_t(1) << idx);
+}
+
+template <class C, class L, class D>
+template <typename F>
+void
+TimingWheel<C, L, D>::_cascade(int level, int idx, F &&drop)
+{
+  Queue<C, L> q = _slots[level][idx];
+  C *c;
+
+  _slots[level][idx].clear();
+  _bits[level] &= ~(uint64_t(1) << idx);
+  while ((c = q.dequeue())) {
+    D::set_slot(c, 0);
+    --_count;
+    if (!drop(c)) {
+      this->insert(c);
+    }
+  }
+}
+
+template <class C, class L, class D>
+template <typename F>
+void
+TimingWheel<C, L, D>::advance(int64_t now, F &&drop)
+{
+  int64_t target = now / _tick;
+
+  while (_now < target) {
+    int cur = _now & (SLOTS - 1);
+    int64_t next;
+
+    if (_bits[0]) {
+      // The next occupied level 0 slot in this span of 64 ticks.
+      uint64_t later = cur == SLOTS - 1 ? 0 : _bits[0] & (~uint64_t(0) << (cur + 1));
+      if (later) {
+        next = _now - cur + __builtin_ctzll(later);
+        if (next > target) {
+          break;
+        }
+        _now = next;
+        this->_expire(next & (SLOTS - 1));
+        continue;
+      }
+      next = _now - cur + SLOTS;
+    } else {
+      // Skip straight to the next cascade, if any.
+      next = this->_next_tick();
+    }
+    if (next > target) {
+      break;
+    }
+
+    // At the start of a span, cascade the upper levels into it.
+    _now = next;
+    for (int l = 1; l < LEVELS; ++l) {
+      int idx = (_now >> (BITS * l)) & (SLOTS - 1);
+      if (_bits[l] & (uint64_t(1) << idx)) {
+        this->_cascade(l, idx, drop);
+      }
+      if (idx != 0) {
+        break;
+      }
+    }
+    if (_bits[0] & 1) {
+      this->_expire(0);
+    }
+  }
+  _now = target;
+}
+
+template <class C, class L, class D>
+int64_t
+TimingWheel<C, L, D>::_next_tick() const
+{
+  int64_t best = INT64_MAX;
+  for (int l = 0; l < LEVELS; ++l) {
+    uint64_t bits = _bits[l];
+    if (bits == 0) {
+      continue;
+    }
+    // The first occupied slot after the current one, going round. For level 0 that is when
+    // the elements are due, for the others when they are cascaded, which is no later.
+    int shift     = BITS * l;
+    int start     = ((_now >> shift) + 1) & (SLOTS - 1);
+    uint64_t spin = start ? (bits >> start) | (bits << (SLOTS - start)) : bits;
+    int64_t at    = ((_now >> shift) + 1 + __builtin_ctzll(spin)) << shift;
+    if (at < best) {
+      best = at;
+    }
+  }
+  return best;
+}
+
+template <class C, class L, class D>
+int64_t
+TimingWheel<C, L, D>::next_due() const
+{
+  if (!_expired.empty()) {
+    return _now * _tick;
+  }
+  int64_t next = this->_next_tick();
+  return next == INT64_MAX ? next : next * _tick;
+}
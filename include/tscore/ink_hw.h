@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 #include "tscore/ink_config.h"
 
 #if TS_USE_HWLOC
@@ -31,3 +33,9 @@ hwloc_topology_t ink_get_topology();
 #endif
 
 int ink_number_of_processors();
+
+// Number of NUMA nodes, 1 if there is no NUMA support.
+int ink_number_of_numa_nodes();
+
+// Bind the pages of [ @a addr , @a addr + @a len ) to the NUMA node with the logical index @a node.
+bool ink_numa_bind_area(void *addr, size_t len, int node);
@@ -192,6 +192,12 @@ struct _InkFreeList {
   uint32_t type_size, chunk_size, used, allocated, alignment;
   uint32_t allocated_base, used_base;
   int advice;
+  int node; // NUMA node the chunks are bound to, -1 for none.
+
+  // Items freed by threads on other NUMA nodes, taken back when @a head runs dry.
+  // Kept on its own cache line so that remote frees do not contend with the local ones.
+  alignas(64) head_p remote;
+  uint32_t remote_freed;
 };
 
 typedef struct ink_freelist_ops InkFreeListOps;
@@ -212,6 +218,16 @@ void ink_freelist_madvise_init(InkFreeList **fl, const char *name, uint32_t type
 void *ink_freelist_new(InkFreeList *f);
 void ink_freelist_free(InkFreeList *f, void *item);
 void ink_freelist_free_bulk(InkFreeList *f, void *head, void *tail, size_t num_item);
+
+/*
+ * NUMA support. A freelist bound to a node allocates its chunks from that
+ * node. Threads on other nodes should free with ink_freelist_free_remote(),
+ * which parks the item until the freelist runs out of local items.
+ */
+void ink_freelist_bind_node(InkFreeList *f, int node);
+void ink_freelist_free_remote(InkFreeList *f, void *item);
+int ink_freelist_thread_node();
+void ink_freelist_set_thread_node(int node);
 void ink_freelists_dump(FILE *f);
 void ink_freelists_dump_baselinerel(FILE *f);
 void ink_freelists_snap_baseline();
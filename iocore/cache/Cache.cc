@@ -83,6 +83,9 @@ int cache_config_read_while_writer             = 0;
 int cache_config_mutex_retry_delay             = 2;
 int cache_read_while_writer_retry_delay        = 50;
 int cache_config_read_while_writer_max_retries = 10;
+int cache_config_admission_enabled             = 0;
+int cache_config_admission_threshold           = 2;
+int64_t cache_config_admission_capacity        = 1048576;
 
 // Globals
 
@@ -111,6 +114,7 @@ ClassAllocator<CacheRemoveCont> cacheRemoveContAllocator("cacheRemoveCont");
 ClassAllocator<EvacuationKey> evacuationKeyAllocator("evacuationKey");
 int CacheVC::size_to_init = -1;
 CacheKey zero_key;
+FrequencySketch *cache_admission_sketch = nullptr;
 
 struct VolInitInfo {
   off_t recover_pos;
@@ -443,7 +447,16 @@ void
 CacheVC::set_http_info(CacheHTTPInfo *ainfo)
 {
   ink_assert(!total_len);
-  if (f.update) {
+  if (ainfo->is_sparse()) {
+    // The size of a sparse alternate is known up front. Filling in more of an existing one stores
+    // the fragments under its keys, otherwise the fragments get new keys.
+    if (f.update && ainfo->compare_object_key(&update_key)) {
+      earliest_key = update_key;
+      key          = earliest_key;
+    } else {
+      ainfo->object_key_set(earliest_key);
+    }
+  } else if (f.update) {
     ainfo->object_key_set(update_key);
     ainfo->object_size_set(update_len);
   } else {
@@ -2091,13 +2104,14 @@ Cache::open(bool clear, bool /* fix ATS_UNUSED */)
         if (cp->disk_vols[i] && !DISK_BAD(cp->disk_vols[i]->disk)) {
           DiskVolBlockQueue *q = cp->disk_vols[i]->dpb_queue.head;
           for (; q; q = q->link.next) {
-            cp->vols[vol_no]            = new Vol();
-            CacheDisk *d                = cp->disk_vols[i]->disk;
-            cp->vols[vol_no]->disk      = d;
-            cp->vols[vol_no]->fd        = d->fd;
-            cp->vols[vol_no]->cache     = this;
-            cp->vols[vol_no]->cache_vol = cp;
-            blocks                      = q->b->len;
+            cp->vols[vol_no]               = new Vol();
+            CacheDisk *d                   = cp->disk_vols[i]->disk;
+            cp->vols[vol_no]->disk         = d;
+            cp->vols[vol_no]->fd           = d->fd;
+            cp->vols[vol_no]->cache        = this;
+            cp->vols[vol_no]->cache_vol    = cp;
+            cp->vols[vol_no]->agg_buf_size = cp->agg_size;
+            blocks                         = q->b->len;
 
             bool vol_clear = clear || d->cleared || q->new_block;
 #if AIO_MODE == AIO_MODE_NATIVE
@@ -2136,7 +2150,7 @@ CacheVC::dead(int /* event ATS_UNUSED */, Event * /*e ATS_UNUSED */)
 bool
 CacheVC::is_pread_capable()
 {
-  return !f.read_from_writer_called;
+  return f.sparse || !f.read_from_writer_called;
 }
 
 #define STORE_COLLISION 1
@@ -2315,11 +2329,10 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   }
   // see if its in the aggregation buffer
   if (dir_agg_buf_valid(vol, &dir)) {
-    int agg_offset = vol->vol_offset(&dir) - vol->header->write_pos;
-    buf            = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
-    ink_assert((agg_offset + io.aiocb.aio_nbytes) <= (unsigned)vol->agg_buf_pos);
+    buf       = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
     char *doc = buf->data();
-    char *agg = vol->agg_buffer + agg_offset;
+    char *agg = vol->agg_buf_doc(vol->vol_offset(&dir));
+    ink_assert(reinterpret_cast<Doc *>(agg)->len <= io.aiocb.aio_nbytes);
     memcpy(doc, agg, io.aiocb.aio_nbytes);
     io.aio_result = io.aiocb.aio_nbytes;
     SET_HANDLER(&CacheVC::handleReadDone);
@@ -2563,6 +2576,7 @@ cplist_update()
       if (config_vol->number == cp->vol_number) {
         if (cp->scheme == config_vol->scheme) {
           cp->ramcache_enabled = config_vol->ramcache_enabled;
+          cp->agg_size         = config_vol->agg_size;
           config_vol->cachep   = cp;
         } else {
           /* delete this volume from all the disks */
@@ -2630,6 +2644,7 @@ cplist_update()
             memset(new_cp->disk_vols, 0, gndisks * sizeof(DiskVol *));
             new_cp->vol_number = config_vol->number;
             new_cp->scheme     = config_vol->scheme;
+            new_cp->agg_size   = config_vol->agg_size;
             config_vol->cachep = new_cp;
             fillExclusiveDisks(config_vol->cachep);
             cp_list.enqueue(new_cp);
@@ -2845,6 +2860,7 @@ cplist_reconfigure()
           delete new_cp;
           return -1;
         }
+        new_cp->agg_size = config_vol->agg_size;
         cp_list.enqueue(new_cp);
         cp_list_len++;
         config_vol->cachep = new_cp;
@@ -3092,6 +3108,10 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("write.success", cache_write_success_stat);
   REG_INT("write.failure", cache_write_failure_stat);
   REG_INT("write.backlog.failure", cache_write_backlog_failure_stat);
+  REG_INT("write.agg_stall.count", cache_write_agg_stall_count_stat);
+  REG_INT("write.agg_stall.time", cache_write_agg_stall_time_stat);
+  REG_INT("admission.accepted", cache_admission_accepted_stat);
+  REG_INT("admission.rejected", cache_admission_rejected_stat);
   REG_INT("update.active", cache_update_active_stat);
   REG_INT("update.success", cache_update_success_stat);
   REG_INT("update.failure", cache_update_failure_stat);
@@ -3222,6 +3242,17 @@ ink_cache_init(ts::ModuleVersion v)
   REC_RegisterConfigUpdateFunc("proxy.config.cache.enable_read_while_writer", update_cache_config, nullptr);
   Debug("cache_init", "proxy.config.cache.enable_read_while_writer = %d", cache_config_read_while_writer);
 
+  REC_EstablishStaticConfigInt32(cache_config_admission_enabled, "proxy.config.cache.admission.enabled");
+  Debug("cache_init", "proxy.config.cache.admission.enabled = %d", cache_config_admission_enabled);
+
+  REC_EstablishStaticConfigInt32(cache_config_admission_threshold, "proxy.config.cache.admission.threshold");
+  Debug("cache_init", "proxy.config.cache.admission.threshold = %d", cache_config_admission_threshold);
+
+  REC_ReadConfigInteger(cache_config_admission_capacity, "proxy.config.cache.admission.capacity");
+  Debug("cache_init", "proxy.config.cache.admission.capacity = %" PRId64, cache_config_admission_capacity);
+  // Always built so the filter can be switched on without a restart.
+  cache_admission_sketch = new FrequencySketch(std::max<int64_t>(cache_config_admission_capacity, 1));
+
   register_cache_stats(cache_rsb, "proxy.process.cache");
 
   REC_ReadConfigInteger(cacheProcessor.wait_for_cache, "proxy.config.http.wait_for_cache");
@@ -3245,9 +3276,28 @@ Action *
 CacheProcessor::open_write(Continuation *cont, int expected_size, const HttpCacheKey *key, CacheHTTPHdr *request,
                            CacheHTTPInfo *old_info, time_t pin_in_cache, CacheFragType type)
 {
+  // Only objects which are not yet in the cache go through admission, updates of stored alternates
+  // and explicit PUSH requests always get written.
+  if (cache_config_admission_enabled && IsCacheReady(type) && (!old_info || (uintptr_t)old_info == CACHE_ALLOW_MULTIPLE_WRITES) &&
+      !(request && request->valid() && request->method_get_wksidx() == HTTP_WKSIDX_PUSH)) {
+    Vol *vol          = caches[type]->key_to_vol(&key->hash, key->hostname, key->hostlen);
+    ProxyMutex *mutex = cont->mutex.get();
+    if (admission_estimate(&key->hash) < cache_config_admission_threshold) {
+      CACHE_INCREMENT_DYN_STAT(cache_admission_rejected_stat);
+      cont->handleEvent(CACHE_EVENT_OPEN_WRITE_FAILED, (void *)-ECACHE_NOT_ADMITTED);
+      return ACTION_RESULT_DONE;
+    }
+    CACHE_INCREMENT_DYN_STAT(cache_admission_accepted_stat);
+  }
   return caches[type]->open_write(cont, &key->hash, old_info, pin_in_cache, nullptr /* key1 */, type, key->hostname, key->hostlen);
 }
 
+int
+CacheProcessor::admission_estimate(const CacheKey *key)
+{
+  return cache_admission_sketch ? cache_admission_sketch->estimate(key->u64[0], key->u64[1]) : 0;
+}
+
 //----------------------------------------------------------------------------
 // Note: this should not be called from the cluster processor, or bad
 // recursion could occur. This is merely a convenience wrapper.
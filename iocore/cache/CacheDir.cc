@@ -966,16 +966,28 @@ sync_cache_dir_on_shutdown()
     // check if we have data in the agg buffer
     // dont worry about the cachevc s in the agg queue
     // directories have not been inserted for these writes
-    if (d->agg_buf_pos) {
+    if (d->agg_flush_len || d->agg_buf_pos) {
       Debug("cache_dir_sync", "Dir %s: flushing agg buffer first", d->hash_text.get());
 
       // set write limit
-      d->header->agg_pos = d->header->write_pos + d->agg_buf_pos;
+      d->header->agg_pos = d->header->write_pos + d->agg_flush_len + d->agg_buf_pos;
 
-      int r = pwrite(d->fd, d->agg_buffer, d->agg_buf_pos, d->header->write_pos);
-      if (r != d->agg_buf_pos) {
-        ink_assert(!"flushing agg buffer failed");
-        continue;
+      // the buffer which may still be in flight goes first, it is laid out before the fill buffer
+      if (d->agg_flush_len) {
+        int r = pwrite(d->fd, d->agg_flush_buffer, d->agg_flush_len, d->header->write_pos);
+        if (r != d->agg_flush_len) {
+          ink_assert(!"flushing agg buffer failed");
+          continue;
+        }
+        d->header->write_pos += d->agg_flush_len;
+        d->agg_flush_len = 0;
+      }
+      if (d->agg_buf_pos) {
+        int r = pwrite(d->fd, d->agg_buffer, d->agg_buf_pos, d->header->write_pos);
+        if (r != d->agg_buf_pos) {
+          ink_assert(!"flushing agg buffer failed");
+          continue;
+        }
       }
       d->header->last_write_pos = d->header->write_pos;
       d->header->write_pos += d->agg_buf_pos;
@@ -650,6 +650,7 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
     int size              = 0;
     int in_percent        = 0;
     bool ramcache_enabled = true;
+    int agg_size          = AGG_SIZE;
 
     while (true) {
       // skip all blank spaces at beginning of line
@@ -749,6 +750,26 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
           err = "Unexpected end of line";
           break;
         }
+      } else if (strcasecmp(tmp, "agg_size") == 0) { // match agg_size
+        tmp += 9;
+        agg_size = atoi(tmp);
+
+        while (ParseRules::is_digit(*tmp)) {
+          tmp++;
+        }
+
+        if (*tmp == 'K' || *tmp == 'k') {
+          agg_size *= 1024;
+          tmp++;
+        } else if (*tmp == 'M' || *tmp == 'm') {
+          agg_size *= 1024 * 1024;
+          tmp++;
+        }
+        if (agg_size < AGG_MIN_SIZE || agg_size > AGG_SIZE) {
+          err = "Aggregation buffer size must be between 512K and 4M";
+          break;
+        }
+        agg_size = ROUND_TO_CACHE_BLOCK(agg_size);
       }
 
       // ends here
@@ -775,6 +796,7 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       configp->size             = size;
       configp->cachep           = nullptr;
       configp->ramcache_enabled = ramcache_enabled;
+      configp->agg_size         = agg_size;
       cp_queue.enqueue(configp);
       num_volumes++;
       if (scheme == CACHE_HTTP_TYPE) {
@@ -782,8 +804,8 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       } else {
         ink_release_assert(!"Unexpected non-HTTP cache volume");
       }
-      Debug("cache_hosting", "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d", volume_number, scheme, size,
-            in_percent, ramcache_enabled);
+      Debug("cache_hosting", "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d, agg size=%d", volume_number,
+            scheme, size, in_percent, ramcache_enabled, agg_size);
     }
 
     tmp = bufTok.iterNext(&i_state);
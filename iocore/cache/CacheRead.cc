@@ -33,6 +33,9 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
     return ACTION_RESULT_DONE;
   }
   ink_assert(caches[type] == this);
+  if (cache_config_admission_enabled) {
+    cache_admission_sketch->increment(key->u64[0], key->u64[1]);
+  }
 
   Vol *vol = key_to_vol(key, hostname, host_len);
   Dir result, *last_collision = nullptr;
@@ -99,6 +102,9 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
     return ACTION_RESULT_DONE;
   }
   ink_assert(caches[type] == this);
+  if (cache_config_admission_enabled) {
+    cache_admission_sketch->increment(key->u64[0], key->u64[1]);
+  }
 
   Vol *vol = key_to_vol(key, hostname, host_len);
   Dir result, *last_collision = nullptr;
@@ -288,6 +294,13 @@ CacheVC::openReadChooseWriter(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSE
       od = nullptr;
       return EVENT_RETURN;
     }
+    if (write_vc->alternate.is_sparse()) {
+      // A sparse fill is not written in order, read what is already on disk instead.
+      DDebug("cache_read_agg", "%p: key: %X writer alternate sparse", this, first_key.slice32(1));
+      write_vc = nullptr;
+      od       = nullptr;
+      return EVENT_RETURN;
+    }
 
     DDebug("cache_read_agg", "%p: key: %X eKey: %d # alts: %d, ndx: %d, # writers: %d writer: %p", this, first_key.slice32(1),
            write_vc->earliest_key.slice32(1), vector.count(), alternate_index, od->num_writers, write_vc);
@@ -616,6 +629,10 @@ CacheVC::openReadReadDone(int event, Event *e)
     // fall through for truncated documents
   }
 Lerror : {
+  if (f.sparse) {
+    // A fragment missing from a sparse alternate is a hole, not damage.
+    return calluser(VC_EVENT_ERROR);
+  }
   char tmpstring[CRYPTO_HEX_SIZE];
   if (request.valid()) {
     int url_length;
@@ -643,10 +660,32 @@ int
 CacheVC::openReadMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
   cancel_trigger();
-  Doc *doc         = reinterpret_cast<Doc *>(buf->data());
+  Doc *doc         = buf ? reinterpret_cast<Doc *>(buf->data()) : nullptr;
   int64_t ntodo    = vio.ntodo();
-  int64_t bytes    = doc->len - doc_pos;
+  int64_t bytes    = doc ? doc->len - doc_pos : 0;
   IOBufferBlock *b = nullptr;
+  if (f.sparse && (seek_to || !doc)) {
+    // The fragments of a sparse alternate all have the same size, so go straight to the one
+    // holding the data.
+    if (seek_to >= doc_len) {
+      vio.ndone = doc_len;
+      return calluser(VC_EVENT_EOS);
+    }
+    int target = seek_to / alternate.sparse_frag_size();
+    if (!doc || target != fragment) {
+      // Lread reads the fragment after the current one.
+      while (fragment < target - 1) {
+        next_CacheKey(&key, &key);
+        ++fragment;
+      }
+      while (fragment > target - 1) {
+        prev_CacheKey(&key, &key);
+        --fragment;
+      }
+      Debug("cache_seek", "Sparse seek @ %" PRId64 " -> #%d", seek_to, target);
+      goto Lread;
+    }
+  }
   if (seek_to) { // handle do_io_pread
     if (seek_to >= doc_len) {
       vio.ndone = doc_len;
@@ -830,6 +869,10 @@ Lread : {
     SET_HANDLER(&CacheVC::openReadMain);
     VC_SCHED_WRITER_RETRY();
   }
+  if (f.sparse) {
+    Debug("cache_read", "Sparse document %X missing fragment %X at %d", first_key.slice32(1), key.slice32(1), (int)vio.ndone);
+    goto Lerror;
+  }
   if (is_action_tag_set("cache")) {
     ink_release_assert(false);
   }
@@ -1186,6 +1229,10 @@ CacheVC::openReadStartHead(int event, Event *e)
             doc->key.toHexStr(xt), key.toHexStr(yt), f.single_fragment ? "single" : "multi", doc->len, doc->total_len,
             alternate.get_frag_offset_count());
     }
+    // The fragments of a sparse alternate are looked up when they are read.
+    if (frag_type == CACHE_FRAG_TYPE_HTTP && alternate.is_sparse()) {
+      goto Lsparse;
+    }
     // the first fragment might have been gc'ed. Make sure the first
     // fragment is there before returning CACHE_EVENT_OPEN_READ
     if (!f.single_fragment) {
@@ -1255,6 +1302,47 @@ Learliest:
   last_collision = nullptr;
   SET_HANDLER(&CacheVC::openReadStartEarliest);
   return openReadStartEarliest(event, e);
+Lsparse:
+  f.sparse     = 1;
+  first_buf    = buf;
+  buf          = nullptr;
+  earliest_key = key;
+  fragment     = -1;
+  dir_clear(&earliest_dir);
+  goto Lsuccess;
+}
+
+int64_t
+CacheVC::get_cached_length(int64_t offset, int64_t length)
+{
+  int64_t end = std::min(offset + length, static_cast<int64_t>(doc_len));
+  if (offset >= end) {
+    return 0;
+  }
+  if (!f.sparse) {
+    return end - offset;
+  }
+  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  if (!lock.is_locked()) {
+    return 0; // as if missing, the range goes to the origin
+  }
+  // Walk the fragments from the one holding @a offset until one is not in the directory.
+  int64_t frag_size = alternate.sparse_frag_size();
+  int64_t pos       = (offset / frag_size) * frag_size;
+  CacheKey k        = earliest_key;
+  for (int64_t i = 0; i < offset / frag_size; ++i) {
+    next_CacheKey(&k, &k);
+  }
+  Dir d;
+  while (pos < end) {
+    Dir *last = nullptr;
+    if (!dir_probe(&k, vol, &d, &last)) {
+      break;
+    }
+    pos += frag_size;
+    next_CacheKey(&k, &k);
+  }
+  return std::max<int64_t>(std::min(pos, end) - offset, 0);
 }
 
 /*
@@ -163,7 +163,7 @@ CacheVC::updateVector(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
       if (small_doc && have_res_alt && (fragment || (f.update && !total_len))) {
         // for multiple fragment document, we must have done
         // CacheVC:openWriteCloseDataDone
-        ink_assert(!fragment || f.data_done);
+        ink_assert(!fragment || f.data_done || f.sparse);
         od->move_resident_alt  = false;
         f.rewrite_resident_alt = 1;
         write_len              = doc->data_len();
@@ -252,10 +252,8 @@ CacheVC::handleWrite(int event, Event * /* e ATS_UNUSED */)
   } else {
     vol->agg.enqueue(this);
   }
-  if (!vol->is_io_in_progress()) {
-    return vol->aggWrite(event, this);
-  }
-  return EVENT_CONT;
+  // The fill buffer can take new writers even while the previous one is being written.
+  return vol->aggWrite(event, this);
 }
 
 static char *
@@ -377,7 +375,7 @@ Vol::aggWriteDone(int event, Event *e)
     if (header->write_pos + EVACUATION_SIZE > scan_pos) {
       periodic_scan();
     }
-    agg_buf_pos = 0;
+    agg_flush_len = 0;
     header->write_serial++;
   } else {
     // delete all the directory entries that we inserted
@@ -389,13 +387,15 @@ Vol::aggWriteDone(int event, Event *e)
           (uint64_t)(io.aiocb.aio_offset + io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
     Dir del_dir;
     dir_clear(&del_dir);
-    for (int done = 0; done < agg_buf_pos;) {
-      Doc *doc = reinterpret_cast<Doc *>(agg_buffer + done);
+    for (int done = 0; done < agg_flush_len;) {
+      Doc *doc = reinterpret_cast<Doc *>(agg_flush_buffer + done);
       dir_set_offset(&del_dir, header->write_pos + done);
       dir_delete(&doc->key, this, &del_dir);
       done += round_to_approx_size(doc->len);
     }
-    agg_buf_pos = 0;
+    // Skip over the failed range, the fill buffer has already been laid out after it.
+    header->write_pos += agg_flush_len;
+    agg_flush_len = 0;
   }
   set_io_not_in_progress();
   // callback ready sync CacheVCs
@@ -412,7 +412,7 @@ Vol::aggWriteDone(int event, Event *e)
     dir_sync_waiting = false;
     cacheDirSync->handleEvent(EVENT_IMMEDIATE, nullptr);
   }
-  if (agg.head || sync.head) {
+  if (agg.head || sync.head || agg_buf_pos) {
     return aggWrite(event, e);
   }
   return EVENT_CONT;
@@ -787,7 +787,7 @@ static int
 agg_copy(char *p, CacheVC *vc)
 {
   Vol *vol = vc->vol;
-  off_t o  = vol->header->write_pos + vol->agg_buf_pos;
+  off_t o  = vol->header->write_pos + vol->agg_flush_len + vol->agg_buf_pos;
 
   if (!vc->f.evacuator) {
     Doc *doc                   = reinterpret_cast<Doc *>(p);
@@ -810,7 +810,7 @@ agg_copy(char *p, CacheVC *vc)
     doc->v_major     = CACHE_DB_MAJOR_VERSION;
     doc->v_minor     = CACHE_DB_MINOR_VERSION;
     doc->unused      = 0; // force this for forward compatibility.
-    doc->total_len   = vc->total_len;
+    doc->total_len   = vc->f.sparse ? vc->alternate.object_size_get() : vc->total_len;
     doc->first_key   = vc->first_key;
     doc->sync_serial = vol->header->sync_serial;
     vc->write_serial = doc->write_serial = vol->header->write_serial;
@@ -853,14 +853,15 @@ agg_copy(char *p, CacheVC *vc)
       ink_assert(vc->f.use_first_key);
       if (vc->frag_type == CACHE_FRAG_TYPE_HTTP) {
         ink_assert(vc->write_vector->count() > 0);
-        if (!vc->f.update && !vc->f.evac_vector) {
+        // The size of a sparse alternate was set when it was created.
+        if (!vc->f.update && !vc->f.evac_vector && !vc->f.sparse) {
           ink_assert(!(vc->first_key == zero_key));
           CacheHTTPInfo *http_info = vc->write_vector->get(vc->alternate_index);
           http_info->object_size_set(vc->total_len);
         }
         // update + data_written =>  Update case (b)
         // need to change the old alternate's object length
-        if (vc->f.update && vc->total_len) {
+        if (vc->f.update && vc->total_len && !vc->f.sparse) {
           CacheHTTPInfo *http_info = vc->write_vector->get(vc->alternate_index);
           http_info->object_size_set(vc->total_len);
         }
@@ -1019,12 +1020,15 @@ Vol::agg_wrap()
    eventProcessor.schedule_xxx().
    Also, make sure that any functions called by this also use
    the eventProcessor to schedule events
+
+   The volume has two aggregation buffers. While one of them is being
+   written (agg_flush_buffer) writers keep being copied into the other
+   one (agg_buffer), laid out on disk directly after the in flight write.
+   Writers only wait when both buffers are busy.
 */
 int
 Vol::aggWrite(int event, void * /* e ATS_UNUSED */)
 {
-  ink_assert(!is_io_in_progress());
-
   Que(CacheVC, link) tocall;
   CacheVC *c;
 
@@ -1036,16 +1040,25 @@ Lagain:
     int writelen = c->agg_len;
     // [amc] this is checked multiple places, on here was it strictly less.
     ink_assert(writelen <= AGG_SIZE);
-    if (agg_buf_pos + writelen > AGG_SIZE || header->write_pos + agg_buf_pos + writelen > (skip + len)) {
+    // a fragment larger than agg_buf_size still goes into an empty buffer
+    if ((agg_buf_pos && agg_buf_pos + writelen > agg_buf_size) || agg_buf_pos + writelen > AGG_SIZE ||
+        header->write_pos + agg_flush_len + agg_buf_pos + writelen > (skip + len)) {
       break;
     }
-    DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_buf_pos, c->first_key.slice32(0));
+    DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_flush_len + agg_buf_pos,
+           c->first_key.slice32(0));
     int wrotelen = agg_copy(agg_buffer + agg_buf_pos, c);
     ink_assert(writelen == wrotelen);
     agg_todo_size -= writelen;
     agg_buf_pos += writelen;
     CacheVC *n = (CacheVC *)c->link.next;
     agg.dequeue();
+    if (c->agg_stall_start) {
+      Vol *vol = this;
+      CACHE_INCREMENT_DYN_STAT(cache_write_agg_stall_count_stat);
+      CACHE_SUM_DYN_STAT(cache_write_agg_stall_time_stat, Thread::get_hrtime() - c->agg_stall_start);
+      c->agg_stall_start = 0;
+    }
     if (c->f.sync && c->f.use_first_key) {
       CacheVC *last = sync.tail;
       while (last && UINT_WRAP_LT(c->write_serial, last->write_serial)) {
@@ -1060,6 +1073,12 @@ Lagain:
     c = n;
   }
 
+  // the other buffer is still being written, or an evacuation read is
+  // outstanding, the completion will pick up from here.
+  if (is_io_in_progress()) {
+    goto Lwait;
+  }
+
   // if we got nothing...
   if (!agg_buf_pos) {
     if (!agg.head && !sync.head) { // nothing to get
@@ -1084,19 +1103,21 @@ Lagain:
   }
 
   // evacuate space
-  off_t end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
-  if (evac_range(header->write_pos, end, !header->phase) < 0) {
-    goto Lwait;
-  }
-  if (end > skip + len) {
-    if (evac_range(start, start + (end - (skip + len)), header->phase) < 0) {
+  {
+    off_t end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
+    if (evac_range(header->write_pos, end, !header->phase) < 0) {
       goto Lwait;
     }
+    if (end > skip + len) {
+      if (evac_range(start, start + (end - (skip + len)), header->phase) < 0) {
+        goto Lwait;
+      }
+    }
   }
 
   // if agg.head, then we are near the end of the disk, so
   // write down the aggregation in whatever size it is.
-  if (agg_buf_pos < AGG_HIGH_WATER && !agg.head && !sync.head && !dir_sync_waiting) {
+  if (agg_buf_pos < agg_buf_size / 2 && !agg.head && !sync.head && !dir_sync_waiting) {
     goto Lwait;
   }
 
@@ -1116,10 +1137,15 @@ Lagain:
   // set write limit
   header->agg_pos = header->write_pos + agg_buf_pos;
 
+  // hand the filled buffer to the disk and start filling the other one
+  std::swap(agg_buffer, agg_flush_buffer);
+  agg_flush_len = agg_buf_pos;
+  agg_buf_pos   = 0;
+
   io.aiocb.aio_fildes = fd;
   io.aiocb.aio_offset = header->write_pos;
-  io.aiocb.aio_buf    = agg_buffer;
-  io.aiocb.aio_nbytes = agg_buf_pos;
+  io.aiocb.aio_buf    = agg_flush_buffer;
+  io.aiocb.aio_nbytes = agg_flush_len;
   io.action           = this;
   /*
     Callback on AIO thread so that we can issue a new write ASAP
@@ -1130,7 +1156,22 @@ Lagain:
   SET_HANDLER(&Vol::aggWriteDone);
   ink_aio_write(&io);
 
+  // let the waiting writers into the buffer that just became free
+  if (agg.head) {
+    goto Lagain;
+  }
+
 Lwait:
+  // remember when the writers left in the queue started waiting for buffer space
+  if (agg.head) {
+    ink_hrtime now = Thread::get_hrtime();
+    for (c = agg.tail; c && !c->agg_stall_start; c = (CacheVC *)c->link.prev) {
+      c->agg_stall_start = now;
+    }
+    if (!agg.head->agg_stall_start) {
+      agg.head->agg_stall_start = now;
+    }
+  }
   int ret = EVENT_CONT;
   while ((c = tocall.dequeue())) {
     if (event == EVENT_CALL && c->mutex->thread_holding == mutex->thread_holding) {
@@ -1154,7 +1195,8 @@ CacheVC::openWriteCloseDir(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED *
       VC_SCHED_LOCK_RETRY();
     }
     vol->close_write(this);
-    if (closed < 0 && fragment) {
+    // Fragments of a sparse alternate are independent, the ones already written stay valid.
+    if (closed < 0 && fragment && !f.sparse) {
       dir_delete(&earliest_key, vol, &earliest_dir);
     }
   }
@@ -1259,7 +1301,7 @@ CacheVC::openWriteCloseHead(int event, Event *e)
   } else {
     return openWriteCloseDir(event, e);
   }
-  if (f.data_done) {
+  if (f.data_done || f.sparse) {
     write_len = 0;
   } else {
     write_len = length;
@@ -1299,10 +1341,12 @@ CacheVC::openWriteCloseDataDone(int event, Event *e)
     } else {
       // Store the offset only if there is a table.
       // Currently there is no alt (and thence no table) for non-HTTP.
-      if (alternate.valid()) {
+      // A sparse alternate has its whole table from the start.
+      if (alternate.valid() && !f.sparse) {
         alternate.push_frag_offset(write_pos);
       }
     }
+    f.sparse_data = f.sparse;
     fragment++;
     write_pos += write_len;
     dir_insert(&key, vol, &dir);
@@ -1310,13 +1354,17 @@ CacheVC::openWriteCloseDataDone(int event, Event *e)
     next_CacheKey(&key, &key);
     if (length) {
       write_len = length;
-      if (write_len > MAX_FRAG_SIZE) {
+      if (f.sparse) {
+        write_len = sparse_write_len();
+      } else if (write_len > MAX_FRAG_SIZE) {
         write_len = MAX_FRAG_SIZE;
       }
-      if ((ret = do_write_call()) == EVENT_RETURN) {
-        goto Lcallreturn;
+      if (write_len) {
+        if ((ret = do_write_call()) == EVENT_RETURN) {
+          goto Lcallreturn;
+        }
+        return ret;
       }
-      return ret;
     }
     f.data_done = 1;
     return openWriteCloseHead(event, e); // must be called under vol lock from here
@@ -1339,6 +1387,18 @@ CacheVC::openWriteClose(int event, Event *e)
     }
   }
   if (closed > 0 || f.allow_empty_doc) {
+    if (f.sparse) {
+      // Store the rest only if it completes a fragment. The vector is not touched if nothing was
+      // stored.
+      if ((write_len = sparse_write_len())) {
+        SET_HANDLER(&CacheVC::openWriteCloseDataDone);
+        return do_write_lock_call();
+      } else if (!f.sparse_data) {
+        closed = -1;
+        return openWriteCloseDir(event, e);
+      }
+      return openWriteCloseHead(event, e);
+    }
     if (total_len == 0) {
       if (f.update || f.allow_empty_doc) {
         return updateVector(event, e);
@@ -1395,10 +1455,12 @@ CacheVC::openWriteWriteDone(int event, Event *e)
     } else {
       // Store the offset only if there is a table.
       // Currently there is no alt (and thence no table) for non-HTTP.
-      if (alternate.valid()) {
+      // A sparse alternate has its whole table from the start.
+      if (alternate.valid() && !f.sparse) {
         alternate.push_frag_offset(write_pos);
       }
     }
+    f.sparse_data = f.sparse;
     ++fragment;
     write_pos += write_len;
     dir_insert(&key, vol, &dir);
@@ -1421,6 +1483,35 @@ target_fragment_size()
   return value;
 }
 
+void
+CacheVC::set_write_offset(int64_t offset)
+{
+  ink_assert(vio.op == VIO::WRITE && !total_len);
+  if (!alternate.valid() || !alternate.is_sparse()) {
+    return;
+  }
+  if (!alternate.get_frag_offset_count()) {
+    alternate.sparse_layout_set(target_fragment_size());
+  }
+  // Only whole fragments are stored, so skip ahead to the first fragment boundary.
+  int64_t frag_size = alternate.sparse_frag_size();
+  f.sparse          = 1;
+  fragment          = (offset + frag_size - 1) / frag_size;
+  sparse_skip       = fragment * frag_size - offset;
+  write_pos         = fragment * frag_size;
+  key               = earliest_key;
+  for (int i = 0; i < fragment; ++i) {
+    next_CacheKey(&key, &key);
+  }
+}
+
+int64_t
+CacheVC::sparse_write_len()
+{
+  int64_t need = std::min(alternate.sparse_frag_size(), alternate.object_size_get() - static_cast<int64_t>(write_pos));
+  return need > 0 && length >= need ? need : 0;
+}
+
 int
 CacheVC::openWriteMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
@@ -1446,6 +1537,13 @@ Lagain:
       return EVENT_CONT;
     }
   }
+  if (sparse_skip) {
+    // Data in front of the first fragment boundary of a sparse write is dropped.
+    int64_t skip = std::min(sparse_skip, std::min(vio.ntodo(), vio.buffer.reader()->read_avail()));
+    vio.buffer.reader()->consume(skip);
+    vio.ndone   += skip;
+    sparse_skip -= skip;
+  }
   int64_t ntodo       = static_cast<int64_t>(vio.ntodo() + length);
   int64_t total_avail = vio.buffer.reader()->read_avail();
   int64_t avail       = total_avail;
@@ -1468,12 +1566,14 @@ Lagain:
     total_len += avail;
   }
   length = static_cast<uint64_t>(towrite);
-  if (length > target_fragment_size() && (length < target_fragment_size() + target_fragment_size() / 4)) {
+  if (f.sparse) {
+    write_len = sparse_write_len();
+  } else if (length > target_fragment_size() && (length < target_fragment_size() + target_fragment_size() / 4)) {
     write_len = target_fragment_size();
   } else {
     write_len = length;
   }
-  bool not_writing = towrite != ntodo && towrite < target_fragment_size();
+  bool not_writing = towrite != ntodo && (f.sparse ? !write_len : towrite < target_fragment_size());
   if (!called_user) {
     if (not_writing) {
       called_user = 1;
@@ -1493,6 +1593,10 @@ Lagain:
     SET_HANDLER(&CacheVC::openWriteClose);
     return openWriteClose(EVENT_NONE, nullptr);
   }
+  if (f.sparse && !write_len) {
+    // The rest of a sparse write does not complete a fragment.
+    return EVENT_CONT;
+  }
   SET_HANDLER(&CacheVC::openWriteWriteDone);
   return do_write_lock_call();
 }
@@ -116,6 +116,13 @@ struct CacheProcessor : public Processor {
   */
   bool has_online_storage() const;
 
+  /** Estimate how many times @a key was recently looked up.
+
+      This is the count the admission filter compares against @c proxy.config.cache.admission.threshold
+      before a new object is written. It saturates at a small value and decays over time.
+  */
+  static int admission_estimate(const CacheKey *key);
+
   static int IsCacheEnabled();
 
   static bool IsCacheReady(CacheFragType type);
@@ -188,6 +195,17 @@ struct CacheVConnection : public VConnection {
   virtual void set_http_info(CacheHTTPInfo *info)  = 0;
   virtual void get_http_info(CacheHTTPInfo **info) = 0;
 
+  /** Start writing a sparse alternate at byte @a offset of the object.
+      Must be called after @c set_http_info and before any data is written. Only whole fragments
+      are stored, leading and trailing bytes which do not fill a fragment are dropped.
+  */
+  virtual void set_write_offset(int64_t offset) = 0;
+  /** Get the number of bytes of the alternate present in the cache starting at @a offset.
+      The search stops after @a length bytes. This is always the rest of the object unless the
+      alternate is sparse.
+  */
+  virtual int64_t get_cached_length(int64_t offset, int64_t length) = 0;
+
   virtual bool is_ram_cache_hit() const   = 0;
   virtual bool set_pin_in_cache(time_t t) = 0;
   virtual time_t get_pin_in_cache()       = 0;
@@ -177,6 +177,7 @@ struct ConfigVol {
   off_t size;
   bool in_percent;
   bool ramcache_enabled;
+  int agg_size = AGG_SIZE;
   int percent;
   CacheVol *cachep;
   LINK(ConfigVol, link);
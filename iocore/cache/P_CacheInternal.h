@@ -25,6 +25,7 @@
 
 #include "tscore/ink_platform.h"
 #include "tscore/InkErrno.h"
+#include "tscore/FrequencySketch.h"
 
 #include "HTTP.h"
 #include "P_CacheHttp.h"
@@ -117,6 +118,10 @@ enum {
   cache_write_success_stat,
   cache_write_failure_stat,
   cache_write_backlog_failure_stat,
+  cache_write_agg_stall_count_stat,
+  cache_write_agg_stall_time_stat,
+  cache_admission_accepted_stat,
+  cache_admission_rejected_stat,
   cache_update_active_stat,
   cache_update_success_stat,
   cache_update_failure_stat,
@@ -227,6 +232,11 @@ extern int cache_config_target_fragment_size;
 extern int cache_config_mutex_retry_delay;
 extern int cache_read_while_writer_retry_delay;
 extern int cache_config_read_while_writer_max_retries;
+extern int cache_config_admission_enabled;
+extern int cache_config_admission_threshold;
+
+// Admission filter, tracks how often keys are looked up.
+extern FrequencySketch *cache_admission_sketch;
 
 // CacheVC
 struct CacheVC : public CacheVConnection {
@@ -388,6 +398,10 @@ struct CacheVC : public CacheVConnection {
   int64_t get_object_size() override;
   void set_http_info(CacheHTTPInfo *info) override;
   void get_http_info(CacheHTTPInfo **info) override;
+  void set_write_offset(int64_t offset) override;
+  int64_t get_cached_length(int64_t offset, int64_t length) override;
+  /// Bytes to write for the next fragment of a sparse alternate, 0 if not available yet.
+  int64_t sparse_write_len();
   /** Get the fragment table.
       @return The address of the start of the fragment table,
       or @c nullptr if there is no fragment table.
@@ -466,6 +480,7 @@ struct CacheVC : public CacheVConnection {
   ContinuationHandler save_handler;
   uint32_t pin_in_cache;
   ink_hrtime start_time;
+  ink_hrtime agg_stall_start; // when this writer found the aggregation buffers full
   int base_stat;
   int recursive;
   int closed;
@@ -478,6 +493,7 @@ struct CacheVC : public CacheVConnection {
   uint64_t total_len;    // total length written and available to write
   uint64_t doc_len;      // total_length (of the selected alternate for HTTP)
   uint64_t update_len;
+  int64_t sparse_skip; // bytes to drop before the first whole fragment of a sparse write
   int fragment;
   int scan_msec_delay;
   CacheVC *write_vc;
@@ -510,6 +526,8 @@ struct CacheVC : public CacheVConnection {
       unsigned int hit_evacuate : 1;
       unsigned int compressed_in_ram : 1; // compressed state in ram cache
       unsigned int allow_empty_doc : 1;   // used for cache empty http document
+      unsigned int sparse : 1;            // fixed size fragments of a sparse alternate
+      unsigned int sparse_data : 1;       // a sparse write stored at least one fragment
     } f;
   };
   // BTF optimization used to skip reading stuff in cache partition that doesn't contain any
@@ -37,7 +37,7 @@
 #define START_BLOCKS 16 // 8k, STORE_BLOCK_SIZE
 #define START_POS ((off_t)START_BLOCKS * CACHE_BLOCK_SIZE)
 #define AGG_SIZE (4 * 1024 * 1024)     // 4MB
-#define AGG_HIGH_WATER (AGG_SIZE / 2)  // 2MB
+#define AGG_MIN_SIZE (512 * 1024)      // 512KB, smallest configurable aggregation buffer
 #define EVACUATION_SIZE (2 * AGG_SIZE) // 8MB
 #define MAX_VOL_SIZE ((off_t)512 * 1024 * 1024 * 1024 * 1024)
 #define STORE_BLOCKS_PER_CACHE_BLOCK (STORE_BLOCK_SIZE / CACHE_BLOCK_SIZE)
@@ -144,9 +144,12 @@ struct Vol : public Continuation {
   Queue<CacheVC, Continuation::Link_link> agg;
   Queue<CacheVC, Continuation::Link_link> stat_cache_vcs;
   Queue<CacheVC, Continuation::Link_link> sync;
-  char *agg_buffer  = nullptr;
-  int agg_todo_size = 0;
-  int agg_buf_pos   = 0;
+  char *agg_buffer       = nullptr; // buffer being filled by new writers
+  char *agg_flush_buffer = nullptr; // buffer being written to disk
+  int agg_todo_size      = 0;
+  int agg_buf_pos        = 0; // bytes in agg_buffer
+  int agg_flush_len      = 0; // bytes in agg_flush_buffer, non-zero only while that write is in progress
+  int agg_buf_size       = AGG_SIZE;
 
   Event *trigger = nullptr;
 
@@ -236,6 +239,7 @@ struct Vol : public Continuation {
   int aggWriteDone(int event, Event *e);
   int aggWrite(int event, void *e);
   void agg_wrap();
+  char *agg_buf_doc(off_t offset);
 
   int evacuateWrite(CacheVC *evacuator, int event, Event *e);
   int evacuateDocReadDone(int event, Event *e);
@@ -269,13 +273,19 @@ struct Vol : public Continuation {
 
   Vol() : Continuation(new_ProxyMutex())
   {
-    open_dir.mutex = mutex;
-    agg_buffer     = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
+    open_dir.mutex   = mutex;
+    agg_buffer       = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
+    agg_flush_buffer = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
     memset(agg_buffer, 0, AGG_SIZE);
+    memset(agg_flush_buffer, 0, AGG_SIZE);
     SET_HANDLER(&Vol::aggWrite);
   }
 
-  ~Vol() override { ats_free(agg_buffer); }
+  ~Vol() override
+  {
+    ats_free(agg_buffer);
+    ats_free(agg_flush_buffer);
+  }
 };
 
 struct AIO_Callback_handler : public Continuation {
@@ -290,6 +300,7 @@ struct CacheVol {
   off_t size            = 0;
   int num_vols          = 0;
   bool ramcache_enabled = true;
+  int agg_size          = AGG_SIZE; // aggregation buffer size of each stripe
   Vol **vols            = nullptr;
   DiskVol **disk_vols   = nullptr;
   LINK(CacheVol, link);
@@ -391,7 +402,8 @@ Vol::vol_out_of_phase_write_valid(Dir *e)
 TS_INLINE int
 Vol::vol_in_phase_valid(Dir *e)
 {
-  return (dir_offset(e) - 1 < ((this->header->write_pos + this->agg_buf_pos - this->start) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 <
+          ((this->header->write_pos + this->agg_flush_len + this->agg_buf_pos - this->start) / CACHE_BLOCK_SIZE));
 }
 
 TS_INLINE off_t
@@ -415,7 +427,19 @@ Vol::vol_offset_to_offset(off_t pos)
 TS_INLINE int
 Vol::vol_in_phase_agg_buf_valid(Dir *e)
 {
-  return (this->vol_offset(e) >= this->header->write_pos && this->vol_offset(e) < (this->header->write_pos + this->agg_buf_pos));
+  return (this->vol_offset(e) >= this->header->write_pos &&
+          this->vol_offset(e) < (this->header->write_pos + this->agg_flush_len + this->agg_buf_pos));
+}
+
+// Locate a document which is still held in one of the aggregation buffers.
+TS_INLINE char *
+Vol::agg_buf_doc(off_t offset)
+{
+  off_t agg_offset = offset - this->header->write_pos;
+  if (agg_offset < this->agg_flush_len) {
+    return this->agg_flush_buffer + agg_offset;
+  }
+  return this->agg_buffer + (agg_offset - this->agg_flush_len);
 }
 // length of the partition not including the offset of location 0.
 TS_INLINE off_t
@@ -215,6 +215,10 @@ CacheWriteTest::do_io_write(size_t size)
     size = this->_size;
   }
   this->vc->set_http_info(&this->info);
+  if (this->write_offset >= 0) {
+    this->_cursor = (char *)GLOBAL_DATA + this->write_offset;
+    this->vc->set_write_offset(this->write_offset);
+  }
   this->vio = this->vc->do_io_write(this, size, this->_write_buffer->alloc_reader());
 }
 
@@ -285,6 +289,14 @@ CacheReadTest::do_io_read(size_t size)
   this->vio = this->vc->do_io_read(this, size, this->_read_buffer);
 }
 
+void
+CacheReadTest::do_io_pread(size_t size, int64_t offset)
+{
+  this->_cursor = (char *)GLOBAL_DATA + offset;
+  this->vc->get_http_info(&this->read_http_info);
+  this->vio = this->vc->do_io_pread(this, size, this->_read_buffer, offset);
+}
+
 int
 CacheReadTest::start_test(int event, void *e)
 {
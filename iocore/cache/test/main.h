@@ -198,6 +198,7 @@ public:
 
   HTTPInfo info;
   HTTPInfo old_info;
+  int64_t write_offset = -1; ///< Offset of the data in a sparse object.
 
 private:
   size_t _size             = 0;
@@ -221,6 +222,7 @@ public:
   int start_test(int event, void *e) override;
   int read_event(int event, void *e);
   void do_io_read(size_t size = 0) override;
+  void do_io_pread(size_t size, int64_t offset);
 
   HTTPInfo info;
   HTTPInfo *read_http_info = nullptr;
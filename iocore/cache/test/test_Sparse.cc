@@ -0,0 +1,210 @@
+/** @file
+
+  A brief file description
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+#include <vector>
+
+#define SPARSE_URL "http://www.scw44.com/"
+
+static int64_t
+frag_size()
+{
+  return cache_config_target_fragment_size - sizeof(Doc);
+}
+
+static int64_t
+sparse_size()
+{
+  return 4 * frag_size() + 1000;
+}
+
+// Write part of a sparse object. If @a fill the existing sparse alternate is read first and the
+// data goes in to it.
+class CacheSparseWrite : public CacheTestHandler
+{
+public:
+  CacheSparseWrite(int64_t offset, int64_t size, bool fill) : CacheTestHandler()
+  {
+    auto wt          = new CacheWriteTest(size, this, SPARSE_URL);
+    wt->write_offset = offset;
+    wt->info.sparse_set(sparse_size());
+    wt->mutex = this->mutex;
+    this->_wt = wt;
+
+    if (fill) {
+      this->_rt        = new CacheReadTest(size, this, SPARSE_URL);
+      this->_rt->mutex = this->mutex;
+    }
+
+    SET_HANDLER(&CacheSparseWrite::start_test);
+  }
+
+  int
+  start_test(int event, void *e)
+  {
+    REQUIRE(event == EVENT_IMMEDIATE);
+    this_ethread()->schedule_imm(this->_rt ? this->_rt : this->_wt);
+    return 0;
+  }
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    CacheWriteTest *wt = static_cast<CacheWriteTest *>(this->_wt);
+    switch (event) {
+    case CACHE_EVENT_OPEN_READ: {
+      REQUIRE(base->vc->alternate.is_sparse());
+      CryptoHash key;
+      base->vc->alternate.object_key_get(&key);
+      wt->old_info.copy(static_cast<HTTPInfo *>(&base->vc->alternate));
+      wt->info.copy_frag_offsets_from(&wt->old_info);
+      wt->info.object_key_set(key);
+      this->_rt->close();
+      this->_rt = nullptr;
+      this_ethread()->schedule_imm(this->_wt);
+      break;
+    }
+    case CACHE_EVENT_OPEN_WRITE:
+      base->do_io_write();
+      break;
+    case VC_EVENT_WRITE_READY:
+      base->reenable();
+      break;
+    case VC_EVENT_WRITE_COMPLETE:
+      base->close();
+      delete this;
+      break;
+    default:
+      REQUIRE(false);
+      break;
+    }
+  }
+};
+
+// Check which parts of the sparse object are cached, then read a range of it.
+class CacheSparseRead : public CacheTestHandler
+{
+public:
+  struct Cached {
+    int64_t offset;
+    int64_t length;
+    int64_t expected;
+  };
+
+  CacheSparseRead(int64_t offset, int64_t size, std::vector<Cached> cached, bool missing = false)
+    : CacheTestHandler(), _offset(offset), _size(size), _cached(std::move(cached)), _missing(missing)
+  {
+    this->_rt        = new CacheReadTest(size, this, SPARSE_URL);
+    this->_rt->mutex = this->mutex;
+
+    SET_HANDLER(&CacheSparseRead::start_test);
+  }
+
+  int
+  start_test(int event, void *e)
+  {
+    REQUIRE(event == EVENT_IMMEDIATE);
+    this_ethread()->schedule_imm(this->_rt);
+    return 0;
+  }
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_READ:
+      REQUIRE(base->vc->alternate.is_sparse());
+      REQUIRE(base->vc->alternate.object_size_get() == sparse_size());
+      for (auto const &c : this->_cached) {
+        CHECK(base->vc->get_cached_length(c.offset, c.length) == c.expected);
+      }
+      static_cast<CacheReadTest *>(base)->do_io_pread(this->_size, this->_offset);
+      break;
+    case VC_EVENT_READ_READY:
+      base->reenable();
+      break;
+    case VC_EVENT_ERROR:
+      CHECK(this->_missing);
+      base->close();
+      delete this;
+      break;
+    case VC_EVENT_READ_COMPLETE:
+      CHECK(!this->_missing);
+      base->close();
+      delete this;
+      break;
+    default:
+      REQUIRE(false);
+      break;
+    }
+  }
+
+private:
+  int64_t _offset;
+  int64_t _size;
+  std::vector<Cached> _cached;
+  bool _missing;
+};
+
+class CacheSparseInit : public CacheInit
+{
+public:
+  CacheSparseInit() {}
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    int64_t f = frag_size();
+
+    // The first two fragments.
+    CacheSparseWrite *w1 = new CacheSparseWrite(0, 2 * f, false);
+    CacheSparseRead *r1 =
+      new CacheSparseRead(f / 2, f, {{0, sparse_size(), 2 * f}, {f, f, f}, {f + 10, 10, 10}, {2 * f, 10, 0}, {3 * f, f, 0}});
+    CacheSparseRead *r2 = new CacheSparseRead(2 * f, 10, {}, true);
+    // The third fragment is not complete in this one, so only the last two are stored.
+    CacheSparseWrite *w2 = new CacheSparseWrite(2 * f + 10, sparse_size() - 2 * f - 10, true);
+    CacheSparseRead *r3  = new CacheSparseRead(
+      3 * f + 500, f, {{0, 2 * f, 2 * f}, {2 * f, f, 0}, {3 * f, sparse_size(), f + 1000}, {4 * f + 10, f, 990}, {sparse_size(), 1, 0}});
+    CacheSparseRead *r4 = new CacheSparseRead(0, 2 * f, {});
+    TerminalTest *tt    = new TerminalTest;
+
+    w1->add(r1);
+    w1->add(r2);
+    w1->add(w2);
+    w1->add(r3);
+    w1->add(r4);
+    w1->add(tt);
+    this_ethread()->schedule_imm(w1);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache sparse write -> read", "cache")
+{
+  init_cache(256 * 1024 * 1024);
+  CacheSparseInit *init = new CacheSparseInit;
+
+  this_ethread()->schedule_imm(init);
+  this_thread()->execute();
+}
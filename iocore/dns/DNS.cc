@@ -26,6 +26,8 @@
 
 #include "I_SplitDNS.h"
 
+#include <algorithm>
+
 #define SRV_COST (RRFIXEDSZ + 0)
 #define SRV_WEIGHT (RRFIXEDSZ + 2)
 #define SRV_PORT (RRFIXEDSZ + 4)
@@ -45,6 +47,7 @@ int dns_failover_period              = DEFAULT_FAILOVER_PERIOD;
 int dns_failover_try_period          = DEFAULT_FAILOVER_TRY_PERIOD;
 int dns_max_dns_in_flight            = MAX_DNS_IN_FLIGHT;
 int dns_max_tcp_continuous_failures  = MAX_DNS_TCP_CONTINUOUS_FAILURES;
+int dns_udp_sockets                  = DEFAULT_DNS_UDP_SOCKETS;
 int dns_validate_qname               = 0;
 unsigned int dns_handler_initialized = 0;
 int dns_ns_rr                        = 0;
@@ -219,6 +222,8 @@ DNSProcessor::start(int, size_t stacksize)
   REC_EstablishStaticConfigInt32(dns_validate_qname, "proxy.config.dns.validate_query_name");
   REC_EstablishStaticConfigInt32(dns_ns_rr, "proxy.config.dns.round_robin_nameservers");
   REC_EstablishStaticConfigInt32(dns_max_tcp_continuous_failures, "proxy.config.dns.max_tcp_continuous_failures");
+  REC_ReadConfigInt32(dns_udp_sockets, "proxy.config.dns.udp_sockets_per_nameserver");
+  dns_udp_sockets = std::clamp(dns_udp_sockets, 1, MAX_DNS_UDP_SOCKETS);
   REC_ReadConfigStringAlloc(dns_ns_list, "proxy.config.dns.nameservers");
   REC_ReadConfigStringAlloc(dns_local_ipv4, "proxy.config.dns.local_ipv4");
   REC_ReadConfigStringAlloc(dns_local_ipv6, "proxy.config.dns.local_ipv6");
@@ -499,44 +504,75 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
   } else if (!target) {
     target = &ip.sa;
   }
-  DNSConnection &cur_con = over_tcp ? tcpcon[icon] : udpcon[icon];
 
   Debug("dns", "open_con: opening connection %s", ats_ip_nptop(target, ip_text, sizeof ip_text));
 
-  if (cur_con.fd != NO_FD) { // Remove old FD from epoll fd
-    cur_con.close();
+  if (!over_tcp) { // Remove old FDs from epoll fd
+    close_udp_cons(icon);
   }
 
-  if (cur_con.connect(target, DNSConnection::Options()
-                                .setNonBlockingConnect(true)
-                                .setNonBlockingIo(true)
-                                .setUseTcp(over_tcp)
-                                .setBindRandomPort(true)
-                                .setLocalIpv6(&local_ipv6.sa)
-                                .setLocalIpv4(&local_ipv4.sa)) < 0) {
-    Debug("dns", "opening connection %s FAILED for %d", ip_text, icon);
-    if (!failed) {
-      if (dns_ns_rr) {
-        rr_failure(icon);
-      } else {
-        failover();
-      }
+  // Each UDP socket binds its own random source port, queries are spread across them.
+  int n_socks = over_tcp ? 1 : dns_udp_sockets;
+  for (int k = 0; k < n_socks; ++k) {
+    DNSConnection &cur_con = over_tcp ? tcpcon[icon] : udpcon[icon][k];
+
+    if (cur_con.fd != NO_FD) { // Remove old FD from epoll fd
+      cur_con.close();
     }
-    return false;
-  } else {
-    if (cur_con.eio.start(pd, &cur_con, EVENTIO_READ) < 0) {
-      Error("[iocore_dns] open_con: Failed to add %d server to epoll list\n", icon);
+
+    if (cur_con.connect(target, DNSConnection::Options()
+                                  .setNonBlockingConnect(true)
+                                  .setNonBlockingIo(true)
+                                  .setUseTcp(over_tcp)
+                                  .setBindRandomPort(true)
+                                  .setLocalIpv6(&local_ipv6.sa)
+                                  .setLocalIpv4(&local_ipv4.sa)) < 0) {
+      Debug("dns", "opening connection %s FAILED for %d", ip_text, icon);
+      if (k > 0) { // Already have a socket for this name server, make do with fewer.
+        break;
+      }
+      if (!failed) {
+        if (dns_ns_rr) {
+          rr_failure(icon);
+        } else {
+          failover();
+        }
+      }
+      return false;
     } else {
-      cur_con.num   = icon;
-      ns_down[icon] = 0;
-      Debug("dns", "opening connection %s on fd %d SUCCEEDED for %d", ip_text, cur_con.fd, icon);
+      if (cur_con.eio.start(pd, &cur_con, EVENTIO_READ) < 0) {
+        Error("[iocore_dns] open_con: Failed to add %d server to epoll list\n", icon);
+      } else {
+        cur_con.num   = icon;
+        ns_down[icon] = 0;
+        Debug("dns", "opening connection %s on fd %d SUCCEEDED for %d", ip_text, cur_con.fd, icon);
+      }
+      ret = true;
     }
-    ret = true;
   }
 
   return ret;
 }
 
+/** Close all the UDP connections to name server @a ndx. */
+void
+DNSHandler::close_udp_cons(int ndx)
+{
+  for (auto &con : udpcon[ndx]) {
+    if (con.fd != NO_FD) {
+      con.close();
+    }
+  }
+}
+
+/** Pick one of the open UDP connections to name server @a ndx at random. */
+DNSConnection &
+DNSHandler::udp_con(int ndx)
+{
+  DNSConnection &con = udpcon[ndx][dns_udp_sockets > 1 ? generator.random() % dns_udp_sockets : 0];
+  return con.fd != NO_FD ? con : udpcon[ndx][0];
+}
+
 void
 DNSHandler::validate_ip()
 {
@@ -665,7 +701,7 @@ DNSHandler::retry_named(int ndx, ink_hrtime t, bool reopen)
     Debug("dns", "retry_named: reopening DNS connection for index %d", ndx);
     last_primary_reopen = t;
     if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
-      udpcon[ndx].close();
+      close_udp_cons(ndx);
     }
     if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
       tcpcon[ndx].close();
@@ -673,7 +709,7 @@ DNSHandler::retry_named(int ndx, ink_hrtime t, bool reopen)
     open_cons(&m_res->nsaddr_list[ndx].sa, true, ndx);
   }
   bool over_tcp = dns_conn_mode == DNS_CONN_MODE::TCP_ONLY;
-  int con_fd    = over_tcp ? tcpcon[ndx].fd : udpcon[ndx].fd;
+  int con_fd    = over_tcp ? tcpcon[ndx].fd : udpcon[ndx][0].fd;
   unsigned char buffer[MAX_DNS_REQUEST_LEN];
   Debug("dns", "trying to resolve '%s' from DNS connection, ndx %d", try_server_names[try_servers], ndx);
   int r       = _ink_res_mkquery(m_res, try_server_names[try_servers], T_A, buffer, over_tcp);
@@ -697,7 +733,7 @@ DNSHandler::try_primary_named(bool reopen)
   if ((t - last_primary_retry) > DNS_PRIMARY_RETRY_PERIOD) {
     unsigned char buffer[MAX_DNS_REQUEST_LEN];
     bool over_tcp      = dns_conn_mode == DNS_CONN_MODE::TCP_ONLY;
-    int con_fd         = over_tcp ? tcpcon[0].fd : udpcon[0].fd;
+    int con_fd         = over_tcp ? tcpcon[0].fd : udpcon[0][0].fd;
     last_primary_retry = t;
     Debug("dns", "trying to resolve '%s' from primary DNS connection", try_server_names[try_servers]);
     int r = _ink_res_mkquery(m_res, try_server_names[try_servers], T_A, buffer, over_tcp);
@@ -772,7 +808,7 @@ DNSHandler::failover()
     switch_named(name_server);
   } else {
     if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
-      udpcon[0].close();
+      close_udp_cons(0);
     }
     if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
       tcpcon[0].close();
@@ -1034,21 +1070,55 @@ DNSHandler::mainEvent(int event, Event *e)
   return EVENT_CONT;
 }
 
+/** Add @a e to the in flight entries. */
+void
+DNSHandler::add_entry(DNSEntry *e)
+{
+  entries.enqueue(e);
+  index_qname(e);
+}
+
+/** Remove @a e from the in flight entries and release its query ids. */
+void
+DNSHandler::remove_entry(DNSEntry *e)
+{
+  entries.remove(e);
+  unindex_qname(e);
+  for (int i : e->id) {
+    if (i < 0) {
+      break;
+    }
+    release_query_id(i);
+  }
+}
+
+/** Index @a e by its current query name. */
+void
+DNSHandler::index_qname(DNSEntry *e)
+{
+  qname_entries.emplace(std::string_view(e->qname), e);
+}
+
+/** Drop the query name index of @a e, which must be done before the name is changed. */
+void
+DNSHandler::unindex_qname(DNSEntry *e)
+{
+  auto [first, last] = qname_entries.equal_range(std::string_view(e->qname));
+  for (auto spot = first; spot != last; ++spot) {
+    if (spot->second == e) {
+      qname_entries.erase(spot);
+      break;
+    }
+  }
+}
+
 /** Find a DNSEntry by id. */
 inline static DNSEntry *
 get_dns(DNSHandler *h, uint16_t id)
 {
-  for (DNSEntry *e = h->entries.head; e; e = static_cast<DNSEntry *>(e->link.next)) {
-    if (e->once_written_flag) {
-      for (int j : e->id) {
-        if (j == id) {
-          return e;
-        } else if (j < 0) {
-          goto Lnext;
-        }
-      }
-    }
-  Lnext:;
+  auto spot = h->qid_entries.find(id);
+  if (spot != h->qid_entries.end() && spot->second->once_written_flag) {
+    return spot->second;
   }
   return nullptr;
 }
@@ -1057,15 +1127,10 @@ get_dns(DNSHandler *h, uint16_t id)
 inline static DNSEntry *
 get_entry(DNSHandler *h, char *qname, int qtype)
 {
-  for (DNSEntry *e = h->entries.head; e; e = static_cast<DNSEntry *>(e->link.next)) {
-    if (e->qtype == qtype) {
-      if (is_addr_query(qtype)) {
-        if (!strcmp(qname, e->qname)) {
-          return e;
-        }
-      } else if (0 == memcmp(qname, e->qname, e->qname_len)) {
-        return e;
-      }
+  auto [first, last] = h->qname_entries.equal_range(std::string_view(qname));
+  for (auto spot = first; spot != last; ++spot) {
+    if (spot->second->qtype == qtype) {
+      return spot->second;
     }
   }
   return nullptr;
@@ -1180,7 +1245,8 @@ write_dns_event(DNSHandler *h, DNSEntry *e, bool over_tcp)
     h->release_query_id(e->id[dns_retries - e->retries]);
   }
   e->id[dns_retries - e->retries] = i;
-  int con_fd                      = over_tcp ? h->tcpcon[h->name_server].fd : h->udpcon[h->name_server].fd;
+  h->qid_entries[i]               = e;
+  int con_fd                      = over_tcp ? h->tcpcon[h->name_server].fd : h->udp_con(h->name_server).fd;
   Debug("dns", "send query (qtype=%d) for %s to fd %d", e->qtype, e->qname, con_fd);
 
   int s = socketManager.send(con_fd, buffer, r, 0);
@@ -1285,7 +1351,7 @@ DNSEntry::mainEvent(int event, Event *e)
       dup->dups.enqueue(this);
     } else {
       Debug("dns", "adding first to collapsing queue");
-      dnsH->entries.enqueue(this);
+      dnsH->add_entry(this);
       dnsProcessor.thread->schedule_imm(dnsH);
     }
     return EVENT_DONE;
@@ -1362,9 +1428,11 @@ dns_result(DNSHandler *h, DNSEntry *e, HostEnt *ent, bool retry, bool tcp_retry)
         if (e->orig_qname_len + strlen(*e->domains) + 2 > MAXDNAME) {
           Debug("dns", "domain too large %.*s + %s", e->orig_qname_len, e->qname, *e->domains);
         } else {
+          h->unindex_qname(e);
           e->qname[e->orig_qname_len] = '.';
           e->qname_len =
             e->orig_qname_len + 1 + ink_strlcpy(e->qname + e->orig_qname_len + 1, *e->domains, MAXDNAME - (e->orig_qname_len + 1));
+          h->index_qname(e);
           ++(e->domains);
           e->retries = dns_retries;
           Debug("dns", "new name = %s retries = %d", e->qname, e->retries);
@@ -1377,7 +1445,9 @@ dns_result(DNSHandler *h, DNSEntry *e, HostEnt *ent, bool retry, bool tcp_retry)
         ++(e->domains);
       } while (*e->domains);
     } else {
+      h->unindex_qname(e);
       e->qname[e->qname_len] = 0;
+      h->index_qname(e);
       if (!strchr(e->qname, '.') && !e->last) {
         e->last = true;
         write_dns(h, tcp_retry);
@@ -1399,15 +1469,8 @@ dns_result(DNSHandler *h, DNSEntry *e, HostEnt *ent, bool retry, bool tcp_retry)
     }
   }
 
-  // Remove head node from DNSHandler::entries queue
-  h->entries.remove(e);
-  // Release Query ID from DNSHandler
-  for (int i : e->id) {
-    if (i < 0) {
-      break;
-    }
-    h->release_query_id(i);
-  }
+  // Remove head node from DNSHandler::entries queue and release its query ids
+  h->remove_entry(e);
 
   if (is_debug_tag_set("dns")) {
     if (is_addr_query(e->qtype)) {
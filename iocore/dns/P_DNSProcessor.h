@@ -26,12 +26,17 @@
 #include "I_EventSystem.h"
 #include "tscore/PendingAction.h"
 
+#include <string_view>
+#include <unordered_map>
+
 #define MAX_NAMED 32
 #define DEFAULT_DNS_RETRIES 5
 #define MAX_DNS_RETRIES 9
 #define DEFAULT_DNS_TIMEOUT 30
 #define MAX_DNS_IN_FLIGHT 2048
 #define MAX_DNS_TCP_CONTINUOUS_FAILURES 10
+#define MAX_DNS_UDP_SOCKETS 16
+#define DEFAULT_DNS_UDP_SOCKETS 1
 #define DEFAULT_FAILOVER_NUMBER (DEFAULT_DNS_RETRIES + 1)
 #define DEFAULT_FAILOVER_PERIOD (DEFAULT_DNS_TIMEOUT + 30)
 // how many seconds before FAILOVER_PERIOD to try the primary with
@@ -52,6 +57,7 @@ extern int dns_failover_period;
 extern int dns_failover_try_period;
 extern int dns_max_dns_in_flight;
 extern int dns_max_tcp_continuous_failures;
+extern int dns_udp_sockets;
 extern unsigned int dns_sequence_number;
 
 //
@@ -167,8 +173,13 @@ struct DNSHandler : public Continuation {
   int ifd[MAX_NAMED];
   int n_con = 0;
   DNSConnection tcpcon[MAX_NAMED];
-  DNSConnection udpcon[MAX_NAMED];
+  /// UDP sockets per name server, each bound to its own random source port.
+  DNSConnection udpcon[MAX_NAMED][MAX_DNS_UDP_SOCKETS];
   Queue<DNSEntry> entries;
+  /// Entries in @a entries by the query ids they have been sent with.
+  std::unordered_map<uint16_t, DNSEntry *> qid_entries;
+  /// Entries in @a entries by query name, to collapse duplicate requests.
+  std::unordered_multimap<std::string_view, DNSEntry *> qname_entries;
   Queue<DNSConnection> triggered;
   int in_flight    = 0;
   int name_server  = 0;
@@ -241,10 +252,18 @@ struct DNSHandler : public Continuation {
   void switch_named(int ndx);
   uint16_t get_query_id();
 
+  void add_entry(DNSEntry *e);
+  void remove_entry(DNSEntry *e);
+  void index_qname(DNSEntry *e);
+  void unindex_qname(DNSEntry *e);
+  DNSConnection &udp_con(int ndx);
+  void close_udp_cons(int ndx);
+
   void
   release_query_id(uint16_t qid)
   {
     qid_in_flight[qid >> 6] &= (uint64_t) ~(0x1ULL << (qid & 0x3F));
+    qid_entries.erase(qid);
   };
 
   void
@@ -312,7 +331,9 @@ DNSHandler::DNSHandler()
     tcp_continuous_failures[i] = 0;
     ns_down[i]                 = 1;
     tcpcon[i].handler          = this;
-    udpcon[i].handler          = this;
+    for (auto &con : udpcon[i]) {
+      con.handler = this;
+    }
   }
   memset(&qid_in_flight, 0, sizeof(qid_in_flight));
   SET_HANDLER(&DNSHandler::startEvent);
@@ -145,8 +145,11 @@ SplitDNSConfig::reconfigure()
 
   if (nullptr != params->m_DNSSrvrTable->getHostMatcher() && nullptr == params->m_DNSSrvrTable->getReMatcher() &&
       nullptr == params->m_DNSSrvrTable->getIPMatcher() && 4 >= params->m_numEle) {
-    HostLookup *pxHL          = params->m_DNSSrvrTable->getHostMatcher()->getHLookup();
-    params->m_pxLeafArray     = pxHL->get_leaf_array();
+    auto *pxHM   = params->m_DNSSrvrTable->getHostMatcher();
+    auto &xNames = pxHM->getNames();
+    for (size_t i = 0; i < xNames.size(); ++i) {
+      params->m_xLeafArray.emplace_back(xNames[i], pxHM->data_array + i);
+    }
     params->m_bEnableFastPath = true;
   }
 
@@ -220,7 +223,7 @@ SplitDNS::findServer(RequestData *rdata, SplitDNSResult *result)
   /* ---------------------------
      the 'alleged' fast path ...
      --------------------------- */
-  if (m_bEnableFastPath && m_pxLeafArray) {
+  if (m_bEnableFastPath) {
     SplitDNSRecord *data_ptr = nullptr;
     char *pHost              = const_cast<char *>(rdata->get_host());
     if (nullptr == pHost) {
@@ -229,9 +232,9 @@ SplitDNS::findServer(RequestData *rdata, SplitDNSResult *result)
     }
 
     int len = strlen(pHost);
-    int n   = std::min(static_cast<size_t>(m_numEle), m_pxLeafArray->size());
+    int n   = std::min(static_cast<size_t>(m_numEle), m_xLeafArray.size());
     for (int i = 0; i < n; i++) {
-      const HostLeaf &pxHL = m_pxLeafArray->at(i);
+      const HostLeaf &pxHL = m_xLeafArray[i];
 
       if (false == pxHL.isNot && static_cast<int>(pxHL.match.size()) > len) {
         continue;
@@ -246,7 +249,8 @@ SplitDNS::findServer(RequestData *rdata, SplitDNSResult *result)
         pMatch++;
       }
 
-      int res = memcmp(pH, pMatch, pxHL.match.size());
+      // The names are lower cased by the host matcher.
+      int res = strncasecmp(pH, pMatch, pxHL.match.size());
 
       if ((0 != res && '!' == cNot) || (0 == res && '!' != cNot)) {
         data_ptr = static_cast<SplitDNSRecord *>(pxHL.opaque_data);
@@ -356,34 +356,21 @@ public:
 
   /** Default handler used until it is overridden.
 
-      This uses the cond var wait in @a ExternalQueue.
+      This waits on the thread's eventfd, or the cond var in @a EventQueueExternal
+      if there is no eventfd.
   */
   class DefaultTailHandler : public LoopTailHandler
   {
     // cppcheck-suppress noExplicitConstructor; allow implicit conversion
-    DefaultTailHandler(ProtectedQueue &q) : _q(q) {}
-
-    int
-    waitForActivity(ink_hrtime timeout) override
-    {
-      _q.wait(Thread::get_hrtime() + timeout);
-      return 0;
-    }
-    void
-    signalActivity() override
-    {
-      /* Try to acquire the `EThread::lock` of the Event Thread:
-       *   - Acquired, indicating that the Event Thread is sleep,
-       *               must send a wakeup signal to the Event Thread.
-       *   - Failed, indicating that the Event Thread is busy, do nothing.
-       */
-      (void)_q.try_signal();
-    }
-
-    ProtectedQueue &_q;
+    DefaultTailHandler(EThread &t) : _t(t) {}
+
+    int waitForActivity(ink_hrtime timeout) override;
+    void signalActivity() override;
+
+    EThread &_t;
 
     friend class EThread;
-  } DEFAULT_TAIL_HANDLER = EventQueueExternal;
+  } DEFAULT_TAIL_HANDLER = *this;
 
   /// Statistics data for event dispatching.
   struct EventMetrics {
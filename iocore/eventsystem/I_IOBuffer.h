@@ -110,7 +110,7 @@ enum AllocType {
 #define BUFFER_SIZE_FOR_CONSTANT(_size) (_size - DEFAULT_BUFFER_SIZES)
 #define BUFFER_SIZE_INDEX_FOR_CONSTANT_SIZE(_size) (_size + DEFAULT_BUFFER_SIZES)
 
-extern Allocator ioBufAllocator[DEFAULT_BUFFER_SIZES];
+extern NumaAllocator ioBufAllocator[DEFAULT_BUFFER_SIZES];
 
 void init_buffer_allocators(int iobuffer_advice);
 
@@ -224,6 +224,13 @@ public:
   */
   char *_data = nullptr;
 
+  /**
+    NUMA node of the ioBufAllocator pool the memory came from, -1 for
+    the pool that is not bound to a node.
+
+  */
+  int _numa_node = -1;
+
   const char *_location = nullptr;
 
   /**
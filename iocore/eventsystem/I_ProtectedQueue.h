@@ -24,16 +24,21 @@
 /****************************************************************************
 
   Protected Queue, a FIFO queue with the following functionality:
-  (1). Multiple threads could be simultaneously trying to enqueue
-       and dequeue. Hence the queue needs to be protected with mutex.
-  (2). In case the queue is empty, dequeue() sleeps for a specified
-       amount of time, or until a new element is inserted, whichever
-       is earlier
+  (1). Multiple threads could be simultaneously trying to enqueue,
+       only the owning thread dequeues. The external events are on a
+       lock free multiple producer, single consumer queue which the
+       owning thread takes in one batch.
+  (2). In case the queue is empty, the owning thread sleeps for a
+       specified amount of time, or until a new element is inserted,
+       whichever is earlier. Only the first insert after the thread
+       goes to sleep wakes it, the rest of a burst do not signal.
 
 
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
+
 #include "tscore/ink_platform.h"
 #include "I_Event.h"
 struct ProtectedQueue {
@@ -41,12 +46,21 @@ struct ProtectedQueue {
   void signal();
   int try_signal();             // Use non blocking lock and if acquired, signal
   void enqueue_local(Event *e); // Safe when called from the same thread
-  void remove(Event *e);
   Event *dequeue_local();
   void dequeue_external();       // Dequeue any external events.
   void wait(ink_hrtime timeout); // Wait for @a timeout nanoseconds on a condition variable if there are no events.
 
-  InkAtomicList al;
+  /** Mark the owning thread as about to sleep.
+
+      After this an enqueue from another thread signals the thread.
+      @return @c false if there are external events already, and the thread should not sleep.
+  */
+  bool sleep();
+  /// Mark the owning thread as awake, enqueues no longer signal it.
+  void wake();
+
+  MPSCQ(Event, link) al;
+  std::atomic<bool> sleeping{false};
   ink_mutex lock;
   ink_cond might_have_data;
   Que(Event, link) localQueue;
@@ -239,7 +239,7 @@ IOBufferData::alloc(int64_t size_index, AllocType type)
   switch (type) {
   case MEMALIGNED:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(size_index)) {
-      _data = (char *)ioBufAllocator[size_index].alloc_void();
+      _data = (char *)ioBufAllocator[size_index].alloc_void_numa(_numa_node);
       // coverity[dead_error_condition]
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(size_index)) {
       _data = (char *)ats_memalign(ats_pagesize(), index_to_buffer_size(size_index));
@@ -248,7 +248,7 @@ IOBufferData::alloc(int64_t size_index, AllocType type)
   default:
   case DEFAULT_ALLOC:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(size_index)) {
-      _data = (char *)ioBufAllocator[size_index].alloc_void();
+      _data = (char *)ioBufAllocator[size_index].alloc_void_numa(_numa_node);
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(size_index)) {
       _data = (char *)ats_malloc(BUFFER_SIZE_FOR_XMALLOC(size_index));
     }
@@ -265,7 +265,7 @@ IOBufferData::dealloc()
   switch (_mem_type) {
   case MEMALIGNED:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(_size_index)) {
-      ioBufAllocator[_size_index].free_void(_data);
+      ioBufAllocator[_size_index].free_void_numa(_data, _numa_node);
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(_size_index)) {
       ::free((void *)_data);
     }
@@ -273,7 +273,7 @@ IOBufferData::dealloc()
   default:
   case DEFAULT_ALLOC:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(_size_index)) {
-      ioBufAllocator[_size_index].free_void(_data);
+      ioBufAllocator[_size_index].free_void_numa(_data, _numa_node);
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(_size_index)) {
       ats_free(_data);
     }
@@ -282,6 +282,7 @@ IOBufferData::dealloc()
   _data       = nullptr;
   _size_index = BUFFER_SIZE_NOT_ALLOCATED;
   _mem_type   = NO_ALLOC;
+  _numa_node  = -1;
 }
 
 TS_INLINE void
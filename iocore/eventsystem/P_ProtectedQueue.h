@@ -34,9 +34,7 @@
 TS_INLINE
 ProtectedQueue::ProtectedQueue()
 {
-  Event e;
   ink_mutex_init(&lock);
-  ink_atomiclist_init(&al, "ProtectedQueue", (char *)&e.link.next - (char *)&e);
   ink_cond_init(&might_have_data);
 }
 
@@ -71,16 +69,6 @@ ProtectedQueue::enqueue_local(Event *e)
   localQueue.enqueue(e);
 }
 
-TS_INLINE void
-ProtectedQueue::remove(Event *e)
-{
-  ink_assert(e->in_the_prot_queue);
-  if (!ink_atomiclist_remove(&al, e)) {
-    localQueue.remove(e);
-  }
-  e->in_the_prot_queue = 0;
-}
-
 TS_INLINE Event *
 ProtectedQueue::dequeue_local()
 {
@@ -91,3 +79,21 @@ ProtectedQueue::dequeue_local()
   }
   return e;
 }
+
+TS_INLINE bool
+ProtectedQueue::sleep()
+{
+  // Pairs with the push and exchange in enqueue(), either the enqueue sees the flag or this sees the event.
+  sleeping.store(true, std::memory_order_seq_cst);
+  if (!al.empty()) {
+    sleeping.store(false, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+TS_INLINE void
+ProtectedQueue::wake()
+{
+  sleeping.store(false, std::memory_order_relaxed);
+}
@@ -33,13 +33,10 @@
 #include "P_EventSystem.h"
 
 // The protected queue is designed to delay signaling of threads
-// until some amount of work has been completed on the current thread
-// in order to prevent excess context switches.
-//
-// Defining EAGER_SIGNALLING disables this behavior and causes
-// threads to be made runnable immediately.
-//
-// #define EAGER_SIGNALLING
+// until they go to sleep, in order to prevent excess context switches
+// and system calls. A thread that is busy picks up the new events in
+// its next loop, a sleeping one is signaled once however many events
+// are enqueued before it wakes.
 
 extern ClassAllocator<Event> eventAllocator;
 
@@ -49,29 +46,22 @@ ProtectedQueue::enqueue(Event *e)
   ink_assert(!e->in_the_prot_queue && !e->in_the_priority_queue);
   EThread *e_ethread   = e->ethread;
   e->in_the_prot_queue = 1;
-  bool was_empty       = (ink_atomiclist_push(&al, e) == nullptr);
+  al.push(e);
 
-  if (was_empty) {
-    EThread *inserting_thread = this_ethread();
-    // queue e->ethread in the list of threads to be signalled
-    // inserting_thread == 0 means it is not a regular EThread
-    if (inserting_thread != e_ethread) {
-      e_ethread->tail_cb->signalActivity();
-    }
+  // inserting_thread == 0 means it is not a regular EThread
+  EThread *inserting_thread = this_ethread();
+  if (inserting_thread != e_ethread && sleeping.load(std::memory_order_seq_cst) &&
+      sleeping.exchange(false, std::memory_order_seq_cst)) {
+    e_ethread->tail_cb->signalActivity();
   }
 }
 
 void
 ProtectedQueue::dequeue_external()
 {
-  Event *e = static_cast<Event *>(ink_atomiclist_popall(&al));
-  // invert the list, to preserve order
-  SLL<Event, Event::Link_link> l, t;
-  t.head = e;
-  while ((e = t.pop())) {
-    l.push(e);
-  }
-  // insert into localQueue
+  SList(Event, link) l = al.popall();
+  Event *e;
+  // insert into localQueue, in order
   while ((e = l.pop())) {
     if (!e->cancelled) {
       localQueue.enqueue(e);
@@ -91,7 +81,7 @@ ProtectedQueue::wait(ink_hrtime timeout)
    *   - And then the Event Thread goes to sleep and waits for the wakeup signal of `EThread::might_have_data`,
    *   - The `EThread::lock` will be locked again when the Event Thread wakes up.
    */
-  if (INK_ATOMICLIST_EMPTY(al) && localQueue.empty()) {
+  if (al.empty() && localQueue.empty()) {
     timespec ts = ink_hrtime_to_timespec(timeout);
     ink_cond_timedwait(&might_have_data, &lock, &ts);
   }
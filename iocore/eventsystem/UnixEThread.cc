@@ -31,6 +31,7 @@
 #include "P_EventSystem.h"
 
 #if HAVE_EVENTFD
+#include <poll.h>
 #include <sys/eventfd.h>
 #endif
 
@@ -120,6 +121,38 @@ EThread::~EThread()
   }
 }
 
+int
+EThread::DefaultTailHandler::waitForActivity(ink_hrtime timeout)
+{
+#if HAVE_EVENTFD
+  struct pollfd pfd = {_t.evfd, POLLIN, 0};
+  timespec ts       = ink_hrtime_to_timespec(timeout);
+  if (ppoll(&pfd, 1, &ts, nullptr) > 0) {
+    uint64_t counter;
+    ATS_UNUSED_RETURN(read(_t.evfd, &counter, sizeof(uint64_t)));
+  }
+#else
+  _t.EventQueueExternal.wait(Thread::get_hrtime() + timeout);
+#endif
+  return 0;
+}
+
+void
+EThread::DefaultTailHandler::signalActivity()
+{
+#if HAVE_EVENTFD
+  uint64_t counter = 1;
+  ATS_UNUSED_RETURN(write(_t.evfd, &counter, sizeof(uint64_t)));
+#else
+  /* Try to acquire the `EThread::lock` of the Event Thread:
+   *   - Acquired, indicating that the Event Thread is sleep,
+   *               must send a wakeup signal to the Event Thread.
+   *   - Failed, indicating that the Event Thread is busy, do nothing.
+   */
+  (void)_t.EventQueueExternal.try_signal();
+#endif
+}
+
 bool
 EThread::is_event_type(EventType et)
 {
@@ -285,7 +318,12 @@ EThread::execute_regular()
       sleep_time = 0;
     }
 
+    // Only a sleeping thread is signaled, so if external events arrived in the meantime do not sleep.
+    if (sleep_time > 0 && !EventQueueExternal.sleep()) {
+      sleep_time = 0;
+    }
     tail_cb->waitForActivity(sleep_time);
+    EventQueueExternal.wake();
 
     // loop cleanup
     loop_finish_time = Thread::get_hrtime_updated();
@@ -344,6 +382,7 @@ EThread::execute()
      * When other threads try to acquire the `EThread::lock` of the target Event Thread:
      *   - Acquired, indicating that the target Event Thread is sleep,
      *   - Failed, indicating that the target Event Thread is busy.
+     * This is only how a sleeping thread is woken if there is no eventfd.
      */
     ink_mutex_acquire(&EventQueueExternal.lock);
     this->execute_regular();
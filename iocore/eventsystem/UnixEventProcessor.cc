@@ -201,6 +201,21 @@ ThreadAffinityInitializer::set_affinity(int, Event *)
     Debug("iocore_thread", "EThread: %d %s: %d", _name, obj->logical_index);
 #endif // HWLOC_API_VERSION
     hwloc_set_thread_cpubind(ink_get_topology(), t->tid, obj->cpuset, HWLOC_CPUBIND_STRICT);
+
+    // A thread that stays within one NUMA node allocates from that node's freelists.
+    hwloc_nodeset_t nodeset = hwloc_bitmap_alloc();
+    hwloc_cpuset_to_nodeset(ink_get_topology(), obj->cpuset, nodeset);
+    if (hwloc_get_nbobjs_by_type(ink_get_topology(), HWLOC_OBJ_NODE) > 1 && hwloc_bitmap_weight(nodeset) == 1) {
+      hwloc_obj_t node = hwloc_get_obj_by_type(ink_get_topology(), HWLOC_OBJ_NODE, 0);
+      while (node && !hwloc_bitmap_isset(nodeset, node->os_index)) {
+        node = node->next_cousin;
+      }
+      if (node) {
+        Debug("iocore_thread", "EThread: %p NUMA Node: %d", t, node->logical_index);
+        ink_freelist_set_thread_node(node->logical_index);
+      }
+    }
+    hwloc_bitmap_free(nodeset);
   } else {
     Warning("hwloc returned an unexpected number of objects -- CPU affinity disabled");
   }
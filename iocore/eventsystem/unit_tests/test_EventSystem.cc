@@ -21,6 +21,8 @@
   limitations under the License.
  */
 
+#include <atomic>
+
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
@@ -33,6 +35,36 @@
 #define TEST_TIME_SECOND 60
 #define TEST_THREADS 2
 
+TEST_CASE("EventSystemExternalQueue", "[iocore]")
+{
+  static std::atomic<int> count;
+  constexpr int BURST  = 1000;
+  constexpr int ROUNDS = 20;
+
+  struct counter : public Continuation {
+    counter(ProxyMutex *m) : Continuation(m) { SET_HANDLER(&counter::count_function); }
+
+    int
+    count_function(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+    {
+      ++count;
+      return 0;
+    }
+  };
+
+  // Bursts of immediate events from another thread, to threads that are asleep between the bursts.
+  counter *cont = new counter(new_ProxyMutex());
+  for (int round = 1; round <= ROUNDS; ++round) {
+    for (int i = 0; i < BURST; ++i) {
+      eventProcessor.schedule_imm(cont);
+    }
+    for (int i = 0; i < 1000 && count < round * BURST; ++i) {
+      usleep(1000);
+    }
+    REQUIRE(count == round * BURST);
+  }
+}
+
 TEST_CASE("EventSystem", "[iocore]")
 {
   static int count;
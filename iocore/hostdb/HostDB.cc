@@ -55,6 +55,8 @@ unsigned int hostdb_ip_stale_interval          = HOST_DB_IP_STALE;
 unsigned int hostdb_ip_timeout_interval        = HOST_DB_IP_TIMEOUT;
 unsigned int hostdb_ip_fail_timeout_interval   = HOST_DB_IP_FAIL_TIMEOUT;
 unsigned int hostdb_serve_stale_but_revalidate = 0;
+int hostdb_prefetch_count                      = 0;
+unsigned int hostdb_prefetch_lead_time         = 5;
 static ts_seconds hostdb_hostfile_check_interval{std::chrono::hours(24)};
 // Epoch timestamp of the current hosts file check. This also functions as a
 // cached version of ts_clock::now().
@@ -506,9 +508,12 @@ HostDBCache::start(int flags)
 
     Debug("hostdb", "Opening %s, partitions=%d storage_size=%" PRIu64 " items=%d", full_path, hostdb_partitions, hostdb_max_size,
           hostdb_max_count);
+    // The snapshot is mapped rather than read, records are loaded from it as they are looked up.
     int load_ret = LoadRefCountCacheFromPath<HostDBRecord>(*this->refcountcache, full_path, HostDBRecord::unmarshall);
     if (load_ret != 0) {
       Warning("Error loading cache from %s: %d", full_path, load_ret);
+    } else {
+      Note("mapped %zu HostDB records from %s", this->refcountcache->get_snapshot()->count(), full_path);
     }
 
     eventProcessor.schedule_imm(new HostDBSync(hostdb_sync_frequency, storage_path, full_path), ET_TASK);
@@ -551,6 +556,8 @@ HostDBProcessor::start(int, size_t)
   REC_EstablishStaticConfigInt32U(hostdb_ip_stale_interval, "proxy.config.hostdb.verify_after");
   REC_EstablishStaticConfigInt32U(hostdb_ip_fail_timeout_interval, "proxy.config.hostdb.fail.timeout");
   REC_EstablishStaticConfigInt32U(hostdb_serve_stale_but_revalidate, "proxy.config.hostdb.serve_stale_for");
+  REC_EstablishStaticConfigInt32(hostdb_prefetch_count, "proxy.config.hostdb.prefetch.count");
+  REC_EstablishStaticConfigInt32U(hostdb_prefetch_lead_time, "proxy.config.hostdb.prefetch.lead_time");
   REC_EstablishStaticConfigInt32U(hostdb_round_robin_max_count, "proxy.config.hostdb.round_robin_max_count");
 
   //
@@ -665,6 +672,20 @@ db_mark_for(IpAddr const &ip)
   return ip.isIp6() ? HOSTDB_MARK_IPV6 : HOSTDB_MARK_IPV4;
 }
 
+/** Start a refresh of @a hash on ET_DNS, without a waiting client.
+ */
+static void
+start_refresh(HostDBHash const &hash, HostResStyle style)
+{
+  HostDBContinuation *c = hostDBContAllocator.alloc();
+  HostDBContinuation::Options copt;
+  copt.host_res_style = style;
+  c->init(hash, copt);
+  c->refresh = true;
+  SET_CONTINUATION_HANDLER(c, (HostDBContHandler)&HostDBContinuation::refreshEvent);
+  eventProcessor.schedule_imm(c, ET_DNS);
+}
+
 HostDBRecord::Handle
 probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
 {
@@ -699,7 +720,7 @@ probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
   if ((!ignore_timeout && record->is_ip_configured_stale() && record->record_type != HostDBType::HOST) ||
       (record->is_ip_timeout() && record->serve_stale_but_revalidate())) {
     HOSTDB_INCREMENT_DYN_STAT(hostdb_total_serve_stale_stat);
-    if (hostDB.is_pending_dns_for_hash(hash.hash)) {
+    if (hostDB.is_pending_dns_for_hash(hash.hash) || !record->claim_refresh()) {
       Debug("hostdb", "%s",
             ts::bwprint(ts::bw_dbg, "stale {} {} {}, using with pending refresh", record->ip_age(),
                         record->ip_timestamp.time_since_epoch(), record->ip_timeout_interval)
@@ -710,12 +731,12 @@ probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
           ts::bwprint(ts::bw_dbg, "stale {} {} {}, using while refresh", record->ip_age(), record->ip_timestamp.time_since_epoch(),
                       record->ip_timeout_interval)
             .c_str());
-    HostDBContinuation *c = hostDBContAllocator.alloc();
-    HostDBContinuation::Options copt;
-    copt.host_res_style = record->af_family == AF_INET6 ? HOST_RES_IPV6_ONLY : HOST_RES_IPV4_ONLY;
-    c->init(hash, copt);
-    c->do_dns();
+    start_refresh(hash, record->af_family == AF_INET6 ? HOST_RES_IPV6_ONLY : HOST_RES_IPV4_ONLY);
+  } else if (hostdb_prefetch_count > 0 && hash.host_name && !record->is_failed() &&
+             record->ip_time_remaining() <= ts_seconds(hostdb_prefetch_lead_time)) {
+    hostDB.offer_prefetch(hash, record.get());
   }
+  ++record->hits;
   return record;
 }
 
@@ -1060,6 +1081,9 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
     if (!action.continuation) {
       // Nothing to do, give up.
       if (event == EVENT_INTERVAL) {
+        if (refresh) {
+          HOSTDB_INCREMENT_DYN_STAT(hostdb_refresh_misses_stat);
+        }
         // Timeout - clear all queries queued up for this FQDN because none of the other ones have sent an
         // actual DNS query. If the request rate is high enough this can cause a persistent queue where the
         // DNS query is never sent and all requests timeout, even if it was a transient error.
@@ -1137,6 +1161,10 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
       }
     } // else first is nullptr
 
+    if (refresh) {
+      HOSTDB_INCREMENT_DYN_STAT(failed ? hostdb_refresh_misses_stat : hostdb_refresh_hits_stat);
+    }
+
     // In the event that the lookup failed (SOA response-- for example) we want to use hash.host_name, since it'll be ""
     TextView query_name = (failed || !hash.host_name.empty()) ? hash.host_name : TextView{e->ent.h_name, strlen(e->ent.h_name)};
     HostDBRecord::Handle r{HostDBRecord::alloc(query_name, valid_records, failed ? 0 : e->srv_hosts.srv_hosts_length)};
@@ -1211,7 +1239,7 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
     if (!serve_stale) { // implies r != old_r
       auto const duration_till_revalidate = r->expiry_time().time_since_epoch();
       auto const seconds_till_revalidate  = duration_cast<ts_seconds>(duration_till_revalidate).count();
-      hostDB.refcountcache->put(r->key, r.get(), r->_record_size, seconds_till_revalidate);
+      hostDB.refcountcache->put(r->key, r.get(), r->_record_size - sizeof(HostDBRecord), seconds_till_revalidate);
     } else {
       Warning("Fallback to serving stale record, skip re-update of hostdb for %.*s", int(query_name.size()), query_name.data());
     }
@@ -1387,6 +1415,21 @@ HostDBContinuation::probeEvent(int /* event ATS_UNUSED */, Event *e)
   return EVENT_DONE;
 }
 
+//
+// Background refresh state, runs on ET_DNS
+//
+int
+HostDBContinuation::refreshEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  // One lookup per name is enough, a client lookup may have started since this was scheduled.
+  if (hostDB.is_pending_dns_for_hash(hash.hash)) {
+    hostdb_cont_free(this);
+    return EVENT_DONE;
+  }
+  do_dns();
+  return EVENT_DONE;
+}
+
 int
 HostDBContinuation::set_check_pending_dns()
 {
@@ -1524,6 +1567,10 @@ HostDBContinuation::backgroundEvent(int /* event ATS_UNUSED */, Event * /* e ATS
 
   hostdb_current_timestamp = ts_clock::now();
 
+  if (hostdb_prefetch_count > 0) {
+    hostDB.prefetch(hostdb_prefetch_count);
+  }
+
   // Do nothing if hosts file checking is not enabled.
   if (hostdb_hostfile_check_interval.count() == 0) {
     return EVENT_CONT;
@@ -1562,6 +1609,56 @@ HostDBContinuation::backgroundEvent(int /* event ATS_UNUSED */, Event * /* e ATS
   return EVENT_CONT;
 }
 
+void
+HostDBCache::offer_prefetch(HostDBHash const &hash, HostDBRecord *r)
+{
+  // Best effort, skip rather than wait on another thread.
+  std::unique_lock lock(prefetch_mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  if (auto spot = prefetch_candidates.find(r->key); spot != prefetch_candidates.end()) {
+    spot->second.record = r;
+  } else if (prefetch_candidates.size() < HOST_DB_MAX_PREFETCH_CANDIDATES) {
+    auto &c   = prefetch_candidates[r->key];
+    c.name    = std::string(hash.host_name);
+    c.db_mark = hash.db_mark;
+    c.port    = hash.port;
+    c.record  = r;
+  }
+}
+
+void
+HostDBCache::prefetch(int count)
+{
+  std::vector<PrefetchCandidate> candidates;
+  {
+    std::lock_guard lock(prefetch_mutex);
+    candidates.reserve(prefetch_candidates.size());
+    for (auto &&[key, c] : prefetch_candidates) {
+      candidates.emplace_back(std::move(c));
+    }
+    prefetch_candidates.clear();
+  }
+
+  auto hottest = candidates.begin() + std::min<size_t>(count, candidates.size());
+  std::partial_sort(candidates.begin(), hottest, candidates.end(),
+                    [](PrefetchCandidate const &lhs, PrefetchCandidate const &rhs) { return lhs.record->hits > rhs.record->hits; });
+  for (auto spot = candidates.begin(); spot != hottest; ++spot) {
+    if (!spot->record->claim_refresh()) {
+      continue;
+    }
+    Debug("hostdb", "prefetch %s, %u hits", spot->name.c_str(), spot->record->hits.load());
+    HostDBHash hash;
+    hash.set_host(spot->name);
+    hash.db_mark = spot->db_mark;
+    hash.port    = spot->port;
+    hash.refresh();
+    start_refresh(hash, host_res_style_for(hash.db_mark));
+    HOSTDB_INCREMENT_THREAD_DYN_STAT(hostdb_prefetch_stat, this_ethread());
+  }
+}
+
 HostDBInfo *
 HostDBRecord::select_best_http(ts_time now, ts_seconds fail_window, sockaddr const *hash_addr)
 {
@@ -1980,6 +2077,15 @@ ink_hostdb_init(ts::ModuleVersion v)
   RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.insert_duplicate_to_pending_dns", RECD_INT, RECP_PERSISTENT,
                      (int)hostdb_insert_duplicate_to_pending_dns_stat, RecRawStatSyncSum);
 
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.refresh.hits", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_refresh_hits_stat, RecRawStatSyncSum);
+
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.refresh.misses", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_refresh_misses_stat, RecRawStatSyncSum);
+
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.prefetch", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_prefetch_stat, RecRawStatSyncSum);
+
   ts_host_res_global_init();
 }
 
@@ -2263,13 +2369,23 @@ HostDBRecord::unmarshall(char *buff, unsigned size)
   if (size < sizeof(self_type)) {
     return nullptr;
   }
-  auto src = reinterpret_cast<self_type *>(buff);
-  ink_release_assert(size == src->_record_size);
-  auto ptr  = ioBufAllocator[src->_iobuffer_index].alloc_void();
+  // The buffer comes from disk, check that it is laid out like a record of its size before using it.
+  auto src           = reinterpret_cast<self_type *>(buff);
+  int iobuffer_index = iobuffer_size_to_index(size, hostdb_max_iobuf_index);
+  if (size != src->_record_size || iobuffer_index < 0 || src->rr_offset < sizeof(self_type) ||
+      src->rr_offset + src->rr_count * sizeof(HostDBInfo) > size || buff[src->rr_offset - 1] != '\0') {
+    Debug("hostdb", "discarding persisted record of %u bytes, it is not valid", size);
+    return nullptr;
+  }
+  auto ptr  = ioBufAllocator[iobuffer_index].alloc_void();
   auto self = static_cast<self_type *>(ptr);
   new (self) self_type();
   auto delta = sizeof(RefCountObj); // skip the VFTP and ref count.
   memcpy(static_cast<std::byte *>(ptr) + delta, buff + delta, size - delta);
+  self->_iobuffer_index = iobuffer_index;
+  // Usage is local to this run.
+  self->hits         = 0;
+  self->refresh_time = TS_TIME_ZERO;
   return self;
 }
 
@@ -2294,6 +2410,17 @@ HostDBRecord::serve_stale_but_revalidate() const
   return false;
 }
 
+bool
+HostDBRecord::claim_refresh()
+{
+  ts_time last = refresh_time.load();
+  // A refresh holds the claim for as long as its lookup may take.
+  if (hostdb_current_timestamp - last < ts_seconds(std::max(hostdb_lookup_timeout, 1))) {
+    return false;
+  }
+  return refresh_time.compare_exchange_strong(last, hostdb_current_timestamp);
+}
+
 HostDBInfo *
 HostDBRecord::select_best_srv(char *target, InkRand *rand, ts_time now, ts_seconds fail_window)
 {
@@ -76,6 +76,12 @@ extern unsigned int hostdb_ip_stale_interval;
 extern unsigned int hostdb_ip_timeout_interval;
 extern unsigned int hostdb_ip_fail_timeout_interval;
 extern unsigned int hostdb_serve_stale_but_revalidate;
+/// Number of the hottest soon to expire names to refresh each second.
+/// This corresponds to proxy.config.hostdb.prefetch.count.
+extern int hostdb_prefetch_count;
+/// How long before expiring a name can be prefetched.
+/// This corresponds to proxy.config.hostdb.prefetch.lead_time.
+extern unsigned int hostdb_prefetch_lead_time;
 extern unsigned int hostdb_round_robin_max_count;
 
 extern int hostdb_max_iobuf_index;
@@ -344,6 +350,12 @@ public:
   /// proxy.config.hostdb.ttl_mode.
   ts_seconds ip_timeout_interval;
 
+  /// Lookups served from this record, used to pick the names to prefetch.
+  std::atomic<uint32_t> hits{0};
+
+  /// When a background refresh of this record was last started.
+  std::atomic<ts_time> refresh_time{TS_TIME_ZERO};
+
   /** Atomically advance the round robin index.
    *
    * If multiple threads call this simultaneously each thread will get a distinct return value.
@@ -456,6 +468,13 @@ public:
    */
   bool serve_stale_but_revalidate() const;
 
+  /** Claim the background refresh of this record.
+   *
+   * @return @c true if the caller should start a refresh, @c false if another one was started
+   * recently enough that it may still be running.
+   */
+  bool claim_refresh();
+
   /// Deallocate @a this.
   void free() override;
 
@@ -487,7 +506,7 @@ public:
   static self_type *unmarshall(char *buff, unsigned size);
 
   /// Database version.
-  static constexpr ts::VersionNumber Version{3, 0};
+  static constexpr ts::VersionNumber Version{3, 1};
 
 protected:
   /// Current active info.
@@ -27,7 +27,9 @@
 
 #pragma once
 
+#include <mutex>
 #include <shared_mutex>
+#include <string>
 
 #include "I_HostDBProcessor.h"
 #include "tscore/TsBuffer.h"
@@ -109,6 +111,8 @@ const unsigned int HOST_DB_MAX_TTL = (0x1FFFFF); // 24 days
 // period to wait for a remote probe...
 #define HOST_DB_RETRY_PERIOD HRTIME_MSECONDS(20)
 #define HOST_DB_ITERATE_PERIOD HRTIME_MSECONDS(5)
+// most names remembered between prefetch passes
+#define HOST_DB_MAX_PREFETCH_CANDIDATES 4096
 
 //#define TEST(_x) _x
 #define TEST(_x)
@@ -124,6 +128,9 @@ enum HostDB_Stats {
   hostdb_ttl_expires_stat,       // D == TTL Expires
   hostdb_re_dns_on_reload_stat,
   hostdb_insert_duplicate_to_pending_dns_stat,
+  hostdb_refresh_hits_stat,   // D == background refreshes which got a fresh answer
+  hostdb_refresh_misses_stat, // D == background refreshes which failed
+  hostdb_prefetch_stat,       // D == refreshes started ahead of expiry
   HostDB_Stat_Count
 };
 
@@ -179,6 +186,22 @@ struct HostDBCache {
   bool is_pending_dns_for_hash(const CryptoHash &hash);
 
   std::shared_ptr<HostFileMap> acquire_host_file();
+
+  /// A name which is about to expire.
+  struct PrefetchCandidate {
+    std::string name;
+    HostDBMark db_mark = HOSTDB_MARK_GENERIC;
+    in_port_t port     = 0;
+    HostDBRecord::Handle record;
+  };
+  /// Names offered for prefetch since the last prefetch pass, by folded hash.
+  std::unordered_map<uint64_t, PrefetchCandidate> prefetch_candidates;
+  std::mutex prefetch_mutex;
+
+  /// Note that the record @a r for @a hash is in use and about to expire.
+  void offer_prefetch(HostDBHash const &hash, HostDBRecord *r);
+  /// Start refreshes for the @a count hottest offered names.
+  void prefetch(int count);
 };
 
 //
@@ -248,6 +271,7 @@ struct HostDBContinuation : public Continuation {
 
   unsigned int missing : 1;
   unsigned int force_dns : 1;
+  unsigned int refresh : 1; ///< Background refresh, no client is waiting.
 
   int probeEvent(int event, Event *e);
   int iterateEvent(int event, Event *e);
@@ -256,6 +280,7 @@ struct HostDBContinuation : public Continuation {
   int backgroundEvent(int event, Event *e);
   int retryEvent(int event, Event *e);
   int setbyEvent(int event, Event *e);
+  int refreshEvent(int event, Event *e);
 
   /// Recompute the hash and update ancillary values.
   void refresh_hash();
@@ -299,7 +324,7 @@ struct HostDBContinuation : public Continuation {
   int make_get_message(char *buf, int len);
   int make_put_message(HostDBInfo *r, Continuation *c, char *buf, int len);
 
-  HostDBContinuation() : missing(false), force_dns(DEFAULT_OPTIONS.force_dns)
+  HostDBContinuation() : missing(false), force_dns(DEFAULT_OPTIONS.force_dns), refresh(false)
   {
     ink_zero(hash_host_name_store);
     ink_zero(hash.hash);
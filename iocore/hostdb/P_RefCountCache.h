@@ -34,13 +34,18 @@
 #include "tscore/I_Version.h"
 #include <unistd.h>
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
 #define REFCOUNT_CACHE_EVENT_SYNC REFCOUNT_CACHE_EVENT_EVENTS_START
 
 #define REFCOUNTCACHE_MAGIC_NUMBER 0x0BAD2D9
 
-static constexpr unsigned char REFCOUNTCACHE_MAJOR_VERSION = 1;
+static constexpr unsigned char REFCOUNTCACHE_MAJOR_VERSION = 2;
 static constexpr unsigned char REFCOUNTCACHE_MINOR_VERSION = 0;
-static constexpr ts::VersionNumber REFCOUNTCACHE_VERSION(1, 0);
+static constexpr ts::VersionNumber REFCOUNTCACHE_VERSION(2, 0);
 
 // Stats
 enum RefCountCache_Stats {
@@ -377,11 +382,106 @@ public:
   bool compatible(RefCountCacheHeader *that) const;
 };
 
+// A snapshot of the cache on disk is laid out so that it can be mapped and read in place:
+//
+//    RefCountCacheHeader
+//    RefCountCacheSnapshotInfo
+//    item data, each item starting on an 8 byte boundary
+//    RefCountCacheSnapshotEntry[count], sorted by key
+//
+// Opening a snapshot reads only the header and the info, each item is checked when it is first
+// looked up and is moved into the cache then. A restart therefore does not wait for the whole
+// file to be read, and items that are never asked for again are never read at all.
+struct RefCountCacheSnapshotInfo {
+  uint64_t count;        // entries in the index
+  uint64_t index_offset; // file offset of the index
+};
+
+struct RefCountCacheSnapshotEntry {
+  uint64_t key;
+  uint64_t offset; // file offset of the item data
+  uint32_t size;
+  uint32_t checksum; // FNV-1a of the item data
+  int64_t expiry_time;
+};
+
+// Items are aligned to this, and the first one starts at the data offset.
+static constexpr uint64_t REFCOUNTCACHE_SNAPSHOT_ALIGN = 8;
+static constexpr uint64_t REFCOUNTCACHE_SNAPSHOT_DATA_OFFSET =
+  (sizeof(RefCountCacheHeader) + sizeof(RefCountCacheSnapshotInfo) + REFCOUNTCACHE_SNAPSHOT_ALIGN - 1) &
+  ~(REFCOUNTCACHE_SNAPSHOT_ALIGN - 1);
+
+// Writes a snapshot to a temporary file, then moves it over the old snapshot once it is complete.
+// The methods return 0 on success or -errno.
+class RefCountCacheSnapshotWriter
+{
+public:
+  RefCountCacheSnapshotWriter() = default;
+  ~RefCountCacheSnapshotWriter();
+
+  int open(const std::string &tmp_filename, RefCountCacheHeader const &header);
+  int append(uint64_t key, const void *data, unsigned int size, ink_time_t expiry_time);
+  // Write the index, sync and rename to @a filename in @a dirname.
+  int commit(const std::string &dirname, const std::string &filename);
+
+  size_t count() const;
+
+  // noncopyable
+  RefCountCacheSnapshotWriter(const RefCountCacheSnapshotWriter &) = delete;
+  RefCountCacheSnapshotWriter &operator=(const RefCountCacheSnapshotWriter &) = delete;
+
+private:
+  int write(const void *ptr, size_t n_bytes);
+
+  int fd = -1;
+  std::string tmp_filename;
+  uint64_t offset = 0;
+  std::vector<RefCountCacheSnapshotEntry> index;
+};
+
+// A snapshot mapped from disk, which holds the items a restarted process has not looked up yet.
+// Each item can be taken out once, after which the cache owns it.
+class RefCountCacheSnapshot
+{
+public:
+  RefCountCacheSnapshot() = default;
+  ~RefCountCacheSnapshot();
+
+  // Map @a filename, returns 0 or -1 if it is missing or not compatible with @a header.
+  int open(const std::string &filename, RefCountCacheHeader const &header);
+
+  // Take the item for @a key, returns its data and sets @a meta, or nullptr if there is no valid item.
+  const char *take(uint64_t key, RefCountCacheItemMeta &meta);
+  // Drop the item for @a key, if it has not been taken.
+  void discard(uint64_t key);
+  // Append the items from @a pos on which have not been taken or expired to @a writer, looking at no
+  // more than @a limit of them, and advance @a pos past those.  Returns 0 or -errno, the whole
+  // snapshot has been carried forward once @a pos reaches count().
+  int carry_forward(RefCountCacheSnapshotWriter &writer, size_t &pos, size_t limit);
+
+  size_t count() const;
+
+  // noncopyable
+  RefCountCacheSnapshot(const RefCountCacheSnapshot &) = delete;
+  RefCountCacheSnapshot &operator=(const RefCountCacheSnapshot &) = delete;
+
+private:
+  const RefCountCacheSnapshotEntry *find(uint64_t key) const;
+  bool valid(const RefCountCacheSnapshotEntry *entry) const;
+
+  char *base  = nullptr;
+  size_t size = 0;
+  const RefCountCacheSnapshotEntry *index = nullptr;
+  size_t index_count                      = 0;
+  std::unique_ptr<std::atomic<bool>[]> taken;
+};
+
 // RefCountCache is a ref-counted key->value map to store classes that inherit from RefCountObj.
 // Once an item is `put` into the cache, the cache will maintain a Ptr<> to that object until erase
 // or clear is called-- which will remove the cache's Ptr<> to the object.
 //
-// This cache may be Persisted (RefCountCacheSync) as well as loaded from disk (LoadRefCountCacheFromPath).
+// This cache may be Persisted (RefCountCacheSerializer) as well as loaded from disk (LoadRefCountCacheFromPath).
+// A loaded snapshot stays mapped and an item in it is moved into the cache the first time get() misses it.
 // This class will optionally emit metrics at the given `metrics_prefix`.
 //
 // Note: although this cache does allow you to set expiry times this cache does not actively GC itself-- meaning
@@ -415,6 +515,10 @@ public:
   RefCountCacheHeader &get_header();
   RecRawStatBlock *get_rsb();
 
+  // Use the snapshot in @a filename for items not in the cache, @a load_func unmarshalls them.
+  int load_snapshot(const std::string &filename, C *(*load_func)(char *, unsigned int));
+  std::shared_ptr<RefCountCacheSnapshot> get_snapshot();
+
 private:
   int max_size;  // Total size
   int max_items; // Total number of items allowed
@@ -423,6 +527,9 @@ private:
   // Header
   RefCountCacheHeader header; // Our header
   RecRawStatBlock *rsb;
+  // Items from disk not yet in the cache, and how to unmarshall them.
+  std::shared_ptr<RefCountCacheSnapshot> snapshot;
+  C *(*load_func)(char *, unsigned int) = nullptr;
 };
 
 template <class C>
@@ -484,7 +591,21 @@ template <class C>
 Ptr<C>
 RefCountCache<C>::get(uint64_t key)
 {
-  return this->partitions[this->partition_for_key(key)]->get(key);
+  RefCountCachePartition<C> &partition = *this->partitions[this->partition_for_key(key)];
+  Ptr<C> item                          = partition.get(key);
+
+  if (item.get() == nullptr) {
+    if (std::shared_ptr<RefCountCacheSnapshot> snap = std::atomic_load(&this->snapshot); snap) {
+      RefCountCacheItemMeta meta(key, 0);
+      if (const char *data = snap->take(key, meta); data != nullptr) {
+        if (C *loaded = this->load_func(const_cast<char *>(data), meta.size); loaded != nullptr) {
+          item = make_ptr(loaded);
+          partition.put(key, loaded, meta.size - sizeof(C), meta.expiry_time);
+        }
+      }
+    }
+  }
+  return item;
 }
 
 template <class C>
@@ -548,23 +669,48 @@ RefCountCache<C>::get_rsb()
   return this->rsb;
 }
 
+template <class C>
+std::shared_ptr<RefCountCacheSnapshot>
+RefCountCache<C>::get_snapshot()
+{
+  return std::atomic_load(&this->snapshot);
+}
+
+template <class C>
+int
+RefCountCache<C>::load_snapshot(const std::string &filename, C *(*load_func)(char *, unsigned int))
+{
+  auto snap = std::make_shared<RefCountCacheSnapshot>();
+  if (snap->open(filename, this->header) != 0) {
+    return -1;
+  }
+  this->load_func = load_func;
+  std::atomic_store(&this->snapshot, snap);
+  return 0;
+}
+
 template <class C>
 void
 RefCountCache<C>::erase(uint64_t key)
 {
   this->partitions[this->partition_for_key(key)]->erase(key);
+  if (std::shared_ptr<RefCountCacheSnapshot> snap = std::atomic_load(&this->snapshot); snap) {
+    snap->discard(key);
+  }
 }
 
 template <class C>
 void
 RefCountCache<C>::clear()
 {
+  std::atomic_store(&this->snapshot, std::shared_ptr<RefCountCacheSnapshot>());
   for (unsigned int i = 0; i < this->num_partitions; i++) {
     this->partitions[i]->clear();
   }
 }
 
 // Fill `cache` with items in file `filepath` using `load_func` to unmarshall the record.
+// The file is mapped and the items are loaded as they are looked up.
 // Errors are -1
 template <typename CacheEntryType>
 int
@@ -576,45 +722,5 @@ LoadRefCountCacheFromPath(RefCountCache<CacheEntryType> &cache, const std::strin
     return -1; // TODO: some specific error code
   }
 
-  int fd = open(filepath.c_str(), O_RDONLY);
-  if (fd < 0) {
-    Warning("Unable to open file %s; [Error]: %s", filepath.c_str(), strerror(errno));
-    return -1;
-  }
-
-  // read in the header
-  RefCountCacheHeader tmpHeader = RefCountCacheHeader();
-  int read_ret                  = read(fd, (char *)&tmpHeader, sizeof(RefCountCacheHeader));
-  if (read_ret != sizeof(RefCountCacheHeader)) {
-    socketManager.close(fd);
-    Warning("Error reading cache header from disk (expected %ld): %d", sizeof(RefCountCacheHeader), read_ret);
-    return -1;
-  }
-  if (!cache.get_header().compatible(&tmpHeader)) {
-    socketManager.close(fd);
-    Warning("Incompatible cache at %s, not loading.", filepath.c_str());
-    return -1; // TODO: specific code for incompatible
-  }
-
-  RefCountCacheItemMeta tmpValue = RefCountCacheItemMeta(0, 0);
-  while (true) { // TODO: better loop
-    read_ret = read(fd, (char *)&tmpValue, sizeof(tmpValue));
-    if (read_ret != sizeof(tmpValue)) {
-      break;
-    }
-    char buf[tmpValue.size];
-    read_ret = read(fd, (char *)&buf, tmpValue.size);
-    if (read_ret != (int)tmpValue.size) {
-      Warning("Encountered error reading item from cache: %d", read_ret);
-      break;
-    }
-
-    CacheEntryType *newItem = load_func((char *)&buf, tmpValue.size);
-    if (newItem != nullptr) {
-      cache.put(tmpValue.key, newItem, tmpValue.size - sizeof(CacheEntryType));
-    }
-  };
-
-  socketManager.close(fd);
-  return 0;
+  return cache.load_snapshot(filepath, load_func);
 }
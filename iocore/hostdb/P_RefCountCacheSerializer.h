@@ -25,10 +25,17 @@
 
 #include "P_RefCountCache.h"
 
+#include <memory>
 #include <utility>
 #include <vector>
 
-// This continuation is responsible for persisting RefCountCache to disk
+// Items of the previous snapshot copied in one go.
+static constexpr size_t REFCOUNTCACHE_CARRY_FORWARD_ITEMS = 4096;
+
+// This continuation is responsible for persisting RefCountCache to disk, as a snapshot which can be
+// mapped on startup (see RefCountCacheSnapshot). Items of the previous snapshot which have not been
+// loaded into the cache yet are written first, so that they survive until they are looked up. They
+// are copied REFCOUNTCACHE_CARRY_FORWARD_ITEMS at a time, giving up the task thread in between.
 // To avoid locking the partitions for a long time we'll do the following per-partition:
 //    - lock
 //    - copy ptrs (bump refcount)
@@ -51,19 +58,21 @@ public:
 
   // Create the tmp file on disk we'll be writing to
   int initialize_storage(int event, Event *e);
+  // Write what is left of the previous snapshot
+  int carry_forward(int event, Event *e);
   // do the final mv and close of file handle
   int finalize_sync();
 
-  // helper method to spin on writes to disk
-  int write_to_disk(const void *, size_t);
-
   RefCountCacheSerializer(Continuation *acont, RefCountCache<C> *cc, int frequency, std::string dirname, std::string filename);
   ~RefCountCacheSerializer() override;
 
 private:
   std::vector<RefCountCacheHashEntry *> partition_items;
 
-  int fd; // fd for the file we are writing to
+  RefCountCacheSnapshotWriter writer; // the file we are writing to
+
+  std::shared_ptr<RefCountCacheSnapshot> snapshot; // the previous snapshot, while it is carried forward
+  size_t snapshot_pos = 0;                         // next item of the previous snapshot
 
   std::string dirname;
   std::string filename;
@@ -72,7 +81,6 @@ private:
   ink_hrtime time_per_partition;
   ink_hrtime start;
 
-  int total_items;
   int64_t total_size;
 
   RecRawStatBlock *rsb;
@@ -85,12 +93,10 @@ RefCountCacheSerializer<C>::RefCountCacheSerializer(Continuation *acont, RefCoun
     partition(0),
     cache(cc),
     cont(acont),
-    fd(-1),
     dirname(std::move(dirname)),
     filename(std::move(filename)),
     time_per_partition(HRTIME_SECONDS(frequency) / cc->partition_count()),
     start(Thread::get_hrtime()),
-    total_items(0),
     total_size(0),
     rsb(cc->get_rsb())
 {
@@ -103,12 +109,7 @@ RefCountCacheSerializer<C>::RefCountCacheSerializer(Continuation *acont, RefCoun
 
 template <class C> RefCountCacheSerializer<C>::~RefCountCacheSerializer()
 {
-  // If we failed before finalizing the on-disk copy, close up and nuke the temporary sync file.
-  if (this->fd != -1) {
-    unlink(this->tmp_filename.c_str());
-    socketManager.close(fd);
-  }
-
+  // If we failed before finalizing the on-disk copy, the writer nukes the temporary sync file.
   for (auto &entry : this->partition_items) {
     RefCountCacheHashEntry::free<C>(entry);
   }
@@ -169,23 +170,14 @@ RefCountCacheSerializer<C>::write_partition(int /* event */, Event *e)
       continue;
     }
 
-    // Write the RefCountCacheItemMeta (as our header)
-    int ret = this->write_to_disk((char *)&entry->meta, sizeof(entry->meta));
-    if (ret < 0) {
-      Warning("Error writing cache item header to %s: %s", this->tmp_filename.c_str(), strerror(-ret));
-      delete this;
-      return EVENT_DONE;
-    }
-
-    // write the actual object now
-    ret = this->write_to_disk((char *)entry->item.get(), entry->meta.size);
+    // write the actual object, the index entry is written by finalize_sync()
+    int ret = this->writer.append(entry->meta.key, entry->item.get(), entry->meta.size, entry->meta.expiry_time);
     if (ret < 0) {
       Warning("Error writing cache item to %s: %s", this->tmp_filename.c_str(), strerror(-ret));
       delete this;
       return EVENT_DONE;
     }
 
-    this->total_items++;
     this->total_size += entry->meta.size;
   }
 
@@ -231,96 +223,64 @@ template <class C>
 int
 RefCountCacheSerializer<C>::initialize_storage(int /* event */, Event *e)
 {
-  this->fd = socketManager.open(this->tmp_filename.c_str(), O_TRUNC | O_RDWR | O_CREAT, 0644); // TODO: configurable perms
-  if (this->fd < 0) {
-    Warning("Unable to create temporary file %s, unable to persist hostdb: %s", this->tmp_filename.c_str(), strerror(errno));
-    delete this;
-    return EVENT_DONE;
-  }
-
   // Write out the header
-  int ret = this->write_to_disk((char *)&this->cache->get_header(), sizeof(RefCountCacheHeader));
+  int ret = this->writer.open(this->tmp_filename, this->cache->get_header());
   if (ret < 0) {
-    Warning("Error writing cache header to %s: %s", this->tmp_filename.c_str(), strerror(-ret));
+    Warning("Unable to create temporary file %s, unable to persist hostdb: %s", this->tmp_filename.c_str(), strerror(-ret));
     delete this;
     return EVENT_DONE;
   }
 
-  SET_HANDLER(&RefCountCacheSerializer::pause_event);
+  // Keep what is left of the snapshot this process started with.
+  this->snapshot = this->cache->get_snapshot();
+
+  SET_HANDLER(&RefCountCacheSerializer::carry_forward);
   e->schedule_imm(ET_TASK);
   return EVENT_CONT;
 }
 
-// Do the final mv and close of file handle. Only reset "fd" to -1 if we fully succeed.
-// Returns 0 on success, -errno on failure.
+// Copy the next chunk of the previous snapshot, then move on to the partitions once it is done.
 template <class C>
 int
-RefCountCacheSerializer<C>::finalize_sync()
+RefCountCacheSerializer<C>::carry_forward(int /* event */, Event *e)
 {
-  int error; // Socket manager return 0 or -errno.
-  int dirfd = -1;
-
-  // fsync the fd we have
-  if ((error = socketManager.fsync(this->fd))) {
-    return error;
+  if (this->snapshot && this->snapshot_pos < this->snapshot->count()) {
+    int ret = this->snapshot->carry_forward(this->writer, this->snapshot_pos, REFCOUNTCACHE_CARRY_FORWARD_ITEMS);
+    if (ret < 0) {
+      Warning("Error writing cache item to %s: %s", this->tmp_filename.c_str(), strerror(-ret));
+      delete this;
+      return EVENT_DONE;
+    }
+    e->schedule_imm(ET_TASK);
+    return EVENT_CONT;
   }
 
-#ifdef O_DIRECTORY
-  dirfd = socketManager.open(this->dirname.c_str(), O_DIRECTORY);
-#else
-  struct stat st;
-  stat(this->dirname.c_str(), &st);
-  if (!S_ISDIR(st.st_mode)) {
-    return -ENOTDIR;
-  }
-  dirfd = socketManager.open(this->dirname.c_str(), 0);
-#endif
-  if (dirfd == -1) {
-    return -errno;
+  if (this->snapshot) {
+    Debug("refcountcache", "carried %zu items forward from the previous snapshot", this->writer.count());
+    this->snapshot.reset();
   }
 
-  // Rename from the temp name to the real name.
-  if (rename(this->tmp_filename.c_str(), this->filename.c_str()) != 0) {
-    error = -errno;
-    socketManager.close(dirfd);
-    return error;
-  }
+  SET_HANDLER(&RefCountCacheSerializer::pause_event);
+  e->schedule_imm(ET_TASK);
+  return EVENT_CONT;
+}
 
-  // Fsync the directory to persist the rename.
-  if ((error = socketManager.fsync(dirfd))) {
-    socketManager.close(dirfd);
+// Write the index, then do the final mv and close of file handle.
+// Returns 0 on success, -errno on failure.
+template <class C>
+int
+RefCountCacheSerializer<C>::finalize_sync()
+{
+  int error = this->writer.commit(this->dirname, this->filename);
+  if (error != 0) {
     return error;
   }
 
-  // Don't bother checking for errors on the close since there's nothing we can do about it at
-  // this point anyway.
-  socketManager.close(dirfd);
-  socketManager.close(this->fd);
-  this->fd = -1;
-
   if (this->rsb) {
     RecSetRawStatCount(this->rsb, refcountcache_last_sync_time, Thread::get_hrtime() / HRTIME_SECOND);
-    RecSetRawStatCount(this->rsb, refcountcache_last_total_items, this->total_items);
+    RecSetRawStatCount(this->rsb, refcountcache_last_total_items, this->writer.count());
     RecSetRawStatCount(this->rsb, refcountcache_last_total_size, this->total_size);
   }
 
   return 0;
 }
-
-// Write *i to this->fd, if there is an error we'll just stop this continuation
-// TODO: reschedule the continuation if the disk was busy?
-template <class C>
-int
-RefCountCacheSerializer<C>::write_to_disk(const void *ptr, size_t n_bytes)
-{
-  size_t written = 0;
-  while (written < n_bytes) {
-    int ret = socketManager.write(this->fd, (char *)ptr + written, n_bytes - written);
-    if (ret <= 0) {
-      return ret;
-    } else {
-      written += ret;
-    }
-  }
-  return 0;
-}
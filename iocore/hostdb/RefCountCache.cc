@@ -21,6 +21,14 @@
 
 #include <P_RefCountCache.h>
 
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "tscore/HashFNV.h"
+
 // Since the hashing values are all fixed size, we can simply use a classAllocator to avoid mallocs
 static ClassAllocator<RefCountCacheHashEntry> refCountCacheHashingValueAllocator("refCountCacheHashingValueAllocator");
 
@@ -49,5 +57,295 @@ RefCountCacheHeader::operator==(RefCountCacheHeader const &that) const
 bool
 RefCountCacheHeader::compatible(RefCountCacheHeader *that) const
 {
-  return this->magic == that->magic && this->version == that->version && this->object_version == that->version;
+  return this->magic == that->magic && this->version == that->version && this->object_version == that->object_version;
 };
+
+namespace
+{
+uint32_t
+snapshot_checksum(const void *data, size_t size)
+{
+  ATSHash32FNV1a hash;
+  hash.update(data, size);
+  hash.final();
+  return hash.get();
+}
+
+bool
+key_less(const RefCountCacheSnapshotEntry &lhs, const RefCountCacheSnapshotEntry &rhs)
+{
+  return lhs.key < rhs.key;
+}
+} // namespace
+
+/*-------------------------------------------------------------------------
+  RefCountCacheSnapshotWriter
+  -------------------------------------------------------------------------*/
+
+RefCountCacheSnapshotWriter::~RefCountCacheSnapshotWriter()
+{
+  // Not committed, throw away the partial file.
+  if (this->fd != -1) {
+    unlink(this->tmp_filename.c_str());
+    socketManager.close(this->fd);
+  }
+}
+
+int
+RefCountCacheSnapshotWriter::open(const std::string &tmp_filename, RefCountCacheHeader const &header)
+{
+  this->tmp_filename = tmp_filename;
+  this->fd           = socketManager.open(this->tmp_filename.c_str(), O_TRUNC | O_RDWR | O_CREAT, 0644);
+  if (this->fd < 0) {
+    int error = this->fd;
+    this->fd  = -1;
+    return error;
+  }
+
+  // The info is filled in by commit(), once the index is known.
+  char start[REFCOUNTCACHE_SNAPSHOT_DATA_OFFSET] = {0};
+  memcpy(start, &header, sizeof(header));
+  return this->write(start, sizeof(start));
+}
+
+int
+RefCountCacheSnapshotWriter::append(uint64_t key, const void *data, unsigned int size, ink_time_t expiry_time)
+{
+  static const char padding[REFCOUNTCACHE_SNAPSHOT_ALIGN] = {0};
+
+  RefCountCacheSnapshotEntry entry;
+  entry.key         = key;
+  entry.offset      = this->offset;
+  entry.size        = size;
+  entry.checksum    = snapshot_checksum(data, size);
+  entry.expiry_time = expiry_time;
+
+  int ret = this->write(data, size);
+  if (ret == 0 && (size % REFCOUNTCACHE_SNAPSHOT_ALIGN) != 0) {
+    ret = this->write(padding, REFCOUNTCACHE_SNAPSHOT_ALIGN - size % REFCOUNTCACHE_SNAPSHOT_ALIGN);
+  }
+  if (ret == 0) {
+    this->index.push_back(entry);
+  }
+  return ret;
+}
+
+int
+RefCountCacheSnapshotWriter::commit(const std::string &dirname, const std::string &filename)
+{
+  int error; // Socket manager return 0 or -errno.
+  int dirfd = -1;
+
+  // Items appended later are newer, keep only the last one for each key.
+  std::stable_sort(this->index.begin(), this->index.end(), key_less);
+  size_t n = 0;
+  for (size_t i = 0; i < this->index.size(); ++i) {
+    if (n > 0 && this->index[n - 1].key == this->index[i].key) {
+      this->index[n - 1] = this->index[i];
+    } else {
+      this->index[n++] = this->index[i];
+    }
+  }
+  this->index.resize(n);
+
+  RefCountCacheSnapshotInfo info = {this->index.size(), this->offset};
+  if ((error = this->write(this->index.data(), this->index.size() * sizeof(RefCountCacheSnapshotEntry))) != 0) {
+    return error;
+  }
+  if (::pwrite(this->fd, &info, sizeof(info), sizeof(RefCountCacheHeader)) != sizeof(info)) {
+    return -errno;
+  }
+
+  // fsync the fd we have
+  if ((error = socketManager.fsync(this->fd))) {
+    return error;
+  }
+
+#ifdef O_DIRECTORY
+  dirfd = socketManager.open(dirname.c_str(), O_DIRECTORY);
+#else
+  struct stat st;
+  stat(dirname.c_str(), &st);
+  if (!S_ISDIR(st.st_mode)) {
+    return -ENOTDIR;
+  }
+  dirfd = socketManager.open(dirname.c_str(), 0);
+#endif
+  if (dirfd < 0) {
+    return dirfd;
+  }
+
+  // Rename from the temp name to the real name.
+  if (rename(this->tmp_filename.c_str(), filename.c_str()) != 0) {
+    error = -errno;
+    socketManager.close(dirfd);
+    return error;
+  }
+
+  // Fsync the directory to persist the rename.
+  if ((error = socketManager.fsync(dirfd))) {
+    socketManager.close(dirfd);
+    return error;
+  }
+
+  // Don't bother checking for errors on the close since there's nothing we can do about it at
+  // this point anyway.
+  socketManager.close(dirfd);
+  socketManager.close(this->fd);
+  this->fd = -1;
+  return 0;
+}
+
+size_t
+RefCountCacheSnapshotWriter::count() const
+{
+  return this->index.size();
+}
+
+int
+RefCountCacheSnapshotWriter::write(const void *ptr, size_t n_bytes)
+{
+  size_t written = 0;
+  while (written < n_bytes) {
+    int64_t ret = socketManager.write(this->fd, const_cast<char *>(static_cast<const char *>(ptr)) + written, n_bytes - written);
+    if (ret <= 0) {
+      return ret < 0 ? ret : -EIO;
+    }
+    written += ret;
+  }
+  this->offset += n_bytes;
+  return 0;
+}
+
+/*-------------------------------------------------------------------------
+  RefCountCacheSnapshot
+  -------------------------------------------------------------------------*/
+
+RefCountCacheSnapshot::~RefCountCacheSnapshot()
+{
+  if (this->base != nullptr) {
+    munmap(this->base, this->size);
+  }
+}
+
+int
+RefCountCacheSnapshot::open(const std::string &filename, RefCountCacheHeader const &header)
+{
+  int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    Warning("Unable to open file %s; [Error]: %s", filename.c_str(), strerror(errno));
+    return -1;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < REFCOUNTCACHE_SNAPSHOT_DATA_OFFSET) {
+    Warning("Snapshot %s is too short to hold a header.", filename.c_str());
+    ::close(fd);
+    return -1;
+  }
+
+  void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    Warning("Unable to map file %s; [Error]: %s", filename.c_str(), strerror(errno));
+    return -1;
+  }
+  this->base = static_cast<char *>(map);
+  this->size = st.st_size;
+
+  RefCountCacheHeader file_header;
+  RefCountCacheSnapshotInfo info;
+  memcpy(&file_header, this->base, sizeof(file_header));
+  memcpy(&info, this->base + sizeof(file_header), sizeof(info));
+
+  if (!header.compatible(&file_header)) {
+    Warning("Incompatible cache at %s, not loading.", filename.c_str());
+    return -1;
+  }
+  if (info.index_offset < REFCOUNTCACHE_SNAPSHOT_DATA_OFFSET || info.index_offset % REFCOUNTCACHE_SNAPSHOT_ALIGN != 0 ||
+      info.index_offset > this->size || info.count != (this->size - info.index_offset) / sizeof(RefCountCacheSnapshotEntry) ||
+      (this->size - info.index_offset) % sizeof(RefCountCacheSnapshotEntry) != 0) {
+    Warning("Snapshot %s is truncated or corrupt, not loading.", filename.c_str());
+    return -1;
+  }
+
+  // Lookups go straight to the index, the items are read only when they are taken.
+  madvise(this->base, this->size, MADV_RANDOM);
+
+  this->index       = reinterpret_cast<const RefCountCacheSnapshotEntry *>(this->base + info.index_offset);
+  this->index_count = info.count;
+  this->taken       = std::make_unique<std::atomic<bool>[]>(this->index_count);
+  return 0;
+}
+
+const RefCountCacheSnapshotEntry *
+RefCountCacheSnapshot::find(uint64_t key) const
+{
+  RefCountCacheSnapshotEntry target;
+  target.key = key;
+
+  auto spot = std::lower_bound(this->index, this->index + this->index_count, target, key_less);
+  return (spot != this->index + this->index_count && spot->key == key) ? spot : nullptr;
+}
+
+bool
+RefCountCacheSnapshot::valid(const RefCountCacheSnapshotEntry *entry) const
+{
+  const char *index_start = reinterpret_cast<const char *>(this->index);
+
+  if (entry->expiry_time >= 0 && entry->expiry_time < ink_time()) {
+    return false;
+  }
+  if (entry->offset < REFCOUNTCACHE_SNAPSHOT_DATA_OFFSET || entry->offset % REFCOUNTCACHE_SNAPSHOT_ALIGN != 0 ||
+      entry->offset + entry->size > static_cast<uint64_t>(index_start - this->base)) {
+    Warning("Snapshot item %" PRIu64 " is out of bounds, skipping.", entry->key);
+    return false;
+  }
+  if (snapshot_checksum(this->base + entry->offset, entry->size) != entry->checksum) {
+    Warning("Snapshot item %" PRIu64 " is corrupt, skipping.", entry->key);
+    return false;
+  }
+  return true;
+}
+
+const char *
+RefCountCacheSnapshot::take(uint64_t key, RefCountCacheItemMeta &meta)
+{
+  const RefCountCacheSnapshotEntry *entry = this->find(key);
+
+  if (entry == nullptr || this->taken[entry - this->index].exchange(true) || !this->valid(entry)) {
+    return nullptr;
+  }
+  meta = RefCountCacheItemMeta(entry->key, entry->size, entry->expiry_time);
+  return this->base + entry->offset;
+}
+
+void
+RefCountCacheSnapshot::discard(uint64_t key)
+{
+  if (const RefCountCacheSnapshotEntry *entry = this->find(key); entry != nullptr) {
+    this->taken[entry - this->index] = true;
+  }
+}
+
+int
+RefCountCacheSnapshot::carry_forward(RefCountCacheSnapshotWriter &writer, size_t &pos, size_t limit)
+{
+  for (size_t end = std::min(this->index_count, pos + limit); pos < end; ++pos) {
+    const RefCountCacheSnapshotEntry &entry = this->index[pos];
+    // The writer checksums what it is given, so the item has to be checked before it is copied.
+    if (this->taken[pos] || !this->valid(&entry)) {
+      continue;
+    }
+    if (int ret = writer.append(entry.key, this->base + entry.offset, entry.size, entry.expiry_time); ret != 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
+size_t
+RefCountCacheSnapshot::count() const
+{
+  return this->index_count;
+}
@@ -72,11 +72,12 @@ public:
     if (size < sizeof(ExampleStruct)) {
       return nullptr;
     }
+    // The vtable and the refcount belong to the new object, copy only the fields and the name.
+    ExampleStruct *src = reinterpret_cast<ExampleStruct *>(buf);
     ExampleStruct *ret = ExampleStruct::alloc(size - sizeof(ExampleStruct));
-    memcpy((void *)ret, buf, size);
-    // Reset the refcount back to 0, this is a bit ugly-- but I'm not sure we want to expose a method
-    // to mess with the refcount, since this is a fairly unique use case
-    ret = new (ret) ExampleStruct();
+    ret->idx           = src->idx;
+    ret->name_offset   = src->name_offset;
+    memcpy(reinterpret_cast<char *>(ret) + sizeof(ExampleStruct), buf + sizeof(ExampleStruct), size - sizeof(ExampleStruct));
     return ret;
   }
 };
@@ -197,6 +198,96 @@ testclear()
   return ret;
 }
 
+// Write a snapshot of @a count items, with item @a expired already expired.
+int
+writeSnapshot(RefCountCache<ExampleStruct> *cache, const std::string &filename, int count, int expired)
+{
+  RefCountCacheSnapshotWriter writer;
+  int ret = writer.open(filename + ".syncing", cache->get_header());
+
+  for (int i = 0; i < count && ret == 0; i++) {
+    ExampleStruct *tmp = ExampleStruct::alloc();
+    tmp->idx           = i;
+    tmp->name_offset   = 0;
+    ret                = writer.append(i, tmp, sizeof(ExampleStruct), i == expired ? 1 : -1);
+    ExampleStruct::dealloc(tmp);
+  }
+  if (ret == 0) {
+    ret = writer.commit("/tmp", filename);
+  }
+  return ret != 0;
+}
+
+int
+testSnapshot()
+{
+  int ret              = 0;
+  std::string filename = "/tmp/refcountcache_snapshot";
+  int numTestEntries   = 1000;
+  int expired          = 7;
+  int corrupt          = 3;
+
+  RefCountCache<ExampleStruct> *cache = new RefCountCache<ExampleStruct>(4);
+  ret |= writeSnapshot(cache, filename, numTestEntries, expired);
+  printf("snapshot written ret=%d\n", ret);
+
+  // Nothing is loaded until it is looked up.
+  ret |= LoadRefCountCacheFromPath<ExampleStruct>(*cache, filename, ExampleStruct::unmarshall) != 0;
+  ret |= cache->count() != 0;
+  // An erased item is not loaded from the snapshot.
+  cache->erase(1);
+  ret |= verifyCache(cache, 0, numTestEntries);
+  ret |= cache->get(1).get() != nullptr;
+  ret |= cache->get(expired).get() != nullptr;
+  ret |= cache->count() != static_cast<size_t>(numTestEntries - 2);
+  printf("snapshot loaded %zu items ret=%d\n", cache->count(), ret);
+  delete cache;
+
+  // A damaged item is skipped, the rest still load.
+  int fd           = open(filename.c_str(), O_RDWR);
+  size_t stride    = (sizeof(ExampleStruct) + 7) & ~size_t(7);
+  char garbage     = 0x5a;
+  off_t corrupt_at = REFCOUNTCACHE_SNAPSHOT_DATA_OFFSET + corrupt * stride + sizeof(RefCountObj);
+  ret |= pwrite(fd, &garbage, 1, corrupt_at) != 1;
+  close(fd);
+
+  cache = new RefCountCache<ExampleStruct>(4);
+  ret |= LoadRefCountCacheFromPath<ExampleStruct>(*cache, filename, ExampleStruct::unmarshall) != 0;
+  ret |= cache->get(corrupt).get() != nullptr;
+  ret |= verifyCache(cache, 0, 10);
+  printf("snapshot damaged item ret=%d\n", ret);
+
+  // Items not looked up yet are carried into the next snapshot, a few at a time.
+  {
+    RefCountCacheSnapshotWriter writer;
+    std::shared_ptr<RefCountCacheSnapshot> initial = cache->get_snapshot();
+    size_t pos                                     = 0;
+    int chunks                                     = 0;
+    ret |= writer.open(filename + ".syncing", cache->get_header()) != 0;
+    while (pos < initial->count() && chunks++ < numTestEntries) {
+      size_t before = pos;
+      ret |= initial->carry_forward(writer, pos, 64) != 0;
+      ret |= pos - before != std::min<size_t>(64, initial->count() - before);
+    }
+    ret |= chunks != static_cast<int>((initial->count() + 63) / 64);
+    ret |= writer.count() != static_cast<size_t>(numTestEntries - 10);
+    printf("snapshot carried %zu items in %d chunks ret=%d\n", writer.count(), chunks, ret);
+  }
+
+  // Clearing the cache drops the snapshot.
+  cache->clear();
+  ret |= cache->get(500).get() != nullptr;
+
+  // A snapshot for another object version is not used.
+  RefCountCache<ExampleStruct> other(4, -1, -1, ts::VersionNumber(1, 0));
+  ret |= LoadRefCountCacheFromPath<ExampleStruct>(other, filename, ExampleStruct::unmarshall) == 0;
+
+  delete cache;
+  unlink(filename.c_str());
+  printf("snapshot ret=%d\n", ret);
+  return ret;
+}
+
 int
 test()
 {
@@ -215,6 +306,10 @@ test()
   ret |= testRefcounting();
   printf("refcount ret %d\n", ret);
 
+  printf("Testing snapshots\n");
+  ret |= testSnapshot();
+  printf("snapshot ret %d\n", ret);
+
   // Initialize our cache
   int cachePartitions                 = 4;
   RefCountCache<ExampleStruct> *cache = new RefCountCache<ExampleStruct>(cachePartitions);
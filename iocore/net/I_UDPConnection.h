@@ -96,8 +96,11 @@ public:
      Required for  and UDPNetProcessor::CreateUDPSocket.  They  don't do
      bindToThread() automatically so that the sockets can be passed to
      other Continuations.
+
+     @param t UDP thread to read the socket on, if @c nullptr one is
+     assigned round robin.
   */
-  void bindToThread(Continuation *c);
+  void bindToThread(Continuation *c, EThread *t = nullptr);
 
   virtual void UDPConnection_is_abstract() = 0;
 };
@@ -69,10 +69,12 @@ public:
      to the NIC.
      @param recv_bufsize (optional) Socket buffer size for sending.
      Limits how much can be queued by OS before we read it.
+     @param thread (optional) UDP thread to read the socket on.
      @return Action* Always returns ACTION_RESULT_DONE if socket was
      created successfully, or ACTION_IO_ERROR if not.
   */
-  Action *UDPBind(Continuation *c, sockaddr const *addr, int fd = -1, int send_bufsize = 0, int recv_bufsize = 0);
+  Action *UDPBind(Continuation *c, sockaddr const *addr, int fd = -1, int send_bufsize = 0, int recv_bufsize = 0,
+                  EThread *thread = nullptr);
 
   // Regarding sendto_re, sendmsg_re, recvfrom_re:
   // * You may be called back on 'c' with completion or error status.
@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "I_EventSystem.h"
 
 class NetHandler;
@@ -79,8 +81,18 @@ public:
 
   bool default_inactivity_timeout = false;
 
+  /// When the NetHandler next looks at the timeouts, 0 if it is not tracking them. Only used on its thread.
+  ink_hrtime timeout_check_at = 0;
+  uint32_t timeout_slot       = 0;
+  /// 1 while in the timeout_update_list of the NetHandler, 2 if it is to be freed when the list is drained.
+  int in_timeout_list = 0;
+
+  /// @return The earlier of the inactivity and active timeouts, 0 if neither is set.
+  ink_hrtime next_timeout_at() const;
+
   LINK(NetEvent, open_link);
-  LINK(NetEvent, cop_link);
+  LINK(NetEvent, timeout_link);
+  SLINK(NetEvent, timeout_alink);
   LINKM(NetEvent, read, ready_link)
   SLINKM(NetEvent, read, enable_link)
   LINKM(NetEvent, write, ready_link)
@@ -107,6 +119,15 @@ NetEvent::has_error() const
   return error != 0;
 }
 
+inline ink_hrtime
+NetEvent::next_timeout_at() const
+{
+  if (next_inactivity_timeout_at && next_activity_timeout_at) {
+    return std::min(next_inactivity_timeout_at, next_activity_timeout_at);
+  }
+  return next_inactivity_timeout_at ? next_inactivity_timeout_at : next_activity_timeout_at;
+}
+
 inline void
 NetEvent::set_error_from_socket()
 {
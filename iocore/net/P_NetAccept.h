@@ -38,6 +38,7 @@
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include "tscore/ink_platform.h"
 #include "P_Connection.h"
@@ -59,6 +60,9 @@ class UnixNetVConnection;
 // TODO fix race between cancel accept and call back
 struct NetAcceptAction : public Action, public RefCountObj {
   Server *server;
+  /// Threads with a listen socket of their own for the port, and how many of them failed to open it.
+  int listen_threads = 0;
+  std::atomic<int> listen_failures{0};
 
   void
   cancel(Continuation *cont = nullptr) override
@@ -93,6 +97,9 @@ struct NetAccept : public Continuation {
   HttpProxyPort *proxyPort = nullptr;
   NetProcessor::AcceptOptions opt;
 
+  /// The accepts of the other threads, when each thread listens on a socket of its own.
+  std::vector<NetAccept *> thread_accepts;
+
   virtual NetProcessor *getNetProcessor() const;
 
   virtual void init_accept(EThread *t = nullptr);
@@ -260,6 +260,10 @@ private:
   QUICAckFrameManager _ack_frame_manager;
   QUICPacketHeaderProtector _ph_protector;
   QUICRTTMeasure _rtt_measure;
+
+  // Packets built in a send event. Their headers are protected together, and then the UDP payloads go out.
+  std::vector<QUICPacketHeaderProtector::Packet> _hp_batch;
+  std::vector<Ptr<IOBufferBlock>> _udp_batch;
   QUICApplicationMap *_application_map = nullptr;
 
   uint32_t _pmtu = 1280;
@@ -343,6 +347,7 @@ private:
   QUICConnectionErrorUPtr _state_closing_receive_packet();
   QUICConnectionErrorUPtr _state_draining_receive_packet();
   QUICConnectionErrorUPtr _state_common_send_packet();
+  void _protect_batched_headers();
   QUICConnectionErrorUPtr _state_handshake_send_retry_packet();
   QUICConnectionErrorUPtr _state_closing_send_packet();
 
@@ -46,6 +46,9 @@ public:
 
   void close_connection(QUICNetVConnection *conn);
 
+  /// @return The worker to encode in the Connection IDs of connections on this handler, -1 for none.
+  int cid_worker() const;
+
 protected:
   void _send_packet(const QUICPacket &packet, UDPConnection *udp_con, IpEndpoint &addr, uint32_t pmtu,
                     const QUICPacketHeaderProtector *ph_protector, int dcil);
@@ -62,6 +65,7 @@ protected:
   virtual void _recv_packet(int event, UDPPacket *udpPacket) = 0;
 
   QUICResetTokenTable &_rtable;
+  int _cid_worker = -1;
 };
 
 /*
@@ -74,6 +78,14 @@ public:
   QUICPacketHandlerIn(const NetProcessor::AcceptOptions &opt, QUICConnectionTable &ctable, QUICResetTokenTable &rtable);
   ~QUICPacketHandlerIn();
 
+  /**
+   * Make this the handler for socket @a index of @a count sockets sharing a port with SO_REUSEPORT.
+   *
+   * Connections started on the socket get the index in the first byte of their Connection IDs, and run on the network
+   * threads paired with the socket.
+   */
+  void set_socket_index(int index, int count);
+
   // NetAccept
   virtual NetProcessor *getNetProcessor() const override;
   virtual NetAccept *clone() const override;
@@ -92,8 +104,11 @@ private:
                              size_t maximum_size);
   void _send_invalid_token_error(const uint8_t *initial_packet, uint64_t initial_packet_len, UDPConnection *connection,
                                  IpEndpoint from);
+  EThread *_assign_thread();
 
   QUICConnectionTable &_ctable;
+  int _socket_count         = 0;
+  unsigned int _next_thread = 0;
 };
 
 /*
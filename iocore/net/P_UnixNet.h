@@ -26,6 +26,7 @@
 #include <bitset>
 
 #include "tscore/ink_platform.h"
+#include "tscore/TimingWheel.h"
 
 #define USE_EDGE_TRIGGER_EPOLL 1
 #define USE_EDGE_TRIGGER_KQUEUE 1
@@ -265,9 +266,35 @@ public:
   QueM(NetEvent, NetState, read, ready_link) read_ready_list;
   QueM(NetEvent, NetState, write, ready_link) write_ready_list;
   Que(NetEvent, open_link) open_list;
-  DList(NetEvent, cop_link) cop_list;
   ASLLM(NetEvent, NetState, read, enable_link) read_enable_list;
   ASLLM(NetEvent, NetState, write, enable_link) write_enable_list;
+
+  /// Describes a @c NetEvent to the timeout wheel.
+  struct TimeoutDescriptor {
+    static int64_t
+    due_of(NetEvent const *ne)
+    {
+      return ne->timeout_check_at;
+    }
+    static uint32_t
+    slot_of(NetEvent const *ne)
+    {
+      return ne->timeout_slot;
+    }
+    static void
+    set_slot(NetEvent *ne, uint32_t slot)
+    {
+      ne->timeout_slot = slot;
+    }
+  };
+  /// Resolution of the timeout wheel.
+  static constexpr ink_hrtime TIMEOUT_TICK = HRTIME_MSECONDS(100);
+  /// The NetEvents in the open_list, by when InactivityCop next looks at their timeouts.
+  TimingWheel<NetEvent, NetEvent::Link_timeout_link, TimeoutDescriptor> timeout_wheel;
+  /// NetEvents whose timeouts moved earlier on another thread.
+  ASLL(NetEvent, timeout_alink) timeout_update_list;
+  /// How often InactivityCop runs, and looks at NetEvents without a timeout.
+  ink_hrtime inactivity_check_interval = HRTIME_SECONDS(1);
   Que(NetEvent, keep_alive_queue_link) keep_alive_queue;
   uint32_t keep_alive_queue_size = 0;
   Que(NetEvent, active_queue_link) active_queue;
@@ -328,6 +355,23 @@ public:
   bool add_to_active_queue(NetEvent *ne);
   void remove_from_active_queue(NetEvent *ne);
 
+  /** Place @a ne in the timeout wheel for its next timeout.
+
+      The wheel is only updated if the timeout is earlier than where @a ne
+      already is, a later one is picked up when InactivityCop gets to it.
+      Only be called on the thread of this NetHandler.
+   */
+  void schedule_timeout(NetEvent *ne, ink_hrtime now, bool closing = false);
+  /** Tell this NetHandler that a timeout of @a ne changed, from any thread.
+
+      If @a closing, @a ne is about to be marked closed and InactivityCop
+      frees it if the NetHandler does not get to it first. @a ne must not
+      be touched once it is marked closed, so this has to be called before.
+   */
+  void timeout_changed(NetEvent *ne, bool closing = false);
+  /// Reschedule the NetEvents in the timeout_update_list, and free those closed while in it.
+  void process_timeout_updates();
+
   /// Per process initialization logic.
   static void init_for_process();
   /// Update configuration values that are per thread and depend on other configuration values.
@@ -355,7 +399,7 @@ public:
 
   /**
     Start to handle active timeout and inactivity timeout on a NetEvent.
-    Put the ne into open_list. All NetEvents in the open_list is checked for timeout by InactivityCop.
+    Put the ne into open_list and the timeout wheel. InactivityCop checks each NetEvent for timeout when it is due in the wheel.
     Only be called when holding the mutex of this NetHandler and must call startIO(ne) first.
 
     @param ne NetEvent to be managed by InactivityCop
@@ -363,7 +407,7 @@ public:
   void startCop(NetEvent *ne);
   /**
     Stop to handle active timeout and inactivity on a NetEvent.
-    Remove the ne from open_list and cop_list.
+    Remove the ne from open_list and the timeout wheel.
     Also remove the ne from keep_alive_queue and active_queue if its context is IN.
     Only be called when holding the mutex of this NetHandler.
 
@@ -889,6 +933,7 @@ NetHandler::startCop(NetEvent *ne)
   ink_assert(!open_list.in(ne));
 
   open_list.enqueue(ne);
+  schedule_timeout(ne, Thread::get_hrtime());
 }
 
 TS_INLINE void
@@ -897,7 +942,12 @@ NetHandler::stopCop(NetEvent *ne)
   ink_release_assert(ne->nh == this);
 
   open_list.remove(ne);
-  cop_list.remove(ne);
+  if (timeout_wheel.in(ne)) {
+    timeout_wheel.remove(ne);
+  }
+  // It is left in the timeout_update_list, another thread may be pushing it, and
+  // process_timeout_updates() skips it since it is no longer in the wheel.
+  ne->timeout_check_at = 0;
   remove_from_keep_alive_queue(ne);
   remove_from_active_queue(ne);
 }
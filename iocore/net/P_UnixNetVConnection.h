@@ -333,14 +333,6 @@ UnixNetVConnection::get_inactivity_timeout()
   return inactivity_timeout_in;
 }
 
-inline void
-UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
-{
-  Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
-  active_timeout_in        = timeout_in;
-  next_activity_timeout_at = (active_timeout_in > 0) ? Thread::get_hrtime() + timeout_in : 0;
-}
-
 inline void
 UnixNetVConnection::cancel_inactivity_timeout()
 {
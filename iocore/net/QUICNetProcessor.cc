@@ -22,6 +22,10 @@
 #include "tscore/ink_config.h"
 #include "tscore/I_Layout.h"
 
+#ifdef __linux__
+#include <linux/filter.h>
+#endif
+
 #include "P_Net.h"
 #include "records/I_RecHttp.h"
 
@@ -39,6 +43,64 @@
 
 QUICNetProcessor quic_NetProcessor;
 
+namespace
+{
+// The socket index has to fit in the first byte of a Connection ID.
+constexpr int MAX_REUSEPORT_SOCKETS = 256;
+
+/// Open a UDP socket bound to @a addr that shares the port with the other sockets for it.
+int
+open_reuseport_socket(sockaddr const *addr)
+{
+#ifdef SO_REUSEPORT
+  int fd = socketManager.socket(addr->sa_family, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    return NO_FD;
+  }
+  if (safe_setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, SOCKOPT_ON, sizeof(int)) < 0 ||
+      (ats_is_ip6(addr) && safe_setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, SOCKOPT_ON, sizeof(int)) < 0) ||
+      socketManager.ink_bind(fd, addr, ats_ip_size(addr)) < 0) {
+    int err = errno;
+    socketManager.close(fd);
+    errno = err;
+    return NO_FD;
+  }
+  return fd;
+#else
+  errno = ENOTSUP;
+  return NO_FD;
+#endif
+}
+
+/** Steer each packet to the socket whose index is in the first byte of its Destination Connection ID.
+
+    The sockets of a port are indexed in the order they were bound.  The filter sees the UDP payload; a
+    long header packet has the DCID after the first byte, the version and the DCID length, a short header
+    packet right after the first byte.  A packet that is too short to load from goes to socket 0.
+*/
+bool
+attach_cid_steering(int fd, int count)
+{
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+  sock_filter code[] = {
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+    BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x80, 0, 2), // header form bit
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, QUICInvariants::LH_DCID_OFFSET),
+    BPF_JUMP(BPF_JMP | BPF_JA, 1, 0, 0),
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, QUICInvariants::SH_DCID_OFFSET),
+    BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, static_cast<uint32_t>(count)),
+    BPF_STMT(BPF_RET | BPF_A, 0),
+  };
+  sock_fprog prog = {static_cast<unsigned short>(sizeof(code) / sizeof(code[0])), code};
+
+  return safe_setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, reinterpret_cast<char *>(&prog), sizeof(prog)) == 0;
+#else
+  errno = ENOTSUP;
+  return false;
+#endif
+}
+} // namespace
+
 QUICNetProcessor::QUICNetProcessor() {}
 
 QUICNetProcessor::~QUICNetProcessor()
@@ -220,8 +282,49 @@ QUICNetProcessor::main_accept(Continuation *cont, SOCKET fd, AcceptOptions const
   na->action_->server = &na->server;
   na->init_accept();
 
-  SCOPED_MUTEX_LOCK(lock, na->mutex, this_ethread());
-  udpNet.UDPBind((Continuation *)na, &na->server.accept_addr.sa, fd, 1048576, 1048576);
+  // With reuseport each UDP thread reads its own socket for the port, through its own packet handler.
+  QUICConfig::scoped_config params;
+  std::vector<int> fds;
+  if (fd == NO_FD && params->reuseport()) {
+    int count = std::min(eventProcessor.thread_group[ET_UDP]._count, MAX_REUSEPORT_SOCKETS);
+    for (int i = 0; i < count; ++i) {
+      int sfd = open_reuseport_socket(&accept_ip.sa);
+      if (sfd == NO_FD) {
+        Warning("QUIC port %d: could not open reuseport socket %d of %d: %s", opt.local_port, i, count, strerror(errno));
+        break;
+      }
+      fds.push_back(sfd);
+    }
+    if (params->reuseport() == 2 && fds.size() > 1 && !attach_cid_steering(fds[0], fds.size())) {
+      Warning("QUIC port %d: could not attach Connection ID steering, packets are spread by address: %s", opt.local_port,
+              strerror(errno));
+    }
+  }
+
+  if (fds.size() <= 1) {
+    if (!fds.empty()) {
+      fd = fds[0];
+    }
+    SCOPED_MUTEX_LOCK(lock, na->mutex, this_ethread());
+    udpNet.UDPBind((Continuation *)na, &na->server.accept_addr.sa, fd, 1048576, 1048576);
+    return na->action_.get();
+  }
+
+  for (unsigned int i = 0; i < fds.size(); ++i) {
+    QUICPacketHandlerIn *handler = static_cast<QUICPacketHandlerIn *>(na);
+    if (i > 0) {
+      handler = new QUICPacketHandlerIn(opt, *this->_ctable, *this->_rtable);
+      ats_ip_copy(&handler->server.accept_addr, &accept_ip);
+      handler->action_ = na->action_;
+      handler->init_accept(nullptr);
+    }
+    handler->server.fd = fds[i];
+    handler->set_socket_index(i, fds.size());
+
+    Debug("quic_ps", "QUIC port %d: socket %u fd=%d", opt.local_port, i, fds[i]);
+    SCOPED_MUTEX_LOCK(lock, handler->mutex, this_ethread());
+    udpNet.UDPBind(handler, &accept_ip.sa, fds[i], 1048576, 1048576, eventProcessor.thread_group[ET_UDP]._thread[i]);
+  }
 
   return na->action_.get();
 }
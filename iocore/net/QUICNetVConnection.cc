@@ -274,7 +274,11 @@ QUICNetVConnection::init(QUICVersion version, QUICConnectionId peer_cid, QUICCon
   this->_original_quic_connection_id = original_cid;
   this->_first_quic_connection_id    = first_cid;
   this->_retry_source_connection_id  = retry_cid;
-  this->_quic_connection_id.randomize();
+  if (packet_handler->cid_worker() >= 0) {
+    this->_quic_connection_id.randomize(packet_handler->cid_worker());
+  } else {
+    this->_quic_connection_id.randomize();
+  }
   this->_initial_source_connection_id = this->_quic_connection_id;
 
   if (ctable) {
@@ -1241,7 +1245,8 @@ QUICNetVConnection::_state_handshake_process_initial_packet(const QUICInitialPac
       this->_alt_con_manager =
         new QUICAltConnectionManager(this, *this->_ctable, *this->_rtable, this->_peer_quic_connection_id,
                                      this->_quic_config->instance_id(), this->_quic_config->active_cid_limit_in(),
-                                     this->_quic_config->preferred_address_ipv4(), this->_quic_config->preferred_address_ipv6());
+                                     this->_quic_config->preferred_address_ipv4(), this->_quic_config->preferred_address_ipv6(),
+                                     this->_packet_handler->cid_worker());
       this->_frame_generators.add_generator(*this->_alt_con_manager, QUICFrameGeneratorWeight::EARLY);
       this->_frame_dispatcher->add_handler(this->_alt_con_manager);
     }
@@ -1542,16 +1547,17 @@ QUICNetVConnection::_state_common_send_packet()
         udp_payload->fill(len);
         written += len;
 
+        // The header is protected with the rest of the event's packets
         int dcil = (this->_peer_quic_connection_id == QUICConnectionId::ZERO()) ? 0 : this->_peer_quic_connection_id.length();
-        if (!this->_ph_protector.protect(buf, len, dcil)) {
-          ink_assert(!"failed to protect buffer");
-        }
+        this->_hp_batch.push_back({buf, len, dcil});
 
         QUICConVDebug("[TX] %s packet #%" PRIu64 " size=%zu", QUICDebugNames::packet_type(packet->type()), packet->packet_number(),
                       len);
 
         if (this->_pp_key_info.is_encryption_key_available(QUICKeyPhase::INITIAL) && packet->type() == QUICPacketType::HANDSHAKE &&
             this->netvc_context == NET_VCONNECTION_OUT) {
+          // Initial packets in the batch still need the keys
+          this->_protect_batched_headers();
           this->_pp_key_info.drop_keys(QUICKeyPhase::INITIAL);
           this->_loss_detector->on_packet_number_space_discarded(QUICPacketNumberSpace::INITIAL);
           this->_minimum_encryption_level = QUICEncryptionLevel::HANDSHAKE;
@@ -1563,13 +1569,19 @@ QUICNetVConnection::_state_common_send_packet()
     }
 
     if (written) {
-      this->_packet_handler->send_packet(this, udp_payload);
+      this->_udp_batch.push_back(std::move(udp_payload));
     } else {
       udp_payload->dealloc();
       break;
     }
   }
 
+  this->_protect_batched_headers();
+  for (auto &udp_payload : this->_udp_batch) {
+    this->_packet_handler->send_packet(this, udp_payload);
+  }
+  this->_udp_batch.clear();
+
   if (packet_count) {
     this->_context->trigger(QUICContext::CallbackEvent::METRICS_UPDATE, this->_congestion_controller->congestion_window(),
                             this->_congestion_controller->bytes_in_flight(), this->_congestion_controller->current_ssthresh());
@@ -1581,6 +1593,15 @@ QUICNetVConnection::_state_common_send_packet()
   return nullptr;
 }
 
+void
+QUICNetVConnection::_protect_batched_headers()
+{
+  if (!this->_hp_batch.empty() && !this->_ph_protector.protect(this->_hp_batch.data(), this->_hp_batch.size())) {
+    ink_assert(!"failed to protect buffer");
+  }
+  this->_hp_batch.clear();
+}
+
 QUICConnectionErrorUPtr
 QUICNetVConnection::_state_closing_send_packet()
 {
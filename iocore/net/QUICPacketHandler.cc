@@ -80,6 +80,12 @@ QUICPacketHandler::close_connection(QUICNetVConnection *conn)
   }
 }
 
+int
+QUICPacketHandler::cid_worker() const
+{
+  return this->_cid_worker;
+}
+
 void
 QUICPacketHandler::_send_packet(const QUICPacket &packet, UDPConnection *udp_con, IpEndpoint &addr, uint32_t pmtu,
                                 const QUICPacketHeaderProtector *ph_protector, int dcil)
@@ -148,6 +154,13 @@ QUICPacketHandlerIn::QUICPacketHandlerIn(const NetProcessor::AcceptOptions &opt,
 
 QUICPacketHandlerIn::~QUICPacketHandlerIn() {}
 
+void
+QUICPacketHandlerIn::set_socket_index(int index, int count)
+{
+  this->_cid_worker   = index;
+  this->_socket_count = count;
+}
+
 NetProcessor *
 QUICPacketHandlerIn::getNetProcessor() const
 {
@@ -211,6 +224,23 @@ QUICPacketHandlerIn::_get_continuation()
   return static_cast<NetAccept *>(this);
 }
 
+EThread *
+QUICPacketHandlerIn::_assign_thread()
+{
+  if (this->_socket_count == 0) {
+    return eventProcessor.assign_thread(ET_NET);
+  }
+
+  // The network threads paired with socket k are k, k + N, k + 2N, ... for N sockets, so that each socket's connections
+  // stay on their own threads.
+  auto &group = eventProcessor.thread_group[ET_NET];
+  int paired  = (group._count - this->_cid_worker + this->_socket_count - 1) / this->_socket_count;
+  if (paired <= 0) {
+    return group._thread[this->_cid_worker % group._count];
+  }
+  return group._thread[this->_cid_worker + this->_socket_count * (this->_next_thread++ % paired)];
+}
+
 void
 QUICPacketHandlerIn::_recv_packet(int event, UDPPacket *udp_packet)
 {
@@ -348,7 +378,7 @@ QUICPacketHandlerIn::_recv_packet(int event, UDPPacket *udp_packet)
     Connection con;
     con.setRemote(&udp_packet->from.sa);
 
-    eth                           = eventProcessor.assign_thread(ET_NET);
+    eth                           = this->_assign_thread();
     QUICConnectionId original_cid = dcid;
     QUICConnectionId peer_cid     = scid;
 
@@ -419,7 +449,11 @@ QUICPacketHandlerIn::_stateless_retry(const uint8_t *buf, uint64_t buf_len, UDPC
 
   if (token_length == 0) {
     QUICConnectionId local_cid;
-    local_cid.randomize();
+    if (this->_cid_worker >= 0) {
+      local_cid.randomize(this->_cid_worker);
+    } else {
+      local_cid.randomize();
+    }
     QUICRetryToken token(from, dcid, local_cid);
     QUICPacketUPtr retry_packet = QUICPacketFactory::create_retry_packet(version, scid, local_cid, token);
 
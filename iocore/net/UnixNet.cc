@@ -41,7 +41,7 @@ extern "C" void fd_reify(struct ev_loop *);
 
 // INKqa10496
 // One Inactivity cop runs on each thread once every second and
-// loops through the list of NetEvents and calls the timeouts
+// calls the timeouts of the NetEvents that are due in the timeout wheel
 class InactivityCop : public Continuation
 {
 public:
@@ -54,13 +54,22 @@ public:
     NetHandler &nh = *get_NetHandler(this_ethread());
 
     Debug("inactivity_cop_check", "Checking inactivity on Thread-ID #%d", this_ethread()->id);
-    // The rest NetEvents in cop_list which are not triggered between InactivityCop runs.
-    // Use pop() to catch any closes caused by callbacks.
-    while (NetEvent *ne = nh.cop_list.pop()) {
+    nh.process_timeout_updates();
+    nh.timeout_wheel.advance(now);
+    // Only the NetEvents due in the wheel are looked at, the others have not timed out.
+    // Each is placed back in the wheel before its callback so that it can close it.
+    while (NetEvent *ne = nh.timeout_wheel.pop_expired()) {
+      ne->timeout_check_at = 0;
+      if (ne->get_thread() != this_ethread()) {
+        nh.schedule_timeout(ne, now);
+        continue;
+      }
+
       // If we cannot get the lock don't stop just keep cleaning
       MUTEX_TRY_LOCK(lock, ne->get_mutex(), this_ethread());
       if (!lock.is_locked()) {
         NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
+        nh.schedule_timeout(ne, now);
         continue;
       }
 
@@ -93,28 +102,20 @@ public:
         }
         Debug("inactivity_cop_verbose", "ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
               ink_hrtime_to_sec(now), ne->next_inactivity_timeout_at, ne->inactivity_timeout_in);
+        nh.schedule_timeout(ne, now);
         ne->callback(VC_EVENT_INACTIVITY_TIMEOUT, e);
       } else if (ne->next_activity_timeout_at && ne->next_activity_timeout_at < now) {
         Debug("inactivity_cop_verbose", "active ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
               ink_hrtime_to_sec(now), ne->next_activity_timeout_at, ne->active_timeout_in);
+        nh.schedule_timeout(ne, now);
         ne->callback(VC_EVENT_ACTIVE_TIMEOUT, e);
+      } else {
+        nh.schedule_timeout(ne, now);
       }
     }
-    // The cop_list is empty now.
-    // Let's reload the cop_list from open_list again.
-    forl_LL(NetEvent, ne, nh.open_list)
-    {
-      if (ne->get_thread() == this_ethread()) {
-        nh.cop_list.push(ne);
-      }
-    }
-    // NetHandler will remove NetEvent from cop_list if it is triggered.
-    // As the NetHandler runs, the number of NetEvents in the cop_list is decreasing.
-    // NetHandler runs 100 times maximum between InactivityCop runs.
-    // Therefore we don't have to check all the NetEvents as much as open_list.
 
-    // Cleanup the active and keep-alive queues periodically
-    nh.manage_active_queue(nullptr, true); // close any connections over the active timeout
+    // Connections over the active timeout are closed through the wheel above, so only
+    // the keep-alive queue needs to be trimmed here.
     nh.manage_keep_alive_queue();
 
     return 0;
@@ -250,6 +251,7 @@ initialize_thread_for_net(EThread *thread)
   REC_ReadConfigInteger(cop_freq, "proxy.config.net.inactivity_check_frequency");
   memcpy(&nh->config, &NetHandler::global_config, sizeof(NetHandler::global_config));
   nh->configure_per_thread_values();
+  nh->inactivity_check_interval = HRTIME_SECONDS(cop_freq);
   thread->schedule_every(inactivityCop, HRTIME_SECONDS(cop_freq));
 
   thread->set_tail_handler(nh);
@@ -265,7 +267,7 @@ initialize_thread_for_net(EThread *thread)
 
 // NetHandler method definitions
 
-NetHandler::NetHandler() : Continuation(nullptr)
+NetHandler::NetHandler() : Continuation(nullptr), timeout_wheel(TIMEOUT_TICK, Thread::get_hrtime_updated())
 {
   SET_HANDLER((NetContHandler)&NetHandler::mainNetEvent);
 }
@@ -347,6 +349,69 @@ NetHandler::init_for_process()
   Debug("net_queue", "proxy.config.net.default_inactivity_timeout updated to %d", global_config.default_inactivity_timeout);
 }
 
+//
+// Timeout wheel of the NetEvents in the open_list.
+//
+void
+NetHandler::schedule_timeout(NetEvent *ne, ink_hrtime now, bool closing)
+{
+  ink_hrtime at = (closing || ne->closed) ? now : ne->next_timeout_at();
+
+  if (at == 0) {
+    // No timeout, but a default may need to be applied later.
+    at = now + inactivity_check_interval;
+  } else if (at <= now) {
+    // Already past, look again next time around.
+    at = now + 1;
+  }
+  if (timeout_wheel.in(ne)) {
+    if (at >= ne->timeout_check_at) {
+      // A later timeout is found when the earlier check is due.
+      return;
+    }
+    timeout_wheel.remove(ne);
+  }
+  ne->timeout_check_at = at;
+  timeout_wheel.insert(ne);
+}
+
+void
+NetHandler::timeout_changed(NetEvent *ne, bool closing)
+{
+  if (this->thread == this_ethread()) {
+    if (ne->timeout_check_at) {
+      schedule_timeout(ne, Thread::get_hrtime(), closing);
+    }
+  } else if (ink_atomic_cas(&ne->in_timeout_list, 0, 1)) {
+    // The wheel belongs to the NetHandler thread, so it is not looked at here.
+    timeout_update_list.push(ne);
+  }
+}
+
+void
+NetHandler::process_timeout_updates()
+{
+  ink_hrtime now = Thread::get_hrtime();
+  SList(NetEvent, timeout_alink) list(timeout_update_list.popall());
+  NetEvent *ne;
+
+  while ((ne = list.pop())) {
+    if (ink_atomic_swap(&ne->in_timeout_list, 0) == 2) {
+      // Freed by free_netevent() while it was in the list.
+      ne->free(this->thread);
+      continue;
+    }
+    // A close is marked only after the NetEvent is pushed, so it may not be seen yet.
+    // Look at it on the next run of InactivityCop, unless it is due before then.
+    ink_hrtime at = now + inactivity_check_interval;
+    if (ne->timeout_check_at > at) {
+      timeout_wheel.remove(ne);
+      ne->timeout_check_at = at;
+      timeout_wheel.insert(ne);
+    }
+  }
+}
+
 //
 // Function used to release a NetEvent and free it.
 //
@@ -363,6 +428,10 @@ NetHandler::free_netevent(NetEvent *ne)
   stopCop(ne);
   // Release ne from NetHandler
   stopIO(ne);
+  // Leave ne to process_timeout_updates() if it is in the timeout_update_list
+  if (ink_atomic_cas(&ne->in_timeout_list, 1, 2)) {
+    return;
+  }
   // Clear and deallocate ne
   ne->free(t);
 }
@@ -503,10 +572,6 @@ NetHandler::waitForActivity(ink_hrtime timeout)
     epd = static_cast<EventIO *> get_ev_data(pd, x);
     if (epd->type == EVENTIO_READWRITE_VC) {
       ne = epd->data.ne;
-      // Remove triggered NetEvent from cop_list because it won't be timeout before next InactivityCop runs.
-      if (cop_list.in(ne)) {
-        cop_list.remove(ne);
-      }
       int flags = get_ev_events(pd, x);
       if (flags & (EVENTIO_ERROR)) {
         ne->set_error_from_socket();
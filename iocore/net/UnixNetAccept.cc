@@ -21,6 +21,8 @@
   limitations under the License.
  */
 
+#include <mutex>
+
 #include <tscore/TSSystemState.h>
 #include <tscore/ink_defs.h>
 
@@ -33,12 +35,64 @@ int accept_till_done   = 1;
 // in different threads at the same time
 Ptr<ProxyMutex> naVecMutex;
 std::vector<NetAccept *> naVec;
+
+// Connections accepted by each ET_NET thread, when the threads accept for themselves.
+static RecRawStatBlock *thread_accept_rsb = nullptr;
+static int thread_accept_count            = 0;
+
 static void
 safe_delay(int msec)
 {
   socketManager.poll(nullptr, 0, msec);
 }
 
+static void
+register_thread_accept_stats()
+{
+  static std::once_flag once;
+
+  std::call_once(once, [] {
+    char name[64];
+    int n = eventProcessor.thread_group[ET_NET]._count;
+
+    if ((thread_accept_rsb = RecAllocateRawStatBlock(n)) == nullptr) {
+      return;
+    }
+    for (int i = 0; i < n; ++i) {
+      snprintf(name, sizeof(name), "proxy.process.net.thread_%d.accepts", i);
+      RecRegisterRawStat(thread_accept_rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, i, RecRawStatSyncSum);
+    }
+    thread_accept_count = n;
+  });
+}
+
+static inline void
+count_thread_accept(EThread *t)
+{
+  if (t->id < thread_accept_count && t->is_event_type(ET_NET)) {
+    RecIncrRawStatSum(thread_accept_rsb, t, t->id, 1);
+  }
+}
+
+#ifdef SO_INCOMING_CPU
+/// @return The CPU the calling thread is bound to, -1 if it may run on more than one.
+static int
+bound_cpu()
+{
+  cpu_set_t set;
+
+  if (sched_getaffinity(0, sizeof(set), &set) != 0 || CPU_COUNT(&set) != 1) {
+    return -1;
+  }
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      return cpu;
+    }
+  }
+  return -1;
+}
+#endif
+
 //
 // General case network connection accept code
 //
@@ -204,18 +258,44 @@ NetAccept::accept_per_thread(int event, void *ep)
   int listen_per_thread = 0;
   REC_ReadConfigInteger(listen_per_thread, "proxy.config.exec_thread.listen");
 
-  if (listen_per_thread == 1) {
-    if (do_listen(NON_BLOCKING)) {
-      Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
-      return -1;
-    }
-  }
-
   if (accept_fn == net_accept) {
     SET_HANDLER((NetAcceptHandler)&NetAccept::acceptFastEvent);
   } else {
     SET_HANDLER((NetAcceptHandler)&NetAccept::acceptEvent);
   }
+
+  if (listen_per_thread > 0) {
+    // Stopped before this thread got to listen.
+    if (action_->cancelled) {
+      return EVENT_DONE;
+    }
+    // The port is kept as long as one of the threads listens on it.
+    if (do_listen(NON_BLOCKING)) {
+      if (++action_->listen_failures == action_->listen_threads) {
+        Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
+      }
+      Warning("thread %d could not listen on port %d, it is left to the other threads", this_ethread()->id,
+              server.accept_addr.host_order_port());
+      return EVENT_DONE;
+    }
+#ifdef SO_INCOMING_CPU
+    // Have the kernel prefer this socket for connections it takes in on the CPU of this thread, so
+    // they are handled where they arrive. Without that the connections are spread by hash.
+    if (listen_per_thread == 2) {
+      int cpu = bound_cpu();
+      if (cpu < 0) {
+        Debug("iocore_net_accept", "thread %d is not bound to a CPU, port %d is not steered to it", this_ethread()->id,
+              server.accept_addr.host_order_port());
+      } else if (safe_setsockopt(server.fd, SOL_SOCKET, SO_INCOMING_CPU, reinterpret_cast<char *>(&cpu), sizeof(cpu)) < 0) {
+        Warning("unable to set SO_INCOMING_CPU %d on port %d: %s", cpu, server.accept_addr.host_order_port(), strerror(errno));
+      } else {
+        Debug("iocore_net_accept", "thread %d accepts the connections of CPU %d on port %d", this_ethread()->id, cpu,
+              server.accept_addr.host_order_port());
+      }
+    }
+#endif
+  }
+
   PollDescriptor *pd = get_PollDescriptor(this_ethread());
   if (this->ep.start(pd, this, EVENTIO_READ) < 0) {
     Fatal("[NetAccept::accept_per_thread]:error starting EventIO");
@@ -240,11 +320,22 @@ NetAccept::init_accept_per_thread()
     }
   }
 
+  register_thread_accept_stats();
+
   SET_HANDLER((NetAcceptHandler)&NetAccept::accept_per_thread);
   n = eventProcessor.thread_group[opt.etype]._count;
 
+  std::vector<NetAccept *> accepts;
   for (i = 0; i < n; i++) {
-    NetAccept *a = (i < n - 1) ? clone() : this;
+    accepts.push_back((i < n - 1) ? clone() : this);
+  }
+  if (listen_per_thread > 0) {
+    action_->listen_threads = n;
+    thread_accepts          = accepts;
+  }
+
+  for (i = 0; i < n; i++) {
+    NetAccept *a = accepts[i];
     EThread *t   = eventProcessor.thread_group[opt.etype]._thread[i];
     a->mutex     = get_NetHandler(t)->mutex;
     t->schedule_imm(a);
@@ -254,6 +345,18 @@ NetAccept::init_accept_per_thread()
 void
 NetAccept::stop_accept()
 {
+  if (!thread_accepts.empty()) {
+    // Each thread closes its own listen socket, which must not be done from here as it is in the
+    // poll set of that thread. Connections still in the queue of one are reset by the kernel.
+    if (!action_->cancelled) {
+      action_->Action::cancel();
+    }
+    for (unsigned i = 0; i < thread_accepts.size(); ++i) {
+      eventProcessor.thread_group[opt.etype]._thread[i]->schedule_imm(thread_accepts[i]);
+    }
+    return;
+  }
+
   if (!action_->cancelled) {
     action_->cancel();
   }
@@ -430,6 +533,13 @@ NetAccept::acceptFastEvent(int event, void *ep)
   UnixNetVConnection *vc = nullptr;
   int loop               = accept_till_done;
 
+  // A listen socket of this thread alone is closed here once the accept is stopped, see stop_accept().
+  if (action_->listen_threads > 0 && action_->cancelled) {
+    this->ep.stop();
+    server.close();
+    return EVENT_DONE;
+  }
+
   do {
     socklen_t sz = sizeof(con.addr);
     int fd       = socketManager.accept4(server.fd, &con.addr.sa, &sz, SOCK_NONBLOCK | SOCK_CLOEXEC);
@@ -493,6 +603,7 @@ NetAccept::acceptFastEvent(int event, void *ep)
     vc = (UnixNetVConnection *)this->getNetProcessor()->allocate_vc(e->ethread);
     ink_release_assert(vc);
 
+    count_thread_accept(e->ethread);
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, 1);
     vc->id = net_next_connection_number();
     vc->con.move(con);
@@ -534,6 +645,14 @@ Ldone:
   return EVENT_CONT;
 
 Lerror:
+  if (action_->listen_threads > 0) {
+    // Only this thread stops, the port is still served by the others. This is kept for stop_accept().
+    Warning("thread %d stopped accepting on port %d, it is left to the other threads", e->ethread->id,
+            server.accept_addr.host_order_port());
+    this->ep.stop();
+    server.close();
+    return EVENT_DONE;
+  }
   server.close();
   e->cancel();
   NET_DECREMENT_DYN_STAT(net_accepts_currently_open_stat);
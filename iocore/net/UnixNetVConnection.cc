@@ -665,6 +665,12 @@ UnixNetVConnection::do_io_close(int alerrno /* = -1 */)
     this->lerrno = alerrno;
   }
 
+  // Have InactivityCop free it if the NetHandler does not get to it first.
+  // Once marked closed the NetHandler may free it, so this comes before.
+  if (!close_inline && nh) {
+    nh->timeout_changed(this, true);
+  }
+
   // Must mark for closed last in case this is a
   // cross thread migration scenario.
   if (alerrno == -1) {
@@ -843,6 +849,9 @@ UnixNetVConnection::set_enabled(VIO *vio)
   if (!next_inactivity_timeout_at && inactivity_timeout_in) {
     next_inactivity_timeout_at = Thread::get_hrtime() + inactivity_timeout_in;
   }
+  if (nh) {
+    nh->timeout_changed(this);
+  }
 }
 
 void
@@ -1315,12 +1324,26 @@ UnixNetVConnection::apply_options()
   con.apply_options(options);
 }
 
+TS_INLINE void
+UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
+{
+  Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
+  active_timeout_in        = timeout_in;
+  next_activity_timeout_at = (active_timeout_in > 0) ? Thread::get_hrtime() + timeout_in : 0;
+  if (nh) {
+    nh->timeout_changed(this);
+  }
+}
+
 TS_INLINE void
 UnixNetVConnection::set_inactivity_timeout(ink_hrtime timeout_in)
 {
   Debug("socket", "Set inactive timeout=%" PRId64 ", for NetVC=%p", timeout_in, this);
   inactivity_timeout_in      = timeout_in;
   next_inactivity_timeout_at = (timeout_in > 0) ? Thread::get_hrtime() + inactivity_timeout_in : 0;
+  if (nh) {
+    nh->timeout_changed(this);
+  }
 }
 
 TS_INLINE void
@@ -1330,6 +1353,9 @@ UnixNetVConnection::set_default_inactivity_timeout(ink_hrtime timeout_in)
   inactivity_timeout_in      = 0;
   default_inactivity_timeout = true;
   next_inactivity_timeout_at = Thread::get_hrtime() + timeout_in;
+  if (nh) {
+    nh->timeout_changed(this);
+  }
 }
 
 TS_INLINE bool
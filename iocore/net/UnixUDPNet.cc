@@ -735,7 +735,7 @@ HardError:
 }
 
 Action *
-UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int send_bufsize, int recv_bufsize)
+UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int send_bufsize, int recv_bufsize, EThread *thread)
 {
   int res              = 0;
   UnixUDPConnection *n = nullptr;
@@ -828,7 +828,7 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
 
   Debug("udpnet", "UDPNetProcessor::UDPBind: %p fd=%d", n, fd);
   n->setBinding(&myaddr.sa);
-  n->bindToThread(cont);
+  n->bindToThread(cont, thread);
 
   pc = get_UDPPollCont(n->ethread);
   pd = pc->pollDescriptor;
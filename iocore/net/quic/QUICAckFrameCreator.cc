@@ -154,16 +154,8 @@ QUICAckFrameManager::QUICAckFrameCreator::refresh_state()
 void
 QUICAckFrameManager::QUICAckFrameCreator::forget(QUICPacketNumber largest_acknowledged)
 {
-  this->_available = false;
-  this->sort();
-  std::list<RecvdPacket> remove_list;
-  for (auto it = this->_packet_numbers.begin(); it != this->_packet_numbers.end(); it++) {
-    if ((*it).packet_number == largest_acknowledged) {
-      remove_list.splice(remove_list.begin(), this->_packet_numbers, it, this->_packet_numbers.end());
-      break;
-    }
-    this->_available |= !(*it).ack_only;
-  }
+  this->_packet_numbers.erase_up_to(largest_acknowledged);
+  this->_available = this->_has_eliciting && this->_largest_eliciting > largest_acknowledged;
 
   if (this->_packet_numbers.empty() || !this->_available) {
     this->_should_send = false;
@@ -200,18 +192,22 @@ QUICAckFrameManager::QUICAckFrameCreator::push_back(QUICPacketNumber packet_numb
   if (!ack_only) {
     this->_available    = true;
     this->_has_new_data = true;
+    if (!this->_has_eliciting || packet_number > this->_largest_eliciting) {
+      this->_largest_eliciting = packet_number;
+      this->_has_eliciting     = true;
+    }
   } else {
     this->_should_send = this->_available ? this->_should_send : false;
   }
 
   this->_expect_next = packet_number + 1;
-  this->_packet_numbers.push_back({ack_only, packet_number});
+  this->_packet_numbers.insert(packet_number);
 }
 
 size_t
 QUICAckFrameManager::QUICAckFrameCreator::size() const
 {
-  return this->_packet_numbers.size();
+  return this->_packet_numbers.count();
 }
 
 void
@@ -224,6 +220,8 @@ QUICAckFrameManager::QUICAckFrameCreator::clear()
   this->_ack_eliciting_count         = 0;
   this->_should_send                 = false;
   this->_available                   = false;
+  this->_has_eliciting               = false;
+  this->_largest_eliciting           = 0;
 }
 
 QUICPacketNumber
@@ -238,13 +236,6 @@ QUICAckFrameManager::QUICAckFrameCreator::largest_ack_received_time() const
   return this->_largest_ack_received_time;
 }
 
-void
-QUICAckFrameManager::QUICAckFrameCreator::sort()
-{
-  //  TODO Find more smart way
-  this->_packet_numbers.sort([](const RecvdPacket &a, const RecvdPacket &b) -> bool { return a.packet_number > b.packet_number; });
-}
-
 QUICAckFrame *
 QUICAckFrameManager::QUICAckFrameCreator::generate_ack_frame(uint8_t *buf, uint16_t maximum_frame_size)
 {
@@ -270,59 +261,29 @@ QUICAckFrameManager::QUICAckFrameCreator::_create_ack_frame(uint8_t *buf)
 {
   ink_assert(!this->_packet_numbers.empty());
   QUICAckFrame *ack_frame = nullptr;
-  this->sort();
-  std::list<RecvdPacket> &list = this->_packet_numbers;
 
   this->_has_new_data = false;
 
-  uint8_t gap     = 0;
-  uint64_t length = 0;
-  auto it         = list.begin();
-
-  // skip ack_only packets
-  for (; it != list.end(); it++) {
-    if (!(*it).ack_only) {
-      break;
-    }
-  }
-
-  if (it == list.end()) {
+  // ack only packets above the largest ack-eliciting one are not acked
+  if (!this->_has_eliciting || !this->_packet_numbers.contains(this->_largest_eliciting)) {
     return ack_frame;
   }
 
-  QUICPacketNumber largest_ack_number = (*it).packet_number;
-  QUICPacketNumber last_ack_number    = largest_ack_number;
-
-  while (it != list.end()) {
-    QUICPacketNumber pn = (*it).packet_number;
-    if (pn == last_ack_number) {
-      last_ack_number--;
-      length++;
-      it++;
+  QUICPacketNumber prev_first = 0;
+  for (auto it = this->_packet_numbers.rbegin(); it != this->_packet_numbers.rend(); ++it) {
+    if (it->first > this->_largest_eliciting) {
       continue;
     }
-
-    ink_assert(length > 0);
+    QUICPacketNumber last = std::min(it->last, this->_largest_eliciting);
 
     if (ack_frame) {
-      ack_frame->ack_block_section()->add_ack_block({static_cast<uint8_t>(gap - 1), length - 1});
+      ack_frame->ack_block_section()->add_ack_block({prev_first - last - 2, last - it->first});
     } else {
       uint64_t delay = this->_calculate_delay();
-      ack_frame      = QUICFrameFactory::create_ack_frame(buf, largest_ack_number, delay, length - 1,
-                                                     this->_ack_manager->issue_frame_id(), this->_ack_manager);
+      ack_frame      = QUICFrameFactory::create_ack_frame(buf, last, delay, last - it->first, this->_ack_manager->issue_frame_id(),
+                                                     this->_ack_manager);
     }
-
-    gap             = last_ack_number - pn;
-    last_ack_number = pn;
-    length          = 0;
-  }
-
-  if (ack_frame) {
-    ack_frame->ack_block_section()->add_ack_block({static_cast<uint8_t>(gap - 1), length - 1});
-  } else {
-    uint64_t delay = this->_calculate_delay();
-    ack_frame = QUICFrameFactory::create_ack_frame(buf, largest_ack_number, delay, length - 1, this->_ack_manager->issue_frame_id(),
-                                                   this->_ack_manager);
+    prev_first = it->first;
   }
 
   return ack_frame;
@@ -26,7 +26,7 @@
 #include "QUICFrameGenerator.h"
 #include "QUICTypes.h"
 #include "QUICFrame.h"
-#include <list>
+#include "QUICRangeSet.h"
 
 class QUICConnection;
 
@@ -36,17 +36,12 @@ public:
   class QUICAckFrameCreator
   {
   public:
-    struct RecvdPacket {
-      bool ack_only                  = false;
-      QUICPacketNumber packet_number = 0;
-    };
     QUICAckFrameCreator(QUICPacketNumberSpace pn_space, QUICAckFrameManager *ack_manager);
     ~QUICAckFrameCreator();
 
     void push_back(QUICPacketNumber packet_number, size_t size, bool ack_only);
     size_t size() const;
     void clear();
-    void sort();
     void forget(QUICPacketNumber largest_acknowledged);
     bool available() const;
     bool is_ack_frame_ready();
@@ -65,7 +60,10 @@ public:
     uint64_t _calculate_delay();
     QUICAckFrame *_create_ack_frame(uint8_t *buf);
 
-    std::list<RecvdPacket> _packet_numbers;
+    // Received packet numbers, kept as the ranges an ACK frame is built from
+    QUICRangeSet _packet_numbers;
+    QUICPacketNumber _largest_eliciting     = 0;     // largest packet number that was not ack only
+    bool _has_eliciting                     = false;
     bool _available                         = false; // packet_number has data to sent
     bool _should_send                       = false; // ack frame should be sent immediately
     bool _has_new_data                      = false; // new data after last sent
@@ -36,8 +36,13 @@ static constexpr char V_DEBUG_TAG[] = "v_quic_alt_con";
 QUICAltConnectionManager::QUICAltConnectionManager(QUICConnection *qc, QUICConnectionTable &ctable, QUICResetTokenTable &rtable,
                                                    const QUICConnectionId &peer_initial_cid, uint32_t instance_id,
                                                    uint8_t local_active_cid_limit, const IpEndpoint *preferred_endpoint_ipv4,
-                                                   const IpEndpoint *preferred_endpoint_ipv6)
-  : _qc(qc), _ctable(ctable), _rtable(rtable), _instance_id(instance_id), _local_active_cid_limit(local_active_cid_limit)
+                                                   const IpEndpoint *preferred_endpoint_ipv6, int cid_worker)
+  : _qc(qc),
+    _ctable(ctable),
+    _rtable(rtable),
+    _instance_id(instance_id),
+    _cid_worker(cid_worker),
+    _local_active_cid_limit(local_active_cid_limit)
 {
   // Sequence number of the initial CID is 0
   this->_alt_quic_connection_ids_remote.push_back({0, peer_initial_cid, {}, {true}});
@@ -111,7 +116,11 @@ QUICAltConnectionManager::AltConnectionInfo
 QUICAltConnectionManager::_generate_next_alt_con_info()
 {
   QUICConnectionId conn_id;
-  conn_id.randomize();
+  if (this->_cid_worker >= 0) {
+    conn_id.randomize(this->_cid_worker);
+  } else {
+    conn_id.randomize();
+  }
   QUICStatelessResetToken token(conn_id, this->_instance_id);
   AltConnectionInfo aci = {++this->_alt_quic_connection_id_seq_num, conn_id, token, {false}};
 
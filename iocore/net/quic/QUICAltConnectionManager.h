@@ -39,7 +39,7 @@ public:
   QUICAltConnectionManager(QUICConnection *qc, QUICConnectionTable &ctable, QUICResetTokenTable &rtable,
                            const QUICConnectionId &peer_initial_cid, uint32_t instance_id, uint8_t active_cid_limit,
                            const IpEndpoint *preferred_endpoint_ipv4 = nullptr,
-                           const IpEndpoint *preferred_endpoint_ipv6 = nullptr);
+                           const IpEndpoint *preferred_endpoint_ipv6 = nullptr, int cid_worker = -1);
   ~QUICAltConnectionManager();
 
   /**
@@ -102,6 +102,7 @@ private:
   std::vector<AltConnectionInfo> _alt_quic_connection_ids_remote;
   std::queue<uint64_t> _retired_seq_nums;
   uint32_t _instance_id                          = 0;
+  int _cid_worker                                = -1; ///< Worker encoded in local CIDs, -1 for none
   uint8_t _local_active_cid_limit                = 0;
   uint8_t _remote_active_cid_limit               = 0;
   uint64_t _alt_quic_connection_id_seq_num       = 0;
@@ -0,0 +1,62 @@
+/** @file
+ *
+ *  Cipher context kept set up with a key
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "QUICCipherContext.h"
+
+#include <cstring>
+
+#include <openssl/crypto.h>
+
+QUICCipherContext::~QUICCipherContext()
+{
+  if (this->_ctx) {
+    EVP_CIPHER_CTX_free(this->_ctx);
+  }
+  OPENSSL_cleanse(this->_key, sizeof(this->_key));
+}
+
+EVP_CIPHER_CTX *
+QUICCipherContext::get(const EVP_CIPHER *cipher, const uint8_t *key, bool encrypt)
+{
+  size_t key_len = EVP_CIPHER_key_length(cipher);
+
+  if (this->_cipher == cipher && this->_encrypt == encrypt && this->_key_len == key_len && memcmp(this->_key, key, key_len) == 0) {
+    return this->_ctx;
+  }
+
+  this->_cipher = nullptr;
+  if (!this->_ctx && !(this->_ctx = EVP_CIPHER_CTX_new())) {
+    return nullptr;
+  }
+  if (!EVP_CipherInit_ex(this->_ctx, cipher, nullptr, key, nullptr, encrypt ? 1 : 0)) {
+    return nullptr;
+  }
+  // Header protection masks are whole blocks, and padding does not apply to the AEADs
+  EVP_CIPHER_CTX_set_padding(this->_ctx, 0);
+
+  this->_cipher  = cipher;
+  this->_encrypt = encrypt;
+  this->_key_len = key_len;
+  memcpy(this->_key, key, key_len);
+  return this->_ctx;
+}
@@ -0,0 +1,58 @@
+/** @file
+ *
+ *  Cipher context kept set up with a key
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <openssl/evp.h>
+
+/**
+ * EVP cipher context that stays set up with a cipher and key between packets.
+ *
+ * Setting up a context expands the key, which costs about as much as protecting a small packet. Packets of a connection use the
+ * same keys until a key update, so the context is only set up again when the cipher or the key changes, and each packet only
+ * sets its nonce.
+ */
+class QUICCipherContext
+{
+public:
+  QUICCipherContext() = default;
+  ~QUICCipherContext();
+
+  QUICCipherContext(const QUICCipherContext &) = delete;
+  QUICCipherContext &operator=(const QUICCipherContext &) = delete;
+
+  /**
+   * Returns the context set up for @a cipher and @a key with no IV, or nullptr on error.
+   */
+  EVP_CIPHER_CTX *get(const EVP_CIPHER *cipher, const uint8_t *key, bool encrypt);
+
+private:
+  EVP_CIPHER_CTX *_ctx      = nullptr;
+  const EVP_CIPHER *_cipher = nullptr;
+  bool _encrypt             = true;
+  size_t _key_len           = 0;
+  uint8_t _key[EVP_MAX_KEY_LENGTH];
+};
@@ -107,6 +107,7 @@ QUICConfigParams::initialize()
   REC_EstablishStaticConfigInt32U(this->_instance_id, "proxy.config.quic.instance_id");
   REC_EstablishStaticConfigInt32(this->_connection_table_size, "proxy.config.quic.connection_table.size");
   REC_EstablishStaticConfigInt32U(this->_stateless_retry, "proxy.config.quic.server.stateless_retry_enabled");
+  REC_EstablishStaticConfigInt32U(this->_reuseport, "proxy.config.quic.server.reuseport");
   REC_EstablishStaticConfigInt32U(this->_vn_exercise_enabled, "proxy.config.quic.client.vn_exercise_enabled");
   REC_EstablishStaticConfigInt32U(this->_cm_exercise_enabled, "proxy.config.quic.client.cm_exercise_enabled");
   REC_EstablishStaticConfigInt32U(this->_quantum_readiness_test_enabled_out,
@@ -225,6 +226,12 @@ QUICConfigParams::stateless_retry() const
   return this->_stateless_retry;
 }
 
+uint32_t
+QUICConfigParams::reuseport() const
+{
+  return this->_reuseport;
+}
+
 uint32_t
 QUICConfigParams::vn_exercise_enabled() const
 {
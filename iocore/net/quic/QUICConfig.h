@@ -38,6 +38,7 @@ public:
 
   uint32_t instance_id() const;
   uint32_t stateless_retry() const;
+  uint32_t reuseport() const;
   uint32_t vn_exercise_enabled() const;
   uint32_t cm_exercise_enabled() const;
   uint32_t quantum_readiness_test_enabled_in() const;
@@ -98,6 +99,7 @@ private:
 
   uint32_t _instance_id                        = 0;
   uint32_t _stateless_retry                    = 0;
+  uint32_t _reuseport                          = 0;
   uint32_t _vn_exercise_enabled                = 0;
   uint32_t _cm_exercise_enabled                = 0;
   uint32_t _quantum_readiness_test_enabled_in  = 0;
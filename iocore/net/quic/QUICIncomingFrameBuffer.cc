@@ -21,8 +21,19 @@
  *  limitations under the License.
  */
 
+#include <algorithm>
+
 #include "QUICIncomingFrameBuffer.h"
 
+namespace
+{
+bool
+offset_less(const std::pair<QUICOffset, const QUICFrame *> &elem, QUICOffset offset)
+{
+  return elem.first < offset;
+}
+} // namespace
+
 //
 // QUICIncomingFrameBuffer
 //
@@ -54,6 +65,32 @@ QUICIncomingFrameBuffer::empty()
   return this->_out_of_order_queue.empty() && this->_recv_buffer.empty();
 }
 
+/**
+ * Returns false if there is a frame at the offset already
+ */
+bool
+QUICIncomingFrameBuffer::_insert_out_of_order(QUICOffset offset, const QUICFrame *frame)
+{
+  auto ite = std::lower_bound(this->_out_of_order_queue.begin(), this->_out_of_order_queue.end(), offset, offset_less);
+  if (ite != this->_out_of_order_queue.end() && ite->first == offset) {
+    return false;
+  }
+  this->_out_of_order_queue.emplace(ite, offset, frame);
+  return true;
+}
+
+const QUICFrame *
+QUICIncomingFrameBuffer::_take_out_of_order(QUICOffset offset)
+{
+  auto ite = std::lower_bound(this->_out_of_order_queue.begin(), this->_out_of_order_queue.end(), offset, offset_less);
+  if (ite == this->_out_of_order_queue.end() || ite->first != offset) {
+    return nullptr;
+  }
+  const QUICFrame *frame = ite->second;
+  this->_out_of_order_queue.erase(ite);
+  return frame;
+}
+
 //
 // QUICIncomingStreamFrameBuffer
 //
@@ -66,14 +103,11 @@ const QUICFrame *
 QUICIncomingStreamFrameBuffer::pop()
 {
   if (this->_recv_buffer.empty()) {
-    auto elem = this->_out_of_order_queue.find(this->_recv_offset);
-    while (elem != this->_out_of_order_queue.end()) {
-      const QUICStreamFrame *frame = static_cast<const QUICStreamFrame *>(elem->second);
+    while (auto elem = this->_take_out_of_order(this->_recv_offset)) {
+      const QUICStreamFrame *frame = static_cast<const QUICStreamFrame *>(elem);
 
       this->_recv_buffer.push(frame);
       this->_recv_offset += frame->data_length();
-      this->_out_of_order_queue.erase(elem);
-      elem = this->_out_of_order_queue.find(this->_recv_offset);
     }
   }
 
@@ -113,8 +147,7 @@ QUICIncomingStreamFrameBuffer::insert(const QUICFrame *frame)
     this->_recv_offset = offset + len;
     this->_recv_buffer.push(stream_frame);
   } else {
-    auto result = this->_out_of_order_queue.insert(std::make_pair(offset, stream_frame));
-    if (!result.second) {
+    if (!this->_insert_out_of_order(offset, stream_frame)) {
       // Duplicate frame doesn't need to be inserted
       delete stream_frame;
     }
@@ -204,14 +237,11 @@ const QUICFrame *
 QUICIncomingCryptoFrameBuffer::pop()
 {
   if (this->_recv_buffer.empty()) {
-    auto elem = this->_out_of_order_queue.find(this->_recv_offset);
-    while (elem != this->_out_of_order_queue.end()) {
-      const QUICCryptoFrame *frame = static_cast<const QUICCryptoFrame *>(elem->second);
+    while (auto elem = this->_take_out_of_order(this->_recv_offset)) {
+      const QUICCryptoFrame *frame = static_cast<const QUICCryptoFrame *>(elem);
 
       this->_recv_buffer.push(frame);
       this->_recv_offset += frame->data_length();
-      this->_out_of_order_queue.erase(elem);
-      elem = this->_out_of_order_queue.find(this->_recv_offset);
     }
   }
 
@@ -246,8 +276,7 @@ QUICIncomingCryptoFrameBuffer::insert(const QUICFrame *frame)
     this->_recv_offset = offset + len;
     this->_recv_buffer.push(crypto_frame);
   } else {
-    auto result = this->_out_of_order_queue.insert(std::make_pair(offset, crypto_frame));
-    if (!result.second) {
+    if (!this->_insert_out_of_order(offset, crypto_frame)) {
       // Duplicate frame doesn't need to be inserted
       delete crypto_frame;
     }
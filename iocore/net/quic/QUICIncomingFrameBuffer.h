@@ -23,8 +23,8 @@
 
 #pragma once
 
-#include <map>
 #include <queue>
+#include <vector>
 
 #include "QUICTypes.h"
 #include "QUICFrame.h"
@@ -40,10 +40,15 @@ public:
   virtual bool empty();
 
 protected:
+  bool _insert_out_of_order(QUICOffset offset, const QUICFrame *frame);
+  const QUICFrame *_take_out_of_order(QUICOffset offset);
+
   QUICOffset _recv_offset = 0;
 
   std::queue<const QUICFrame *> _recv_buffer;
-  std::map<QUICOffset, const QUICFrame *> _out_of_order_queue;
+  // Frames that arrived ahead of _recv_offset, sorted by offset. There are only a few at a time, which makes a flat vector
+  // cheaper than a tree.
+  std::vector<std::pair<QUICOffset, const QUICFrame *>> _out_of_order_queue;
 };
 
 class QUICIncomingStreamFrameBuffer : public QUICIncomingFrameBuffer, public QUICTransferProgressProvider
@@ -168,14 +168,12 @@ QUICLossDetector::on_packet_number_space_discarded(QUICPacketNumberSpace pn_spac
 {
   ink_assert(pn_space != QUICPacketNumberSpace::APPLICATION_DATA);
   size_t bytes_in_flight = 0;
-  for (auto it = this->_sent_packets[static_cast<int>(pn_space)].begin();
-       it != this->_sent_packets[static_cast<int>(pn_space)].end();) {
-    auto ret = this->_remove_from_sent_packet_list(it, pn_space);
-    auto &pi = ret.first;
-    if (pi->in_flight) {
+  auto &sent_packets     = this->_sent_packets[static_cast<int>(pn_space)];
+  for (QUICPacketNumber pn = sent_packets.lowest(); pn < sent_packets.end(); ++pn) {
+    auto pi = this->_remove_from_sent_packet_list(pn, pn_space);
+    if (pi && pi->in_flight) {
       bytes_in_flight += pi->sent_bytes;
     }
-    it = ret.second;
   }
   this->_cc->on_packet_number_space_discarded(bytes_in_flight);
   // Reset the loss detection and PTO timer
@@ -469,10 +467,15 @@ QUICLossDetector::_on_loss_detection_timeout()
 
   if (is_debug_tag_set("v_quic_loss_detector")) {
     for (auto i = 0; i < 3; i++) {
-      for (auto &unacked : this->_sent_packets[i]) {
+      auto &sent_packets = this->_sent_packets[i];
+      for (QUICPacketNumber pn = sent_packets.lowest(); pn < sent_packets.end(); ++pn) {
+        const QUICSentPacketInfo *unacked = sent_packets.find(pn);
+        if (unacked == nullptr) {
+          continue;
+        }
         QUICLDVDebug("[%s] #%" PRIu64 " ack_eliciting=%i size=%zu %u",
-                     QUICDebugNames::pn_space(static_cast<QUICPacketNumberSpace>(i)), unacked.first, unacked.second->ack_eliciting,
-                     unacked.second->sent_bytes, this->_ack_eliciting_outstanding.load());
+                     QUICDebugNames::pn_space(static_cast<QUICPacketNumberSpace>(i)), pn, unacked->ack_eliciting,
+                     unacked->sent_bytes, this->_ack_eliciting_outstanding.load());
       }
     }
   }
@@ -497,14 +500,17 @@ QUICLossDetector::_detect_and_remove_lost_packets(QUICPacketNumberSpace pn_space
   // Packets with packet numbers before this are deemed lost.
   //  QUICPacketNumber lost_pn = this->_largest_acked_packet[static_cast<int>(pn_space)] - this->_k_packet_threshold;
 
-  for (auto it = this->_sent_packets[static_cast<int>(pn_space)].begin();
-       it != this->_sent_packets[static_cast<int>(pn_space)].end();) {
-    if (it->first > this->_largest_acked_packet[static_cast<int>(pn_space)]) {
+  auto &sent_packets = this->_sent_packets[static_cast<int>(pn_space)];
+  for (QUICPacketNumber pn = sent_packets.lowest(); pn < sent_packets.end(); ++pn) {
+    if (pn > this->_largest_acked_packet[static_cast<int>(pn_space)]) {
       // the spec uses continue but we can break here because the _sent_packets is sorted by packet_number.
       break;
     }
 
-    auto &unacked = it->second;
+    const QUICSentPacketInfo *unacked = sent_packets.find(pn);
+    if (unacked == nullptr) {
+      continue;
+    }
 
     // Mark packet as lost, or set time when it should be marked.
     if (unacked->time_sent <= lost_send_time ||
@@ -512,17 +518,15 @@ QUICLossDetector::_detect_and_remove_lost_packets(QUICPacketNumberSpace pn_space
       if (unacked->time_sent <= lost_send_time) {
         QUICLDDebug("[%s] Lost: time since sent is too long (#%" PRId64 " sent=%" PRId64 ", delay=%" PRId64
                     ", fraction=%lf, lrtt=%" PRId64 ", srtt=%" PRId64 ")",
-                    QUICDebugNames::pn_space(pn_space), it->first, unacked->time_sent, lost_send_time, this->_k_time_threshold,
+                    QUICDebugNames::pn_space(pn_space), pn, unacked->time_sent, lost_send_time, this->_k_time_threshold,
                     this->_rtt_measure->latest_rtt(), this->_rtt_measure->smoothed_rtt());
       } else {
         QUICLDDebug("[%s] Lost: packet delta is too large (#%" PRId64 " largest=%" PRId64 " threshold=%" PRId32 ")",
-                    QUICDebugNames::pn_space(pn_space), it->first, this->_largest_acked_packet[static_cast<int>(pn_space)],
+                    QUICDebugNames::pn_space(pn_space), pn, this->_largest_acked_packet[static_cast<int>(pn_space)],
                     this->_k_packet_threshold);
       }
 
-      auto ret = this->_remove_from_sent_packet_list(it, pn_space);
-      auto pi  = std::move(ret.first);
-      it       = ret.second;
+      auto pi = this->_remove_from_sent_packet_list(pn, pn_space);
       if (pi->in_flight) {
         this->_context.trigger(QUICContext::CallbackEvent::PACKET_LOST, *pi);
         lost_packets.emplace(pi->packet_number, std::move(pi));
@@ -535,7 +539,6 @@ QUICLossDetector::_detect_and_remove_lost_packets(QUICPacketNumberSpace pn_space
         this->_loss_time[static_cast<int>(pn_space)] =
           std::min(this->_loss_time[static_cast<int>(pn_space)], unacked->time_sent + loss_delay);
       }
-      ++it;
     }
   }
 
@@ -614,30 +617,30 @@ std::vector<QUICSentPacketInfoUPtr>
 QUICLossDetector::_detect_and_remove_acked_packets(const QUICAckFrame &ack_frame, QUICPacketNumberSpace pn_space)
 {
   std::vector<QUICSentPacketInfoUPtr> packets;
-  std::set<QUICAckFrame::PacketNumberRange> numbers;
-  int index = static_cast<int>(pn_space);
+  auto &sent_packets = this->_sent_packets[static_cast<int>(pn_space)];
+
+  // Take the packets of each range out of the ring, from the largest down so that packets[0] is the largest acked.
+  auto remove_range = [&](QUICPacketNumber largest, QUICPacketNumber smallest) {
+    if (sent_packets.empty() || largest < sent_packets.lowest() || smallest >= sent_packets.end()) {
+      return;
+    }
+    QUICPacketNumber low = std::max(smallest, sent_packets.lowest());
+    for (QUICPacketNumber pn = std::min(largest, sent_packets.end() - 1) + 1; pn > low; --pn) {
+      if (auto pi = this->_remove_from_sent_packet_list(pn - 1, pn_space)) {
+        packets.push_back(std::move(pi));
+      }
+    }
+  };
 
   QUICPacketNumber x = ack_frame.largest_acknowledged();
-  numbers.insert({x, static_cast<uint64_t>(x) - ack_frame.ack_block_section()->first_ack_block()});
+  remove_range(x, static_cast<uint64_t>(x) - ack_frame.ack_block_section()->first_ack_block());
   x -= ack_frame.ack_block_section()->first_ack_block() + 1;
   for (auto &&block : *(ack_frame.ack_block_section())) {
     x -= block.gap() + 1;
-    numbers.insert({x, static_cast<uint64_t>(x) - block.length()});
+    remove_range(x, static_cast<uint64_t>(x) - block.length());
     x -= block.length() + 1;
   }
 
-  for (auto &&range : numbers) {
-    for (auto ite = this->_sent_packets[index].begin(); ite != this->_sent_packets[index].end();) {
-      if (range.contains(ite->first)) {
-        auto ret = this->_remove_from_sent_packet_list(ite, pn_space);
-        packets.push_back(std::move(ret.first));
-        ite = ret.second;
-      } else {
-        ++ite;
-      }
-    }
-  }
-
   return packets;
 }
 
@@ -647,44 +650,43 @@ QUICLossDetector::_add_to_sent_packet_list(QUICPacketNumber packet_number, QUICS
   SCOPED_MUTEX_LOCK(lock, this->_loss_detection_mutex, this_ethread());
 
   // Add to the list
-  int index = static_cast<int>(packet_info->pn_space);
-  this->_sent_packets[index].insert(std::pair<QUICPacketNumber, QUICSentPacketInfoUPtr>(packet_number, std::move(packet_info)));
+  int index          = static_cast<int>(packet_info->pn_space);
+  bool ack_eliciting = packet_info->ack_eliciting;
+  bool in_flight     = packet_info->in_flight;
+  if (!this->_sent_packets[index].insert(std::move(packet_info))) {
+    return;
+  }
 
   // Increment counters
-  auto ite = this->_sent_packets[index].find(packet_number);
-  if (ite != this->_sent_packets[index].end()) {
-    if (ite->second->ack_eliciting) {
-      ++this->_ack_eliciting_outstanding;
-      ink_assert(this->_ack_eliciting_outstanding.load() > 0);
-    }
-    if (ite->second->in_flight) {
-      ++this->_num_packets_in_flight[index];
-    }
+  if (ack_eliciting) {
+    ++this->_ack_eliciting_outstanding;
+    ink_assert(this->_ack_eliciting_outstanding.load() > 0);
+  }
+  if (in_flight) {
+    ++this->_num_packets_in_flight[index];
   }
 }
 
-std::pair<QUICSentPacketInfoUPtr, std::map<QUICPacketNumber, QUICSentPacketInfoUPtr>::iterator>
-QUICLossDetector::_remove_from_sent_packet_list(std::map<QUICPacketNumber, QUICSentPacketInfoUPtr>::iterator it,
-                                                QUICPacketNumberSpace pn_space)
+QUICSentPacketInfoUPtr
+QUICLossDetector::_remove_from_sent_packet_list(QUICPacketNumber packet_number, QUICPacketNumberSpace pn_space)
 {
   SCOPED_MUTEX_LOCK(lock, this->_loss_detection_mutex, this_ethread());
 
-  this->_decrement_counters(it, pn_space);
-  auto pi = std::move(it->second);
-  return {std::move(pi), this->_sent_packets[static_cast<int>(pn_space)].erase(it)};
+  auto pi = this->_sent_packets[static_cast<int>(pn_space)].remove(packet_number);
+  if (pi) {
+    this->_decrement_counters(*pi, pn_space);
+  }
+  return pi;
 }
 
 void
-QUICLossDetector::_decrement_counters(std::map<QUICPacketNumber, QUICSentPacketInfoUPtr>::iterator it,
-                                      QUICPacketNumberSpace pn_space)
+QUICLossDetector::_decrement_counters(const QUICSentPacketInfo &packet_info, QUICPacketNumberSpace pn_space)
 {
-  if (it != this->_sent_packets[static_cast<int>(pn_space)].end()) {
-    if (it->second->ack_eliciting) {
-      ink_assert(this->_ack_eliciting_outstanding.load() > 0);
-      --this->_ack_eliciting_outstanding;
-    }
-    --this->_num_packets_in_flight[static_cast<int>(pn_space)];
+  if (packet_info.ack_eliciting) {
+    ink_assert(this->_ack_eliciting_outstanding.load() > 0);
+    --this->_ack_eliciting_outstanding;
   }
+  --this->_num_packets_in_flight[static_cast<int>(pn_space)];
 }
 
 bool
@@ -25,7 +25,6 @@
 
 // TODO Using STL Map because ts/Map lacks remove method
 #include <map>
-#include <set>
 
 #include "I_EventSystem.h"
 #include "I_Action.h"
@@ -38,6 +37,7 @@
 #include "QUICConnection.h"
 #include "QUICContext.h"
 #include "QUICCongestionController.h"
+#include "QUICSentPacketRing.h"
 
 class QUICPadder;
 class QUICPinger;
@@ -87,16 +87,15 @@ private:
   ink_hrtime _time_of_last_ack_eliciting_packet[QUIC_N_PACKET_SPACES] = {0};
   QUICPacketNumber _largest_acked_packet[QUIC_N_PACKET_SPACES]        = {0};
   ink_hrtime _loss_time[QUIC_N_PACKET_SPACES]                         = {0};
-  std::map<QUICPacketNumber, QUICSentPacketInfoUPtr> _sent_packets[QUIC_N_PACKET_SPACES];
+  QUICSentPacketRing _sent_packets[QUIC_N_PACKET_SPACES];
 
   // These are not defined on the spec but expected to be count
   // These counter have to be updated when inserting / erasing packets from _sent_packets with following functions.
   std::atomic<uint32_t> _ack_eliciting_outstanding;
   std::atomic<uint32_t> _num_packets_in_flight[QUIC_N_PACKET_SPACES];
   void _add_to_sent_packet_list(QUICPacketNumber packet_number, std::unique_ptr<QUICSentPacketInfo> packet_info);
-  std::pair<QUICSentPacketInfoUPtr, std::map<QUICPacketNumber, QUICSentPacketInfoUPtr>::iterator> _remove_from_sent_packet_list(
-    std::map<QUICPacketNumber, QUICSentPacketInfoUPtr>::iterator it, QUICPacketNumberSpace pn_space);
-  void _decrement_counters(std::map<QUICPacketNumber, QUICSentPacketInfoUPtr>::iterator it, QUICPacketNumberSpace pn_space);
+  QUICSentPacketInfoUPtr _remove_from_sent_packet_list(QUICPacketNumber packet_number, QUICPacketNumberSpace pn_space);
+  void _decrement_counters(const QUICSentPacketInfo &packet_info, QUICPacketNumberSpace pn_space);
 
   /*
    * Because this alarm will be reset on every packet transmission, to reduce number of events,
@@ -31,12 +31,82 @@
 bool
 QUICPacketHeaderProtector::protect(uint8_t *unprotected_packet, size_t unprotected_packet_len, int dcil) const
 {
-  // Do nothing if the packet is VN
+  Packet packet = {unprotected_packet, unprotected_packet_len, dcil};
+  return this->protect(&packet, 1);
+}
+
+bool
+QUICPacketHeaderProtector::protect(const Packet *packets, size_t n) const
+{
+  uint8_t samples[BATCH_SIZE * SAMPLE_LEN];
+  uint8_t masks[BATCH_SIZE * SAMPLE_LEN];
+  const Packet *batch[BATCH_SIZE];
+  size_t batch_len             = 0;
+  const EVP_CIPHER *batch_aead = nullptr;
+  const uint8_t *batch_key     = nullptr;
+  bool result                  = true;
+
+  auto flush = [&]() {
+    if (batch_len == 0) {
+      return;
+    }
+    if (!this->_generate_masks(masks, samples, batch_len, batch_key, batch_aead, this->_protect_ctx)) {
+      Debug("v_quic_pne", "Failed to generate a mask");
+      result = false;
+    } else {
+      for (size_t i = 0; i < batch_len; ++i) {
+        if (!this->_protect(batch[i]->buf, batch[i]->len, masks + i * SAMPLE_LEN, batch[i]->dcil)) {
+          Debug("quic_pne", "Failed to encrypt a packet number");
+        }
+      }
+    }
+    batch_len = 0;
+  };
+
+  for (size_t i = 0; i < n; ++i) {
+    const Packet &packet = packets[i];
+
+    // Do nothing if the packet is VN
+    QUICPacketType type;
+    QUICPacketR::type(type, packet.buf, packet.len);
+    if (type == QUICPacketType::VERSION_NEGOTIATION) {
+      continue;
+    }
+
+    const EVP_CIPHER *aead;
+    const uint8_t *key;
+    if (!this->_get_key_for_protect(aead, key, packet.buf, packet.len)) {
+      result = false;
+      continue;
+    }
+
+    uint8_t sample_offset;
+    if (!this->_calc_sample_offset(&sample_offset, packet.buf, packet.len, packet.dcil)) {
+      Debug("v_quic_pne", "Failed to calculate a sample offset");
+      result = false;
+      continue;
+    }
+
+    // Keys are kept per key phase, so the same key is at the same address
+    if (batch_len == BATCH_SIZE || aead != batch_aead || key != batch_key) {
+      flush();
+    }
+    batch_aead = aead;
+    batch_key  = key;
+    memcpy(samples + batch_len * SAMPLE_LEN, packet.buf + sample_offset, SAMPLE_LEN);
+    batch[batch_len++] = &packet;
+  }
+  flush();
+
+  return result;
+}
+
+bool
+QUICPacketHeaderProtector::_get_key_for_protect(const EVP_CIPHER *&aead, const uint8_t *&key, const uint8_t *unprotected_packet,
+                                                size_t unprotected_packet_len) const
+{
   QUICPacketType type;
   QUICPacketR::type(type, unprotected_packet, unprotected_packet_len);
-  if (type == QUICPacketType::VERSION_NEGOTIATION) {
-    return true;
-  }
 
   QUICKeyPhase phase;
   if (QUICInvariants::is_long_header(unprotected_packet)) {
@@ -50,34 +120,18 @@ QUICPacketHeaderProtector::protect(uint8_t *unprotected_packet, size_t unprotect
   Debug("v_quic_pne", "Protecting a packet number of %s packet using %s", QUICDebugNames::packet_type(type),
         QUICDebugNames::key_phase(phase));
 
-  const EVP_CIPHER *aead = this->_pp_key_info.get_cipher_for_hp(phase);
+  aead = this->_pp_key_info.get_cipher_for_hp(phase);
   if (!aead) {
     Debug("quic_pne", "Failed to encrypt a packet number: keys for %s is not ready", QUICDebugNames::key_phase(phase));
     return false;
   }
 
-  const uint8_t *key = this->_pp_key_info.encryption_key_for_hp(phase);
+  key = this->_pp_key_info.encryption_key_for_hp(phase);
   if (!key) {
     Debug("quic_pne", "Failed to encrypt a packet number: keys for %s is not ready", QUICDebugNames::key_phase(phase));
     return false;
   }
 
-  uint8_t sample_offset;
-  if (!this->_calc_sample_offset(&sample_offset, unprotected_packet, unprotected_packet_len, dcil)) {
-    Debug("v_quic_pne", "Failed to calculate a sample offset");
-    return false;
-  }
-
-  uint8_t mask[EVP_MAX_BLOCK_LENGTH];
-  if (!this->_generate_mask(mask, unprotected_packet + sample_offset, key, aead)) {
-    Debug("v_quic_pne", "Failed to generate a mask");
-    return false;
-  }
-
-  if (!this->_protect(unprotected_packet, unprotected_packet_len, mask, dcil)) {
-    Debug("quic_pne", "Failed to encrypt a packet number");
-  }
-
   return true;
 }
 
@@ -121,8 +175,8 @@ QUICPacketHeaderProtector::unprotect(uint8_t *protected_packet, size_t protected
     return false;
   }
 
-  uint8_t mask[EVP_MAX_BLOCK_LENGTH];
-  if (!this->_generate_mask(mask, protected_packet + sample_offset, key, aead)) {
+  uint8_t mask[SAMPLE_LEN];
+  if (!this->_generate_masks(mask, protected_packet + sample_offset, 1, key, aead, this->_unprotect_ctx)) {
     Debug("v_quic_pne", "Failed to generate a mask");
     return false;
   }
@@ -25,23 +25,52 @@
 
 #include "QUICTypes.h"
 #include "QUICKeyGenerator.h"
+#include "QUICCipherContext.h"
 
 class QUICPacketProtectionKeyInfo;
 
 class QUICPacketHeaderProtector
 {
 public:
+  /**
+   * A packet to protect, which is in a UDP payload and has its payload protected already.
+   */
+  struct Packet {
+    uint8_t *buf;
+    size_t len;
+    int dcil;
+  };
+
   QUICPacketHeaderProtector(const QUICPacketProtectionKeyInfo &pp_key_info) : _pp_key_info(pp_key_info) {}
 
   bool unprotect(uint8_t *protected_packet, size_t protected_packet_len) const;
   bool protect(uint8_t *unprotected_packet, size_t unprotected_packet_len, int dcil) const;
 
+  /**
+   * Protects the headers of @a n packets.
+   *
+   * The masks for packets next to each other that use the same AES key are made with one ECB call over all of their samples,
+   * which lets AES-NI work on several blocks at a time. Returns false if any of the packets could not be protected.
+   */
+  bool protect(const Packet *packets, size_t n) const;
+
 private:
+  static constexpr size_t SAMPLE_LEN = 16;
+  // Packets whose masks are made together
+  static constexpr size_t BATCH_SIZE = 64;
+
   const QUICPacketProtectionKeyInfo &_pp_key_info;
 
+  // Keyed contexts for making masks, one for each direction as each has its own keys
+  mutable QUICCipherContext _protect_ctx;
+  mutable QUICCipherContext _unprotect_ctx;
+
   bool _calc_sample_offset(uint8_t *sample_offset, const uint8_t *protected_packet, size_t protected_packet_len, int dcil) const;
 
-  bool _generate_mask(uint8_t *mask, const uint8_t *sample, const uint8_t *key, const EVP_CIPHER *cipher) const;
+  bool _get_key_for_protect(const EVP_CIPHER *&cipher, const uint8_t *&key, const uint8_t *unprotected_packet,
+                            size_t unprotected_packet_len) const;
+  bool _generate_masks(uint8_t *masks, const uint8_t *samples, size_t n, const uint8_t *key, const EVP_CIPHER *cipher,
+                       QUICCipherContext &ctx) const;
 
   bool _unprotect(uint8_t *packet, size_t packet_len, const uint8_t *mask) const;
   bool _protect(uint8_t *packet, size_t packet_len, const uint8_t *mask, int dcil) const;
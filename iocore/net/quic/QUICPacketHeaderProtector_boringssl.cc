@@ -26,33 +26,31 @@
 #include <openssl/chacha.h>
 
 bool
-QUICPacketHeaderProtector::_generate_mask(uint8_t *mask, const uint8_t *sample, const uint8_t *key, const EVP_CIPHER *cipher) const
+QUICPacketHeaderProtector::_generate_masks(uint8_t *masks, const uint8_t *samples, size_t n, const uint8_t *key,
+                                           const EVP_CIPHER *cipher, QUICCipherContext &cipher_ctx) const
 {
   static constexpr unsigned char FIVE_ZEROS[] = {0x00, 0x00, 0x00, 0x00, 0x00};
 
   if (cipher == nullptr) {
-    uint32_t counter = htole32(*reinterpret_cast<const uint32_t *>(&sample[0]));
-    CRYPTO_chacha_20(mask, FIVE_ZEROS, sizeof(FIVE_ZEROS), key, &sample[4], counter);
-  } else {
-    int len             = 0;
-    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-    if (!ctx) {
-      return false;
+    // The sample is the counter and nonce, so each mask is a separate call
+    for (size_t i = 0; i < n; ++i) {
+      const uint8_t *sample = samples + i * SAMPLE_LEN;
+      uint32_t counter      = htole32(*reinterpret_cast<const uint32_t *>(&sample[0]));
+      CRYPTO_chacha_20(masks + i * SAMPLE_LEN, FIVE_ZEROS, sizeof(FIVE_ZEROS), key, &sample[4], counter);
     }
-    if (!EVP_EncryptInit_ex(ctx, cipher, nullptr, key, sample)) {
-      EVP_CIPHER_CTX_free(ctx);
-      return false;
-    }
-    if (!EVP_EncryptUpdate(ctx, mask, &len, sample, 16)) {
-      EVP_CIPHER_CTX_free(ctx);
-      return false;
-    }
-    if (!EVP_EncryptFinal_ex(ctx, mask + len, &len)) {
-      EVP_CIPHER_CTX_free(ctx);
-      return false;
-    }
-    EVP_CIPHER_CTX_free(ctx);
+    return true;
+  }
+
+  EVP_CIPHER_CTX *ctx = cipher_ctx.get(cipher, key, true);
+  if (!ctx) {
+    return false;
+  }
+
+  // AES-ECB, a mask is the encrypted sample, and the samples are next to each other
+  int len = 0;
+  if (!EVP_EncryptUpdate(ctx, masks, &len, samples, n * SAMPLE_LEN)) {
+    return false;
   }
 
-  return true;
+  return static_cast<size_t>(len) == n * SAMPLE_LEN;
 }
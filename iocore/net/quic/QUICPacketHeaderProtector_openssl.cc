@@ -24,37 +24,32 @@
 #include "QUICPacketHeaderProtector.h"
 
 bool
-QUICPacketHeaderProtector::_generate_mask(uint8_t *mask, const uint8_t *sample, const uint8_t *key, const EVP_CIPHER *cipher) const
+QUICPacketHeaderProtector::_generate_masks(uint8_t *masks, const uint8_t *samples, size_t n, const uint8_t *key,
+                                           const EVP_CIPHER *cipher, QUICCipherContext &cipher_ctx) const
 {
   static constexpr unsigned char FIVE_ZEROS[] = {0x00, 0x00, 0x00, 0x00, 0x00};
-  EVP_CIPHER_CTX *ctx                         = EVP_CIPHER_CTX_new();
 
+  EVP_CIPHER_CTX *ctx = cipher_ctx.get(cipher, key, true);
   if (!ctx) {
     return false;
   }
-  if (!EVP_EncryptInit_ex(ctx, cipher, nullptr, key, sample)) {
-    EVP_CIPHER_CTX_free(ctx);
-    return false;
-  }
 
   int len = 0;
   if (cipher == EVP_chacha20()) {
-    if (!EVP_EncryptUpdate(ctx, mask, &len, FIVE_ZEROS, sizeof(FIVE_ZEROS))) {
-      EVP_CIPHER_CTX_free(ctx);
-      return false;
-    }
-  } else {
-    if (!EVP_EncryptUpdate(ctx, mask, &len, sample, 16)) {
-      EVP_CIPHER_CTX_free(ctx);
-      return false;
+    // The sample is the counter and nonce, so each mask is a separate call
+    for (size_t i = 0; i < n; ++i) {
+      if (!EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, samples + i * SAMPLE_LEN) ||
+          !EVP_EncryptUpdate(ctx, masks + i * SAMPLE_LEN, &len, FIVE_ZEROS, sizeof(FIVE_ZEROS))) {
+        return false;
+      }
     }
+    return true;
   }
-  if (!EVP_EncryptFinal_ex(ctx, mask + len, &len)) {
-    EVP_CIPHER_CTX_free(ctx);
+
+  // AES-ECB, a mask is the encrypted sample, and the samples are next to each other
+  if (!EVP_EncryptUpdate(ctx, masks, &len, samples, n * SAMPLE_LEN)) {
     return false;
   }
 
-  EVP_CIPHER_CTX_free(ctx);
-
-  return true;
+  return static_cast<size_t>(len) == n * SAMPLE_LEN;
 }
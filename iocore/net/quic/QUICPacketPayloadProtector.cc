@@ -126,111 +126,3 @@ QUICPacketPayloadProtector::_gen_nonce(uint8_t *nonce, size_t &nonce_len, uint64
     nonce[iv_len - 8 + i] ^= p[i];
   }
 }
-
-bool
-QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t max_cipher_len, const Ptr<IOBufferBlock> plain,
-                                     uint64_t pkt_num, const uint8_t *ad, size_t ad_len, const uint8_t *key, const uint8_t *iv,
-                                     size_t iv_len, const EVP_CIPHER *aead, size_t tag_len) const
-{
-  EVP_CIPHER_CTX *aead_ctx;
-  int len;
-  uint8_t nonce[EVP_MAX_IV_LENGTH] = {0};
-  size_t nonce_len                 = 0;
-
-  this->_gen_nonce(nonce, nonce_len, pkt_num, iv, iv_len);
-
-  if (!(aead_ctx = EVP_CIPHER_CTX_new())) {
-    return false;
-  }
-  if (!EVP_EncryptInit_ex(aead_ctx, aead, nullptr, nullptr, nullptr)) {
-    return false;
-  }
-  if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_IVLEN, nonce_len, nullptr)) {
-    return false;
-  }
-  if (!EVP_EncryptInit_ex(aead_ctx, nullptr, nullptr, key, nonce)) {
-    return false;
-  }
-  if (!EVP_EncryptUpdate(aead_ctx, nullptr, &len, ad, ad_len)) {
-    return false;
-  }
-
-  cipher_len = 0;
-  for (Ptr<IOBufferBlock> b = plain; b; b = b->next) {
-    if (!EVP_EncryptUpdate(aead_ctx, cipher + cipher_len, &len, reinterpret_cast<unsigned char *>(b->start()), b->size())) {
-      return false;
-    }
-    cipher_len += len;
-  }
-
-  if (!EVP_EncryptFinal_ex(aead_ctx, cipher + cipher_len, &len)) {
-    return false;
-  }
-  cipher_len += len;
-
-  if (max_cipher_len < cipher_len + tag_len) {
-    return false;
-  }
-  if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_GET_TAG, tag_len, cipher + cipher_len)) {
-    return false;
-  }
-  cipher_len += tag_len;
-
-  EVP_CIPHER_CTX_free(aead_ctx);
-
-  return true;
-}
-
-bool
-QUICPacketPayloadProtector::_unprotect(uint8_t *plain, size_t &plain_len, size_t max_plain_len, const uint8_t *cipher,
-                                       size_t cipher_len, uint64_t pkt_num, const uint8_t *ad, size_t ad_len, const uint8_t *key,
-                                       const uint8_t *iv, size_t iv_len, const EVP_CIPHER *aead, size_t tag_len) const
-{
-  EVP_CIPHER_CTX *aead_ctx;
-  int len;
-  uint8_t nonce[EVP_MAX_IV_LENGTH] = {0};
-  size_t nonce_len                 = 0;
-
-  this->_gen_nonce(nonce, nonce_len, pkt_num, iv, iv_len);
-
-  if (!(aead_ctx = EVP_CIPHER_CTX_new())) {
-    return false;
-  }
-  if (!EVP_DecryptInit_ex(aead_ctx, aead, nullptr, nullptr, nullptr)) {
-    return false;
-  }
-  if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_IVLEN, nonce_len, nullptr)) {
-    return false;
-  }
-  if (!EVP_DecryptInit_ex(aead_ctx, nullptr, nullptr, key, nonce)) {
-    return false;
-  }
-  if (!EVP_DecryptUpdate(aead_ctx, nullptr, &len, ad, ad_len)) {
-    return false;
-  }
-
-  if (cipher_len < tag_len) {
-    return false;
-  }
-  cipher_len -= tag_len;
-  if (!EVP_DecryptUpdate(aead_ctx, plain, &len, cipher, cipher_len)) {
-    return false;
-  }
-  plain_len = len;
-
-  if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_TAG, tag_len, const_cast<uint8_t *>(cipher + cipher_len))) {
-    return false;
-  }
-
-  int ret = EVP_DecryptFinal_ex(aead_ctx, plain + len, &len);
-
-  EVP_CIPHER_CTX_free(aead_ctx);
-
-  if (ret > 0) {
-    plain_len += len;
-    return true;
-  } else {
-    Debug(tag, "Failed to decrypt -- the first 4 bytes decrypted are %0x %0x %0x %0x", plain[0], plain[1], plain[2], plain[3]);
-    return false;
-  }
-}
@@ -26,6 +26,7 @@
 #include "I_IOBuffer.h"
 #include "QUICTypes.h"
 #include "QUICKeyGenerator.h"
+#include "QUICCipherContext.h"
 
 class QUICPacketProtectionKeyInfo;
 
@@ -42,6 +43,10 @@ public:
 private:
   const QUICPacketProtectionKeyInfo &_pp_key_info;
 
+  // Keyed contexts, so that protecting a packet does not set up the key again
+  mutable QUICCipherContext _encryption_ctx;
+  mutable QUICCipherContext _decryption_ctx;
+
   bool _unprotect(uint8_t *plain, size_t &plain_len, size_t max_plain_len, const uint8_t *protected_payload,
                   size_t protected_payload_len, uint64_t pkt_num, const uint8_t *ad, size_t ad_len, const uint8_t *key,
                   const uint8_t *iv, size_t iv_len, const EVP_CIPHER *cipher, size_t tag_len) const;
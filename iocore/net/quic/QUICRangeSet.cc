@@ -0,0 +1,131 @@
+/** @file
+ *
+ *  Set of integers kept as ranges
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "QUICRangeSet.h"
+
+#include <algorithm>
+
+bool
+QUICRangeSet::insert(uint64_t x)
+{
+  if (this->_ranges.empty() || x > this->_ranges.back().last + 1) {
+    this->_ranges.push_back({x, x});
+    return true;
+  }
+  if (x == this->_ranges.back().last + 1) {
+    this->_ranges.back().last = x;
+    return true;
+  }
+
+  // Out of order, the first range that starts after x and the one before it.
+  auto next = std::upper_bound(this->_ranges.begin(), this->_ranges.end(), x,
+                               [](uint64_t v, const Range &r) -> bool { return v < r.first; });
+  auto prev = next == this->_ranges.begin() ? this->_ranges.end() : next - 1;
+  if (prev != this->_ranges.end() && x <= prev->last) {
+    return false;
+  }
+
+  bool join_prev = prev != this->_ranges.end() && prev->last + 1 == x;
+  bool join_next = next != this->_ranges.end() && next->first == x + 1;
+  if (join_prev && join_next) {
+    prev->last = next->last;
+    this->_ranges.erase(next);
+  } else if (join_prev) {
+    prev->last = x;
+  } else if (join_next) {
+    next->first = x;
+  } else {
+    this->_ranges.insert(next, {x, x});
+  }
+  return true;
+}
+
+void
+QUICRangeSet::erase_up_to(uint64_t x)
+{
+  auto it = std::find_if(this->_ranges.begin(), this->_ranges.end(), [x](const Range &r) -> bool { return r.last > x; });
+  it      = this->_ranges.erase(this->_ranges.begin(), it);
+  if (it != this->_ranges.end() && it->first <= x) {
+    it->first = x + 1;
+  }
+}
+
+void
+QUICRangeSet::clear()
+{
+  this->_ranges.clear();
+}
+
+bool
+QUICRangeSet::empty() const
+{
+  return this->_ranges.empty();
+}
+
+bool
+QUICRangeSet::contains(uint64_t x) const
+{
+  auto next = std::upper_bound(this->_ranges.begin(), this->_ranges.end(), x,
+                               [](uint64_t v, const Range &r) -> bool { return v < r.first; });
+  return next != this->_ranges.begin() && x <= (next - 1)->last;
+}
+
+uint64_t
+QUICRangeSet::count() const
+{
+  uint64_t n = 0;
+  for (const auto &r : this->_ranges) {
+    n += r.last - r.first + 1;
+  }
+  return n;
+}
+
+size_t
+QUICRangeSet::size() const
+{
+  return this->_ranges.size();
+}
+
+QUICRangeSet::const_iterator
+QUICRangeSet::begin() const
+{
+  return this->_ranges.begin();
+}
+
+QUICRangeSet::const_iterator
+QUICRangeSet::end() const
+{
+  return this->_ranges.end();
+}
+
+QUICRangeSet::const_reverse_iterator
+QUICRangeSet::rbegin() const
+{
+  return this->_ranges.rbegin();
+}
+
+QUICRangeSet::const_reverse_iterator
+QUICRangeSet::rend() const
+{
+  return this->_ranges.rend();
+}
@@ -0,0 +1,80 @@
+/** @file
+ *
+ *  Set of integers kept as ranges
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Set of integers, such as packet numbers, kept as disjoint, non-adjacent ranges in ascending order.
+ *
+ * Numbers mostly come in order, so adding one usually extends the last range in place, and nothing is allocated once the
+ * vector has grown to the number of gaps in the set.
+ */
+class QUICRangeSet
+{
+public:
+  struct Range {
+    uint64_t first; ///< Smallest number in the range.
+    uint64_t last;  ///< Largest number in the range.
+  };
+
+  using const_iterator         = std::vector<Range>::const_iterator;
+  using const_reverse_iterator = std::vector<Range>::const_reverse_iterator;
+
+  /**
+   * Add @a x.
+   *
+   * @return @c false if @a x was in the set already.
+   */
+  bool insert(uint64_t x);
+
+  /**
+   * Remove all the numbers up to and including @a x.
+   */
+  void erase_up_to(uint64_t x);
+
+  void clear();
+  bool empty() const;
+  bool contains(uint64_t x) const;
+
+  /**
+   * @return The number of integers in the set.
+   */
+  uint64_t count() const;
+
+  /**
+   * @return The number of ranges.
+   */
+  size_t size() const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+  const_reverse_iterator rbegin() const;
+  const_reverse_iterator rend() const;
+
+private:
+  std::vector<Range> _ranges;
+};
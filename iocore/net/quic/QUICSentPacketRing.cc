@@ -0,0 +1,155 @@
+/** @file
+ *
+ *  Sent packets indexed by packet number
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "QUICSentPacketRing.h"
+
+bool
+QUICSentPacketRing::insert(QUICSentPacketInfoUPtr info)
+{
+  QUICPacketNumber pn = info->packet_number;
+
+  if (this->_count == 0) {
+    this->_head = 0;
+    this->_base = pn;
+    this->_span = 0;
+  } else if (pn < this->_base) {
+    // Packet numbers only go up, but keep the ring consistent if one does not.
+    size_t shift = this->_base - pn;
+    this->_grow(this->_span + shift);
+    this->_head = (this->_head - shift) & (this->_slots.size() - 1);
+    this->_base = pn;
+    this->_span += shift;
+  }
+
+  if (pn - this->_base >= this->_span) {
+    this->_grow(pn - this->_base + 1);
+    this->_span = pn - this->_base + 1;
+  }
+
+  auto &slot = this->_slot(pn);
+  if (slot) {
+    return false;
+  }
+  slot = std::move(info);
+  ++this->_count;
+  return true;
+}
+
+QUICSentPacketInfo *
+QUICSentPacketRing::find(QUICPacketNumber pn) const
+{
+  if (pn < this->_base || pn - this->_base >= this->_span) {
+    return nullptr;
+  }
+  return this->_slots[(this->_head + (pn - this->_base)) & (this->_slots.size() - 1)].get();
+}
+
+QUICSentPacketInfoUPtr
+QUICSentPacketRing::remove(QUICPacketNumber pn)
+{
+  if (pn < this->_base || pn - this->_base >= this->_span) {
+    return nullptr;
+  }
+
+  QUICSentPacketInfoUPtr info = std::move(this->_slot(pn));
+  if (!info) {
+    return info;
+  }
+
+  if (--this->_count == 0) {
+    this->_span = 0;
+  } else {
+    // Keep both ends of the window on a packet.
+    while (!this->_slots[this->_head]) {
+      this->_head = (this->_head + 1) & (this->_slots.size() - 1);
+      ++this->_base;
+      --this->_span;
+    }
+    while (!this->_slot(this->_base + this->_span - 1)) {
+      --this->_span;
+    }
+  }
+  return info;
+}
+
+void
+QUICSentPacketRing::clear()
+{
+  for (QUICPacketNumber pn = this->_base; pn < this->_base + this->_span; ++pn) {
+    this->_slot(pn).reset();
+  }
+  this->_head  = 0;
+  this->_span  = 0;
+  this->_count = 0;
+}
+
+bool
+QUICSentPacketRing::empty() const
+{
+  return this->_count == 0;
+}
+
+size_t
+QUICSentPacketRing::size() const
+{
+  return this->_count;
+}
+
+QUICPacketNumber
+QUICSentPacketRing::lowest() const
+{
+  return this->_base;
+}
+
+QUICPacketNumber
+QUICSentPacketRing::end() const
+{
+  return this->_base + this->_span;
+}
+
+QUICSentPacketInfoUPtr &
+QUICSentPacketRing::_slot(QUICPacketNumber pn)
+{
+  return this->_slots[(this->_head + (pn - this->_base)) & (this->_slots.size() - 1)];
+}
+
+void
+QUICSentPacketRing::_grow(size_t span)
+{
+  if (span <= this->_slots.size()) {
+    return;
+  }
+
+  size_t capacity = this->_slots.empty() ? INITIAL_CAPACITY : this->_slots.size();
+  while (capacity < span) {
+    capacity *= 2;
+  }
+
+  // Lay the window out from the start of the new ring.
+  std::vector<QUICSentPacketInfoUPtr> slots(capacity);
+  for (size_t i = 0; i < this->_span; ++i) {
+    slots[i] = std::move(this->_slots[(this->_head + i) & (this->_slots.size() - 1)]);
+  }
+  this->_slots.swap(slots);
+  this->_head = 0;
+}
@@ -0,0 +1,80 @@
+/** @file
+ *
+ *  Sent packets indexed by packet number
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "QUICTypes.h"
+
+/**
+ * Sent packets of a packet number space that are waiting for an ACK, indexed by packet number.
+ *
+ * Packet numbers are sent in order and acked roughly in order, so the outstanding packets are a window of packet numbers with a
+ * few holes. The window is kept in a ring of slots, one for each packet number, which makes finding and removing a packet an
+ * index operation. The ring only grows, so it stops allocating once it is as large as the congestion window needs.
+ */
+class QUICSentPacketRing
+{
+public:
+  /**
+   * Add @a info under its packet number.
+   *
+   * @return @c false if there is a packet with the number already, @a info is dropped.
+   */
+  bool insert(QUICSentPacketInfoUPtr info);
+
+  /**
+   * @return The packet numbered @a pn, or @c nullptr.
+   */
+  QUICSentPacketInfo *find(QUICPacketNumber pn) const;
+
+  /**
+   * Take out the packet numbered @a pn.
+   *
+   * @return The packet, or @c nullptr if there is none.
+   */
+  QUICSentPacketInfoUPtr remove(QUICPacketNumber pn);
+
+  void clear();
+  bool empty() const;
+  size_t size() const;
+
+  /**
+   * The packet numbers in the ring are in [lowest(), end()); there can be holes.
+   */
+  QUICPacketNumber lowest() const;
+  QUICPacketNumber end() const;
+
+private:
+  static constexpr size_t INITIAL_CAPACITY = 32;
+
+  QUICSentPacketInfoUPtr &_slot(QUICPacketNumber pn);
+  void _grow(size_t span);
+
+  std::vector<QUICSentPacketInfoUPtr> _slots; // size is zero or a power of 2
+  size_t _head           = 0;                 // slot of _base
+  QUICPacketNumber _base = 0;                 // lowest packet number in the ring
+  size_t _span           = 0;                 // packet numbers from _base up to the highest one in the ring
+  size_t _count          = 0;
+};
@@ -671,6 +671,15 @@ QUICConnectionId::randomize()
   this->_len = QUICConnectionId::SCID_LEN;
 }
 
+void
+QUICConnectionId::randomize(uint8_t worker)
+{
+  this->randomize();
+  if (this->_len > 0) {
+    this->_id[0] = worker;
+  }
+}
+
 uint64_t
 QUICConnectionId::_hashcode() const
 {
@@ -267,6 +267,11 @@ public:
   uint8_t length() const;
   bool is_zero() const;
   void randomize();
+  /**
+   * Randomize, but with @a worker in the first byte so that a packet can be steered to the worker by its Destination
+   * Connection ID.
+   */
+  void randomize(uint8_t worker);
 
 private:
   uint64_t _hashcode() const;
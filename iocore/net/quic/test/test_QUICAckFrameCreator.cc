@@ -284,6 +284,29 @@ TEST_CASE("QUICAckFrameManager_loss_recover", "[quic]")
   ack_frame->~QUICFrame();
 }
 
+TEST_CASE("QUICAckFrameManager large gap", "[quic]")
+{
+  QUICAckFrameManager ack_manager;
+  QUICEncryptionLevel level = QUICEncryptionLevel::INITIAL;
+  uint8_t frame_buf[QUICFrame::MAX_INSTANCE_SIZE];
+
+  // Gaps and ranges wider than a byte
+  ack_manager.update(level, 1, 1, false);
+  ack_manager.update(level, 2, 1, false);
+  for (QUICPacketNumber pn = 1000; pn < 1300; ++pn) {
+    ack_manager.update(level, pn, 1, false);
+  }
+  QUICFrame *ack_frame = ack_manager.generate_frame(frame_buf, level, UINT16_MAX, UINT16_MAX, 0, 0);
+  QUICAckFrame *frame  = static_cast<QUICAckFrame *>(ack_frame);
+  CHECK(frame != nullptr);
+  CHECK(frame->ack_block_count() == 1);
+  CHECK(frame->largest_acknowledged() == 1299);
+  CHECK(frame->ack_block_section()->first_ack_block() == 299);
+  CHECK(frame->ack_block_section()->begin()->gap() == 996);
+  CHECK(frame->ack_block_section()->begin()->length() == 1);
+  ack_frame->~QUICFrame();
+}
+
 TEST_CASE("QUICAckFrameManager_QUICAckFrameCreator", "[quic]")
 {
   QUICAckFrameManager ack_manager;
@@ -237,6 +237,26 @@ TEST_CASE("QUICPacketHeaderProtector")
     REQUIRE(client_ph_protector.unprotect(tmp, sizeof(tmp)));
     CHECK(memcmp(original, tmp, sizeof(original)) == 0);
 
+    // ## Batch, the same as one at a time
+    uint8_t single[48];
+    memcpy(single, original, sizeof(single));
+    REQUIRE(client_ph_protector.protect(single, sizeof(single), 18));
+
+    uint8_t batch[3][48];
+    QUICPacketHeaderProtector::Packet packets[3];
+    for (int i = 0; i < 3; ++i) {
+      memcpy(batch[i], original, sizeof(batch[i]));
+      packets[i] = {batch[i], sizeof(batch[i]), 18};
+    }
+    // A different sample for the middle one
+    batch[1][30] ^= 0xff;
+    REQUIRE(client_ph_protector.protect(packets, 3));
+    CHECK(memcmp(batch[0], single, sizeof(single)) == 0);
+    CHECK(memcmp(batch[2], single, sizeof(single)) == 0);
+    REQUIRE(server_ph_protector.unprotect(batch[1], sizeof(batch[1])));
+    batch[1][30] ^= 0xff;
+    CHECK(memcmp(original, batch[1], sizeof(original)) == 0);
+
     delete client;
     delete server;
   }
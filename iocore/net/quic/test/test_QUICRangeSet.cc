@@ -0,0 +1,109 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "QUICRangeSet.h"
+
+#include <iterator>
+#include <random>
+#include <set>
+
+TEST_CASE("QUICRangeSet", "[quic]")
+{
+  SECTION("in order")
+  {
+    QUICRangeSet set;
+    CHECK(set.empty());
+    for (uint64_t i = 1; i <= 5; ++i) {
+      CHECK(set.insert(i));
+    }
+    CHECK(set.size() == 1);
+    CHECK(set.count() == 5);
+    CHECK(set.begin()->first == 1);
+    CHECK(set.begin()->last == 5);
+    CHECK_FALSE(set.insert(3));
+    CHECK(set.count() == 5);
+  }
+
+  SECTION("gaps and merge")
+  {
+    QUICRangeSet set;
+    CHECK(set.insert(1));
+    CHECK(set.insert(5));
+    CHECK(set.insert(3));
+    CHECK(set.size() == 3);
+    CHECK(set.contains(3));
+    CHECK_FALSE(set.contains(2));
+
+    CHECK(set.insert(2));
+    CHECK(set.size() == 2);
+    CHECK(set.insert(4));
+    CHECK(set.size() == 1);
+    CHECK(set.count() == 5);
+    CHECK(set.rbegin()->last == 5);
+  }
+
+  SECTION("erase")
+  {
+    QUICRangeSet set;
+    for (uint64_t i : {1, 2, 3, 7, 8, 10}) {
+      set.insert(i);
+    }
+    set.erase_up_to(2);
+    CHECK(set.count() == 4);
+    CHECK(set.begin()->first == 3);
+    set.erase_up_to(9);
+    CHECK(set.size() == 1);
+    CHECK(set.begin()->first == 10);
+    set.erase_up_to(10);
+    CHECK(set.empty());
+  }
+
+  SECTION("same as std::set")
+  {
+    std::mt19937_64 rng(42);
+    QUICRangeSet set;
+    std::set<uint64_t> expected;
+
+    for (int i = 0; i < 10000; ++i) {
+      uint64_t x = rng() % 1000;
+      CHECK(set.insert(x) == expected.insert(x).second);
+      if (i % 1000 == 999) {
+        uint64_t y = rng() % 1000;
+        set.erase_up_to(y);
+        expected.erase(expected.begin(), expected.upper_bound(y));
+      }
+    }
+
+    CHECK(set.count() == expected.size());
+    for (uint64_t x = 0; x < 1000; ++x) {
+      CHECK(set.contains(x) == (expected.count(x) == 1));
+    }
+    for (auto it = set.begin(); it != set.end(); ++it) {
+      if (it != set.begin()) {
+        CHECK(it->first > std::prev(it)->last + 1);
+      }
+    }
+  }
+}
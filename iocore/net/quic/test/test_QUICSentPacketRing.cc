@@ -0,0 +1,93 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "QUICSentPacketRing.h"
+
+static QUICSentPacketInfoUPtr
+sent_packet(QUICPacketNumber pn)
+{
+  QUICSentPacketInfoUPtr info = std::make_unique<QUICSentPacketInfo>();
+  info->packet_number         = pn;
+  return info;
+}
+
+TEST_CASE("QUICSentPacketRing", "[quic]")
+{
+  SECTION("insert and remove")
+  {
+    QUICSentPacketRing ring;
+    CHECK(ring.empty());
+    CHECK(ring.remove(0) == nullptr);
+
+    for (QUICPacketNumber pn = 10; pn < 20; ++pn) {
+      CHECK(ring.insert(sent_packet(pn)));
+    }
+    CHECK_FALSE(ring.insert(sent_packet(15)));
+    CHECK(ring.size() == 10);
+    CHECK(ring.lowest() == 10);
+    CHECK(ring.end() == 20);
+    CHECK(ring.find(15)->packet_number == 15);
+    CHECK(ring.find(20) == nullptr);
+
+    // A hole in the middle keeps the window
+    CHECK(ring.remove(15)->packet_number == 15);
+    CHECK(ring.remove(15) == nullptr);
+    CHECK(ring.find(15) == nullptr);
+    CHECK(ring.lowest() == 10);
+    CHECK(ring.end() == 20);
+
+    // Removing the ends moves them to the next packet
+    for (QUICPacketNumber pn = 10; pn < 15; ++pn) {
+      CHECK(ring.remove(pn) != nullptr);
+    }
+    CHECK(ring.lowest() == 16);
+    CHECK(ring.remove(19) != nullptr);
+    CHECK(ring.end() == 19);
+    CHECK(ring.size() == 3);
+
+    ring.clear();
+    CHECK(ring.empty());
+    CHECK(ring.find(16) == nullptr);
+  }
+
+  SECTION("grow")
+  {
+    QUICSentPacketRing ring;
+
+    // Keep a sliding window with a few old packets left behind, so that the ring wraps and grows
+    for (QUICPacketNumber pn = 0; pn < 1000; ++pn) {
+      CHECK(ring.insert(sent_packet(pn)));
+      if (pn >= 40 && (pn - 40) % 7 != 0) {
+        CHECK(ring.remove(pn - 40) != nullptr);
+      }
+    }
+    CHECK(ring.lowest() == 0);
+    CHECK(ring.end() == 1000);
+    for (QUICPacketNumber pn = 0; pn < 1000; ++pn) {
+      bool expected = pn >= 960 || pn % 7 == 0;
+      CHECK((ring.find(pn) != nullptr) == expected);
+    }
+  }
+}
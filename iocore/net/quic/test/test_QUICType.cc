@@ -98,6 +98,31 @@ TEST_CASE("QUICType", "[quic]")
     CHECK(path_b == path_a);
   }
 
+  SECTION("QUICConnectionId worker")
+  {
+    // The reuseport socket filter reads the first byte of the DCID at these offsets to pick the socket.
+    for (int worker : {0, 1, 2, 127, 255}) {
+      QUICConnectionId cid;
+      cid.randomize(worker);
+      REQUIRE(cid.length() > 0);
+
+      uint8_t lh[64] = {0xc3, 0x00, 0x00, 0x00, 0x01, cid.length()};
+      size_t len     = 0;
+      QUICTypeUtil::write_QUICConnectionId(cid, lh + QUICInvariants::LH_DCID_OFFSET, &len);
+      QUICConnectionId lh_dcid;
+      CHECK(QUICInvariants::dcid(lh_dcid, lh, sizeof(lh)));
+      CHECK(lh_dcid == cid);
+      CHECK(lh[QUICInvariants::LH_DCID_OFFSET] == worker);
+
+      uint8_t sh[64] = {0x43};
+      QUICTypeUtil::write_QUICConnectionId(cid, sh + QUICInvariants::SH_DCID_OFFSET, &len);
+      QUICConnectionId sh_dcid;
+      CHECK(QUICInvariants::dcid(sh_dcid, sh, sizeof(sh)));
+      CHECK(sh_dcid == cid);
+      CHECK(sh[QUICInvariants::SH_DCID_OFFSET] == worker);
+    }
+  }
+
   SECTION("QUICRetryToken")
   {
     IpEndpoint ep;
@@ -124,6 +124,8 @@ public:
   virtual void append_value(std::string &s, const Resources &res) = 0;
 
 protected:
+  friend class Program;
+
   // Evaluate the condition
   virtual bool eval(const Resources &res) = 0;
 
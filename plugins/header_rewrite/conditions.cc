@@ -207,6 +207,11 @@ ConditionHeader::initialize(Parser &p)
   match->set(p.get_arg());
   _matcher = match;
 
+  _header_name = getWellKnownHeader(_qualifier);
+  if (nullptr == _header_name) {
+    _header_name = _qualifier.c_str();
+  }
+
   require_resources(RSRC_CLIENT_REQUEST_HEADERS);
   require_resources(RSRC_CLIENT_RESPONSE_HEADERS);
   require_resources(RSRC_SERVER_REQUEST_HEADERS);
@@ -231,7 +236,7 @@ ConditionHeader::append_value(std::string &s, const Resources &res)
   if (bufp && hdr_loc) {
     TSMLoc field_loc;
 
-    field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, _qualifier.c_str(), _qualifier.size());
+    field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, _header_name, _qualifier.size());
     TSDebug(PLUGIN_NAME, "Getting Header: %s, field_loc: %p", _qualifier.c_str(), field_loc);
 
     while (field_loc) {
@@ -264,6 +264,7 @@ protected:
 
 private:
   bool _client;
+  const char *_header_name = nullptr; // WKS of the header if it has one, or the qualifier itself
 };
 
 // url
@@ -27,6 +27,7 @@
 
 #include "parser.h"
 #include "ruleset.h"
+#include "program.h"
 #include "resources.h"
 #include "conditions.h"
 #include "conditions_geo.h"
@@ -60,6 +61,7 @@ public:
   {
     TSDebug(PLUGIN_NAME_DBG, "RulesConfig CTOR");
     memset(_rules, 0, sizeof(_rules));
+    memset(_programs, 0, sizeof(_programs));
     memset(_resids, 0, sizeof(_resids));
 
     _cont = TSContCreate(cont_rewrite_headers, nullptr);
@@ -70,6 +72,7 @@ public:
   {
     TSDebug(PLUGIN_NAME_DBG, "RulesConfig DTOR");
     for (int i = TS_HTTP_READ_REQUEST_HDR_HOOK; i <= TS_HTTP_LAST_HOOK; ++i) { // lgtm[cpp/constant-comparison]
+      delete _programs[i];
       delete _rules[i];
     }
     TSContDestroy(_cont);
@@ -92,6 +95,12 @@ public:
     return _rules[hook];
   }
 
+  const Program *
+  program(int hook) const
+  {
+    return _programs[hook];
+  }
+
   bool parse_config(const std::string &fname, TSHttpHookID default_hook);
 
 private:
@@ -99,6 +108,7 @@ private:
 
   TSCont _cont;
   RuleSet *_rules[TS_HTTP_LAST_HOOK + 1];
+  Program *_programs[TS_HTTP_LAST_HOOK + 1];
   ResourceIDs _resids[TS_HTTP_LAST_HOOK + 1];
 };
 
@@ -237,6 +247,15 @@ RulesConfig::parse_config(const std::string &fname, TSHttpHookID default_hook)
     }
   }
 
+  // Compile the rule sets of each hook, including the remap pseudo hook. Multiple config files
+  // append to the same rule sets, so anything compiled from a previous file is replaced.
+  for (int i = TS_HTTP_READ_REQUEST_HDR_HOOK; i <= TS_HTTP_LAST_HOOK; ++i) { // lgtm[cpp/constant-comparison]
+    if (_rules[i]) {
+      delete _programs[i];
+      _programs[i] = new Program(_rules[i]);
+    }
+  }
+
   return true;
 }
 
@@ -278,24 +297,14 @@ cont_rewrite_headers(TSCont contp, TSEvent event, void *edata)
     break;
   }
 
-  if (hook != TS_HTTP_LAST_HOOK) {
-    const RuleSet *rule = conf->rule(hook);
+  if (hook != TS_HTTP_LAST_HOOK && conf->program(hook)) {
     Resources res(txnp, contp);
 
     // Get the resources necessary to process this event
     res.gather(conf->resid(hook), hook);
 
-    // Evaluation of all rules. This code is sort of duplicate in DoRemap as well.
-    while (rule) {
-      if (rule->eval(res)) {
-        OperModifiers rt = rule->exec(res);
-
-        if (rule->last() || (rt & OPER_LAST)) {
-          break; // Conditional break, force a break with [L]
-        }
-      }
-      rule = rule->next;
-    }
+    // Evaluation of all rules.
+    conf->program(hook)->run(res);
   }
 
   TSHttpTxnReenable(txnp, TS_EVENT_HTTP_CONTINUE);
@@ -502,23 +511,17 @@ TSRemapDoRemap(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri)
   // Now handle the remap specific rules for the "remap hook" (which is not a real hook).
   // This is sufficiently different than the normal cont_rewrite_headers() callback, and
   // we can't (shouldn't) schedule this as a TXN hook.
-  RuleSet *rule = conf->rule(TS_REMAP_PSEUDO_HOOK);
-  Resources res(rh, rri);
+  const Program *program = conf->program(TS_REMAP_PSEUDO_HOOK);
 
-  res.gather(RSRC_CLIENT_REQUEST_HEADERS, TS_REMAP_PSEUDO_HOOK);
-  while (rule) {
-    if (rule->eval(res)) {
-      OperModifiers rt = rule->exec(res);
+  if (program) {
+    Resources res(rh, rri);
 
-      if (res.changed_url == true) {
-        rval = TSREMAP_DID_REMAP;
-      }
+    res.gather(RSRC_CLIENT_REQUEST_HEADERS, TS_REMAP_PSEUDO_HOOK);
+    program->run(res);
 
-      if (rule->last() || (rt & OPER_LAST)) {
-        break; // Conditional break, force a break with [L]
-      }
+    if (res.changed_url == true) {
+      rval = TSREMAP_DID_REMAP;
     }
-    rule = rule->next;
   }
 
   TSDebug(PLUGIN_NAME_DBG, "Returning from TSRemapDoRemap with status: %d", rval);
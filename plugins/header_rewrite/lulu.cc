@@ -17,6 +17,7 @@
 */
 
 #include <string>
+#include <cstring>
 #include <netinet/in.h>
 
 #include "ts/ts.h"
@@ -89,3 +90,40 @@ getPort(sockaddr const *s_sockaddr)
     break;
   }
 }
+
+// Header names the core knows as well-known strings (WKS). Passing the WKS pointer instead of
+// a copy of the name lets field lookups use the header's presence bits and slot accelerators,
+// rather than comparing the name against every field.
+#define WKS(name) {&TS_MIME_FIELD_##name, &TS_MIME_LEN_##name}
+
+static const struct {
+  const char *const *name;
+  const int *len;
+} well_known_headers[] = {
+  WKS(ACCEPT), WKS(ACCEPT_CHARSET), WKS(ACCEPT_ENCODING), WKS(ACCEPT_LANGUAGE), WKS(ACCEPT_RANGES), WKS(AGE), WKS(ALLOW),
+  WKS(APPROVED), WKS(AUTHORIZATION), WKS(BYTES), WKS(CACHE_CONTROL), WKS(CLIENT_IP), WKS(CONNECTION), WKS(CONTENT_BASE),
+  WKS(CONTENT_ENCODING), WKS(CONTENT_LANGUAGE), WKS(CONTENT_LENGTH), WKS(CONTENT_LOCATION), WKS(CONTENT_MD5), WKS(CONTENT_RANGE),
+  WKS(CONTENT_TYPE), WKS(CONTROL), WKS(COOKIE), WKS(DATE), WKS(DISTRIBUTION), WKS(ETAG), WKS(EXPECT), WKS(EXPIRES),
+  WKS(FOLLOWUP_TO), WKS(FROM), WKS(HOST), WKS(IF_MATCH), WKS(IF_MODIFIED_SINCE), WKS(IF_NONE_MATCH), WKS(IF_RANGE),
+  WKS(IF_UNMODIFIED_SINCE), WKS(KEEP_ALIVE), WKS(KEYWORDS), WKS(LAST_MODIFIED), WKS(LINES), WKS(LOCATION), WKS(MAX_FORWARDS),
+  WKS(MESSAGE_ID), WKS(NEWSGROUPS), WKS(ORGANIZATION), WKS(PATH), WKS(PRAGMA), WKS(PROXY_AUTHENTICATE), WKS(PROXY_AUTHORIZATION),
+  WKS(PROXY_CONNECTION), WKS(PUBLIC), WKS(RANGE), WKS(REFERENCES), WKS(REFERER), WKS(REPLY_TO), WKS(RETRY_AFTER), WKS(SENDER),
+  WKS(SERVER), WKS(SET_COOKIE), WKS(STRICT_TRANSPORT_SECURITY), WKS(SUBJECT), WKS(SUMMARY), WKS(TE), WKS(TRANSFER_ENCODING),
+  WKS(UPGRADE), WKS(USER_AGENT), WKS(VARY), WKS(VIA), WKS(WARNING), WKS(WWW_AUTHENTICATE), WKS(XREF), WKS(X_FORWARDED_FOR),
+  WKS(FORWARDED)};
+
+#undef WKS
+
+// Return the WKS for a header name, or nullptr if it is not a well-known header.
+// This is a linear search, meant for use when a configuration is loaded.
+const char *
+getWellKnownHeader(const std::string &name)
+{
+  for (auto const &wks : well_known_headers) {
+    if (static_cast<int>(name.size()) == *wks.len && 0 == strncasecmp(name.c_str(), *wks.name, name.size())) {
+      return *wks.name;
+    }
+  }
+
+  return nullptr;
+}
@@ -32,6 +32,7 @@
 std::string getIP(sockaddr const *s_sockaddr);
 char *getIP(sockaddr const *s_sockaddr, char res[INET6_ADDRSTRLEN]);
 uint16_t getPort(sockaddr const *s_sockaddr);
+const char *getWellKnownHeader(const std::string &name);
 
 extern const char PLUGIN_NAME[];
 extern const char PLUGIN_NAME_DBG[];
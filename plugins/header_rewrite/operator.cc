@@ -52,7 +52,11 @@ OperatorHeaders::initialize(Parser &p)
 {
   Operator::initialize(p);
 
-  _header = p.get_arg();
+  _header      = p.get_arg();
+  _header_name = getWellKnownHeader(_header);
+  if (nullptr == _header_name) {
+    _header_name = _header.c_str();
+  }
 
   require_resources(RSRC_SERVER_RESPONSE_HEADERS);
   require_resources(RSRC_SERVER_REQUEST_HEADERS);
@@ -62,6 +62,8 @@ public:
   }
 
 protected:
+  friend class Program;
+
   virtual void exec(const Resources &res) const = 0;
 
 private:
@@ -85,6 +87,7 @@ public:
 
 protected:
   std::string _header;
+  const char *_header_name = nullptr; // WKS of the header if it has one, or _header itself
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,103 @@
+/*
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+//////////////////////////////////////////////////////////////////////////////////////////////
+// program.cc: compile rule sets into a flat program, and run it
+//
+#include "program.h"
+
+Program::Program(const RuleSet *rule)
+{
+  for (; rule; rule = rule->next) {
+    uint32_t ncond = 0, noper = 0;
+
+    for (const Statement *s = rule->_cond; s; s = s->_next) {
+      ++ncond;
+    }
+    for (const Statement *s = rule->_oper; s; s = s->_next) {
+      ++noper;
+    }
+
+    // Conditions chain to the right, "A [OR] B C" is "A || (B && C)", so each one either decides the
+    // rule or falls through to the next condition.
+    const uint32_t exec = _code.size() + ncond;
+    const uint32_t skip = exec + noper + 1;
+
+    for (Condition *c = rule->_cond; c; c = static_cast<Condition *>(c->_next)) {
+      const bool more   = (nullptr != c->_next);
+      const bool is_or  = c->_mods & COND_OR;
+      const uint32_t pc = _code.size();
+      Insn insn;
+
+      insn.op       = OP_COND;
+      insn.flag     = c->_mods & COND_NOT;
+      insn.on_true  = (more && !is_or) ? pc + 1 : exec;
+      insn.on_false = (more && is_or) ? pc + 1 : skip;
+      insn.cond     = c;
+      _code.push_back(insn);
+    }
+
+    for (const Operator *o = rule->_oper; o; o = static_cast<const Operator *>(o->_next)) {
+      Insn insn;
+
+      insn.op       = OP_EXEC;
+      insn.flag     = false;
+      insn.on_true  = 0;
+      insn.on_false = 0;
+      insn.oper     = o;
+      _code.push_back(insn);
+    }
+
+    Insn end;
+
+    end.op       = OP_END;
+    end.flag     = rule->last() || (rule->_opermods & OPER_LAST);
+    end.on_true  = 0;
+    end.on_false = 0;
+    end.oper     = nullptr;
+    _code.push_back(end);
+  }
+
+  TSDebug(PLUGIN_NAME, "Compiled rule program of %zu instructions", _code.size());
+}
+
+void
+Program::run(const Resources &res) const
+{
+  const uint32_t size = _code.size();
+  uint32_t pc         = 0;
+
+  while (pc < size) {
+    const Insn &insn = _code[pc];
+
+    switch (insn.op) {
+    case OP_COND:
+      pc = (insn.cond->eval(res) != insn.flag) ? insn.on_true : insn.on_false;
+      break;
+    case OP_EXEC:
+      insn.oper->exec(res);
+      ++pc;
+      break;
+    case OP_END:
+      if (insn.flag) {
+        return; // Conditional break, force a break with [L]
+      }
+      ++pc;
+      break;
+    }
+  }
+}
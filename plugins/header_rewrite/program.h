@@ -0,0 +1,72 @@
+/*
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// A compiled, flat form of the rule sets of one hook.
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ruleset.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// The rule sets for a hook, compiled into one array of instructions when the
+// configuration is loaded. Every condition becomes one instruction which jumps
+// straight to the operators of its rule, or past the rule, once the outcome is
+// known. This replaces walking each rule's condition and operator lists, and the
+// per rule [L] checks, on every transaction.
+//
+class Program
+{
+public:
+  explicit Program(const RuleSet *rules);
+
+  // noncopyable
+  Program(const Program &) = delete;
+  void operator=(const Program &) = delete;
+
+  void run(const Resources &res) const;
+
+  size_t
+  size() const
+  {
+    return _code.size();
+  }
+
+private:
+  enum Opcode : uint8_t {
+    OP_COND, // Evaluate a condition, continue at on_true or on_false
+    OP_EXEC, // Run an operator
+    OP_END,  // End of a rule's operators, stop if the rule was the last one to run
+  };
+
+  struct Insn {
+    Opcode op;
+    bool flag; // OP_COND: negate the result, OP_END: stop here
+    uint32_t on_true;
+    uint32_t on_false;
+    union {
+      Condition *cond;
+      const Operator *oper;
+    };
+  };
+
+  std::vector<Insn> _code;
+};
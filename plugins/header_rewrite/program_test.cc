@@ -0,0 +1,286 @@
+/*
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+/*
+ * Checks that a compiled Program evaluates the rule sets exactly as walking
+ * the rule list does: the same conditions are evaluated, in the same order,
+ * and the same operators run, for every outcome of the conditions.
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstdarg>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ruleset.h"
+#include "program.h"
+
+const char PLUGIN_NAME[]     = "TEST_header_rewrite";
+const char PLUGIN_NAME_DBG[] = "TEST_dbg_header_rewrite";
+
+// The plugin API used by the rule set code, none of which does anything here.
+extern "C" void
+TSError(const char *fmt, ...)
+{
+  va_list args;
+
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+  fprintf(stderr, "\n");
+}
+
+extern "C" void
+TSDebug(const char * /* tag */, const char * /* fmt */, ...)
+{
+}
+
+extern "C" void
+_TSReleaseAssert(const char *txt, const char *f, int l)
+{
+  fprintf(stderr, "%s:%d: failed assertion `%s'\n", f, l, txt);
+  abort();
+}
+
+extern "C" const char *
+TSHttpHookNameLookup(TSHttpHookID /* hook */)
+{
+  return "test hook";
+}
+
+extern "C" TSReturnCode
+TSHandleMLocRelease(TSMBuffer /* bufp */, TSMLoc /* parent */, TSMLoc /* mloc */)
+{
+  return TS_SUCCESS;
+}
+
+extern "C" TSHttpStatus
+TSHttpHdrStatusGet(TSMBuffer /* bufp */, TSMLoc /* offset */)
+{
+  return TS_HTTP_STATUS_NONE;
+}
+
+extern "C" TSReturnCode
+TSHttpTxnClientReqGet(TSHttpTxn /* txnp */, TSMBuffer * /* bufp */, TSMLoc * /* offset */)
+{
+  return TS_ERROR;
+}
+
+extern "C" TSReturnCode
+TSHttpTxnClientRespGet(TSHttpTxn /* txnp */, TSMBuffer * /* bufp */, TSMLoc * /* offset */)
+{
+  return TS_ERROR;
+}
+
+extern "C" TSReturnCode
+TSHttpTxnServerReqGet(TSHttpTxn /* txnp */, TSMBuffer * /* bufp */, TSMLoc * /* offset */)
+{
+  return TS_ERROR;
+}
+
+extern "C" TSReturnCode
+TSHttpTxnServerRespGet(TSHttpTxn /* txnp */, TSMBuffer * /* bufp */, TSMLoc * /* offset */)
+{
+  return TS_ERROR;
+}
+
+const char *
+getWellKnownHeader(const std::string & /* name */)
+{
+  return nullptr;
+}
+
+// The outcome of each test condition, one bit per condition, and the trace of
+// what was evaluated and run.
+static unsigned outcomes;
+static std::string trace;
+
+// %{T<n>} is true when bit n of outcomes is set.
+class ConditionTest : public Condition
+{
+public:
+  explicit ConditionTest(int bit) : _bit(bit) {}
+
+  void
+  append_value(std::string & /* s */, const Resources & /* res */) override
+  {
+  }
+
+protected:
+  bool
+  eval(const Resources & /* res */) override
+  {
+    trace += "T" + std::to_string(_bit) + " ";
+    return outcomes & (1U << _bit);
+  }
+
+private:
+  int _bit;
+};
+
+// mark <name> adds the name to the trace.
+class OperatorTest : public Operator
+{
+public:
+  void
+  initialize(Parser &p) override
+  {
+    Operator::initialize(p);
+    _name = p.get_arg();
+  }
+
+protected:
+  void
+  exec(const Resources & /* res */) const override
+  {
+    trace += _name + " ";
+  }
+
+private:
+  std::string _name;
+};
+
+Condition *
+condition_factory(const std::string &cond)
+{
+  if (cond.size() == 2 && cond[0] == 'T' && std::isdigit(cond[1])) {
+    return new ConditionTest(cond[1] - '0');
+  }
+  return nullptr;
+}
+
+Operator *
+operator_factory(const std::string &op)
+{
+  return op == "mark" ? new OperatorTest() : nullptr;
+}
+
+// Build the rule sets the way the plugin does, a condition after an operator
+// starts a new rule.
+static RuleSet *
+build_rules(const std::vector<std::string> &lines)
+{
+  RuleSet *rules = nullptr;
+  RuleSet *rule  = nullptr;
+
+  for (const auto &line : lines) {
+    Parser p;
+
+    if (!p.parse_line(line) || p.empty()) {
+      continue;
+    }
+    if (p.is_cond() && rule && rule->has_operator()) {
+      rule = nullptr;
+    }
+    if (nullptr == rule) {
+      rule = new RuleSet();
+      if (rules) {
+        rules->append(rule);
+      } else {
+        rules = rule;
+      }
+    }
+    if (!(p.is_cond() ? rule->add_condition(p, "test", 0) : rule->add_operator(p, "test", 0))) {
+      std::cerr << "could not add: " << line << std::endl;
+    }
+  }
+
+  return rules;
+}
+
+// How the rule sets were evaluated before they were compiled.
+static void
+run_rules(const RuleSet *rule, const Resources &res)
+{
+  while (rule) {
+    if (rule->eval(res)) {
+      OperModifiers rt = rule->exec(res);
+
+      if (rule->last() || (rt & OPER_LAST)) {
+        break; // Conditional break, force a break with [L]
+      }
+    }
+    rule = rule->next;
+  }
+}
+
+// Run the rules both ways for every outcome of the conditions.
+static int
+test_rules(const char *name, const std::vector<std::string> &lines, int nconds)
+{
+  RuleSet *rules = build_rules(lines);
+  Program program(rules);
+  Resources res(nullptr, static_cast<TSCont>(nullptr));
+  std::set<std::string> traces;
+  int errors = 0;
+
+  for (outcomes = 0; outcomes < (1U << nconds); ++outcomes) {
+    trace.clear();
+    run_rules(rules, res);
+    std::string expected = trace;
+
+    trace.clear();
+    program.run(res);
+    if (trace != expected) {
+      std::cerr << "CHECK FAILED for " << name << " with outcomes " << outcomes << ": \"" << trace << "\" != \"" << expected
+                << "\"" << std::endl;
+      ++errors;
+    }
+    traces.insert(expected);
+  }
+
+  // Make sure the outcomes made a difference at all.
+  if (traces.size() < 2) {
+    std::cerr << "CHECK FAILED for " << name << ": the rules ran the same way every time" << std::endl;
+    ++errors;
+  }
+
+  std::cout << "Finished program test: " << name << std::endl;
+  delete rules;
+  return errors;
+}
+
+int
+main()
+{
+  int errors = 0;
+
+  errors += test_rules("AND", {"cond %{T0}", "cond %{T1}", "cond %{T2}", "mark A", "cond %{T3}", "mark B", "mark C"}, 4);
+
+  errors += test_rules("OR and NOT",
+                       {"cond %{T0} [OR]", "cond %{T1} [NOT]", "cond %{T2} [OR,NOT]", "cond %{T3}", "mark A", "mark B",
+                        "cond %{T4} [NOT,OR]", "cond %{T5} [NOT]", "mark C"},
+                       6);
+
+  errors += test_rules("OR chain", {"cond %{T0} [OR]", "cond %{T1} [OR]", "cond %{T2} [OR]", "cond %{T3}", "mark A"}, 4);
+
+  errors += test_rules("no conditions", {"mark A", "cond %{T0} [NOT]", "mark B", "mark C"}, 1);
+
+  errors += test_rules("last on a condition",
+                       {"cond %{T0}", "mark A", "cond %{T1} [OR]", "cond %{T2} [L]", "mark B", "cond %{T3}", "mark C"}, 4);
+
+  errors += test_rules("last on an operator",
+                       {"cond %{T0} [NOT]", "cond %{T1}", "mark A", "mark B [L]", "cond %{T2} [OR]", "cond %{T3}", "mark C [L]",
+                        "cond %{T4}", "mark D", "mark E"},
+                       5);
+
+  return errors ? 1 : 0;
+}
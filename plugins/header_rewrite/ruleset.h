@@ -111,6 +111,8 @@ public:
   RuleSet *next = nullptr; // Linked list
 
 private:
+  friend class Program;
+
   Condition *_cond   = nullptr;                        // First pre-condition (linked list)
   Operator *_oper    = nullptr;                        // First operator (linked list)
   TSHttpHookID _hook = TS_HTTP_READ_RESPONSE_HDR_HOOK; // Which hook is this rule for
@@ -143,6 +143,8 @@ public:
   }
 
 protected:
+  friend class Program;
+
   virtual void initialize_hooks();
 
   UrlQualifiers parse_url_qualifier(const std::string &q) const;
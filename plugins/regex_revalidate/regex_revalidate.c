@@ -43,6 +43,8 @@
 #define OVECTOR_SIZE 30
 #define LOG_ROLL_INTERVAL 86400
 #define LOG_ROLL_OFFSET 0
+#define RULES_PER_MATCHER 128
+#define MARK_MAX 16
 
 static const char *const PLUGIN_NAME = "regex_revalidate";
 static const char *const DEFAULT_DIR = "var/trafficserver"; /* Not perfect, but no better API) */
@@ -121,8 +123,34 @@ typedef struct invalidate_t {
   struct invalidate_t *next;
 } invalidate_t;
 
+/* Up to RULES_PER_MATCHER rules compiled into one alternation.
+ * A miss on the alternation rules out every rule in the group with one pcre_exec. On a hit each
+ * alternative sets a (*MARK) with its index, naming one rule that is known to match.
+ */
+typedef struct {
+  pcre *regex; // NULL if the rules have to be matched one by one
+  pcre_extra *regex_extra;
+  invalidate_t **rules;
+  int count;
+  time_t max_epoch;
+  time_t max_expiry;
+} matcher_t;
+
+/* Immutable snapshot of the rules, swapped in as a whole on reload. */
 typedef struct {
   invalidate_t *invalidate_list;
+  invalidate_t **rules;
+  int count;
+  matcher_t *matchers;
+  int matcher_count;
+  time_t max_epoch;  // no rule applies to objects cached after this
+  time_t min_expiry; // the ruleset must be pruned after this
+  unsigned generation;
+} ruleset_t;
+
+typedef struct {
+  ruleset_t *ruleset;
+  unsigned generation;
   char *config_path;
   time_t last_load;
   TSTextLogObject log;
@@ -171,10 +199,136 @@ free_invalidate_t_list(invalidate_t *iptr)
   }
 }
 
+static int
+rule_count(invalidate_t const *iptr)
+{
+  int count = 0;
+  for (; iptr; iptr = iptr->next) {
+    ++count;
+  }
+  return count;
+}
+
+static void
+compile_matcher(matcher_t *m)
+{
+  size_t len = 1;
+  char *pattern, *pos;
+  const char *errptr;
+  int erroffset, i;
+
+  for (i = 0; i < m->count; ++i) {
+    len += strlen(m->rules[i]->regex_text) + MARK_MAX + 16;
+  }
+  pattern = pos = (char *)TSmalloc(len);
+  *pos          = '\0';
+  for (i = 0; i < m->count; ++i) {
+    pos += snprintf(pos, len - (pos - pattern), "%s(*MARK:%d)(?:%s)", i ? "|" : "", i, m->rules[i]->regex_text);
+  }
+
+  m->regex = pcre_compile(pattern, 0, &errptr, &erroffset, NULL);
+  if (m->regex) {
+    m->regex_extra = pcre_study(m->regex, 0, &errptr);
+  } else {
+    TSDebug(PLUGIN_NAME, "Combined matcher for %d rules did not compile (%s), matching them one by one", m->count, errptr);
+  }
+  TSfree(pattern);
+}
+
+static void
+free_ruleset_t(ruleset_t *rs)
+{
+  for (int i = 0; i < rs->matcher_count; ++i) {
+    matcher_t *const m = rs->matchers + i;
+    if (m->regex_extra) {
+#ifndef PCRE_STUDY_JIT_COMPILE
+      pcre_free(m->regex_extra);
+#else
+      pcre_free_study(m->regex_extra);
+#endif
+    }
+    if (m->regex) {
+      pcre_free(m->regex);
+    }
+  }
+  free_invalidate_t_list(rs->invalidate_list);
+  TSfree(rs->matchers);
+  TSfree(rs->rules);
+  TSfree(rs);
+}
+
+/* Build the matchers for a list of rules, the ruleset takes ownership of the list. */
+static ruleset_t *
+make_ruleset_t(invalidate_t *list, unsigned generation)
+{
+  ruleset_t *rs = (ruleset_t *)TSmalloc(sizeof(ruleset_t));
+  invalidate_t *iptr;
+  int i = 0, backrefs, alone;
+
+  rs->invalidate_list = list;
+  rs->count           = rule_count(list);
+  rs->rules           = (invalidate_t **)TSmalloc((rs->count + 1) * sizeof(invalidate_t *));
+  rs->matchers        = (matcher_t *)TSmalloc((rs->count + 1) * sizeof(matcher_t));
+  rs->matcher_count   = 0;
+  rs->max_epoch       = 0;
+  rs->min_expiry      = 0;
+  rs->generation      = generation;
+
+  for (iptr = list; iptr; iptr = iptr->next) {
+    rs->rules[i++] = iptr;
+  }
+
+  // Rules keep their config order, the first matching rule wins as before.
+  matcher_t *m = NULL;
+  for (i = 0; i < rs->count; ++i) {
+    iptr = rs->rules[i];
+    if (0 == i || iptr->epoch > rs->max_epoch) {
+      rs->max_epoch = iptr->epoch;
+    }
+    if (0 == i || iptr->expiry < rs->min_expiry) {
+      rs->min_expiry = iptr->expiry;
+    }
+
+    // Rules which would break the alternation get a matcher of their own: back references would point at the wrong
+    // group, a backtracking verb such as (*COMMIT) can fail the whole alternation and an unclosed \Q quotes the next rule.
+    backrefs = 0;
+    pcre_fullinfo(iptr->regex, iptr->regex_extra, PCRE_INFO_BACKREFMAX, &backrefs);
+    alone = backrefs > 0 || NULL != strstr(iptr->regex_text, "(*") || NULL != strstr(iptr->regex_text, "\\Q");
+
+    if (NULL == m || m->count >= RULES_PER_MATCHER || alone) {
+      m = rs->matchers + rs->matcher_count++;
+      memset(m, 0, sizeof(matcher_t));
+      m->rules      = rs->rules + i;
+      m->max_epoch  = iptr->epoch;
+      m->max_expiry = iptr->expiry;
+    }
+    m->count++;
+    if (iptr->epoch > m->max_epoch) {
+      m->max_epoch = iptr->epoch;
+    }
+    if (iptr->expiry > m->max_expiry) {
+      m->max_expiry = iptr->expiry;
+    }
+    if (alone) {
+      m = NULL;
+    }
+  }
+
+  for (i = 0; i < rs->matcher_count; ++i) {
+    if (rs->matchers[i].count > 1) {
+      compile_matcher(rs->matchers + i);
+    }
+  }
+
+  TSDebug(PLUGIN_NAME, "Generation %u: %d rules in %d matchers", generation, rs->count, rs->matcher_count);
+  return rs;
+}
+
 static plugin_state_t *
 init_plugin_state_t(plugin_state_t *pstate)
 {
-  pstate->invalidate_list = NULL;
+  pstate->ruleset         = NULL;
+  pstate->generation      = 0;
   pstate->config_path     = NULL;
   pstate->last_load       = 0;
   pstate->log             = NULL;
@@ -185,8 +339,8 @@ init_plugin_state_t(plugin_state_t *pstate)
 static void
 free_plugin_state_t(plugin_state_t *pstate)
 {
-  if (pstate->invalidate_list) {
-    free_invalidate_t_list(pstate->invalidate_list);
+  if (pstate->ruleset) {
+    free_ruleset_t(pstate->ruleset);
   }
   if (pstate->config_path) {
     TSfree(pstate->config_path);
@@ -363,13 +517,40 @@ load_state(plugin_state_t *pstate, invalidate_t **ilist)
   return true;
 }
 
+static const char *
+config_file_path(plugin_state_t const *pstate, char *buf, size_t len)
+{
+  if (pstate->config_path[0] != '/') {
+    snprintf(buf, len, "%s/%s", TSConfigDirGet(), pstate->config_path);
+    return buf;
+  }
+  return pstate->config_path;
+}
+
+/* Cheap check whether a reload would change anything, so an idle poll does not recompile every rule. */
+static bool
+config_changed(plugin_state_t const *pstate)
+{
+  char buf[PATH_MAX];
+  struct stat s;
+  ruleset_t const *const rs = pstate->ruleset;
+
+  if (rs && rs->count && difftime(rs->min_expiry, time(NULL)) < 0) {
+    return true;
+  }
+  if (stat(config_file_path(pstate, buf, sizeof(buf)), &s) < 0) {
+    return false;
+  }
+  return pstate->last_load < s.st_mtime;
+}
+
 static bool
 load_config(plugin_state_t *pstate, invalidate_t **ilist)
 {
   FILE *fs;
   struct stat s;
-  size_t path_len;
-  char *path;
+  char buf[PATH_MAX];
+  const char *path;
   char line[LINE_MAX];
   time_t now;
   pcre *config_re;
@@ -378,13 +559,7 @@ load_config(plugin_state_t *pstate, invalidate_t **ilist)
   int ln = 0;
   invalidate_t *iptr, *i;
 
-  if (pstate->config_path[0] != '/') {
-    path_len = strlen(TSConfigDirGet()) + strlen(pstate->config_path) + 2;
-    path     = alloca(path_len);
-    snprintf(path, path_len, "%s/%s", TSConfigDirGet(), pstate->config_path);
-  } else {
-    path = pstate->config_path;
-  }
+  path = config_file_path(pstate, buf, sizeof(buf));
   if (stat(path, &s) < 0) {
     TSDebug(PLUGIN_NAME, "Could not stat %s", path);
     return false;
@@ -528,11 +703,11 @@ list_config(plugin_state_t *pstate, invalidate_t *i)
 static int
 free_handler(TSCont cont, TSEvent event, void *edata)
 {
-  invalidate_t *iptr;
+  ruleset_t *rs;
 
-  TSDebug(PLUGIN_NAME, "Freeing old config");
-  iptr = (invalidate_t *)TSContDataGet(cont);
-  free_invalidate_t_list(iptr);
+  rs = (ruleset_t *)TSContDataGet(cont);
+  TSDebug(PLUGIN_NAME, "Freeing old config generation %u", rs->generation);
+  free_ruleset_t(rs);
   TSContDestroy(cont);
   return 0;
 }
@@ -541,9 +716,10 @@ static int
 config_handler(TSCont cont, TSEvent event, void *edata)
 {
   plugin_state_t *pstate;
-  invalidate_t *i, *iptr;
+  invalidate_t *i;
+  ruleset_t *rs;
   TSCont free_cont;
-  bool updated;
+  bool updated = false;
   TSMutex mutex;
 
   mutex = TSContMutexGet(cont);
@@ -551,27 +727,33 @@ config_handler(TSCont cont, TSEvent event, void *edata)
 
   TSDebug(PLUGIN_NAME, "In config Handler");
   pstate = (plugin_state_t *)TSContDataGet(cont);
-  i      = copy_config(pstate->invalidate_list);
 
-  updated = prune_config(&i);
-  updated = load_config(pstate, &i) || updated;
+  // Everything expensive happens here on a task thread, transactions keep using the current
+  // ruleset until the new one is swapped in.
+  if (config_changed(pstate)) {
+    i = copy_config(pstate->ruleset ? pstate->ruleset->invalidate_list : NULL);
 
-  if (updated) {
-    list_config(pstate, i);
-    iptr = __sync_val_compare_and_swap(&(pstate->invalidate_list), pstate->invalidate_list, i);
+    updated = prune_config(&i);
+    updated = load_config(pstate, &i) || updated;
 
-    if (iptr) {
-      free_cont = TSContCreate(free_handler, TSMutexCreate());
-      TSContDataSet(free_cont, (void *)iptr);
-      TSContScheduleOnPool(free_cont, FREE_TMOUT, TS_THREAD_POOL_TASK);
-    }
-  } else {
-    TSDebug(PLUGIN_NAME, "No Changes");
-    if (i) {
+    if (updated) {
+      list_config(pstate, i);
+      rs = __atomic_exchange_n(&pstate->ruleset, make_ruleset_t(i, ++pstate->generation), __ATOMIC_ACQ_REL);
+
+      if (rs) {
+        free_cont = TSContCreate(free_handler, TSMutexCreate());
+        TSContDataSet(free_cont, (void *)rs);
+        TSContScheduleOnPool(free_cont, FREE_TMOUT, TS_THREAD_POOL_TASK);
+      }
+    } else if (i) {
       free_invalidate_t_list(i);
     }
   }
 
+  if (!updated) {
+    TSDebug(PLUGIN_NAME, "No Changes");
+  }
+
   TSMutexUnlock(mutex);
 
   // Don't reschedule for TS_EVENT_MGMT_UPDATE
@@ -600,6 +782,59 @@ get_date_from_cached_hdr(TSHttpTxn txn)
   return date;
 }
 
+static bool
+rule_applies(invalidate_t const *iptr, time_t date, time_t now)
+{
+  return (difftime(iptr->epoch, date) >= 0) && (difftime(iptr->expiry, now) >= 0);
+}
+
+/* Find the first rule which applies to an object cached at @a date and matches @a url. */
+static invalidate_t *
+match_ruleset(ruleset_t const *rs, const char *url, int url_len, time_t date, time_t now)
+{
+  for (int i = 0; i < rs->matcher_count; ++i) {
+    matcher_t const *const m = rs->matchers + i;
+
+    if (difftime(m->max_epoch, date) < 0 || difftime(m->max_expiry, now) < 0) {
+      continue;
+    }
+
+    int marked = -1;
+    if (m->regex) {
+      unsigned char *mark = NULL;
+      pcre_extra extra;
+
+      if (m->regex_extra) {
+        extra = *m->regex_extra;
+      } else {
+        memset(&extra, 0, sizeof(extra));
+      }
+      extra.flags |= PCRE_EXTRA_MARK;
+      extra.mark = &mark;
+
+      if (pcre_exec(m->regex, &extra, url, url_len, 0, 0, NULL, 0) < 0) {
+        continue;
+      }
+      if (mark) {
+        marked = atoi((const char *)mark);
+      }
+    }
+
+    // The mark names the rule which matched leftmost in the URL, not the first one in config order,
+    // so the rules ahead of it still have to be tried. Its own regex need not be run again.
+    for (int j = 0; j < m->count; ++j) {
+      invalidate_t *const iptr = m->rules[j];
+      if (!rule_applies(iptr, date, now)) {
+        continue;
+      }
+      if (j == marked || pcre_exec(iptr->regex, iptr->regex_extra, url, url_len, 0, 0, NULL, 0) >= 0) {
+        return iptr;
+      }
+    }
+  }
+  return NULL;
+}
+
 static int
 main_handler(TSCont cont, TSEvent event, void *edata)
 {
@@ -607,6 +842,7 @@ main_handler(TSCont cont, TSEvent event, void *edata)
   int status;
   invalidate_t *iptr;
   plugin_state_t *pstate;
+  ruleset_t *rs;
 
   time_t date = 0, now = 0;
   char *url   = NULL;
@@ -617,29 +853,21 @@ main_handler(TSCont cont, TSEvent event, void *edata)
     if (TSHttpTxnCacheLookupStatusGet(txn, &status) == TS_SUCCESS) {
       if (status == TS_CACHE_LOOKUP_HIT_FRESH) {
         pstate = (plugin_state_t *)TSContDataGet(cont);
-        iptr   = pstate->invalidate_list;
-        while (iptr) {
-          if (!date) {
-            date = get_date_from_cached_hdr(txn);
-            now  = time(NULL);
-          }
-          if ((difftime(iptr->epoch, date) >= 0) && (difftime(iptr->expiry, now) >= 0)) {
-            if (!url) {
-              url = TSHttpTxnEffectiveUrlStringGet(txn, &url_len);
-            }
-            if (pcre_exec(iptr->regex, iptr->regex_extra, url, url_len, 0, 0, NULL, 0) >= 0) {
+        rs     = __atomic_load_n(&pstate->ruleset, __ATOMIC_ACQUIRE);
+        if (rs && rs->count) {
+          date = get_date_from_cached_hdr(txn);
+          now  = time(NULL);
+          // Objects cached after the newest rule of this generation are never matched.
+          if (difftime(rs->max_epoch, date) >= 0) {
+            url  = TSHttpTxnEffectiveUrlStringGet(txn, &url_len);
+            iptr = match_ruleset(rs, url, url_len, date, now);
+            if (iptr) {
               TSHttpTxnCacheLookupStatusSet(txn, iptr->new_result);
               increment_stat(iptr->new_result);
               TSDebug(PLUGIN_NAME, "Forced revalidate - %.*s %s", url_len, url, strForResult(iptr->new_result));
-              iptr = NULL;
             }
+            TSfree(url);
           }
-          if (iptr) {
-            iptr = iptr->next;
-          }
-        }
-        if (url) {
-          TSfree(url);
         }
       }
     }
@@ -718,8 +946,6 @@ TSPluginInit(int argc, const char *argv[])
   if (!load_config(pstate, &iptr)) {
     TSDebug(PLUGIN_NAME, "Problem loading config from file %s", pstate->config_path);
   } else {
-    pstate->invalidate_list = iptr;
-
     /* Load and merge previous state if provided */
     if (NULL != pstate->state_path) {
       if (!load_state(pstate, &iptr)) {
@@ -730,6 +956,7 @@ TSPluginInit(int argc, const char *argv[])
     }
 
     list_config(pstate, iptr);
+    pstate->ruleset = make_ruleset_t(iptr, ++pstate->generation);
   }
 
   info.plugin_name   = PLUGIN_NAME;
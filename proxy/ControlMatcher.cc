@@ -29,6 +29,9 @@
  ****************************************************************************/
 
 #include <sys/types.h>
+#include <arpa/nameser.h>
+
+#include <algorithm>
 
 #include "tscore/ink_config.h"
 #include "tscore/MatcherUtils.h"
@@ -38,7 +41,6 @@
 #include "ControlMatcher.h"
 #include "CacheControl.h"
 #include "ParentSelection.h"
-#include "tscore/HostLookup.h"
 #include "HTTP.h"
 #include "URL.h"
 #include "P_EventSystem.h"
@@ -50,6 +52,52 @@
  *   Place all template instantiations at the bottom of the file
  ****************************************************************/
 
+namespace
+{
+// Lower case a host or domain name and drop the dots around it, which
+//   are optional in both the config and the request.
+std::string_view
+normalize_name(std::string_view name, char *buf)
+{
+  while (!name.empty() && name.front() == '.') {
+    name.remove_prefix(1);
+  }
+  while (!name.empty() && name.back() == '.') {
+    name.remove_suffix(1);
+  }
+  for (size_t i = 0; i < name.size(); ++i) {
+    buf[i] = ParseRules::ink_tolower(name[i]);
+  }
+  return {buf, name.size()};
+}
+
+pcre_extra *
+study_regex(pcre *re)
+{
+  const char *errptr;
+  int study_opts = 0;
+
+#ifdef PCRE_CONFIG_JIT
+  study_opts |= PCRE_STUDY_JIT_COMPILE;
+#endif
+
+  return pcre_study(re, study_opts, &errptr);
+}
+
+void
+free_regex(pcre *re, pcre_extra *extra)
+{
+  if (extra) {
+#ifdef PCRE_CONFIG_JIT
+    pcre_free_study(extra);
+#else
+    pcre_free(extra);
+#endif
+  }
+  pcre_free(re);
+}
+} // namespace
+
 // HttpRequestData accessors
 //   Can not be inlined due being virtual functions
 //
@@ -89,12 +137,6 @@ HttpRequestData::get_client_ip()
 template <class Data, class MatchResult>
 HostMatcher<Data, MatchResult>::HostMatcher(const char *name, const char *filename) : BaseMatcher<Data>(name, filename)
 {
-  host_lookup = new HostLookup(name);
-}
-
-template <class Data, class MatchResult> HostMatcher<Data, MatchResult>::~HostMatcher()
-{
-  delete host_lookup;
 }
 
 //
@@ -108,21 +150,12 @@ void
 HostMatcher<Data, MatchResult>::Print() const
 {
   printf("\tHost/Domain Matcher with %d elements\n", num_el);
-  host_lookup->Print(PrintFunc);
-}
-
-//
-// template <class Data,class MatchResult>
-// void HostMatcher<Data,MatchResult>::PrintFunc(void* opaque_data)
-//
-//  Debugging Method
-//
-template <class Data, class MatchResult>
-void
-HostMatcher<Data, MatchResult>::PrintFunc(void *opaque_data)
-{
-  Data *d = (Data *)opaque_data;
-  d->Print();
+  for (auto const &[name, entries] : name_index) {
+    for (auto const &entry : entries) {
+      printf("\t\t%s %.*s\n", entry.domain ? "Domain" : "Host", static_cast<int>(name.size()), name.data());
+      entry.data->Print();
+    }
+  }
 }
 
 // void HostMatcher<Data,MatchResult>::AllocateSpace(int num_entries)
@@ -136,8 +169,6 @@ HostMatcher<Data, MatchResult>::AllocateSpace(int num_entries)
   // Should not have been allocated before
   ink_assert(array_len == -1);
 
-  host_lookup->AllocateSpace(num_entries);
-
   data_array = new Data[num_entries];
   array_len  = num_entries;
   num_el     = 0;
@@ -152,27 +183,39 @@ template <class Data, class MatchResult>
 void
 HostMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result) const
 {
-  void *opaque_ptr;
-  Data *data_ptr;
-  bool r;
-
   // Check to see if there is any work to do before making
   //   the string copy
   if (num_el <= 0) {
     return;
   }
 
-  HostLookupState s;
-
-  r = host_lookup->MatchFirst(rdata->get_host(), &s, &opaque_ptr);
+  std::string_view host{rdata->get_host() ? rdata->get_host() : ""};
 
-  while (r == true) {
-    ink_assert(opaque_ptr != nullptr);
-    data_ptr = (Data *)opaque_ptr;
-    data_ptr->UpdateMatch(result, rdata);
-
-    r = host_lookup->MatchNext(&s, &opaque_ptr);
+  // Names too long for DNS are rare enough to be normalized on the heap.
+  char buf[MAXDNAME];
+  std::string long_buf;
+  char *dst = buf;
+  if (host.size() > sizeof(buf)) {
+    long_buf.resize(host.size());
+    dst = long_buf.data();
   }
+
+  // Look up every suffix of the host which starts at a label, from
+  //   the root down to the whole name.  Domains match at any of them,
+  //   hosts only at the whole name.
+  std::string_view name{normalize_name(host, dst)};
+  size_t start = name.size() + 1;
+
+  do {
+    start = start > name.size() ? name.size() : name.rfind('.', start - 2) + 1;
+    if (auto spot = name_index.find(name.substr(start)); spot != name_index.end()) {
+      for (auto const &entry : spot->second) {
+        if (entry.domain || start == 0) {
+          entry.data->UpdateMatch(result, rdata);
+        }
+      }
+    }
+  } while (start > 0);
 }
 
 //
@@ -218,7 +261,9 @@ HostMatcher<Data, MatchResult>::NewEntry(matcher_line *line_info)
     new (cur_d) Data(); // reconstruct
   } else {
     // Fill in the matching info
-    host_lookup->NewEntry(match_data, (line_info->type == MATCH_DOMAIN) ? true : false, cur_d);
+    std::string &name = names.emplace_back(match_data);
+    name.resize(normalize_name(name, name.data()).size());
+    name_index[name].push_back({cur_d, line_info->type == MATCH_DOMAIN});
     num_el++;
   }
 
@@ -375,10 +420,21 @@ RegexMatcher<Data, MatchResult>::RegexMatcher(const char *name, const char *file
 template <class Data, class MatchResult> RegexMatcher<Data, MatchResult>::~RegexMatcher()
 {
   for (int i = 0; i < num_el; i++) {
-    pcre_free(re_array[i]);
+    free_regex(re_array[i], re_extra[i]);
     ats_free(re_str[i]);
   }
+  for (auto const &group : inner_groups) {
+    if (group.re) {
+      free_regex(group.re, group.extra);
+    }
+  }
+  for (auto const &group : outer_groups) {
+    if (group.re) {
+      free_regex(group.re, group.extra);
+    }
+  }
   delete[] re_str;
+  ats_free(re_extra);
   ats_free(re_array);
 }
 
@@ -411,6 +467,9 @@ RegexMatcher<Data, MatchResult>::AllocateSpace(int num_entries)
   re_array = static_cast<pcre **>(ats_malloc(sizeof(pcre *) * num_entries));
   memset(re_array, 0, sizeof(pcre *) * num_entries);
 
+  re_extra = static_cast<pcre_extra **>(ats_malloc(sizeof(pcre_extra *) * num_entries));
+  memset(re_extra, 0, sizeof(pcre_extra *) * num_entries);
+
   data_array = new Data[num_entries];
 
   re_str = new char *[num_entries];
@@ -451,7 +510,8 @@ RegexMatcher<Data, MatchResult>::NewEntry(matcher_line *line_info)
     return Result::failure("%s regular expression error at line %d position %d : %s", matcher_name, line_info->line_num, erroffset,
                            errptr);
   }
-  re_str[num_el] = ats_strdup(pattern);
+  re_extra[num_el] = study_regex(re_array[num_el]);
+  re_str[num_el]   = ats_strdup(pattern);
 
   // Remove our consumed label from the parsed line
   line_info->line[0][line_info->dest_entry] = nullptr;
@@ -465,8 +525,9 @@ RegexMatcher<Data, MatchResult>::NewEntry(matcher_line *line_info)
     // There was a problem so undo the effects this function
     ats_free(re_str[num_el]);
     re_str[num_el] = nullptr;
-    pcre_free(re_array[num_el]);
+    free_regex(re_array[num_el], re_extra[num_el]);
     re_array[num_el] = nullptr;
+    re_extra[num_el] = nullptr;
   } else {
     num_el++;
   }
@@ -474,18 +535,164 @@ RegexMatcher<Data, MatchResult>::NewEntry(matcher_line *line_info)
   return error;
 }
 
+//
+// void RegexMatcher<Data,MatchResult>::Compile()
+//
+//   Compiles the regexs, once all of them have been added, into
+//     alternations of GROUP_SIZE regexs and, for larger tables,
+//     of OUTER_GROUP_SIZE regexs.  Each alternative sets a (*MARK)
+//     with the index of its regex.
+//
+template <class Data, class MatchResult>
+void
+RegexMatcher<Data, MatchResult>::Compile()
+{
+  // A single group would only add a pcre_exec in front of the regexs
+  if (num_el > GROUP_SIZE) {
+    CompileGroups(inner_groups, GROUP_SIZE);
+  }
+  if (num_el > OUTER_GROUP_SIZE) {
+    CompileGroups(outer_groups, OUTER_GROUP_SIZE);
+  }
+}
+
+template <class Data, class MatchResult>
+void
+RegexMatcher<Data, MatchResult>::CompileGroups(std::vector<Group> &groups, int size)
+{
+  const char *errptr;
+  int erroffset;
+
+  groups.reserve((num_el + size - 1) / size);
+  for (int first = 0; first < num_el; first += size) {
+    Group &group = groups.emplace_back();
+    std::string pattern;
+    bool combine = true;
+
+    group.first = first;
+    group.count = std::min(size, num_el - first);
+
+    for (int i = first; i < first + group.count && combine; i++) {
+      int backrefs = 0;
+
+      // Back references would point at the wrong group once combined,
+      //   verbs must start the pattern or would clash with our marks,
+      //   and an unclosed \Q would quote the alternatives after it.
+      pcre_fullinfo(re_array[i], re_extra[i], PCRE_INFO_BACKREFMAX, &backrefs);
+      combine = backrefs == 0 && strstr(re_str[i], "(*") == nullptr && strstr(re_str[i], "\\Q") == nullptr;
+
+      pattern.append(i == first ? "(*MARK:" : "|(*MARK:").append(std::to_string(i)).append(")(?:").append(re_str[i]).append(")");
+    }
+
+    if (combine) {
+      group.re = pcre_compile(pattern.c_str(), 0, &errptr, &erroffset, nullptr);
+    }
+    if (group.re) {
+      group.extra = study_regex(group.re);
+    } else {
+      Debug("matcher", "%s regexs at lines %d to %d are matched one by one", matcher_name, data_array[first].line_num,
+            data_array[first + group.count - 1].line_num);
+    }
+  }
+}
+
+//
+// int RegexMatcher<Data,MatchResult>::MatchGroup(const Group& group, const char* str, int len)
+//
+//   Returns -1 if none of the regexs in arg group match, the index
+//     of a regex that does match if the combined regex can tell, or
+//     num_el if each regex has to be tried
+//
+template <class Data, class MatchResult>
+int
+RegexMatcher<Data, MatchResult>::MatchGroup(const Group &group, const char *str, int len) const
+{
+  unsigned char *mark = nullptr;
+  pcre_extra extra;
+  int r;
+
+  if (group.re == nullptr) {
+    return num_el;
+  }
+
+  if (group.extra) {
+    extra = *group.extra;
+  } else {
+    ink_zero(extra);
+  }
+  extra.flags |= PCRE_EXTRA_MARK;
+  extra.mark   = &mark;
+
+  r = pcre_exec(group.re, &extra, str, len, 0, 0, nullptr, 0);
+  if (r == PCRE_ERROR_NOMATCH) {
+    return -1;
+  } else if (r < 0 || mark == nullptr) {
+    // An error, such as running out of JIT stack.  Let the regexs decide.
+    return num_el;
+  }
+  return atoi(reinterpret_cast<char *>(mark));
+}
+
+//
+// void RegexMatcher<Data,MatchResult>::MatchString(const char* str, RequestData* rdata, MatchResult* result)
+//
+//   Updates arg result for each regex that matches arg str, in the
+//     order of the regexs.  Only the regexs in groups whose combined
+//     regex matches are run.
+//
+template <class Data, class MatchResult>
+void
+RegexMatcher<Data, MatchResult>::MatchString(const char *str, RequestData *rdata, MatchResult *result) const
+{
+  int len = strlen(str);
+  int r;
+
+  auto match_regexs = [&](int first, int count, int matched) {
+    for (int i = first; i < first + count; i++) {
+      r = i == matched ? 0 : pcre_exec(re_array[i], re_extra[i], str, len, 0, 0, nullptr, 0);
+      if (r > -1) {
+        Debug("matcher", "%s Matched %s with regex at line %d", matcher_name, str, data_array[i].line_num);
+        data_array[i].UpdateMatch(result, rdata);
+      } else if (r < -1) {
+        // An error has occurred
+        Warning("Error [%d] matching regex at line %d.", r, data_array[i].line_num);
+      } // else it's -1 which means no match was found.
+    }
+  };
+
+  auto match_groups = [&](size_t first, size_t last) {
+    for (size_t g = first; g < last && g < inner_groups.size(); g++) {
+      const Group &group = inner_groups[g];
+      int matched        = MatchGroup(group, str, len);
+      if (matched >= 0) {
+        match_regexs(group.first, group.count, matched);
+      }
+    }
+  };
+
+  if (inner_groups.empty()) {
+    match_regexs(0, num_el, -1);
+  } else if (outer_groups.empty()) {
+    match_groups(0, inner_groups.size());
+  } else {
+    for (auto const &outer : outer_groups) {
+      if (MatchGroup(outer, str, len) >= 0) {
+        match_groups(outer.first / GROUP_SIZE, (outer.first + outer.count + GROUP_SIZE - 1) / GROUP_SIZE);
+      }
+    }
+  }
+}
+
 //
 // void RegexMatcher<Data,MatchResult>::Match(RequestData* rdata, MatchResult* result)
 //
-//   Coduncts a linear search through the regex array and
-//     updates arg result for each regex that matches arg URL
+//   Updates arg result for each regex that matches arg URL
 //
 template <class Data, class MatchResult>
 void
 RegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result) const
 {
   char *url_str;
-  int r;
 
   // Check to see there is any work to before we copy the
   //   URL
@@ -505,16 +712,7 @@ RegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
   // The function unescapifyStr() is already called in
   // HttpRequestData::get_string(); therefore, no need to call again here.
 
-  for (int i = 0; i < num_el; i++) {
-    r = pcre_exec(re_array[i], nullptr, url_str, strlen(url_str), 0, 0, nullptr, 0);
-    if (r > -1) {
-      Debug("matcher", "%s Matched %s with regex at line %d", matcher_name, url_str, data_array[i].line_num);
-      data_array[i].UpdateMatch(result, rdata);
-    } else if (r < -1) {
-      // An error has occurred
-      Warning("Error [%d] matching regex at line %d.", r, data_array[i].line_num);
-    } // else it's -1 which means no match was found.
-  }
+  this->MatchString(url_str, rdata, result);
   ats_free(url_str);
 }
 
@@ -530,15 +728,13 @@ HostRegexMatcher<Data, MatchResult>::HostRegexMatcher(const char *name, const ch
 //
 // void HostRegexMatcher<Data,MatchResult>::Match(RequestData* rdata, MatchResult* result)
 //
-//   Conducts a linear search through the regex array and
-//     updates arg result for each regex that matches arg host_regex
+//   Updates arg result for each regex that matches arg host_regex
 //
 template <class Data, class MatchResult>
 void
 HostRegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result) const
 {
   const char *url_str;
-  int r;
 
   // Check to see there is any work to before we copy the
   //   URL
@@ -553,17 +749,7 @@ HostRegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *resu
   if (url_str == nullptr) {
     url_str = "";
   }
-  for (int i = 0; i < this->num_el; i++) {
-    r = pcre_exec(this->re_array[i], nullptr, url_str, strlen(url_str), 0, 0, nullptr, 0);
-    if (r != -1) {
-      Debug("matcher", "%s Matched %s with regex at line %d", const_cast<char *>(this->matcher_name), url_str,
-            this->data_array[i].line_num);
-      this->data_array[i].UpdateMatch(result, rdata);
-    } else {
-      // An error has occurred
-      Warning("error matching regex at line %d", this->data_array[i].line_num);
-    }
-  }
+  this->MatchString(url_str, rdata, result);
 }
 
 //
@@ -651,14 +837,25 @@ template <class Data, class MatchResult>
 void
 IpMatcher<Data, MatchResult>::Match(sockaddr const *addr, RequestData *rdata, MatchResult *result) const
 {
-  void *raw;
-  if (ip_map.contains(addr, &raw)) {
-    Data *cur = static_cast<Data *>(raw);
-    ink_assert(cur != nullptr);
-    cur->UpdateMatch(result, rdata);
+  void *cur = nullptr;
+
+  if (ip_trie.contains(addr, &cur)) {
+    static_cast<Data *>(cur)->UpdateMatch(result, rdata);
   }
 }
 
+//
+// void IpMatcher<Data,MatchResult>::Compile()
+//
+//   Compiles the ranges in the map into the trie searched by Match()
+//
+template <class Data, class MatchResult>
+void
+IpMatcher<Data, MatchResult>::Compile()
+{
+  ip_trie.assign(ip_map);
+}
+
 template <class Data, class MatchResult>
 void
 IpMatcher<Data, MatchResult>::Print() const
@@ -926,6 +1123,17 @@ ControlMatcher<Data, MatchResult>::BuildTableFromString(char *file_buf)
 
   ink_assert(second_pass == numEntries);
 
+  // Build the lookup structures, this runs on the task thread for reloads
+  if (reMatch != nullptr) {
+    reMatch->Compile();
+  }
+  if (hrMatch != nullptr) {
+    hrMatch->Compile();
+  }
+  if (ipMatch != nullptr) {
+    ipMatch->Compile();
+  }
+
   if (is_debug_tag_set("matcher")) {
     Print();
   }
@@ -976,3 +1184,162 @@ template class HostMatcher<CacheControlRecord, CacheControlResult>;
 template class RegexMatcher<CacheControlRecord, CacheControlResult>;
 template class UrlMatcher<CacheControlRecord, CacheControlResult>;
 template class IpMatcher<CacheControlRecord, CacheControlResult>;
+
+#if TS_HAS_TESTS
+#include "tscore/TestBox.h"
+
+namespace
+{
+// A record which only remembers its line, so the test can see which lines
+//   matched and in what order.
+struct TestRecord {
+  int line_num = 0;
+
+  Result
+  Init(matcher_line *line_info)
+  {
+    line_num = line_info->line_num;
+    return Result::ok();
+  }
+
+  void
+  UpdateMatch(std::vector<int> *result, RequestData * /* rdata ATS_UNUSED */)
+  {
+    result->push_back(line_num);
+  }
+
+  void
+  Print() const
+  {
+  }
+};
+
+struct TestRequestData : public RequestData {
+  const char *url;
+
+  explicit TestRequestData(const char *u) : url(u) {}
+
+  char *
+  get_string() override
+  {
+    return ats_strdup(url);
+  }
+  const char *
+  get_host() override
+  {
+    return nullptr;
+  }
+  sockaddr const *
+  get_ip() override
+  {
+    return nullptr;
+  }
+  sockaddr const *
+  get_client_ip() override
+  {
+    return nullptr;
+  }
+};
+
+struct TestRegexMatcher : public RegexMatcher<TestRecord, std::vector<int>> {
+  TestRegexMatcher() : RegexMatcher("ControlMatcher test", "test") {}
+
+  using RegexMatcher::inner_groups;
+  using RegexMatcher::outer_groups;
+};
+} // namespace
+
+REGRESSION_TEST(ControlMatcher_RegexGroups)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  // Enough regexs for inner and outer groups.  The first group holds only
+  //   plain regexs, the others each hold one which cannot be combined.
+  std::vector<std::string> regexs = {
+    // group 0
+    "foo", "^http://x/", "\\.html$", "bar", "^http://x/foo", "none0", "none1", "none2",
+    // group 1, a back reference
+    "(a)z", "(b)\\1", "none3", "none4", "none5", "none6", "none7", "foo",
+    // group 2, a verb which fails the whole alternation once it is passed
+    "/a(*COMMIT)x", "foo$", "none8", "none9", "none10", "none11", "none12", "none13",
+    // group 3, an unclosed \Q which would quote the alternatives after it up
+    //   to the \E of the next regex, leaving a combined regex which compiles
+    "\\Q.gif", "\\Q?debug\\E", "/bar", "none15", "none16", "none17", "none18", "none19",
+  };
+  while (regexs.size() < 70) {
+    regexs.push_back("^nomatch" + std::to_string(regexs.size()) + "$");
+  }
+  regexs.push_back("foo"); // in the last outer group
+
+  TestRegexMatcher matcher;
+  matcher.AllocateSpace(regexs.size());
+  for (size_t i = 0; i < regexs.size(); ++i) {
+    matcher_line line;
+    ink_zero(line);
+    line.line[0][0] = const_cast<char *>("url_regex");
+    line.line[1][0] = const_cast<char *>(regexs[i].c_str());
+    line.num_el     = 1;
+    line.line_num   = i + 1;
+    box.check(!matcher.NewEntry(&line).failed(), "regex %s did not compile", regexs[i].c_str());
+  }
+  matcher.Compile();
+
+  box.check(matcher.inner_groups.size() == 9 && matcher.outer_groups.size() == 2,
+            "expected 9 inner and 2 outer groups, got %zu and %zu", matcher.inner_groups.size(), matcher.outer_groups.size());
+  if (matcher.inner_groups.size() == 9) {
+    box.check(matcher.inner_groups[0].re != nullptr, "the plain group was not combined");
+    for (int g = 1; g <= 3; ++g) {
+      box.check(matcher.inner_groups[g].re == nullptr, "group %d was combined", g);
+    }
+  }
+
+  // Every matching line is reported in file order, as if each regex were
+  //   run on its own, even where the combined regex matches a later line
+  //   first.
+  const char *urls[] = {
+    "http://x/foo", "http://x/index.html", "http://y/bar", "http://y/az", "http://y/bb", "http://y/a/foo",
+    "http://y/ax", "http://y/a.gif", "http://y/a.gif/bar", "http://y/a.gif?debug", "http://y/nomatch40", "http://y/none",
+  };
+  for (const char *url : urls) {
+    std::vector<int> expected, matched;
+
+    for (size_t i = 0; i < regexs.size(); ++i) {
+      const char *errptr;
+      int erroffset;
+      pcre *re = pcre_compile(regexs[i].c_str(), 0, &errptr, &erroffset, nullptr);
+      if (pcre_exec(re, nullptr, url, strlen(url), 0, 0, nullptr, 0) >= 0) {
+        expected.push_back(i + 1);
+      }
+      pcre_free(re);
+    }
+
+    TestRequestData rdata(url);
+    matcher.Match(&rdata, &matched);
+
+    std::string want, got;
+    for (int line : expected) {
+      want.append(" ").append(std::to_string(line));
+    }
+    for (int line : matched) {
+      got.append(" ").append(std::to_string(line));
+    }
+    box.check(matched == expected, "%s matched lines%s, expected%s", url, got.c_str(), want.c_str());
+  }
+
+  // A few lines spelled out, in case the one by one matching above is wrong.
+  std::vector<std::pair<const char *, std::vector<int>>> cases = {
+    {"http://x/foo", {1, 2, 5, 16, 18, 71}},
+    {"http://y/bb", {10}},
+    {"http://y/a/foo", {1, 16, 18, 71}},
+    {"http://y/a.gif/bar", {4, 25, 27}},
+    {"http://y/a.gif?debug", {25, 26}},
+  };
+  for (auto const &[url, expected] : cases) {
+    std::vector<int> matched;
+    TestRequestData rdata(url);
+    matcher.Match(&rdata, &matched);
+    box.check(matched == expected, "%s did not match the expected lines", url);
+  }
+}
+#endif
@@ -54,23 +54,22 @@
  *  Lookup Table Descriptions
  *  -------------------------
  *
- *   regex table - implemented as a linear list of regular expressions to
- *       match against
+ *   regex table - implemented as a list of regular expressions to
+ *       match against.  Once the table is built consecutive expressions
+ *       are also compiled into combined alternations, in two levels of
+ *       groups.  A group whose combined expression does not match is
+ *       skipped, only the expressions in matching groups are run one
+ *       by one.
  *
- *   host/domain table - The host domain table is logically implemented as
- *       tree, broken up at each partition in a hostname.  Three mechanism
- *       are used to move from one level to the next: a hash table, a fixed
- *       sized array and a constant time index (class charIndex).  The constant
- *       time index is only used to from the root domain to the first
- *       level partition (ie: .com). The fixed array is used for subsequent
- *       paritions until the fan out exceeds the arrays fixed size at which
- *       time, the fixed array is converted to a hash table
+ *   host/domain table - a hash of host and domain names, lower cased and
+ *       without leading or trailing dots.  A host name is looked up by
+ *       each of its suffixes on a label boundary, shortest first, which
+ *       finds the domains it is in and finally the host itself.
  *
  *   ip table - supports ip ranges.  A single ip address is treated as
- *       a range with the same beginning and end address.  The table is
- *       is divided up into a fixed number of  levels, indexed 8 bit
- *       boundaries, starting at the high bit of the address.  Subsequent
- *       levels are allocated only when needed.
+ *       a range with the same beginning and end address.  The ranges are
+ *       collected in an IpMap and then compiled into an IpMapTrie, which
+ *       finds an address in a few table steps.
  *
  ****************************************************************************/
 
@@ -87,6 +86,7 @@
 #pragma once
 
 #include "tscore/IpMap.h"
+#include "tscore/IpMapTrie.h"
 #include "tscore/Result.h"
 #include "tscore/MatcherUtils.h"
 
@@ -96,7 +96,11 @@
 #include "tscore/Regex.h"
 #include "URL.h"
 
+#include <deque>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #ifdef HAVE_CTYPE_H
 #include <cctype>
@@ -110,7 +114,6 @@
     Error("%s", _buf);                                      \
   }
 
-class HostLookup;
 struct HttpApiInfo;
 struct matcher_line;
 struct matcher_tags;
@@ -222,9 +225,29 @@ public:
   using super::data_array;
   using super::array_len;
 
+  void Compile();
+
 protected:
-  pcre **re_array = nullptr; // array of compiled regexs
-  char **re_str   = nullptr; // array of uncompiled regex strings
+  /// Consecutive regexs compiled into one alternation.
+  struct Group {
+    int first         = 0;       // index of the first regex in the group
+    int count         = 0;       // number of regexs in the group
+    pcre *re          = nullptr; // combined regex, nullptr if it did not compile
+    pcre_extra *extra = nullptr;
+  };
+
+  static constexpr int GROUP_SIZE       = 8;  // regexs in an inner group
+  static constexpr int OUTER_GROUP_SIZE = 64; // regexs in an outer group
+
+  void CompileGroups(std::vector<Group> &groups, int size);
+  void MatchString(const char *str, RequestData *rdata, MatchResult *result) const;
+  int MatchGroup(const Group &group, const char *str, int len) const;
+
+  pcre **re_array       = nullptr; // array of compiled regexs
+  pcre_extra **re_extra = nullptr; // array of study data for the regexs
+  char **re_str         = nullptr; // array of uncompiled regex strings
+  std::vector<Group> outer_groups; // groups of OUTER_GROUP_SIZE regexs
+  std::vector<Group> inner_groups; // groups of GROUP_SIZE regexs
 };
 
 template <class Data, class MatchResult> class HostRegexMatcher : public RegexMatcher<Data, MatchResult>
@@ -248,7 +271,6 @@ template <class Data, class MatchResult> class HostMatcher : protected BaseMatch
 
 public:
   HostMatcher(const char *name, const char *filename);
-  ~HostMatcher();
 
   void AllocateSpace(int num_entries);
   Result NewEntry(matcher_line *line_info);
@@ -262,15 +284,23 @@ public:
   using super::data_array;
   using super::array_len;
 
-  HostLookup *
-  getHLookup()
+  /// Normalized name of each entry, in the order of @c data_array.
+  const std::deque<std::string> &
+  getNames() const
   {
-    return host_lookup;
+    return names;
   }
 
 private:
-  static void PrintFunc(void *opaque_data);
-  HostLookup *host_lookup = nullptr; // Data structure to do the lookups
+  /// A host or domain entry in the name index.
+  struct NameEntry {
+    Data *data;
+    bool domain;
+  };
+  using NameIndex = std::unordered_map<std::string_view, std::vector<NameEntry>>;
+
+  std::deque<std::string> names; // storage for the keys of the name index
+  NameIndex name_index;          // normalized host / domain name to entries
 };
 
 template <class Data, class MatchResult> class IpMatcher : protected BaseMatcher<Data>
@@ -285,6 +315,7 @@ public:
 
   void Match(sockaddr const *ip_addr, RequestData *rdata, MatchResult *result) const;
   void Print() const;
+  void Compile();
 
   using super::num_el;
   using super::matcher_name;
@@ -294,7 +325,9 @@ public:
 
 private:
   static void PrintFunc(void *opaque_data);
-  IpMap ip_map; // Data structure to do lookups
+
+  IpMap ip_map;      // Ranges as they are added
+  IpMapTrie ip_trie; // Compiled ip_map, for lookups
 };
 
 #define ALLOW_HOST_TABLE 1 << 0
@@ -180,7 +180,7 @@ IpAllow::match(sockaddr const *ip, match_key_t key)
   self_type *self = acquire();
   void *raw       = nullptr;
   if (SRC_ADDR == key) {
-    self->_src_map.contains(ip, &raw);
+    self->_src_trie.contains(ip, &raw);
     Record *r = static_cast<Record *>(raw);
     // Special check - if checking in accept is enabled and the record is a deny all,
     // then return a missing record instead to force an immediate deny. Otherwise it's delayed
@@ -189,7 +189,7 @@ IpAllow::match(sockaddr const *ip, match_key_t key)
       raw = nullptr;
     }
   } else {
-    self->_dst_map.contains(ip, &raw);
+    self->_dst_trie.contains(ip, &raw);
   }
   if (raw == nullptr) {
     self->release();
@@ -293,6 +293,9 @@ IpAllow::BuildTable()
     for (auto &item : _dst_map) {
       item.setData(&_dst_acls[reinterpret_cast<size_t>(item.data())]);
     }
+    // The maps are complete, compile them for lookup.
+    _src_trie.assign(_src_map);
+    _dst_trie.assign(_dst_map);
     if (is_debug_tag_set("ip_allow")) {
       Print();
     }
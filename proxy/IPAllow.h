@@ -37,6 +37,7 @@
 #include "hdrs/HTTP.h"
 #include "ProxyConfig.h"
 #include "tscore/IpMap.h"
+#include "tscore/IpMapTrie.h"
 #include "tscpp/util/TextView.h"
 #include "tscore/ts_file.h"
 
@@ -199,6 +200,8 @@ private:
   ts::file::path config_file; ///< Path to configuration file.
   IpMap _src_map;
   IpMap _dst_map;
+  IpMapTrie _src_trie; ///< Compiled @c _src_map, for lookup.
+  IpMapTrie _dst_trie; ///< Compiled @c _dst_map, for lookup.
   std::vector<Record> _src_acls;
   std::vector<Record> _dst_acls;
 };
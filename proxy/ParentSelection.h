@@ -193,6 +193,7 @@ struct ParentResult {
   bool chash_init[MAX_GROUP_RINGS] = {false};
   TSHostStatus first_choice_status = TSHostStatus::TS_HOST_STATUS_INIT;
   bool do_not_cache_response       = false;
+  bool to_peer                     = false; // the parent is a peer in a peering ring.
 
   void
   reset()
@@ -1986,6 +1986,8 @@ HTTPCacheAlt::copy(HTTPCacheAlt *to_copy)
 void
 HTTPCacheAlt::copy_frag_offsets_from(HTTPCacheAlt *src)
 {
+  // The fragment layout of a sparse alternate only makes sense with the marker.
+  m_sparse            = src->m_sparse;
   m_frag_offset_count = src->m_frag_offset_count;
   if (m_frag_offset_count > 0) {
     if (m_frag_offset_count > N_INTEGRAL_FRAG_OFFSETS) {
@@ -2387,3 +2389,30 @@ HTTPInfo::push_frag_offset(FragOffset offset)
 
   m_alt->m_frag_offsets[m_alt->m_frag_offset_count++] = offset;
 }
+
+void
+HTTPInfo::sparse_set(int64_t size)
+{
+  ink_assert(m_alt);
+  m_alt->m_sparse            = CACHE_ALT_SPARSE;
+  m_alt->m_frag_offset_count = 0;
+  object_size_set(size);
+}
+
+void
+HTTPInfo::sparse_layout_set(int64_t frag_size)
+{
+  ink_assert(m_alt && frag_size > 0);
+  int64_t size = object_size_get();
+
+  m_alt->m_frag_offset_count = 0;
+  for (int64_t offset = frag_size; offset < size; offset += frag_size) {
+    push_frag_offset(offset);
+  }
+}
+
+int64_t
+HTTPInfo::sparse_frag_size()
+{
+  return m_alt->m_frag_offset_count ? static_cast<int64_t>(m_alt->m_frag_offsets[0]) : object_size_get();
+}
@@ -1245,6 +1245,12 @@ enum {
   CACHE_ALT_MAGIC_DEAD      = 0xdeadeed,
 };
 
+// Value of HTTPCacheAlt::m_sparse for an alternate which may be missing fragments. Older objects
+// have padding in that place, so any other value means the alternate is complete.
+enum {
+  CACHE_ALT_SPARSE = 0x5ba45e00,
+};
+
 // struct HTTPCacheAlt
 struct HTTPCacheAlt {
   HTTPCacheAlt();
@@ -1267,6 +1273,8 @@ struct HTTPCacheAlt {
 
   int32_t m_object_key[sizeof(CryptoHash) / sizeof(int32_t)];
   int32_t m_object_size[2];
+  /// CACHE_ALT_SPARSE if only some fragments of the object may be stored.
+  uint32_t m_sparse = 0;
 
   HTTPHdr m_request_hdr;
   HTTPHdr m_response_hdr;
@@ -1439,6 +1447,21 @@ public:
   /// Add an @a offset to the end of the fragment offset table.
   void push_frag_offset(FragOffset offset);
 
+  /// Test if the alternate is sparse, i.e. fragments may be missing from the cache.
+  bool
+  is_sparse() const
+  {
+    return m_alt->m_sparse == CACHE_ALT_SPARSE;
+  }
+  /** Mark the alternate sparse for an object of @a size bytes.
+      This clears the fragment table, which is set up by @c sparse_layout_set.
+  */
+  void sparse_set(int64_t size);
+  /// Fill the fragment table for fragments of @a frag_size bytes.
+  void sparse_layout_set(int64_t frag_size);
+  /// Size of the fragments of a sparse alternate, all but the last are this size.
+  int64_t sparse_frag_size();
+
   // Sanity check functions
   static bool check_marshalled(char *buf, int len);
 
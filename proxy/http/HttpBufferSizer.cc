@@ -0,0 +1,221 @@
+/** @file
+
+  Response buffer sizing from learned body size distributions.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <functional>
+
+#include "records/I_RecProcess.h"
+#include "HttpBufferSizer.h"
+
+HttpBufferSizer httpBufferSizer;
+
+namespace
+{
+enum {
+  STAT_SIZED_BUFFERS,
+  STAT_WASTED_BYTES,
+  STAT_ALLOCATED_BYTES,
+  STAT_FREE_BYTES,
+  N_STATS_PER_SIZE,
+};
+
+const char *const STAT_NAME[N_STATS_PER_SIZE] = {"sized_buffers", "wasted_bytes", "allocated_bytes", "free_bytes"};
+
+RecRawStatBlock *buffer_rsb = nullptr;
+
+// The allocator gauges are read from the freelists, all of them in one pass.
+int
+buffer_gauge_sync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int)
+{
+  for (int i = 0; i < DEFAULT_BUFFER_SIZES; ++i) {
+    int id            = i * N_STATS_PER_SIZE;
+    int64_t allocated = ioBufAllocator[i].allocated_size();
+    int64_t used      = ioBufAllocator[i].used_size();
+
+    RecSetGlobalRawStatSum(rsb, id + STAT_ALLOCATED_BYTES, allocated);
+    RecSetGlobalRawStatCount(rsb, id + STAT_ALLOCATED_BYTES, 1);
+    RecRawStatUpdateSum(rsb, id + STAT_ALLOCATED_BYTES);
+
+    RecSetGlobalRawStatSum(rsb, id + STAT_FREE_BYTES, std::max<int64_t>(allocated - used, 0));
+    RecSetGlobalRawStatCount(rsb, id + STAT_FREE_BYTES, 1);
+    RecRawStatUpdateSum(rsb, id + STAT_FREE_BYTES);
+  }
+  return REC_ERR_OKAY;
+}
+} // namespace
+
+HttpBufferClass
+HttpBufferClass::for_size(int64_t size, int64_t max_index)
+{
+  HttpBufferClass bc;
+
+  for (bc.c = 0; bc.c < 2 * max_index; ++bc.c) {
+    // There is no half block below the smallest one.
+    if (bc.c != 1 && bc.size() >= size) {
+      return bc;
+    }
+  }
+  return bc;
+}
+
+int64_t
+HttpBufferClass::first_index() const
+{
+  return c == 1 ? 1 : c / 2;
+}
+
+int64_t
+HttpBufferClass::rest_index() const
+{
+  return c & 1 && c > 1 ? c / 2 - 1 : this->first_index();
+}
+
+int64_t
+HttpBufferClass::size() const
+{
+  int64_t first = BUFFER_SIZE_FOR_INDEX(this->first_index());
+  return this->rest_index() == this->first_index() ? first : first + BUFFER_SIZE_FOR_INDEX(this->rest_index());
+}
+
+int64_t
+HttpBufferClass::capacity(int64_t bytes) const
+{
+  int64_t first = BUFFER_SIZE_FOR_INDEX(this->first_index());
+  int64_t rest  = BUFFER_SIZE_FOR_INDEX(this->rest_index());
+
+  if (bytes <= first) {
+    return first;
+  }
+  return first + (bytes - first + rest - 1) / rest * rest;
+}
+
+uint64_t
+HttpBufferSizer::key(const void *mapping, std::string_view content_type)
+{
+  // Parameters such as the charset do not change the size much.
+  content_type = content_type.substr(0, content_type.find(';'));
+  while (!content_type.empty() && content_type.back() == ' ') {
+    content_type.remove_suffix(1);
+  }
+
+  uint64_t h = std::hash<std::string_view>{}(content_type);
+  h ^= std::hash<const void *>{}(mapping) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+  // Zero marks an empty slot.
+  return h | 1;
+}
+
+void
+HttpBufferSizer::learn(uint64_t key, int64_t bytes)
+{
+  Slot &slot = _slots[key % SLOTS];
+
+  // The counts are not updated together, a race only costs a sample or two.
+  if (slot.key.load(std::memory_order_relaxed) != key) {
+    for (auto &n : slot.count) {
+      n.store(0, std::memory_order_relaxed);
+    }
+    slot.total.store(0, std::memory_order_relaxed);
+    slot.key.store(key, std::memory_order_relaxed);
+  }
+
+  HttpBufferClass bc = HttpBufferClass::for_size(bytes, MAX_BUFFER_SIZE_INDEX);
+  slot.count[bc.c].fetch_add(1, std::memory_order_relaxed);
+  if (slot.total.fetch_add(1, std::memory_order_relaxed) + 1 >= MAX_SAMPLES) {
+    uint32_t total = 0;
+    for (auto &n : slot.count) {
+      uint32_t v = n.load(std::memory_order_relaxed) / 2;
+      n.store(v, std::memory_order_relaxed);
+      total += v;
+    }
+    slot.total.store(total, std::memory_order_relaxed);
+  }
+}
+
+HttpBufferClass
+HttpBufferSizer::guess(uint64_t key, int64_t max_index) const
+{
+  Slot const &slot = _slots[key % SLOTS];
+  HttpBufferClass bc;
+
+  uint32_t total = slot.total.load(std::memory_order_relaxed);
+  if (slot.key.load(std::memory_order_relaxed) != key || total < MIN_SAMPLES) {
+    return bc;
+  }
+
+  uint64_t want = (static_cast<uint64_t>(total) * COVERAGE + 99) / 100;
+  uint64_t seen = 0;
+  for (bc.c = 0; bc.c < CLASSES - 1; ++bc.c) {
+    seen += slot.count[bc.c].load(std::memory_order_relaxed);
+    if (seen >= want) {
+      break;
+    }
+  }
+  bc.c = std::min<int>(bc.c, 2 * max_index);
+  return bc;
+}
+
+void
+HttpBufferSizer::clear()
+{
+  for (auto &slot : _slots) {
+    slot.key.store(0, std::memory_order_relaxed);
+    slot.total.store(0, std::memory_order_relaxed);
+    for (auto &n : slot.count) {
+      n.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+void
+http_buffer_sizer_account(HttpBufferClass bc, int64_t bytes)
+{
+  if (buffer_rsb == nullptr || !bc.valid()) {
+    return;
+  }
+
+  // The unused space is at the end, in the last block.
+  int64_t index = bytes <= BUFFER_SIZE_FOR_INDEX(bc.first_index()) ? bc.first_index() : bc.rest_index();
+  int id        = static_cast<int>(index) * N_STATS_PER_SIZE;
+
+  RecIncrRawStat(buffer_rsb, this_ethread(), id + STAT_SIZED_BUFFERS, 1);
+  RecIncrRawStat(buffer_rsb, this_ethread(), id + STAT_WASTED_BYTES, bc.capacity(bytes) - bytes);
+}
+
+void
+http_buffer_sizer_register_stats()
+{
+  char name[256];
+
+  buffer_rsb = RecAllocateRawStatBlock(DEFAULT_BUFFER_SIZES * N_STATS_PER_SIZE);
+  for (int i = 0; i < DEFAULT_BUFFER_SIZES; ++i) {
+    for (int s = 0; s < N_STATS_PER_SIZE; ++s) {
+      bool gauge = s == STAT_ALLOCATED_BYTES || s == STAT_FREE_BYTES;
+      snprintf(name, sizeof(name), "proxy.process.iobuffer.%d.%s", BUFFER_SIZE_FOR_INDEX(i), STAT_NAME[s]);
+      RecRegisterRawStat(buffer_rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, i * N_STATS_PER_SIZE + s,
+                         gauge ? nullptr : RecRawStatSyncSum);
+    }
+  }
+
+  // Name must be that of a stat, the last one will do since all the gauges are updated together.
+  RecRegisterRawStatSyncCb(name, buffer_gauge_sync, buffer_rsb, 0);
+}
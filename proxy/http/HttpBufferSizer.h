@@ -0,0 +1,116 @@
+/** @file
+
+  Response buffer sizing from learned body size distributions.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+#include "I_IOBuffer.h"
+
+/** Size classes for response buffers.
+
+    The IOBuffer allocators only have power of two block sizes, so a
+    response that is a little over one of them takes a block of twice
+    the size. A size class is a block of one of those sizes, followed
+    by blocks of the same size or, for the classes in between, of half
+    that size. Class @c 2k is a single block of index @c k and class
+    @c 2k+1 a block of index @c k and one of index @c k-1, one and a
+    half times the size.
+*/
+struct HttpBufferClass {
+  int c = -1; ///< Class, -1 for none.
+
+  /// @return The smallest class for @a size bytes, up to a block of index @a max_index.
+  static HttpBufferClass for_size(int64_t size, int64_t max_index);
+
+  /// @return Bytes in the blocks of the class.
+  int64_t size() const;
+  /// @return The index of the first block.
+  int64_t first_index() const;
+  /// @return The index of the blocks after the first.
+  int64_t rest_index() const;
+  /// @return Bytes in the blocks a buffer of this class needs to hold @a bytes.
+  int64_t capacity(int64_t bytes) const;
+
+  bool
+  valid() const
+  {
+    return c >= 0;
+  }
+};
+
+/** Learns the size of response bodies and picks buffers to fit them.
+
+    The sizes are kept as a histogram over the size classes for each
+    key, which is made from the remap rule and the content type. A
+    response without a content length gets a buffer of the class that
+    holds most of the bodies seen for its key, rather than the default
+    buffer size. The table has a fixed number of slots, a key takes
+    over the slot of another one that hashes to it, and the counts are
+    halved as they grow so that the histograms follow changes.
+*/
+class HttpBufferSizer
+{
+public:
+  /// Number of size classes.
+  static constexpr int CLASSES = 2 * DEFAULT_BUFFER_SIZES - 1;
+  /// Slots in the table.
+  static constexpr int SLOTS = 1024;
+  /// Samples needed before the histogram of a key is used.
+  static constexpr uint32_t MIN_SAMPLES = 16;
+  /// The counts of a key are halved when they reach this.
+  static constexpr uint32_t MAX_SAMPLES = 1024;
+  /// The share of the bodies, in percent, the picked class holds.
+  static constexpr uint32_t COVERAGE = 90;
+
+  /// @return The key for a remap rule and content type.
+  static uint64_t key(const void *mapping, std::string_view content_type);
+
+  /// Record a body of @a bytes for @a key.
+  void learn(uint64_t key, int64_t bytes);
+
+  /// @return The class for bodies of @a key, invalid if there are not enough samples.
+  HttpBufferClass guess(uint64_t key, int64_t max_index) const;
+
+  /// Clear all the histograms.
+  void clear();
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> key{0};
+    std::atomic<uint32_t> total{0};
+    std::atomic<uint32_t> count[CLASSES] = {};
+  };
+
+  Slot _slots[SLOTS];
+};
+
+extern HttpBufferSizer httpBufferSizer;
+
+/// Account for a buffer of class @a bc that held @a bytes.
+void http_buffer_sizer_account(HttpBufferClass bc, int64_t bytes);
+
+/// Register the per allocator buffer stats.
+void http_buffer_sizer_register_stats();
@@ -194,6 +194,14 @@ HttpCacheSM::state_cache_open_write(int event, void *data)
     break;
 
   case CACHE_EVENT_OPEN_WRITE_FAILED: {
+    if (reinterpret_cast<intptr_t>(data) == -ECACHE_NOT_ADMITTED) {
+      // Retrying will not change the admission decision, forward it right away.
+      Debug("http_cache", "[%" PRId64 "] [state_cache_open_write] object not admitted to the cache", master_sm->sm_id);
+      open_write_cb = true;
+      err_code      = reinterpret_cast<intptr_t>(data);
+      master_sm->handleEvent(event, &captive_action);
+      break;
+    }
     if (master_sm->t_state.txn_conf->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY) {
       // fall back to open_read_tries
       // Note that when CACHE_WL_FAIL_ACTION_READ_RETRY is configured, max_cache_open_write_retries
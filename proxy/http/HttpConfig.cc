@@ -27,6 +27,7 @@
 #include <cctype>
 #include <cstring>
 #include "HttpConfig.h"
+#include "HttpBufferSizer.h"
 #include "HTTP.h"
 #include "ProcessManager.h"
 #include "ProxyConfig.h"
@@ -1137,6 +1138,7 @@ HttpConfig::startup()
   extern void SSLConfigInit(IpMap * map);
   http_rsb = RecAllocateRawStatBlock(static_cast<int>(http_stat_count));
   register_stat_callbacks();
+  http_buffer_sizer_register_stats();
 
   HttpConfigParams &c = m_master;
 
@@ -1330,6 +1332,7 @@ HttpConfig::startup()
   HttpEstablishStaticConfigByte(c.oride.cache_ignore_auth, "proxy.config.http.cache.ignore_authentication");
   HttpEstablishStaticConfigByte(c.oride.cache_urls_that_look_dynamic, "proxy.config.http.cache.cache_urls_that_look_dynamic");
   HttpEstablishStaticConfigByte(c.cache_post_method, "proxy.config.http.cache.post_method");
+  HttpEstablishStaticConfigByte(c.cache_range_sparse, "proxy.config.http.cache.range.sparse");
 
   HttpEstablishStaticConfigByte(c.oride.ignore_accept_mismatch, "proxy.config.http.cache.ignore_accept_mismatch");
   HttpEstablishStaticConfigByte(c.oride.ignore_accept_language_mismatch, "proxy.config.http.cache.ignore_accept_language_mismatch");
@@ -1399,6 +1402,7 @@ HttpConfig::startup()
   HttpEstablishStaticConfigLongLong(c.max_post_size, "proxy.config.http.max_post_size");
   HttpEstablishStaticConfigLongLong(c.max_payload_iobuf_index, "proxy.config.payload.io.max_buffer_index");
   HttpEstablishStaticConfigLongLong(c.max_msg_iobuf_index, "proxy.config.msg.io.max_buffer_index");
+  HttpEstablishStaticConfigByte(c.adaptive_buffer_sizing, "proxy.config.http.adaptive_buffer_sizing");
 
   //##############################################################################
   //#
@@ -1632,6 +1636,7 @@ HttpConfig::reconfigure()
   params->oride.cache_ignore_auth              = INT_TO_BOOL(m_master.oride.cache_ignore_auth);
   params->oride.cache_urls_that_look_dynamic   = INT_TO_BOOL(m_master.oride.cache_urls_that_look_dynamic);
   params->cache_post_method                    = INT_TO_BOOL(m_master.cache_post_method);
+  params->cache_range_sparse                   = INT_TO_BOOL(m_master.cache_range_sparse);
 
   params->oride.ignore_accept_mismatch          = m_master.oride.ignore_accept_mismatch;
   params->oride.ignore_accept_language_mismatch = m_master.oride.ignore_accept_language_mismatch;
@@ -1656,6 +1661,7 @@ HttpConfig::reconfigure()
   params->max_post_size                  = m_master.max_post_size;
   params->max_payload_iobuf_index        = m_master.max_payload_iobuf_index;
   params->max_msg_iobuf_index            = m_master.max_msg_iobuf_index;
+  params->adaptive_buffer_sizing         = m_master.adaptive_buffer_sizing;
 
   params->oride.cache_required_headers = m_master.oride.cache_required_headers;
   params->oride.cache_range_lookup     = INT_TO_BOOL(m_master.oride.cache_range_lookup);
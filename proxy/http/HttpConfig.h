@@ -805,6 +805,7 @@ public:
 
   MgmtInt max_payload_iobuf_index = BUFFER_SIZE_INDEX_32K;
   MgmtInt max_msg_iobuf_index     = BUFFER_SIZE_INDEX_32K;
+  MgmtByte adaptive_buffer_sizing = 0;
 
   char *redirect_actions_string                        = nullptr;
   IpMap *redirect_actions_map                          = nullptr;
@@ -822,7 +823,8 @@ public:
 
   MgmtByte enable_http_stats = 1; // Can be "slow"
 
-  MgmtByte cache_post_method = 0;
+  MgmtByte cache_post_method  = 0;
+  MgmtByte cache_range_sparse = 0;
 
   MgmtByte push_method_enabled = 0;
 
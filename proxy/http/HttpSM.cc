@@ -2503,6 +2503,13 @@ HttpSM::state_cache_open_write(int event, void *data)
       t_state.cache_info.write_lock_state  = HttpTransact::CACHE_WL_FAIL;
       break;
     }
+    if (cache_sm.get_last_error() == -ECACHE_NOT_ADMITTED) {
+      // Not popular enough to be cached yet, go to the origin without writing the object.
+      SMDebug("http", "object not admitted to the cache");
+      t_state.cache_open_write_fail_action = CACHE_WL_FAIL_ACTION_DEFAULT;
+      t_state.cache_info.write_lock_state  = HttpTransact::CACHE_WL_FAIL;
+      break;
+    }
     if (t_state.txn_conf->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_DEFAULT) {
       t_state.cache_info.write_lock_state = HttpTransact::CACHE_WL_FAIL;
       break;
@@ -4503,7 +4510,13 @@ HttpSM::parse_range_and_compare(MIMEField *field, int64_t content_length)
     ++nr;
 
     if (cache_sm.cache_read_vc && t_state.cache_info.object_read) {
-      if (!cache_sm.cache_read_vc->is_pread_capable() && cache_config_read_while_writer == 2) {
+      if (t_state.cache_info.object_read->is_sparse()) {
+        // Only a single range can be served from a sparse alternate, and only if all of it is there.
+        if (nr > 1 || cache_sm.cache_read_vc->get_cached_length(start, end - start + 1) < end - start + 1) {
+          SMDebug("http_range", "request range not in sparse object, start %" PRId64 ", end %" PRId64, start, end);
+          t_state.range_in_cache = false;
+        }
+      } else if (!cache_sm.cache_read_vc->is_pread_capable() && cache_config_read_while_writer == 2) {
         // write in progress, check if request range not in cache yet
         HTTPInfo::FragOffset *frag_offset_tbl = t_state.cache_info.object_read->get_frag_table();
         int frag_offset_cnt                   = t_state.cache_info.object_read->get_frag_offset_count();
@@ -4690,6 +4703,7 @@ HttpSM::do_cache_lookup_and_read()
 
   milestones[TS_MILESTONE_CACHE_OPEN_READ_BEGIN] = Thread::get_hrtime();
   t_state.cache_lookup_result                    = HttpTransact::CACHE_LOOKUP_NONE;
+  t_state.cache_info.sparse_fill                 = nullptr;
   t_state.cache_info.lookup_count++;
   // YTS Team, yamsat Plugin
   // Changed the lookup_url to c_url which enables even
@@ -4739,7 +4753,9 @@ inline void
 HttpSM::do_cache_prepare_write()
 {
   milestones[TS_MILESTONE_CACHE_OPEN_WRITE_BEGIN] = Thread::get_hrtime();
-  do_cache_prepare_action(&cache_sm, t_state.cache_info.object_read, true);
+  // A sparse alternate being filled in is updated by the write.
+  do_cache_prepare_action(&cache_sm,
+                          t_state.cache_info.object_read ? t_state.cache_info.object_read : t_state.cache_info.sparse_fill, true);
 }
 
 inline void
@@ -6442,8 +6458,12 @@ HttpSM::setup_cache_write_transfer(HttpCacheSM *c_sm, VConnection *source_vc, HT
   store_info->request_sent_time_set(t_state.request_sent_time);
   store_info->response_received_time_set(t_state.response_received_time);
 
+  bool sparse = store_info->is_sparse();
   c_sm->cache_write_vc->set_http_info(store_info);
   store_info->clear();
+  if (sparse) {
+    c_sm->cache_write_vc->set_write_offset(t_state.cache_info.sparse_offset);
+  }
 
   tunnel.add_consumer(c_sm->cache_write_vc, source_vc, &HttpSM::tunnel_handler_cache_write, HT_CACHE_WRITE, name, skip_bytes);
 
@@ -6621,6 +6641,25 @@ int
 HttpSM::find_http_resp_buffer_size(int64_t content_length)
 {
   int64_t alloc_index;
+  int64_t max_index     = t_state.http_config_param->max_payload_iobuf_index;
+  resp_buffer_hdr_bytes = t_state.hdr_info.client_response.valid() ? t_state.hdr_info.client_response.length_get() : 0;
+
+  if (t_state.http_config_param->adaptive_buffer_sizing) {
+    // Size for the header that is there, rather than a whole header buffer, and
+    // for the bodies seen for this remap rule and content type if there is no length.
+    HTTPHdr *resp     = t_state.hdr_info.server_response.valid() ? &t_state.hdr_info.server_response : nullptr;
+    int ctype_len     = 0;
+    const char *ctype = resp ? resp->value_get(MIME_FIELD_CONTENT_TYPE, MIME_LEN_CONTENT_TYPE, &ctype_len) : nullptr;
+    resp_buffer_key   = HttpBufferSizer::key(t_state.url_map.getMapping(), std::string_view(ctype, ctype ? ctype_len : 0));
+
+    HttpBufferClass body = content_length == HTTP_UNDEFINED_CL ? httpBufferSizer.guess(resp_buffer_key, max_index) :
+                                                                 HttpBufferClass::for_size(content_length, max_index);
+    if (body.valid()) {
+      int64_t body_size = content_length == HTTP_UNDEFINED_CL ? body.size() : content_length;
+      resp_buffer_class = HttpBufferClass::for_size(resp_buffer_hdr_bytes + body_size, max_index);
+      return resp_buffer_class.first_index();
+    }
+  }
 
   if (content_length == HTTP_UNDEFINED_CL) {
     // Try use our configured default size.  Otherwise pick
@@ -6631,12 +6670,30 @@ HttpSM::find_http_resp_buffer_size(int64_t content_length)
     }
   } else {
     int64_t buf_size = index_to_buffer_size(HTTP_HEADER_BUFFER_SIZE_INDEX) + content_length;
-    alloc_index      = buffer_size_to_index(buf_size, t_state.http_config_param->max_payload_iobuf_index);
+    alloc_index      = buffer_size_to_index(buf_size, max_index);
   }
 
+  // A single block size, kept to account for the space it wastes.
+  resp_buffer_class.c = 2 * alloc_index;
   return alloc_index;
 }
 
+// MIOBuffer *HttpSM::new_resp_buffer(int64_t alloc_index)
+//
+//   Allocates a response buffer of the index from find_http_resp_buffer_size,
+//     which grows by blocks of its size class
+//
+MIOBuffer *
+HttpSM::new_resp_buffer(int64_t alloc_index)
+{
+  MIOBuffer *buf = new_MIOBuffer(alloc_index);
+
+  if (resp_buffer_class.valid() && resp_buffer_class.first_index() == alloc_index) {
+    buf->size_index = resp_buffer_class.rest_index();
+  }
+  return buf;
+}
+
 // int HttpSM::server_transfer_init()
 //
 //    Moves data from the header buffer into the reply buffer
@@ -6688,7 +6745,7 @@ HttpSM::setup_server_transfer_to_transform()
   int64_t nbytes;
 
   alloc_index               = find_server_buffer_size();
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_resp_buffer(alloc_index);
   IOBufferReader *buf_start = buf->alloc_reader();
   nbytes                    = server_transfer_init(buf, 0);
 
@@ -6717,7 +6774,7 @@ HttpSM::setup_transfer_from_transform()
   int64_t alloc_index = find_server_buffer_size();
 
   // TODO change this call to new_empty_MIOBuffer()
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_resp_buffer(alloc_index);
   buf->water_mark           = static_cast<int>(t_state.txn_conf->default_buffer_water_mark);
   IOBufferReader *buf_start = buf->alloc_reader();
 
@@ -6755,7 +6812,7 @@ HttpTunnelProducer *
 HttpSM::setup_transfer_from_transform_to_cache_only()
 {
   int64_t alloc_index       = find_server_buffer_size();
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_resp_buffer(alloc_index);
   IOBufferReader *buf_start = buf->alloc_reader();
 
   HttpTunnelConsumer *c = tunnel.get_consumer(transform_info.vc);
@@ -6786,7 +6843,7 @@ HttpSM::setup_server_transfer_to_cache_only()
   int64_t nbytes;
 
   alloc_index               = find_server_buffer_size();
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_resp_buffer(alloc_index);
   IOBufferReader *buf_start = buf->alloc_reader();
 
   action = (t_state.current.server && t_state.current.server->transfer_encoding == HttpTransact::CHUNKED_ENCODING) ?
@@ -6817,7 +6874,7 @@ HttpSM::setup_server_transfer()
 
   alloc_index = find_server_buffer_size();
 #ifndef USE_NEW_EMPTY_MIOBUFFER
-  MIOBuffer *buf = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf = new_resp_buffer(alloc_index);
 #else
   MIOBuffer *buf = new_empty_MIOBuffer(alloc_index);
   buf->append_block(HTTP_HEADER_BUFFER_SIZE_INDEX);
@@ -6906,7 +6963,7 @@ HttpSM::setup_push_transfer_to_cache()
   int64_t nbytes, alloc_index;
 
   alloc_index               = find_http_resp_buffer_size(t_state.hdr_info.request_content_length);
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_resp_buffer(alloc_index);
   IOBufferReader *buf_start = buf->alloc_reader();
 
   ink_release_assert(t_state.hdr_info.request_content_length != HTTP_UNDEFINED_CL);
@@ -7230,6 +7287,14 @@ HttpSM::update_stats()
     }
   }
 
+  // How well the response buffer fit the body from the origin.
+  if (resp_buffer_class.valid() && server_response_body_bytes > 0) {
+    http_buffer_sizer_account(resp_buffer_class, resp_buffer_hdr_bytes + server_response_body_bytes);
+    if (resp_buffer_key) {
+      httpBufferSizer.learn(resp_buffer_key, server_response_body_bytes);
+    }
+  }
+
   ink_hrtime total_time = milestones.elapsed(TS_MILESTONE_SM_START, TS_MILESTONE_SM_FINISH);
 
   // ua_close will not be assigned properly in some exceptional situation.
@@ -40,6 +40,7 @@
 #include "HttpTransact.h"
 #include "UrlRewrite.h"
 #include "HttpTunnel.h"
+#include "HttpBufferSizer.h"
 #include "InkAPIInternal.h"
 #include "../ProxyTransaction.h"
 #include "HdrUtils.h"
@@ -522,6 +523,7 @@ protected:
   bool is_bg_fill_necessary(HttpTunnelConsumer *c);
   int find_server_buffer_size();
   int find_http_resp_buffer_size(int64_t cl);
+  MIOBuffer *new_resp_buffer(int64_t alloc_index);
   int64_t server_transfer_init(MIOBuffer *buf, int hdr_size);
 
   /// Update the milestones to track time spent in the plugin API.
@@ -561,6 +563,12 @@ public:
   int server_transact_count       = 0;
 
   TransactionMilestones milestones;
+
+  // Size class of the response buffer, and what it was picked for, see HttpBufferSizer.
+  HttpBufferClass resp_buffer_class;
+  uint64_t resp_buffer_key      = 0;
+  int64_t resp_buffer_hdr_bytes = 0;
+
   ink_hrtime api_timer = 0;
   // The next two enable plugins to tag the state machine for
   // the purposes of logging so the instances can be correlated
@@ -36,6 +36,7 @@
 #include "tscore/ParseRules.h"
 #include "tscore/Filenames.h"
 #include "tscore/bwf_std_format.h"
+#include "tscpp/util/TextView.h"
 #include "HTTP.h"
 #include "HdrUtils.h"
 #include "logging/Log.h"
@@ -762,6 +763,109 @@ does_method_effect_cache(int method)
            method == HTTP_WKSIDX_POST));
 }
 
+// The complete object sent in response to a range request may be cached.
+inline static bool
+is_range_cache_write_allowed(HttpTransact::State *s)
+{
+  return s->txn_conf->cache_range_write;
+}
+
+// A range request may open a cache write, for the complete object or for a sparse alternate if
+// the response turns out to be partial.
+inline static bool
+is_range_cache_open_write_allowed(HttpTransact::State *s)
+{
+  return is_range_cache_write_allowed(s) || s->http_config_param->cache_range_sparse;
+}
+
+// Parse a "bytes first-last/length" Content-Range value. The complete length must be given.
+inline static bool
+parse_content_range(HTTPHdr *response, int64_t &first, int64_t &last, int64_t &length)
+{
+  int len           = 0;
+  const char *value = response->value_get(MIME_FIELD_CONTENT_RANGE, MIME_LEN_CONTENT_RANGE, &len);
+  if (value == nullptr) {
+    return false;
+  }
+  ts::TextView text{value, static_cast<size_t>(len)};
+  ts::TextView unit = text.trim_if(&ParseRules::is_ws).take_prefix_at(' ');
+  if (strcasecmp(unit, std::string_view("bytes")) != 0) {
+    return false;
+  }
+  auto number = [](ts::TextView token, int64_t &n) -> bool {
+    ts::TextView parsed;
+    token.trim_if(&ParseRules::is_ws);
+    n = ts::svtoi(token, &parsed, 10);
+    return !token.empty() && parsed.size() == token.size();
+  };
+  ts::TextView first_text = text.take_prefix_at('-');
+  ts::TextView last_text  = text.take_prefix_at('/');
+  return number(first_text, first) && number(last_text, last) && number(text, length) && 0 <= first && first <= last &&
+         last < length;
+}
+
+// A partial response can be stored in a sparse alternate if it is a single range with a known
+// complete length, and has a validator to check other partial responses for the object against.
+inline static bool
+is_partial_response_storable(HttpTransact::State *s, HTTPHdr *request, HTTPHdr *response)
+{
+  int64_t first, last, length;
+  if (!s->http_config_param->cache_range_sparse || request->method_get_wksidx() != HTTP_WKSIDX_GET ||
+      !parse_content_range(response, first, last, length)) {
+    return false;
+  }
+  int len          = 0;
+  const char *etag = response->value_get(MIME_FIELD_ETAG, MIME_LEN_ETAG, &len);
+  if (etag) {
+    return !(len >= 2 && etag[0] == 'W' && etag[1] == '/');
+  }
+  return response->presence(MIME_PRESENCE_LAST_MODIFIED);
+}
+
+// Whether a partial response is for the same version of the object as a sparse alternate.
+inline static bool
+sparse_alternate_matches(HTTPInfo *alt, HTTPHdr *response, int64_t length)
+{
+  HTTPHdr *cached = alt->response_get();
+  if (alt->object_size_get() != length) {
+    return false;
+  }
+  int cached_len = 0, len = 0;
+  const char *cached_etag = cached->value_get(MIME_FIELD_ETAG, MIME_LEN_ETAG, &cached_len);
+  const char *etag        = response->value_get(MIME_FIELD_ETAG, MIME_LEN_ETAG, &len);
+  if (cached_etag || etag) {
+    return cached_etag && etag && cached_len == len && memcmp(cached_etag, etag, len) == 0;
+  }
+  return cached->get_last_modified() == response->get_last_modified();
+}
+
+// Turn the partial response headed for the cache into the headers of the complete object, marked
+// as sparse. The response is added to the sparse alternate being filled if it matches.
+static void
+set_sparse_headers_for_cache_write(HttpTransact::State *s)
+{
+  HTTPInfo *info   = &s->cache_info.object_store;
+  HTTPHdr *cached  = info->response_get();
+  int64_t first    = 0;
+  int64_t last     = 0;
+  int64_t length   = 0;
+  const char *text = http_hdr_reason_lookup(HTTP_STATUS_OK);
+
+  parse_content_range(cached, first, last, length);
+  cached->status_set(HTTP_STATUS_OK);
+  cached->reason_set(text, strlen(text));
+  cached->field_delete(MIME_FIELD_CONTENT_RANGE, MIME_LEN_CONTENT_RANGE);
+  cached->set_content_length(length);
+  info->sparse_set(length);
+  if (s->cache_info.sparse_fill && sparse_alternate_matches(s->cache_info.sparse_fill, &s->hdr_info.server_response, length)) {
+    CryptoHash key;
+    info->copy_frag_offsets_from(s->cache_info.sparse_fill);
+    s->cache_info.sparse_fill->object_key_get(&key);
+    info->object_key_set(key);
+  }
+  s->cache_info.sparse_offset = first;
+}
+
 inline static HttpTransact::StateMachineAction_t
 how_to_open_connection(HttpTransact::State *s)
 {
@@ -2022,7 +2126,7 @@ HttpTransact::OSDNSLookup(State *s)
       // Access Control is called after DNS response
     } else {
       if ((s->cache_info.action == CACHE_DO_NO_ACTION) &&
-          (((s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && !s->txn_conf->cache_range_write) ||
+          (((s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && !is_range_cache_open_write_allowed(s)) ||
             s->range_setup == RANGE_NOT_SATISFIABLE || s->range_setup == RANGE_NOT_HANDLED))) {
         TRANSACT_RETURN(SM_ACTION_API_OS_DNS, HandleCacheOpenReadMiss);
       } else if (!s->txn_conf->cache_http || s->cache_lookup_result == HttpTransact::CACHE_LOOKUP_SKIPPED) {
@@ -2822,6 +2926,21 @@ HttpTransact::HandleCacheOpenReadHit(State *s)
     send_revalidate     = true;
   }
 
+  // A sparse alternate is never revalidated or served whole, the object is fetched again instead.
+  if (obj->is_sparse() && s->api_update_cached_object != HttpTransact::UPDATE_CACHED_OBJECT_CONTINUE &&
+      (send_revalidate || s->method != HTTP_WKSIDX_GET || !s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) ||
+       s->hdr_info.client_request.presence(MIME_PRESENCE_IF_RANGE))) {
+    TxnDebug("http_seq", "Sparse object can't serve the request");
+    s->cache_lookup_result = CACHE_LOOKUP_MISS;
+    s->cache_info.action   = CACHE_DO_NO_ACTION;
+    if (s->force_dns) {
+      HandleCacheOpenReadMiss(s);
+    } else {
+      CallOSDNSLookup(s);
+    }
+    return;
+  }
+
   TxnDebug("http_trans", "CacheOpenRead --- needs_auth          = %d", needs_authenticate);
   TxnDebug("http_trans", "CacheOpenRead --- needs_revalidate    = %d", needs_revalidate);
   TxnDebug("http_trans", "CacheOpenRead --- response_returnable = %d", response_returnable);
@@ -3255,6 +3374,10 @@ HttpTransact::HandleCacheOpenReadMiss(State *s)
     s->next_action       = SM_ACTION_INTERNAL_CACHE_NOOP;
     return;
   }
+  // A sparse alternate which could not serve the request may be filled in by the response.
+  if (s->cache_info.object_read && s->cache_info.object_read->valid() && s->cache_info.object_read->is_sparse()) {
+    s->cache_info.sparse_fill = s->cache_info.object_read;
+  }
   // reinitialize some variables to reflect cache miss state.
   s->cache_info.object_read = nullptr;
   s->request_sent_time      = UNDEFINED_TIME;
@@ -3267,7 +3390,7 @@ HttpTransact::HandleCacheOpenReadMiss(State *s)
   // We must, however, not cache the responses to these requests.
   if (does_method_require_cache_copy_deletion(s->http_config_param, s->method) && s->api_req_cacheable == false) {
     s->cache_info.action = CACHE_DO_NO_ACTION;
-  } else if ((s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && !s->txn_conf->cache_range_write) ||
+  } else if ((s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && !is_range_cache_open_write_allowed(s)) ||
              does_method_effect_cache(s->method) == false || s->range_setup == RANGE_NOT_SATISFIABLE ||
              s->range_setup == RANGE_NOT_HANDLED) {
     s->cache_info.action = CACHE_DO_NO_ACTION;
@@ -4438,7 +4561,7 @@ HttpTransact::handle_cache_operation_on_forward_server_response(State *s)
         ink_assert(s->cache_info.object_read != nullptr);
         s->cache_info.action = CACHE_DO_REPLACE;
 
-        if (s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE)) {
+        if (s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && server_response_code != HTTP_STATUS_PARTIAL_CONTENT) {
           s->state_machine->do_range_setup_if_necessary();
         }
       }
@@ -4448,9 +4571,13 @@ HttpTransact::handle_cache_operation_on_forward_server_response(State *s)
         s->cache_info.action = CACHE_DO_NO_ACTION;
       } else if (s->method == HTTP_WKSIDX_HEAD) {
         s->cache_info.action = CACHE_DO_NO_ACTION;
+      } else if (s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && server_response_code != HTTP_STATUS_PARTIAL_CONTENT &&
+                 !is_range_cache_write_allowed(s)) {
+        // The write was opened for a sparse alternate, but the origin sent something other than a partial response.
+        s->cache_info.action = CACHE_DO_NO_ACTION;
       } else {
         s->cache_info.action = CACHE_DO_WRITE;
-        if (s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE)) {
+        if (s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && server_response_code != HTTP_STATUS_PARTIAL_CONTENT) {
           s->state_machine->do_range_setup_if_necessary();
         }
       }
@@ -4589,6 +4716,9 @@ HttpTransact::handle_cache_operation_on_forward_server_response(State *s)
 
   if ((s->cache_info.action == CACHE_DO_WRITE) || (s->cache_info.action == CACHE_DO_REPLACE)) {
     set_headers_for_cache_write(s, &s->cache_info.object_store, &s->hdr_info.server_request, &s->hdr_info.server_response);
+    if (server_response_code == HTTP_STATUS_PARTIAL_CONTENT) {
+      set_sparse_headers_for_cache_write(s);
+    }
   }
   // 304, 412, and 416 responses are handled here
   if ((client_response_code == HTTP_STATUS_NOT_MODIFIED) || (client_response_code == HTTP_STATUS_PRECONDITION_FAILED)) {
@@ -6267,8 +6397,9 @@ HttpTransact::is_response_cacheable(State *s, HTTPHdr *request, HTTPHdr *respons
       }
     }
   }
-  // do not cache partial content - Range response
-  if (response_code == HTTP_STATUS_PARTIAL_CONTENT || response_code == HTTP_STATUS_RANGE_NOT_SATISFIABLE) {
+  // do not cache partial content - Range response, unless it can be stored in a sparse alternate
+  if ((response_code == HTTP_STATUS_PARTIAL_CONTENT && !is_partial_response_storable(s, request, response)) ||
+      response_code == HTTP_STATUS_RANGE_NOT_SATISFIABLE) {
     TxnDebug("http_trans", "response code %d - don't cache", response_code);
     return false;
   }
@@ -7624,7 +7755,7 @@ HttpTransact::is_request_likely_cacheable(State *s, HTTPHdr *request)
 {
   if ((s->method == HTTP_WKSIDX_GET || s->api_req_cacheable) && !s->api_server_response_no_store &&
       !request->presence(MIME_PRESENCE_AUTHORIZATION) &&
-      (!request->presence(MIME_PRESENCE_RANGE) || s->txn_conf->cache_range_write)) {
+      (!request->presence(MIME_PRESENCE_RANGE) || is_range_cache_open_write_allowed(s))) {
     return true;
   }
   return false;
@@ -7683,6 +7814,14 @@ HttpTransact::build_request(State *s, HTTPHdr *base_request, HTTPHdr *outgoing_r
     HttpTransactHeaders::insert_via_header_in_request(s, outgoing_request);
   }
 
+  // The peer marker is for one hop only, a peer that forwards the request upstream drops it.
+  if (s->current.request_to == ResolveInfo::PARENT_PROXY && s->parent_result.to_peer) {
+    std::string const &self = Machine::instance()->host_name;
+    outgoing_request->value_set(NH_PEER_HEADER.data(), NH_PEER_HEADER.size(), self.data(), self.size());
+  } else {
+    outgoing_request->field_delete(NH_PEER_HEADER.data(), NH_PEER_HEADER.size());
+  }
+
   // We build 1.1 request header and then convert as necessary to
   //  the appropriate version in HttpTransact::build_request
   outgoing_request->version_set(HTTP_1_1);
@@ -494,6 +494,8 @@ public:
     HTTPInfo transform_store;
     CacheDirectives directives;
     HTTPInfo *object_read             = nullptr;
+    HTTPInfo *sparse_fill             = nullptr; ///< Sparse alternate a partial response may add to.
+    int64_t sparse_offset             = -1;      ///< Offset of a partial response being stored.
     int open_read_retries             = 0;
     int open_write_retries            = 0;
     CacheWriteLock_t write_lock_state = CACHE_WL_INIT;
@@ -109,6 +109,14 @@ NextHopConsistentHash::NextHopConsistentHash(const std::string_view name, const
                 strategy_name.c_str(), hash_key_path.data());
       }
     }
+    if (n["load_bound"]) {
+      load_bound = n["load_bound"].as<float>();
+      if (load_bound < 0) {
+        NH_Note("Invalid 'load_bound' value, '%f', for the strategy named '%s', the load will not be bounded.", load_bound,
+                strategy_name.c_str());
+        load_bound = 0;
+      }
+    }
   } catch (std::exception &ex) {
     throw std::invalid_argument("Error parsing the strategy named '" + strategy_name + "' due to '" + ex.what() +
                                 "', this strategy will be ignored.");
@@ -132,6 +140,7 @@ NextHopConsistentHash::NextHopConsistentHash(const std::string_view name, const
       NH_Debug(NH_DEBUG_TAG, "Loading hash rings - ring: %d, host record: %d, name: %s, hostname: %s, strategy: %s", i, j, p->name,
                p->hostname.c_str(), strategy_name.c_str());
     }
+    hash_ring->set_load_bound(load_bound);
     hash.clear();
     rings.push_back(std::move(hash_ring));
   }
@@ -266,6 +275,16 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
       result.chash_init[i] = false;
       wrap_around[i]       = false;
     }
+    // a request from a peer goes upstream, never to another peer.  Peers do not always agree on which
+    // peers are down, so a second peer hop could send the request back where it came from.  A client
+    // can not set the marker to get around the peers.
+    if (ring_mode == NH_PEERING_RING && request_info.hdr &&
+        request_info.hdr->field_find(NH_PEER_HEADER.data(), NH_PEER_HEADER.size()) != nullptr &&
+        isPeerAddr(request_info.get_client_ip())) {
+      NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] request is from a peer, skipping the peering ring", sm_id);
+      wrap_around[0] = true;
+      cur_ring       = (groups == 1) ? NO_RING_USE_POST_REMAP : 1;
+    }
   } else {
     // not first call, save the previously tried parent.
     if (result.hostname) {
@@ -335,7 +354,7 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
         if (firstcall) {
           result.first_choice_status = (hst) ? hst->status : TSHostStatus::TS_HOST_STATUS_UP;
           // if peering and the selected host is myself, change rings and search for an upstream parent.
-          if (ring_mode == NH_PEERING_RING && (pRec->self || is_self)) {
+          if (ring_mode == NH_PEERING_RING && (pRec->self || (is_self && self_port == 0))) {
             if (groups == 1) {
               // use host from post-remap URL
               cur_ring = NO_RING_USE_POST_REMAP;
@@ -350,7 +369,8 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
           }
         } else {
           // not first call, make sure we're not re-using the same parent, search again if we are.
-          if (first_call_host.size() > 0 && first_call_host == pRec->hostname && first_call_port == pRec->getPort(scheme)) {
+          if ((first_call_host.size() > 0 && first_call_host == pRec->hostname && first_call_port == pRec->getPort(scheme)) ||
+              (ring_mode == NH_PEERING_RING && pRec->self)) {
             pRec = nullptr;
             continue;
           }
@@ -359,7 +379,10 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
         // for retry.
         if (!pRec->available.load() && host_stat == TS_HOST_STATUS_UP) {
           _now == 0 ? _now = time(nullptr) : _now = now;
-          if ((pRec->failedAt.load() + retry_time) < static_cast<unsigned>(_now)) {
+          time_t failed_at = pRec->failedAt.load();
+          // a peer is retried by one transaction at a time, the others go upstream until it is marked up or down again.
+          if ((failed_at + retry_time) < static_cast<unsigned>(_now) &&
+              (ring_mode != NH_PEERING_RING || cur_ring != 0 || pRec->failedAt.compare_exchange_strong(failed_at, _now))) {
             nextHopRetry       = true;
             result.last_parent = pRec->host_index;
             result.last_lookup = pRec->group_index;
@@ -424,7 +447,8 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
       result.port = pRec->getPort(scheme);
       break;
     }
-    result.retry = nextHopRetry;
+    result.retry   = nextHopRetry;
+    result.to_peer = ring_mode == NH_PEERING_RING && cur_ring == 0;
     // if using a peering ring mode and the parent selected came from the 'peering' group,
     // cur_ring == 0, then if the config allows it, set the flag to not cache the result.
     if (ring_mode == NH_PEERING_RING && !cache_peer_result && cur_ring == 0) {
@@ -445,6 +469,7 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
     result.hostname = nullptr;
     result.port     = 0;
     result.retry    = false;
+    result.to_peer  = false;
     NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] result.result: %s set hostname null port 0 retry false", sm_id,
              ParentResultStr[result.result]);
   }
@@ -45,6 +45,7 @@ class NextHopConsistentHash : public NextHopSelectionStrategy
 
 public:
   NHHashKeyType hash_key = NH_PATH_HASH_KEY;
+  float load_bound       = 0; ///< Allowed excess load of a host over its share, 0 if unbounded.
 
   NextHopConsistentHash() = delete;
   NextHopConsistentHash(const std::string_view name, const NHPolicyType &policy, ts::Yaml::Map &n);
@@ -21,12 +21,14 @@
   limitations under the License.
  */
 
+#include <algorithm>
 #include <optional>
 
 #include <yaml-cpp/yaml.h>
 #include <YamlCfg.h>
 #include "I_Machine.h"
 #include "HttpSM.h"
+#include "P_HostDB.h"
 #include "NextHopSelectionStrategy.h"
 
 // ring mode strings
@@ -97,7 +99,18 @@ NextHopSelectionStrategy::NextHopSelectionStrategy(const std::string_view &name,
           YAML::Node self_node = failover_node["self"];
           if (self_node) {
             self_host = self_node.Scalar();
-            NH_Debug(NH_DEBUG_TAG, "%s is self", self_host.c_str());
+            // a port tells this host apart from peers that run on the same machine.
+            auto colon = self_host.rfind(':');
+            if (colon != std::string::npos && self_host.find(':') == colon) {
+              ts::TextView port_text{self_host.data() + colon + 1, self_host.size() - colon - 1};
+              ts::TextView parsed;
+              self_port = ts::svtoi(port_text, &parsed, 10);
+              if (port_text.empty() || parsed.size() != port_text.size() || self_port < 1 || self_port > 65535) {
+                throw std::invalid_argument("self host (" + self_host + ") has an invalid port");
+              }
+              self_host.erase(colon);
+            }
+            NH_Debug(NH_DEBUG_TAG, "%s port %d is self", self_host.c_str(), self_port);
           }
         } else {
           ring_mode = NH_ALTERNATE_RING;
@@ -204,12 +217,24 @@ NextHopSelectionStrategy::NextHopSelectionStrategy(const std::string_view &name,
               std::shared_ptr<HostRecord> host_rec = std::make_shared<HostRecord>(hosts_list[hst].as<HostRecordCfg>());
               host_rec->group_index                = grp;
               host_rec->host_index                 = hst;
-              if ((self_host == host_rec->hostname) || mach->is_self(host_rec->hostname.c_str())) {
+              bool is_self = false;
+              if (self_port != 0) {
+                // other hosts with this name are peers on the same machine, only the port identifies self.
+                is_self = self_host == host_rec->hostname &&
+                          std::any_of(host_rec->protocols.begin(), host_rec->protocols.end(),
+                                      [this](std::shared_ptr<NHProtocol> const &p) { return p->port == uint32_t(self_port); });
+              } else {
+                is_self = (self_host == host_rec->hostname) || mach->is_self(host_rec->hostname.c_str());
+              }
+              if (is_self) {
                 if (ring_mode == NH_PEERING_RING && grp != 0) {
                   throw std::invalid_argument("self host (" + self_host +
                                               ") can only appear in first host group for peering ring mode");
                 }
-                h_stat.setHostStatus(host_rec->hostname.c_str(), TSHostStatus::TS_HOST_STATUS_DOWN, 0, Reason::SELF_DETECT);
+                // a host status is by name, which would mark down the other peers that share it.
+                if (self_port == 0) {
+                  h_stat.setHostStatus(host_rec->hostname.c_str(), TSHostStatus::TS_HOST_STATUS_DOWN, 0, Reason::SELF_DETECT);
+                }
                 host_rec->self = true;
                 self_host_used = true;
               }
@@ -245,7 +270,148 @@ NextHopSelectionStrategy::NextHopSelectionStrategy(const std::string_view &name,
       throw std::invalid_argument("ring mode '" + std::string(peering_rings) +
                                   "' is only implemented for a 'consistent_hash' policy");
     }
+    // only a request from one of these hosts is taken to come from a peer, they are resolved by resolvePeers().
+    for (auto const &host_rec : host_groups[0]) {
+      peer_hosts.push_back(host_rec->hostname);
+    }
+  }
+}
+
+bool
+NextHopSelectionStrategy::isPeerAddr(sockaddr const *ip) const
+{
+  return std::atomic_load(&peer_addrs)->contains(ip);
+}
+
+void
+NextHopSelectionStrategy::setPeerAddrs(std::shared_ptr<const IpMap> addrs)
+{
+  std::atomic_store(&peer_addrs, std::move(addrs));
+}
+
+#ifndef _NH_UNIT_TESTS_
+// how often the peering ring hosts are looked up again.  The HostDB answers from its cache until
+// the DNS TTL of a host runs out, so a refresh mostly costs a cache probe per host.
+static constexpr ink_hrtime NH_PEER_REFRESH = HRTIME_SECONDS(60);
+
+// Looks up the peering ring hosts of a strategy in the HostDB, for both address families, and
+// hands their addresses to the strategy.  A host that does not resolve keeps the addresses it had
+// before.  The lookups repeat until the strategy is gone, that is until a reload replaced it.
+class NextHopPeerResolver : public Continuation
+{
+public:
+  explicit NextHopPeerResolver(std::shared_ptr<NextHopSelectionStrategy> const &strategy)
+    : Continuation(new_ProxyMutex()),
+      strategy(strategy),
+      hosts(strategy->peer_hosts),
+      addrs(hosts.size()),
+      unresolved(hosts.size(), false)
+  {
+    SET_HANDLER(&NextHopPeerResolver::resolveEvent);
+  }
+
+  int resolveEvent(int event, void *data);
+
+private:
+  void lookup();
+  void publish();
+
+  std::weak_ptr<NextHopSelectionStrategy> strategy;
+  std::vector<std::string> hosts;
+  std::vector<std::vector<IpAddr>> addrs; // addresses of each host, as last resolved.
+  std::vector<std::vector<IpAddr>> found; // addresses of each host found in this round.
+  std::vector<bool> unresolved;           // the host did not resolve last round, it was warned about.
+  size_t next  = 0;                       // the next lookup, two for each host.
+  bool waiting = false;                   // a lookup answers later.
+};
+
+int
+NextHopPeerResolver::resolveEvent(int event, void *data)
+{
+  if (event == EVENT_HOST_DB_LOOKUP) {
+    HostDBRecord *r = static_cast<HostDBRecord *>(data);
+    if (r && !r->is_failed()) {
+      for (auto const &info : r->rr_info()) {
+        found[next / 2].push_back(info.data.ip);
+      }
+    }
+    ++next;
+    if (!waiting) {
+      return EVENT_DONE; // answered from within getbyname_re(), lookup() goes on.
+    }
+    waiting = false;
+  } else {
+    // start a round, unless the strategy is gone.
+    if (strategy.expired()) {
+      delete this;
+      return EVENT_DONE;
+    }
+    next = 0;
+    found.assign(hosts.size(), {});
+  }
+  lookup();
+  return EVENT_DONE;
+}
+
+void
+NextHopPeerResolver::lookup()
+{
+  while (next < 2 * hosts.size()) {
+    std::string const &host = hosts[next / 2];
+    HostDBProcessor::Options opt;
+    size_t current = next;
+
+    opt.host_res_style = (next % 2 == 0) ? HOST_RES_IPV4_ONLY : HOST_RES_IPV6_ONLY;
+    if (hostDBProcessor.getbyname_re(this, host.c_str(), host.size(), opt) != ACTION_RESULT_DONE) {
+      waiting = true;
+      return;
+    }
+    if (next == current) {
+      ++next; // done without an answer.
+    }
+  }
+  publish();
+}
+
+void
+NextHopPeerResolver::publish()
+{
+  std::shared_ptr<NextHopSelectionStrategy> strat = strategy.lock();
+  if (!strat) {
+    delete this;
+    return;
+  }
+
+  auto peers = std::make_shared<IpMap>();
+  for (size_t i = 0; i < hosts.size(); ++i) {
+    if (!found[i].empty()) {
+      addrs[i]      = std::move(found[i]);
+      unresolved[i] = false;
+    } else if (!unresolved[i]) {
+      NH_Warn("Could not resolve the peer '%s' of the strategy named '%s', %s.", hosts[i].c_str(),
+              strat->strategy_name.c_str(),
+              addrs[i].empty() ? "requests from it are treated as client requests" : "keeping its previous addresses");
+      unresolved[i] = true;
+    }
+    for (auto const &ip : addrs[i]) {
+      peers->mark(ip, ip);
+    }
+  }
+  NH_Debug(NH_DEBUG_TAG, "strategy '%s' has %zu peer addresses", strat->strategy_name.c_str(), peers->count());
+  strat->setPeerAddrs(std::move(peers));
+
+  eventProcessor.schedule_in(this, NH_PEER_REFRESH, ET_TASK);
+}
+#endif /* _NH_UNIT_TESTS_ */
+
+void
+NextHopSelectionStrategy::resolvePeers(std::shared_ptr<NextHopSelectionStrategy> const &strategy)
+{
+#ifndef _NH_UNIT_TESTS_
+  if (!strategy->peer_hosts.empty()) {
+    eventProcessor.schedule_imm(new NextHopPeerResolver(strategy), ET_TASK);
   }
+#endif /* _NH_UNIT_TESTS_ */
 }
 
 void
@@ -23,9 +23,11 @@
 
 #pragma once
 
+#include <memory>
 #include <utility>
 
 #include "ts/parentselectdefs.h"
+#include "tscore/IpMap.h"
 #include "ParentSelection.h"
 #include "HttpTransact.h"
 
@@ -41,6 +43,10 @@
 
 constexpr const char *NH_DEBUG_TAG = "next_hop";
 
+// marks a request sent to a peer in peering_ring mode, a peer does not forward such a request to another peer.
+// The field is trusted only on requests from the address of a peer.
+constexpr std::string_view NH_PEER_HEADER = "X-Nexthop-Peer";
+
 namespace ts
 {
 namespace Yaml
@@ -205,6 +211,13 @@ public:
 
   void retryComplete(TSHttpTxn txn, const char *hostname, const int port);
 
+  // true if @a ip is an address of a peering ring host.
+  bool isPeerAddr(sockaddr const *ip) const;
+  // replace the addresses of the peering ring hosts, safe while requests are being routed.
+  void setPeerAddrs(std::shared_ptr<const IpMap> addrs);
+  // resolve the peering ring hosts of @a strategy through the HostDB, and again every so often.
+  static void resolvePeers(std::shared_ptr<NextHopSelectionStrategy> const &strategy);
+
   std::string strategy_name;
   bool go_direct           = true;
   bool parent_is_proxy     = true;
@@ -225,4 +238,9 @@ public:
   uint32_t hst_index               = 0;
   uint32_t num_parents             = 0;
   uint32_t distance                = 0; // index into the strategies list.
+  int self_port                    = 0; // port of the self host, when several peers share a host.
+  std::vector<std::string> peer_hosts;  // names of the peering ring hosts.
+
+private:
+  std::shared_ptr<const IpMap> peer_addrs = std::make_shared<IpMap>(); // addresses of the peering ring hosts.
 };
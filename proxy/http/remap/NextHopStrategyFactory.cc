@@ -151,11 +151,13 @@ NextHopStrategyFactory::createStrategy(const std::string &name, const NHPolicyTy
     case NH_CONSISTENT_HASH:
       strat_chash = std::make_shared<NextHopConsistentHash>(name, policy_type, node);
       _strategies.emplace(std::make_pair(std::string(name), strat_chash));
+      NextHopSelectionStrategy::resolvePeers(strat_chash);
       break;
     default: // handles P_UNDEFINED, no strategy is added
       break;
     };
   } catch (std::exception &ex) {
+    NH_Error("%s", ex.what());
     strat.reset();
   }
 }
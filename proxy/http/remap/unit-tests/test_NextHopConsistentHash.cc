@@ -655,5 +655,135 @@ SCENARIO("Testing NextHopConsistentHash using a peering ring_mode.")
         }
       }
     }
+
+    WHEN("requests are received.")
+    {
+      HttpSM sm;
+      ParentResult *result = &sm.t_state.parent_result;
+      TSHttpTxn txnp       = reinterpret_cast<TSHttpTxn>(&sm);
+      time_t now           = time(nullptr);
+
+      // the peer marker is only trusted on requests from a peer address.
+      IpEndpoint peer_ip, client_ip;
+      ats_ip_pton("192.0.2.1", &peer_ip);
+      ats_ip_pton("198.51.100.1", &client_ip);
+      auto peers = std::make_shared<IpMap>();
+      peers->mark(&peer_ip);
+      strategy->setPeerAddrs(peers);
+
+      auto request = [&](int64_t id, std::string const &path, bool from_peer, bool forged = false) {
+        build_request(id, &sm, from_peer ? &peer_ip.sin : &client_ip.sin, "rabbit.net", nullptr);
+        sm.t_state.request_data.hdr->url_get()->path_set(path.data(), path.size());
+        if (from_peer || forged) {
+          sm.t_state.request_data.hdr->value_set(NH_PEER_HEADER.data(), NH_PEER_HEADER.size(), "p1.bar.com", 10);
+        }
+        result->reset();
+        strategy->findNextHop(txnp, nullptr, now);
+        REQUIRE(result->result == ParentResultType::PARENT_SPECIFIED);
+      };
+      auto in_group = [&](uint32_t grp) {
+        for (auto const &h : strategy->host_groups[grp]) {
+          if (h->hostname == result->hostname) {
+            return true;
+          }
+        }
+        return false;
+      };
+
+      THEN("the owning peer is chosen, or an upstream parent when the owner is self.")
+      {
+        int to_peer = 0;
+        int to_self = 0;
+        for (int i = 0; i < 64; ++i) {
+          request(40000 + i, "asset" + std::to_string(i), false);
+          if (result->to_peer) {
+            ++to_peer;
+            CHECK(in_group(0));
+            CHECK(strcmp(result->hostname, "p3.bar.com") != 0);
+            CHECK(result->do_not_cache_response);
+          } else {
+            ++to_self;
+            CHECK(in_group(1));
+          }
+        }
+        CHECK(to_peer > 0);
+        CHECK(to_self > 0);
+      }
+
+      THEN("a request from a peer is not sent to another peer.")
+      {
+        for (int i = 0; i < 64; ++i) {
+          request(41000 + i, "asset" + std::to_string(i), true);
+          CHECK(!result->to_peer);
+          CHECK(in_group(1));
+        }
+      }
+
+      THEN("a peer marker from a client that is not a peer is ignored.")
+      {
+        int to_peer = 0;
+        for (int i = 0; i < 64; ++i) {
+          request(41100 + i, "asset" + std::to_string(i), false, true);
+          if (result->to_peer) {
+            ++to_peer;
+          }
+        }
+        CHECK(to_peer > 0);
+      }
+
+      THEN("a peer that is down is retried by one request at a time.")
+      {
+        int i = 0;
+        do {
+          request(42000 + i, "asset" + std::to_string(i), false);
+        } while (!result->to_peer && ++i < 64);
+        REQUIRE(result->to_peer);
+        std::string peer = result->hostname;
+        std::string path = "asset" + std::to_string(i);
+
+        // the stubs use a failure threshold of 1, this marks the peer down.
+        strategy->markNextHop(txnp, result->hostname, result->port, NH_MARK_DOWN, nullptr, now);
+        request(42100, path, false);
+        CHECK(peer != result->hostname);
+
+        // the retry window is 1 second.
+        now += 5;
+        request(42101, path, false);
+        CHECK(peer == result->hostname);
+        CHECK(result->retry);
+        ParentResult probe = *result;
+        request(42102, path, false);
+        CHECK(peer != result->hostname);
+        CHECK(!result->retry);
+
+        // the peer answers the retry.
+        *result = probe;
+        strategy->markNextHop(txnp, probe.hostname, probe.port, NH_MARK_UP, nullptr, now);
+        request(42103, path, false);
+        CHECK(peer == result->hostname);
+        CHECK(!result->retry);
+      }
+      // free up request resources.
+      br_destroy(sm);
+    }
+  }
+
+  GIVEN("Loading the peering.yaml config with peers that share a host.")
+  {
+    std::shared_ptr<NextHopSelectionStrategy> strategy;
+    NextHopStrategyFactory nhf(TS_SRC_DIR "unit-tests/peering.yaml");
+    strategy = nhf.strategyInstance("peering-group-2");
+
+    THEN("only the host with the self port is self.")
+    {
+      REQUIRE(strategy != nullptr);
+      REQUIRE(strategy->self_port == 9080);
+      for (std::size_t i = 0; i < strategy->host_groups.size(); ++i) {
+        for (auto const &elem : strategy->host_groups[i]) {
+          bool should_be_self = elem->hostname == "p4.bar.com" && elem->getPort(NH_SCHEME_HTTP) == 9080;
+          REQUIRE(elem->self == should_be_self);
+        }
+      }
+    }
   }
 }
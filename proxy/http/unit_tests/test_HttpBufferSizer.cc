@@ -0,0 +1,136 @@
+/** @file
+
+  Unit tests for HttpBufferSizer.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <memory>
+
+#include "catch.hpp"
+
+#include "HttpBufferSizer.h"
+
+TEST_CASE("HttpBufferClass", "[http][buffer]")
+{
+  SECTION("sizes")
+  {
+    HttpBufferClass bc = HttpBufferClass::for_size(1, MAX_BUFFER_SIZE_INDEX);
+    REQUIRE(bc.c == 0);
+    REQUIRE(bc.size() == 128);
+
+    // No class between 128 and 256.
+    bc = HttpBufferClass::for_size(129, MAX_BUFFER_SIZE_INDEX);
+    REQUIRE(bc.size() == 256);
+    REQUIRE(bc.first_index() == BUFFER_SIZE_INDEX_256);
+
+    bc = HttpBufferClass::for_size(8 * 1024 + 1, MAX_BUFFER_SIZE_INDEX);
+    REQUIRE(bc.size() == 12 * 1024);
+    REQUIRE(bc.first_index() == BUFFER_SIZE_INDEX_8K);
+    REQUIRE(bc.rest_index() == BUFFER_SIZE_INDEX_4K);
+
+    bc = HttpBufferClass::for_size(12 * 1024 + 1, MAX_BUFFER_SIZE_INDEX);
+    REQUIRE(bc.size() == 16 * 1024);
+    REQUIRE(bc.first_index() == bc.rest_index());
+
+    // Nothing bigger than the largest block allowed.
+    bc = HttpBufferClass::for_size(1 << 20, BUFFER_SIZE_INDEX_32K);
+    REQUIRE(bc.first_index() == BUFFER_SIZE_INDEX_32K);
+    REQUIRE(bc.rest_index() == BUFFER_SIZE_INDEX_32K);
+  }
+
+  SECTION("classes grow")
+  {
+    for (int c = 2; c < HttpBufferSizer::CLASSES; ++c) {
+      HttpBufferClass lo{c - 1}, hi{c};
+      if (c != 2) {
+        REQUIRE(lo.size() < hi.size());
+      }
+      REQUIRE(HttpBufferClass::for_size(hi.size(), MAX_BUFFER_SIZE_INDEX).c == c);
+    }
+  }
+
+  SECTION("capacity")
+  {
+    HttpBufferClass bc = HttpBufferClass::for_size(9 * 1024, MAX_BUFFER_SIZE_INDEX);
+    REQUIRE(bc.capacity(100) == 8 * 1024);
+    REQUIRE(bc.capacity(9 * 1024) == 12 * 1024);
+    // Past the class, the buffer grows by the smaller blocks.
+    REQUIRE(bc.capacity(13 * 1024) == 16 * 1024);
+    REQUIRE(bc.capacity(17 * 1024) == 20 * 1024);
+  }
+}
+
+TEST_CASE("HttpBufferSizer", "[http][buffer]")
+{
+  auto sizer        = std::make_unique<HttpBufferSizer>();
+  uint64_t json     = HttpBufferSizer::key(nullptr, "application/json");
+  uint64_t html     = HttpBufferSizer::key(nullptr, "text/html; charset=utf-8");
+  int mapping_value = 0;
+
+  REQUIRE(html == HttpBufferSizer::key(nullptr, "text/html"));
+  REQUIRE(json != HttpBufferSizer::key(&mapping_value, "application/json"));
+
+  SECTION("needs samples")
+  {
+    for (uint32_t i = 1; i < HttpBufferSizer::MIN_SAMPLES; ++i) {
+      sizer->learn(json, 1000);
+    }
+    REQUIRE(!sizer->guess(json, MAX_BUFFER_SIZE_INDEX).valid());
+    sizer->learn(json, 1000);
+    REQUIRE(sizer->guess(json, MAX_BUFFER_SIZE_INDEX).size() == 1024);
+    REQUIRE(!sizer->guess(html, MAX_BUFFER_SIZE_INDEX).valid());
+  }
+
+  SECTION("covers most bodies")
+  {
+    // 95 bodies of 9K and 5 of 200K, the class holds the 9K ones.
+    for (int i = 0; i < 100; ++i) {
+      sizer->learn(html, i % 20 == 0 ? 200 * 1024 : 9 * 1024);
+    }
+    HttpBufferClass bc = sizer->guess(html, MAX_BUFFER_SIZE_INDEX);
+    REQUIRE(bc.size() == 12 * 1024);
+
+    // Limited to the largest block allowed.
+    for (int i = 0; i < 100; ++i) {
+      sizer->learn(html, 200 * 1024);
+    }
+    REQUIRE(sizer->guess(html, BUFFER_SIZE_INDEX_32K).first_index() == BUFFER_SIZE_INDEX_32K);
+  }
+
+  SECTION("follows changes")
+  {
+    for (uint32_t i = 0; i < HttpBufferSizer::MAX_SAMPLES; ++i) {
+      sizer->learn(json, 100 * 1024);
+    }
+    for (uint32_t i = 0; i < 4 * HttpBufferSizer::MAX_SAMPLES; ++i) {
+      sizer->learn(json, 2000);
+    }
+    REQUIRE(sizer->guess(json, MAX_BUFFER_SIZE_INDEX).size() == 2048);
+  }
+
+  SECTION("clear")
+  {
+    for (uint32_t i = 0; i < HttpBufferSizer::MIN_SAMPLES; ++i) {
+      sizer->learn(json, 1000);
+    }
+    sizer->clear();
+    REQUIRE(!sizer->guess(json, MAX_BUFFER_SIZE_INDEX).valid());
+  }
+}
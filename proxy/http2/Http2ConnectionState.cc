@@ -1702,7 +1702,9 @@ Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_len
   Http2StreamDebug(session, stream->get_id(), "Send a DATA frame - client window con: %5zd stream: %5zd payload: %5zd",
                    _client_rwnd, stream->client_rwnd(), payload_length);
 
-  Http2DataFrame data(stream->get_id(), flags, resp_reader, payload_length);
+  // Without TLS the body blocks can go to the socket as they are, TLS writes a record per block.
+  bool zero_copy = this->session->get_proxy_session()->ssl() == nullptr;
+  Http2DataFrame data(stream->get_id(), flags, resp_reader, payload_length, zero_copy);
   this->session->xmit(data, flags & HTTP2_FLAGS_DATA_END_STREAM);
 
   if (flags & HTTP2_FLAGS_DATA_END_STREAM) {
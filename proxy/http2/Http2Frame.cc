@@ -53,15 +53,29 @@ Http2DataFrame::write_to(MIOBuffer *iobuffer) const
   // Write frame header
   uint8_t buf[HTTP2_FRAME_HEADER_LEN];
   http2_write_frame_header(this->_hdr, make_iovec(buf));
-  int64_t len = iobuffer->write(buf, sizeof(buf));
+  int64_t len = sizeof(buf);
+  if (this->_zero_copy && iobuffer->block_write_avail() < len) {
+    // The last block is likely a cloned payload, don't allocate a block of the buffer's size for the header
+    IOBufferBlock *b = new_IOBufferBlock();
+    b->alloc(BUFFER_SIZE_INDEX_128);
+    memcpy(b->end(), buf, len);
+    b->fill(len);
+    iobuffer->append_block(b);
+  } else {
+    len = iobuffer->write(buf, sizeof(buf));
+  }
 
   // Write frame payload
   if (this->_reader && this->_payload_len > 0) {
     int64_t written = 0;
-    // Fill current IOBufferBlock as much as possible to reduce SSL_write() calls
     while (written < this->_payload_len) {
       int64_t read_len = std::min(this->_payload_len - written, this->_reader->block_read_avail());
-      written += iobuffer->write(this->_reader->start(), read_len);
+      if (this->_zero_copy && read_len >= ZERO_COPY_MIN_LEN) {
+        written += iobuffer->write(this->_reader, read_len);
+      } else {
+        // Fill current IOBufferBlock as much as possible to reduce SSL_write() calls
+        written += iobuffer->write(this->_reader->start(), read_len);
+      }
       this->_reader->consume(read_len);
     }
     len += written;
@@ -71,8 +71,16 @@ protected:
 class Http2DataFrame : public Http2TxFrame
 {
 public:
-  Http2DataFrame(Http2StreamId stream_id, uint8_t flags, IOBufferReader *r, uint32_t l)
-    : Http2TxFrame({l, HTTP2_FRAME_TYPE_DATA, flags, stream_id}), _reader(r), _payload_len(l)
+  /// Payload pieces at least this long are referred to rather than copied, if @a zero_copy is set.
+  static constexpr int64_t ZERO_COPY_MIN_LEN = 4096;
+
+  /**
+     With @a zero_copy the payload blocks of @a r are cloned into the output instead of copied, so
+     that the body goes from the producer's blocks to the socket as is. This suits transports that
+     gather blocks into one write, it would make a TLS record of each frame header otherwise.
+   */
+  Http2DataFrame(Http2StreamId stream_id, uint8_t flags, IOBufferReader *r, uint32_t l, bool zero_copy = false)
+    : Http2TxFrame({l, HTTP2_FRAME_TYPE_DATA, flags, stream_id}), _reader(r), _payload_len(l), _zero_copy(zero_copy)
   {
   }
 
@@ -81,6 +89,7 @@ public:
 private:
   IOBufferReader *_reader = nullptr;
   uint32_t _payload_len   = 0;
+  bool _zero_copy         = false;
 };
 
 /**
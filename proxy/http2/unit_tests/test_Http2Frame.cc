@@ -60,6 +60,59 @@ TEST_CASE("Http2Frame", "[http2][Http2Frame]")
     CHECK(memcmp(buf, expected, written) == 0);
   }
 
+  SECTION("DATA")
+  {
+    // A payload over two blocks, one long enough to be cloned and one to be copied.
+    MIOBuffer *body        = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+    IOBufferReader *body_r = body->alloc_reader();
+    int64_t body_len       = Http2DataFrame::ZERO_COPY_MIN_LEN + 100;
+    for (int64_t i = 0; i < body_len; ++i) {
+      char c = 'a' + i % 26;
+      body->write(&c, 1);
+    }
+    REQUIRE(body_r->block_read_avail() < body_len);
+    IOBufferBlock *first = body_r->get_current_block();
+    int64_t payload_len  = body_len - 10;
+
+    for (bool zero_copy : {false, true}) {
+      IOBufferReader *r = body_r->clone();
+      Http2DataFrame frame(3, HTTP2_FLAGS_DATA_END_STREAM, r, payload_len, zero_copy);
+      int64_t written = frame.write_to(miob);
+
+      CHECK(written == static_cast<int64_t>(HTTP2_FRAME_HEADER_LEN + payload_len));
+      CHECK(written == miob_r->read_avail());
+      CHECK(r->read_avail() == body_len - payload_len);
+
+      // The payload refers to the body's block only if it is zero copy.
+      bool shared = false;
+      for (IOBufferBlock *b = miob_r->get_current_block(); b; b = b->next.get()) {
+        shared |= b->data.get() == first->data.get();
+      }
+      CHECK(shared == zero_copy);
+
+      uint8_t hdr[HTTP2_FRAME_HEADER_LEN];
+      miob_r->read(hdr, sizeof(hdr));
+      uint8_t expected[] = {
+        static_cast<uint8_t>(payload_len >> 16), static_cast<uint8_t>(payload_len >> 8), static_cast<uint8_t>(payload_len),
+        0x00,                  ///< Type
+        0x01,                  ///< Flags
+        0x00, 0x00, 0x00, 0x03 ///< Stream Identifier
+      };
+      CHECK(memcmp(hdr, expected, sizeof(hdr)) == 0);
+
+      ats_scoped_str payload(static_cast<char *>(ats_malloc(payload_len)));
+      CHECK(miob_r->read(payload.get(), payload_len) == payload_len);
+      for (int64_t i = 0; i < payload_len; ++i) {
+        if (payload.get()[i] != 'a' + i % 26) {
+          FAIL("payload differs at " << i);
+        }
+      }
+      r->dealloc();
+    }
+
+    free_MIOBuffer(body);
+  }
+
   free_MIOBuffer(miob);
 }
 
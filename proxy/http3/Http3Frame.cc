@@ -153,6 +153,15 @@ Http3DataFrame::Http3DataFrame(ats_unique_buf payload, size_t payload_len)
   this->_payload = this->_payload_uptr.get();
 }
 
+Http3DataFrame::Http3DataFrame(IOBufferReader &reader, size_t payload_len)
+  : Http3Frame(Http3FrameType::DATA), _payload_len(payload_len)
+{
+  this->_length = this->_payload_len;
+  this->_payload_blocks.write(reader.get_current_block(), payload_len, reader.start_offset);
+  ink_assert(this->_payload_blocks.length() == static_cast<int64_t>(payload_len));
+  reader.consume(payload_len);
+}
+
 Ptr<IOBufferBlock>
 Http3DataFrame::to_io_buffer_block() const
 {
@@ -160,16 +169,23 @@ Http3DataFrame::to_io_buffer_block() const
   size_t n       = 0;
   size_t written = 0;
 
+  // The payload blocks follow the header block as they are
+  bool refer = this->_payload_blocks.head() != nullptr;
+
   block = make_ptr<IOBufferBlock>(new_IOBufferBlock());
-  block->alloc(iobuffer_size_to_index(HEADER_OVERHEAD + this->length(), BUFFER_SIZE_INDEX_32K));
+  block->alloc(refer ? BUFFER_SIZE_INDEX_128 : iobuffer_size_to_index(HEADER_OVERHEAD + this->length(), BUFFER_SIZE_INDEX_32K));
   uint8_t *block_start = reinterpret_cast<uint8_t *>(block->start());
 
   QUICVariableInt::encode(block_start, UINT64_MAX, n, static_cast<uint64_t>(this->_type));
   written += n;
   QUICVariableInt::encode(block_start + written, UINT64_MAX, n, this->_length);
   written += n;
-  memcpy(block_start + written, this->_payload, this->_payload_len);
-  written += this->_payload_len;
+  if (refer) {
+    block->next = const_cast<IOBufferBlock *>(this->_payload_blocks.head());
+  } else {
+    memcpy(block_start + written, this->_payload, this->_payload_len);
+    written += this->_payload_len;
+  }
 
   block->fill(written);
   return block;
@@ -501,29 +517,11 @@ Http3FrameFactory::create_data_frame(const uint8_t *payload, size_t payload_len)
   return Http3DataFrameUPtr(frame, &Http3FrameDeleter::delete_data_frame);
 }
 
-// TODO: This should clone IOBufferBlock chain to avoid memcpy
 Http3DataFrameUPtr
 Http3FrameFactory::create_data_frame(IOBufferReader *reader, size_t payload_len)
 {
-  ats_unique_buf buf = ats_unique_malloc(payload_len);
-  size_t written     = 0;
-
-  while (written < payload_len) {
-    int64_t len = reader->block_read_avail();
-
-    if (written + len > payload_len) {
-      len = payload_len - written;
-    }
-
-    memcpy(buf.get() + written, reinterpret_cast<uint8_t *>(reader->start()), len);
-    reader->consume(len);
-    written += len;
-  }
-
-  ink_assert(written == payload_len);
-
   Http3DataFrame *frame = http3DataFrameAllocator.alloc();
-  new (frame) Http3DataFrame(std::move(buf), payload_len);
+  new (frame) Http3DataFrame(*reader, payload_len);
 
   return Http3DataFrameUPtr(frame, &Http3FrameDeleter::delete_data_frame);
 }
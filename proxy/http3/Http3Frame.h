@@ -76,10 +76,13 @@ public:
   Http3DataFrame() : Http3Frame() {}
   Http3DataFrame(const uint8_t *buf, size_t len);
   Http3DataFrame(ats_unique_buf payload, size_t payload_len);
+  /// Refer to @a payload_len bytes of @a reader without copying them, and consume them.
+  Http3DataFrame(IOBufferReader &reader, size_t payload_len);
 
   Ptr<IOBufferBlock> to_io_buffer_block() const override;
   void reset(const uint8_t *buf, size_t len) override;
 
+  /// The payload, which is not available if the frame refers to blocks.
   const uint8_t *payload() const;
   uint64_t payload_length() const;
 
@@ -87,6 +90,7 @@ private:
   const uint8_t *_payload      = nullptr;
   ats_unique_buf _payload_uptr = {nullptr};
   size_t _payload_len          = 0;
+  IOBufferChain _payload_blocks;
 };
 
 //
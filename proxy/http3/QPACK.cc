@@ -26,6 +26,7 @@
 #include "QPACK.h"
 #include "tscore/ink_defs.h"
 #include "tscore/ink_memory.h"
+#include "tscore/HashFNV.h"
 
 #define QPACKDebug(fmt, ...) Debug("qpack", "[%s] " fmt, this->_qc->cids().data(), ##__VA_ARGS__)
 #define QPACKDTDebug(fmt, ...) Debug("qpack", "" fmt, ##__VA_ARGS__)
@@ -147,7 +148,13 @@ QPACK::QPACK(QUICConnection *qc, uint32_t max_header_list_size, uint16_t max_tab
   this->_decoder_stream_sending_instructions_reader = this->_decoder_stream_sending_instructions->alloc_reader();
 }
 
-QPACK::~QPACK() {}
+QPACK::~QPACK()
+{
+  if (this->_encoder_stream_batch) {
+    this->_encoder_stream_batch->free();
+    this->_encoder_stream_batch = nullptr;
+  }
+}
 
 void
 QPACK::on_new_stream(QUICStream &stream)
@@ -208,6 +215,7 @@ QPACK::encode(uint64_t stream_id, HTTPHdr &header_set, MIOBuffer *header_block,
   }
 
   uint16_t base_index = this->_largest_known_received_index;
+  this->_may_block     = this->_blocking_stream_count() < this->_max_blocking_streams;
 
   // Compress headers and record the largest reference
   uint16_t referred_index           = 0;
@@ -221,10 +229,14 @@ QPACK::encode(uint64_t stream_id, HTTPHdr &header_set, MIOBuffer *header_block,
     largest_reference  = std::max(largest_reference, referred_index);
     smallest_reference = std::min(smallest_reference, referred_index);
     if (ret < 0) {
+      this->_flush_encoder_stream();
       compressed_headers->free();
       return ret;
     }
   }
+  // The instructions must be sent before the header block that refers to them.
+  this->_flush_encoder_stream();
+
   struct EntryReference eref = {smallest_reference, largest_reference};
   this->_references.emplace(stream_id, eref);
 
@@ -371,6 +383,8 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
           this->_dynamic_table.ref_entry(current_index);
         }
       }
+    } else if (!this->_should_insert(lowered_name, name_len, value, value_len)) {
+      // Not worth a dynamic table entry, refer to a name in a table if any.
     } else if (lookup_result_static.match_type == LookupResult::MatchType::NAME) {
       if (never_index) {
         // Name in static table is always available. Do nothing.
@@ -434,6 +448,13 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
     }
   }
 
+  // An entry the decoder may not have received yet blocks the stream until it has, which is only allowed
+  // for as many streams as the decoder said it would hold.
+  if (!this->_may_block && lookup_result_dynamic.match_type != LookupResult::MatchType::NONE &&
+      lookup_result_dynamic.index > this->_largest_known_received_index) {
+    lookup_result_dynamic.match_type = LookupResult::MatchType::NONE;
+  }
+
   // Encode
   if (lookup_result_static.match_type == LookupResult::MatchType::EXACT) {
     this->_encode_indexed_header_field(lookup_result_static.index, base_index, false, compressed_header);
@@ -441,7 +462,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
                base_index, false);
     referred_index = 0;
   } else if (lookup_result_dynamic.match_type == LookupResult::MatchType::EXACT) {
-    if (lookup_result_dynamic.index < this->_largest_known_received_index) {
+    if (lookup_result_dynamic.index <= this->_largest_known_received_index) {
       this->_encode_indexed_header_field(lookup_result_dynamic.index, base_index, true, compressed_header);
       QPACKDebug("Encoded Indexed Header Field: abs_index=%d, base_index=%d, dynamic_table=%d", lookup_result_dynamic.index,
                  base_index, true);
@@ -479,6 +500,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
     this->_encode_literal_header_field_without_name_ref(lowered_name, name_len, value, value_len, never_index, compressed_header);
     QPACKDebug("Encoded Literal Header Field Without Name Ref: name=%.*s, value=%.*s, never_index=%d", name_len, lowered_name,
                value_len, value, never_index);
+    referred_index = 0;
   }
 
   return 0;
@@ -994,6 +1016,55 @@ QPACK::_update_reference_counts(uint64_t stream_id)
   }
 }
 
+uint16_t
+QPACK::_blocking_stream_count() const
+{
+  uint16_t count = 0;
+  for (const auto &ref : this->_references) {
+    if (ref.second.largest > this->_largest_known_received_index) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+bool
+QPACK::_should_insert(const char *name, int name_len, const char *value, int value_len)
+{
+  // A large field would evict many others
+  if (name_len + value_len > this->_max_table_size / 4) {
+    return false;
+  }
+
+  uint64_t hash  = _hash_field(name, name_len, value, value_len);
+  uint64_t &seen = this->_field_history[hash % FIELD_HISTORY_SIZE];
+  if (seen == hash) {
+    return true;
+  }
+  seen = hash;
+  return false;
+}
+
+uint64_t
+QPACK::_hash_name(const char *name, int name_len)
+{
+  ATSHash64FNV1a h;
+  h.update(name, name_len);
+  h.final();
+  return h.get();
+}
+
+uint64_t
+QPACK::_hash_field(const char *name, int name_len, const char *value, int value_len)
+{
+  ATSHash64FNV1a h;
+  h.update(name, name_len);
+  h.update(":", 1);
+  h.update(value, value_len);
+  h.final();
+  return h.get();
+}
+
 void
 QPACK::_resume_decode()
 {
@@ -1262,7 +1333,7 @@ QPACK::DynamicTable::~DynamicTable()
     this->_storage = nullptr;
   }
   if (this->_entries) {
-    delete this->_entries;
+    ats_free(this->_entries);
     this->_entries = nullptr;
   }
 }
@@ -1272,7 +1343,7 @@ QPACK::DynamicTable::lookup(uint16_t index, const char **name, int *name_len, co
 {
   // ink_assert(index >= this->_entries[(this->_entries_tail + 1) % this->_max_entries].index);
   // ink_assert(index <= this->_entries[this->_entries_head].index);
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
+  uint16_t pos = this->_position(index);
   *name_len    = this->_entries[pos].name_len;
   *value_len   = this->_entries[pos].value_len;
   this->_storage->read(this->_entries[pos].offset, name, *name_len, value, *value_len);
@@ -1282,38 +1353,32 @@ QPACK::DynamicTable::lookup(uint16_t index, const char **name, int *name_len, co
 const QPACK::LookupResult
 QPACK::DynamicTable::lookup(const char *name, int name_len, const char *value, int value_len)
 {
-  QPACK::LookupResult::MatchType match_type = QPACK::LookupResult::MatchType::NONE;
-  uint16_t i                                = this->_entries_tail + 1;
-  int end                                   = this->_entries_head;
-  uint16_t candidate_index                  = 0;
-  const char *tmp_name                      = nullptr;
-  const char *tmp_value                     = nullptr;
+  const char *tmp_name  = nullptr;
+  const char *tmp_value = nullptr;
 
   // DynamicTable is empty
-  if (this->_entries_inserted == 0) {
-    return {candidate_index, match_type};
-  }
-
-  // TODO Use a tree for better performance
-  for (; i <= end; i = (i + 1) % this->_max_entries) {
-    if (name_len != 0 && this->_entries[i].name_len == name_len) {
-      this->_storage->read(this->_entries[i].offset, &tmp_name, this->_entries[i].name_len, &tmp_value,
-                           this->_entries[i].value_len);
-      if (memcmp(name, tmp_name, name_len) == 0) {
-        candidate_index = this->_entries[i].index;
-        if (value_len == this->_entries[i].value_len && memcmp(value, tmp_value, value_len) == 0) {
-          // Exact match
-          match_type = QPACK::LookupResult::MatchType::EXACT;
-          break;
-        } else {
-          // Name match -- Keep it for no exact matches
-          match_type = QPACK::LookupResult::MatchType::NAME;
-        }
-      }
+  if (this->_entries_inserted == 0 || name_len == 0) {
+    return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
+  }
+
+  if (auto spot = this->_field_index.find(_hash_field(name, name_len, value, value_len)); spot != this->_field_index.end()) {
+    const DynamicTableEntry &entry = this->_entries[this->_position(spot->second)];
+    this->_storage->read(entry.offset, &tmp_name, entry.name_len, &tmp_value, entry.value_len);
+    if (entry.name_len == name_len && entry.value_len == value_len && memcmp(name, tmp_name, name_len) == 0 &&
+        memcmp(value, tmp_value, value_len) == 0) {
+      return {entry.index, QPACK::LookupResult::MatchType::EXACT};
     }
   }
 
-  return {candidate_index, match_type};
+  if (auto spot = this->_name_index.find(_hash_name(name, name_len)); spot != this->_name_index.end()) {
+    const DynamicTableEntry &entry = this->_entries[this->_position(spot->second)];
+    this->_storage->read(entry.offset, &tmp_name, entry.name_len, &tmp_value, entry.value_len);
+    if (entry.name_len == name_len && memcmp(name, tmp_name, name_len) == 0) {
+      return {entry.index, QPACK::LookupResult::MatchType::NAME};
+    }
+  }
+
+  return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
 }
 
 const QPACK::LookupResult
@@ -1357,10 +1422,14 @@ QPACK::DynamicTable::insert_entry(const char *name, uint16_t name_len, const cha
 
   // Evict
   if (this->_available != available) {
+    uint16_t last = (tail + this->_max_entries - 1) % this->_max_entries;
     QPACKDTDebug("Evict entries: from %u to %u", this->_entries[(this->_entries_tail + 1) % this->_max_entries].index,
-                 this->_entries[tail - 1].index);
+                 this->_entries[last].index);
+    for (uint16_t i = (this->_entries_tail + 1) % this->_max_entries; i != tail; i = (i + 1) % this->_max_entries) {
+      this->_unindex_entry(this->_entries[i]);
+    }
     this->_available    = available;
-    this->_entries_tail = tail - 1;
+    this->_entries_tail = last;
     QPACKDTDebug("Available size: %u", this->_available);
   }
 
@@ -1370,6 +1439,10 @@ QPACK::DynamicTable::insert_entry(const char *name, uint16_t name_len, const cha
                                          name_len, value_len, 0};
   this->_available -= required_len;
 
+  // The latest entry is the one to refer to, as it is the last to be evicted
+  this->_name_index[_hash_name(name, name_len)]                    = this->_entries_inserted;
+  this->_field_index[_hash_field(name, name_len, value, value_len)] = this->_entries_inserted;
+
   QPACKDTDebug("Insert Entry: entry=%u, index=%u, size=%u", this->_entries_head, this->_entries_inserted, name_len + value_len);
   QPACKDTDebug("Available size: %u", this->_available);
   return {this->_entries_inserted, value_len ? LookupResult::MatchType::EXACT : LookupResult::MatchType::NAME};
@@ -1413,15 +1486,38 @@ QPACK::DynamicTable::update_size(uint16_t max_size)
 void
 QPACK::DynamicTable::ref_entry(uint16_t index)
 {
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
-  ++this->_entries[pos].ref_count;
+  ++this->_entries[this->_position(index)].ref_count;
 }
 
 void
 QPACK::DynamicTable::unref_entry(uint16_t index)
 {
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
-  --this->_entries[pos].ref_count;
+  --this->_entries[this->_position(index)].ref_count;
+}
+
+uint16_t
+QPACK::DynamicTable::_position(uint16_t index) const
+{
+  // Entries are stored in order of their absolute index, the latest one at the head
+  uint16_t behind = this->_entries[this->_entries_head].index - index;
+  return (this->_entries_head + this->_max_entries - behind) % this->_max_entries;
+}
+
+void
+QPACK::DynamicTable::_unindex_entry(const DynamicTableEntry &entry)
+{
+  const char *name;
+  const char *value;
+
+  this->_storage->read(entry.offset, &name, entry.name_len, &value, entry.value_len);
+  if (auto spot = this->_name_index.find(_hash_name(name, entry.name_len));
+      spot != this->_name_index.end() && spot->second == entry.index) {
+    this->_name_index.erase(spot);
+  }
+  if (auto spot = this->_field_index.find(_hash_field(name, entry.name_len, value, entry.value_len));
+      spot != this->_field_index.end() && spot->second == entry.index) {
+    this->_field_index.erase(spot);
+  }
 }
 
 uint16_t
@@ -1433,8 +1529,7 @@ QPACK::DynamicTable::largest_index() const
 int
 QPACK::_write_insert_with_name_ref(uint16_t index, bool dynamic, const char *value, uint16_t value_len)
 {
-  IOBufferBlock *instruction = new_IOBufferBlock();
-  instruction->alloc(TS_IOBUFFER_SIZE_INDEX_2K);
+  IOBufferBlock *instruction = this->_encoder_stream_block(4 * value_len + 32);
 
   char *buf     = instruction->end();
   char *buf_end = buf + instruction->write_avail();
@@ -1463,9 +1558,8 @@ QPACK::_write_insert_with_name_ref(uint16_t index, bool dynamic, const char *val
   }
   written += ret;
 
-  // Finalize and Schedule to send
+  // Finalize, it is sent with the rest of the batch
   instruction->fill(written);
-  this->_encoder_stream_sending_instructions->append_block(instruction);
 
   return 0;
 }
@@ -1473,8 +1567,7 @@ QPACK::_write_insert_with_name_ref(uint16_t index, bool dynamic, const char *val
 int
 QPACK::_write_insert_without_name_ref(const char *name, int name_len, const char *value, uint16_t value_len)
 {
-  IOBufferBlock *instruction = new_IOBufferBlock();
-  instruction->alloc(TS_IOBUFFER_SIZE_INDEX_2K);
+  IOBufferBlock *instruction = this->_encoder_stream_block(4 * (name_len + value_len) + 32);
 
   char *buf     = instruction->end();
   char *buf_end = buf + instruction->write_avail();
@@ -1498,9 +1591,8 @@ QPACK::_write_insert_without_name_ref(const char *name, int name_len, const char
   }
   written += ret;
 
-  // Finalize and Schedule to send
+  // Finalize, it is sent with the rest of the batch
   instruction->fill(written);
-  this->_encoder_stream_sending_instructions->append_block(instruction);
 
   return 0;
 }
@@ -1508,13 +1600,15 @@ QPACK::_write_insert_without_name_ref(const char *name, int name_len, const char
 int
 QPACK::_write_duplicate(uint16_t index)
 {
-  IOBufferBlock *instruction = new_IOBufferBlock();
-  instruction->alloc(TS_IOBUFFER_SIZE_INDEX_2K);
+  IOBufferBlock *instruction = this->_encoder_stream_block(16);
 
   char *buf     = instruction->end();
   char *buf_end = buf + instruction->write_avail();
   int written   = 0;
 
+  // Duplicate
+  buf[0] = 0x00;
+
   // Index
   int ret;
   if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(buf + written), reinterpret_cast<uint8_t *>(buf_end), index, 5)) <
@@ -1523,9 +1617,8 @@ QPACK::_write_duplicate(uint16_t index)
   }
   written += ret;
 
-  // Finalize and Schedule to send
+  // Finalize, it is sent with the rest of the batch
   instruction->fill(written);
-  this->_encoder_stream_sending_instructions->append_block(instruction);
 
   return 0;
 }
@@ -1533,8 +1626,7 @@ QPACK::_write_duplicate(uint16_t index)
 int
 QPACK::_write_dynamic_table_size_update(uint16_t max_size)
 {
-  IOBufferBlock *instruction = new_IOBufferBlock();
-  instruction->alloc(TS_IOBUFFER_SIZE_INDEX_128);
+  IOBufferBlock *instruction = this->_encoder_stream_block(16);
 
   char *buf     = instruction->end();
   char *buf_end = buf + instruction->write_avail();
@@ -1551,13 +1643,40 @@ QPACK::_write_dynamic_table_size_update(uint16_t max_size)
   }
   written += ret;
 
-  // Finalize and Schedule to send
+  // Finalize, it is sent with the rest of the batch
   instruction->fill(written);
-  this->_encoder_stream_sending_instructions->append_block(instruction);
 
   return 0;
 }
 
+IOBufferBlock *
+QPACK::_encoder_stream_block(int64_t len)
+{
+  if (this->_encoder_stream_batch && this->_encoder_stream_batch->write_avail() < len) {
+    this->_flush_encoder_stream();
+  }
+  if (!this->_encoder_stream_batch) {
+    this->_encoder_stream_batch = new_IOBufferBlock();
+    this->_encoder_stream_batch->alloc(std::max(static_cast<int64_t>(TS_IOBUFFER_SIZE_INDEX_2K),
+                                                iobuffer_size_to_index(len, MAX_BUFFER_SIZE_INDEX)));
+  }
+  return this->_encoder_stream_batch;
+}
+
+void
+QPACK::_flush_encoder_stream()
+{
+  if (!this->_encoder_stream_batch) {
+    return;
+  }
+  if (this->_encoder_stream_batch->size() > 0) {
+    this->_encoder_stream_sending_instructions->append_block(this->_encoder_stream_batch);
+  } else {
+    this->_encoder_stream_batch->free();
+  }
+  this->_encoder_stream_batch = nullptr;
+}
+
 int
 QPACK::_write_table_state_synchronize(uint16_t insert_count)
 {
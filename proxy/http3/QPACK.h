@@ -24,6 +24,7 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
 
 #include "I_EventSystem.h"
 #include "I_Event.h"
@@ -79,6 +80,9 @@ public:
   static size_t estimate_header_block_size(const HTTPHdr &header_set);
 
 private:
+  // make sure the unit tests can access internals
+  friend class QPACKTest;
+
   struct LookupResult {
     uint16_t index                                  = 0;
     enum MatchType { NONE, NAME, EXACT } match_type = MatchType::NONE;
@@ -145,9 +149,17 @@ private:
     uint16_t largest_index() const;
 
   private:
+    uint16_t _position(uint16_t index) const;
+    void _unindex_entry(const DynamicTableEntry &entry);
+
     uint16_t _available        = 0;
     uint16_t _entries_inserted = 0;
 
+    // Absolute index of the latest entry for a hash of the name, and of the name and the value.
+    // A hit is checked against the entry as the hashes may collide.
+    std::unordered_map<uint64_t, uint16_t> _name_index;
+    std::unordered_map<uint64_t, uint16_t> _field_index;
+
     // FIXME It may be better to split this array into small arrays to reduce memory footprint
     struct DynamicTableEntry *_entries = nullptr;
     uint16_t _max_entries              = 0;
@@ -249,6 +261,20 @@ private:
 
   DynamicTable _dynamic_table;
   std::map<uint64_t, struct EntryReference> _references;
+
+  static uint64_t _hash_name(const char *name, int name_len);
+  static uint64_t _hash_field(const char *name, int name_len, const char *value, int value_len);
+
+  // Encoder insertion strategy
+  // A field is only inserted into the dynamic table once it has been seen before, so that values that are
+  // unique to a message, like dates and lengths, do not evict the ones that repeat.
+  static constexpr int FIELD_HISTORY_SIZE = 256;
+  uint64_t _field_history[FIELD_HISTORY_SIZE] = {};
+  bool _should_insert(const char *name, int name_len, const char *value, int value_len);
+  /// Number of streams whose header blocks refer to entries the decoder may not have received yet.
+  uint16_t _blocking_stream_count() const;
+  /// Whether the header block being encoded may refer to entries the decoder may not have received yet.
+  bool _may_block = false;
   uint32_t _max_header_list_size = 0;
   uint16_t _max_table_size       = 0;
   uint16_t _max_blocking_streams = 0;
@@ -280,6 +306,11 @@ private:
   int _write_duplicate(uint16_t index);
   int _write_dynamic_table_size_update(uint16_t max_size);
 
+  // Encoder stream instructions of a header block are batched into one block, which is sent when it is done
+  IOBufferBlock *_encoder_stream_batch = nullptr;
+  IOBufferBlock *_encoder_stream_block(int64_t len);
+  void _flush_encoder_stream();
+
   // Decoder Stream
   int _read_table_state_synchronize(IOBufferReader &reader, uint16_t &insert_count);
   int _read_header_acknowledgement(IOBufferReader &reader, uint64_t &stream_id);
@@ -279,6 +279,53 @@ acknowledge_header_block(TestQUICStream *stream, uint64_t stream_id)
   stream->write(buf, ret, 0, stream_id);
 }
 
+class QPACKTest
+{
+public:
+  using DynamicTable = QPACK::DynamicTable;
+  using LookupResult = QPACK::LookupResult;
+
+  // Instructions the encoder has queued on its encoder stream
+  static int64_t
+  encoder_instructions(QPACK &qpack, uint8_t *buf, int64_t len)
+  {
+    return qpack._encoder_stream_sending_instructions_reader->read(buf, len);
+  }
+
+  // Hand an instruction to the encoder as if it arrived on the decoder stream
+  static void
+  receive_decoder_instruction(QPACK &qpack, const uint8_t *buf, int64_t len)
+  {
+    MIOBuffer *instruction = new_MIOBuffer(BUFFER_SIZE_INDEX_128);
+    IOBufferReader *reader = instruction->alloc_reader();
+    instruction->write(buf, len);
+    qpack._on_decoder_stream_read_ready(*reader);
+    free_MIOBuffer(instruction);
+  }
+};
+
+static int64_t
+encode_field(QPACK &qpack, uint64_t stream_id, const char *name, const char *value, uint8_t *buf, int64_t len)
+{
+  HTTPHdr hdr;
+  hdr.create(HTTP_TYPE_REQUEST);
+  MIMEField *field = hdr.field_create(name, strlen(name));
+  hdr.field_attach(field);
+  hdr.field_value_set(field, value, strlen(value));
+
+  MIOBuffer *header_block             = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  IOBufferReader *header_block_reader = header_block->alloc_reader();
+  uint64_t header_block_len           = 0;
+  int64_t ret                         = -1;
+  if (qpack.encode(stream_id, hdr, header_block, header_block_len) == 0) {
+    ret = header_block_reader->read(buf, len);
+  }
+
+  free_MIOBuffer(header_block);
+  hdr.destroy();
+  return ret;
+}
+
 static int
 test_encode(const char *qif_file, const char *out_file, int dts, int mbs, int am)
 {
@@ -472,3 +519,127 @@ TEST_CASE("Decoding", "[qpack-decode]")
     }
   }
 }
+
+TEST_CASE("Dynamic table", "[qpack-dynamic-table]")
+{
+  SECTION("Evicted entries are no longer found")
+  {
+    QPACKTest::DynamicTable table(16);
+
+    CHECK(table.insert_entry("x-a", 3, "1", 1).index == 1);
+    CHECK(table.insert_entry("x-b", 3, "22", 2).index == 2);
+    CHECK(table.insert_entry("x-c", 3, "333", 3).index == 3);
+    CHECK(table.lookup("x-a", 3, "1", 1).match_type == QPACKTest::LookupResult::MatchType::EXACT);
+
+    // Makes room by evicting the two oldest entries
+    CHECK(table.insert_entry("x-d", 3, "4444", 4).index == 4);
+
+    CHECK(table.lookup("x-a", 3, "1", 1).match_type == QPACKTest::LookupResult::MatchType::NONE);
+    CHECK(table.lookup("x-a", 3, "9", 1).match_type == QPACKTest::LookupResult::MatchType::NONE);
+    CHECK(table.lookup("x-b", 3, "22", 2).match_type == QPACKTest::LookupResult::MatchType::NONE);
+    CHECK(table.lookup("x-b", 3, "9", 1).match_type == QPACKTest::LookupResult::MatchType::NONE);
+
+    auto result = table.lookup("x-c", 3, "333", 3);
+    CHECK(result.match_type == QPACKTest::LookupResult::MatchType::EXACT);
+    CHECK(result.index == 3);
+    result = table.lookup("x-d", 3, "9", 1);
+    CHECK(result.match_type == QPACKTest::LookupResult::MatchType::NAME);
+    CHECK(result.index == 4);
+
+    // An evicted field can be inserted again
+    CHECK(table.insert_entry("x-a", 3, "1", 1).index == 5);
+    result = table.lookup("x-a", 3, "1", 1);
+    CHECK(result.match_type == QPACKTest::LookupResult::MatchType::EXACT);
+    CHECK(result.index == 5);
+  }
+
+  SECTION("The latest entry is found")
+  {
+    QPACKTest::DynamicTable table(12);
+
+    CHECK(table.insert_entry("x-a", 3, "1", 1).index == 1);
+    CHECK(table.insert_entry("x-b", 3, "2", 1).index == 2);
+    CHECK(table.duplicate_entry(1).index == 3);
+
+    auto result = table.lookup("x-a", 3, "1", 1);
+    CHECK(result.match_type == QPACKTest::LookupResult::MatchType::EXACT);
+    CHECK(result.index == 3);
+    result = table.lookup("x-a", 3, "9", 1);
+    CHECK(result.match_type == QPACKTest::LookupResult::MatchType::NAME);
+    CHECK(result.index == 3);
+
+    // Evicting the original leaves the duplicate in place
+    CHECK(table.insert_entry("x-c", 3, "3", 1).index == 4);
+    result = table.lookup("x-a", 3, "1", 1);
+    CHECK(result.match_type == QPACKTest::LookupResult::MatchType::EXACT);
+    CHECK(result.index == 3);
+
+    // A new value for a name is the one referred to by name
+    CHECK(table.insert_entry("x-a", 3, "5", 1).index == 5);
+    result = table.lookup("x-a", 3, "9", 1);
+    CHECK(result.match_type == QPACKTest::LookupResult::MatchType::NAME);
+    CHECK(result.index == 5);
+    result = table.lookup("x-a", 3, "1", 1);
+    CHECK(result.match_type == QPACKTest::LookupResult::MatchType::EXACT);
+    CHECK(result.index == 3);
+  }
+}
+
+TEST_CASE("Encoding with the dynamic table", "[qpack-encode-dynamic-table]")
+{
+  QUICApplicationDriver driver;
+  uint8_t block[128];
+  uint8_t instructions[128];
+
+  SECTION("Only repeated fields are inserted")
+  {
+    QPACK qpack(driver.get_connection(), UINT32_MAX, 4096, 100);
+
+    // Sent as a Literal Header Field Without Name Reference
+    REQUIRE(encode_field(qpack, 1, "x-once", "a", block, sizeof(block)) > 2);
+    CHECK(block[0] == 0);
+    CHECK((block[2] & 0xe0) == 0x20);
+    CHECK(QPACKTest::encoder_instructions(qpack, instructions, sizeof(instructions)) == 0);
+
+    REQUIRE(encode_field(qpack, 2, "x-twice", "b", block, sizeof(block)) > 2);
+    CHECK(QPACKTest::encoder_instructions(qpack, instructions, sizeof(instructions)) == 0);
+
+    // Inserted with an Insert Without Name Reference, and referred to
+    REQUIRE(encode_field(qpack, 3, "x-twice", "b", block, sizeof(block)) > 2);
+    CHECK(block[0] == 1);
+    CHECK(QPACKTest::encoder_instructions(qpack, instructions, sizeof(instructions)) > 0);
+    CHECK((instructions[0] & 0xc0) == 0x40);
+
+    REQUIRE(encode_field(qpack, 4, "x-twice", "b", block, sizeof(block)) > 2);
+    CHECK(block[0] == 1);
+    CHECK(QPACKTest::encoder_instructions(qpack, instructions, sizeof(instructions)) == 0);
+  }
+
+  SECTION("No blocked streams")
+  {
+    QPACK qpack(driver.get_connection(), UINT32_MAX, 4096, 0);
+
+    REQUIRE(encode_field(qpack, 1, "x-field", "a", block, sizeof(block)) > 2);
+    CHECK(block[0] == 0);
+
+    // The field is inserted, but the entry is not referred to until the decoder has it
+    REQUIRE(encode_field(qpack, 2, "x-field", "a", block, sizeof(block)) > 2);
+    CHECK(block[0] == 0);
+    CHECK((block[2] & 0xe0) == 0x20);
+    CHECK(QPACKTest::encoder_instructions(qpack, instructions, sizeof(instructions)) > 0);
+
+    REQUIRE(encode_field(qpack, 3, "x-field", "a", block, sizeof(block)) > 2);
+    CHECK(block[0] == 0);
+    CHECK((block[2] & 0xe0) == 0x20);
+
+    // Insert Count Increment
+    const uint8_t increment[] = {0x01};
+    QPACKTest::receive_decoder_instruction(qpack, increment, sizeof(increment));
+
+    // Indexed Header Field referring to the acknowledged entry
+    REQUIRE(encode_field(qpack, 4, "x-field", "a", block, sizeof(block)) == 3);
+    CHECK(block[0] == 1);
+    CHECK(block[1] == 0);
+    CHECK(block[2] == 0x80);
+  }
+}
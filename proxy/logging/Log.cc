@@ -47,6 +47,8 @@
 #include "LogObject.h"
 #include "LogConfig.h"
 #include "LogBuffer.h"
+#include "LogCollector.h"
+#include "LogColumnar.h"
 #include "LogUtils.h"
 #include "Log.h"
 #include "tscore/SimpleTokenizer.h"
@@ -1286,20 +1288,111 @@ Log::preproc_thread_main(void *args)
   return nullptr;
 }
 
+/*-------------------------------------------------------------------------
+  Log::flush_thread_main
+
+  The flush thread writes out the data handed to it by the preproc threads.
+  Columnar files have their LogBuffers collected into blocks here, and a
+  block is written out once it is full, before the file is rolled and
+  every periodic_tasks_interval seconds otherwise.
+  -------------------------------------------------------------------------*/
+
+namespace
+{
+void
+flush_to_file(LogFile *logfile, const char *buf, int total_bytes)
+{
+  int len, bytes_written = 0;
+  ProxyMutex *mutex      = this_thread()->mutex.get();
+
+  // Data for a collector is queued for its sender thread, which does the
+  // accounting from here on.
+  if (logfile->m_collector) {
+    int entries = logfile->m_file_format == LOG_FILE_BINARY ? reinterpret_cast<const LogBufferHeader *>(buf)->entry_count :
+                                                              std::count(buf, buf + total_bytes, '\n');
+    logfile->m_collector->enqueue(buf, total_bytes, entries);
+    return;
+  }
+
+  // make sure we're open & ready to write
+  logfile->check_fd();
+  if (!logfile->is_open()) {
+    SiteThrottledWarning("File:%s was closed, have dropped (%d) bytes.", logfile->get_name(), total_bytes);
+
+    RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, total_bytes);
+    return;
+  }
+
+  int logfilefd = logfile->get_fd();
+  // This should always be true because we just checked it.
+  ink_assert(logfilefd >= 0);
+
+  // write *all* data to target file as much as possible
+  //
+  while (total_bytes - bytes_written) {
+    if (Log::config->logging_space_exhausted) {
+      Debug("log", "logging space exhausted, failed to write file:%s, have dropped (%d) bytes.", logfile->get_name(),
+            (total_bytes - bytes_written));
+
+      RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, total_bytes - bytes_written);
+      break;
+    }
+
+    len = ::write(logfilefd, &buf[bytes_written], total_bytes - bytes_written);
+
+    if (len < 0) {
+      SiteThrottledError("Failed to write log to %s: [tried %d, wrote %d, %s]", logfile->get_name(), total_bytes - bytes_written,
+                         bytes_written, strerror(errno));
+
+      RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, total_bytes - bytes_written);
+      break;
+    }
+    Debug("log", "Successfully wrote some stuff to %s", logfile->get_name());
+    bytes_written += len;
+  }
+
+  RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_written_to_disk_stat, bytes_written);
+
+  if (logfile->m_log) {
+    ink_atomic_increment(&logfile->m_log->m_bytes_written, bytes_written);
+  }
+}
+
+struct PendingBlock {
+  Ptr<LogFile> logfile;
+  LogColumnarBlock block;
+};
+
+void
+flush_block(PendingBlock &pending)
+{
+  LogColumnarHeader *header = pending.block.encode();
+
+  if (header) {
+    Debug("log", "writing a columnar block of %u entries (%u bytes, %u compressed) to %s", header->entry_count, header->raw_bytes,
+          header->payload_bytes, pending.logfile->get_name());
+    flush_to_file(pending.logfile.get(), reinterpret_cast<char *>(header), sizeof(LogColumnarHeader) + header->payload_bytes);
+    ats_free(header);
+  }
+}
+} // namespace
+
 void *
 Log::flush_thread_main(void * /* args ATS_UNUSED */)
 {
   LogBuffer *logbuffer;
   LogFlushData *fdata;
   ink_hrtime now, last_time = 0;
-  int len, total_bytes;
   SLL<LogFlushData, LogFlushData::Link_link> link, invert_link;
-  ProxyMutex *mutex = this_thread()->mutex.get();
+  std::vector<std::unique_ptr<PendingBlock>> pending_blocks;
 
   Log::flush_notify->lock();
 
   while (true) {
     if (TSSystemState::is_event_system_shut_down()) {
+      for (auto &pending : pending_blocks) {
+        flush_block(*pending);
+      }
       return nullptr;
     }
     fdata = static_cast<LogFlushData *>(ink_atomiclist_popall(flush_data_list));
@@ -1314,69 +1407,40 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
     // process each flush data
     //
     while ((fdata = invert_link.pop())) {
-      char *buf         = nullptr;
-      int bytes_written = 0;
-      LogFile *logfile  = fdata->m_logfile.get();
+      LogFile *logfile = fdata->m_logfile.get();
 
       if (logfile->m_file_format == LOG_FILE_BINARY) {
         logbuffer                      = static_cast<LogBuffer *>(fdata->m_data);
         LogBufferHeader *buffer_header = logbuffer->header();
 
-        buf         = reinterpret_cast<char *>(buffer_header);
-        total_bytes = buffer_header->byte_count;
-
-      } else if (logfile->m_file_format == LOG_FILE_ASCII || logfile->m_file_format == LOG_FILE_PIPE) {
-        buf         = static_cast<char *>(fdata->m_data);
-        total_bytes = fdata->m_len;
+        flush_to_file(logfile, reinterpret_cast<char *>(buffer_header), buffer_header->byte_count);
 
-      } else {
-        ink_release_assert(!"Unknown file format type!");
-      }
+      } else if (logfile->m_file_format == LOG_FILE_COLUMNAR) {
+        logbuffer = static_cast<LogBuffer *>(fdata->m_data);
 
-      // make sure we're open & ready to write
-      logfile->check_fd();
-      if (!logfile->is_open()) {
-        SiteThrottledWarning("File:%s was closed, have dropped (%d) bytes.", logfile->get_name(), total_bytes);
-
-        RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, total_bytes);
-        delete fdata;
-        continue;
-      }
-
-      int logfilefd = logfile->get_fd();
-      // This should always be true because we just checked it.
-      ink_assert(logfilefd >= 0);
-
-      // write *all* data to target file as much as possible
-      //
-      while (total_bytes - bytes_written) {
-        if (Log::config->logging_space_exhausted) {
-          Debug("log", "logging space exhausted, failed to write file:%s, have dropped (%d) bytes.", logfile->get_name(),
-                (total_bytes - bytes_written));
-
-          RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat,
-                         total_bytes - bytes_written);
-          break;
+        auto spot = std::find_if(pending_blocks.begin(), pending_blocks.end(),
+                                 [logfile](auto const &pending) { return pending->logfile.get() == logfile; });
+        if (spot == pending_blocks.end()) {
+          pending_blocks.emplace_back(new PendingBlock);
+          pending_blocks.back()->logfile = fdata->m_logfile;
+          spot                           = std::prev(pending_blocks.end());
         }
 
-        len = ::write(logfilefd, &buf[bytes_written], total_bytes - bytes_written);
-
-        if (len < 0) {
-          SiteThrottledError("Failed to write log to %s: [tried %d, wrote %d, %s]", logfile->get_name(),
-                             total_bytes - bytes_written, bytes_written, strerror(errno));
-
-          RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat,
-                         total_bytes - bytes_written);
-          break;
+        PendingBlock &pending = **spot;
+        if (!pending.block.add(logbuffer->header())) {
+          flush_block(pending);
+          pending.block.add(logbuffer->header());
+        }
+        if (pending.block.entry_count() >= static_cast<uint32_t>(Log::config->columnar_block_entries) ||
+            pending.block.byte_count() >= LOG_COLUMNAR_MAX_BLOCK_BYTES) {
+          flush_block(pending);
         }
-        Debug("log", "Successfully wrote some stuff to %s", logfile->get_name());
-        bytes_written += len;
-      }
 
-      RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_written_to_disk_stat, bytes_written);
+      } else if (logfile->m_file_format == LOG_FILE_ASCII || logfile->m_file_format == LOG_FILE_PIPE) {
+        flush_to_file(logfile, static_cast<char *>(fdata->m_data), fdata->m_len);
 
-      if (logfile->m_log) {
-        ink_atomic_increment(&logfile->m_log->m_bytes_written, bytes_written);
+      } else {
+        ink_release_assert(!"Unknown file format type!");
       }
 
       delete fdata;
@@ -1386,6 +1450,12 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
     //
     now = Thread::get_hrtime() / HRTIME_SECOND;
     if (now >= last_time + periodic_tasks_interval) {
+      // Write out the partial blocks first so they land in the file before it is rolled.
+      for (auto &pending : pending_blocks) {
+        flush_block(*pending);
+      }
+      pending_blocks.clear();
+
       Debug("log-preproc", "periodic tasks for %" PRId64, (int64_t)now);
       periodic_tasks(now);
       last_time = Thread::get_hrtime() / HRTIME_SECOND;
@@ -87,6 +87,7 @@ public:
   {
     switch (m_logfile->m_file_format) {
     case LOG_FILE_BINARY:
+    case LOG_FILE_COLUMNAR:
       logbuffer = static_cast<LogBuffer *>(m_data);
       LogBuffer::destroy(logbuffer);
       break;
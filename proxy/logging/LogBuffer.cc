@@ -31,6 +31,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 #include "P_EventSystem.h"
 #include "LogField.h"
@@ -57,6 +59,16 @@ FieldListCacheElement fieldlist_cache[FIELDLIST_CACHE_SIZE];
 int fieldlist_cache_entries = 0;
 int32_t LogBuffer::M_ID;
 
+namespace
+{
+const char *buffer_size_exceeded_msg = "Traffic Server is skipping the current log entry because its size "
+                                       "exceeds the maximum line (entry) size for an ascii log buffer";
+
+// Compiled formats, keyed by the symbol string and the printf string.
+std::mutex render_program_mutex;
+std::unordered_map<std::string, std::unique_ptr<LogRenderProgram>> render_program_cache;
+} // namespace
+
 /*-------------------------------------------------------------------------
   The following LogBufferHeader routines are used to grab strings out from
   the data section using the offsets held in the buffer header.
@@ -493,9 +505,6 @@ LogBuffer::resolve_custom_entry(LogFieldList *fieldlist, char *printf_str, char
   int bytes_written   = 0;
   int res, i;
 
-  const char *buffer_size_exceeded_msg = "Traffic Server is skipping the current log entry because its size "
-                                         "exceeds the maximum line (entry) size for an ascii log buffer";
-
   for (i = 0; i < printf_len; i++) {
     if (printf_str[i] == LOG_FIELD_MARKER) {
       ++markCount;
@@ -568,6 +577,12 @@ LogBuffer::to_ascii(LogEntryHeader *entry, LogFormatType type, char *buf, int bu
     //
     return ink_strlcpy(write_to, read_from, buf_len);
   }
+
+  if (!alt_format) {
+    if (const LogRenderProgram *program = render_program(symbol_str, printf_str)) {
+      return program->render(read_from, write_to, buf_len, escape_type);
+    }
+  }
   //
   // We no longer make the distinction between custom vs pre-defined
   // logging formats in converting to ASCII.  This way we're sure to
@@ -654,6 +669,150 @@ LogBuffer::to_ascii(LogEntryHeader *entry, LogFormatType type, char *buf, int bu
   return ret;
 }
 
+/*-------------------------------------------------------------------------
+  LogBuffer::render_program
+
+  Return the compiled program for a format, compiling it the first time it
+  is seen.  Returns nullptr if the format can not be compiled, in which
+  case the entries have to be resolved one field at a time.
+  -------------------------------------------------------------------------*/
+const LogRenderProgram *
+LogBuffer::render_program(const char *symbol_str, const char *printf_str)
+{
+  if (symbol_str == nullptr || printf_str == nullptr) {
+    return nullptr;
+  }
+
+  std::string key{symbol_str};
+  key.push_back('\0');
+  key.append(printf_str);
+
+  std::lock_guard<std::mutex> lock(render_program_mutex);
+  auto spot = render_program_cache.find(key);
+
+  if (spot == render_program_cache.end()) {
+    if (render_program_cache.size() >= FIELDLIST_CACHE_SIZE) {
+      return nullptr;
+    }
+    Debug("log-fieldlist", "Compiling render program for %s", symbol_str);
+    spot = render_program_cache.emplace(std::move(key), std::make_unique<LogRenderProgram>(symbol_str, printf_str)).first;
+  }
+  return spot->second->valid() ? spot->second.get() : nullptr;
+}
+
+/*-------------------------------------------------------------------------
+  LogRenderProgram::LogRenderProgram
+  -------------------------------------------------------------------------*/
+LogRenderProgram::LogRenderProgram(const char *symbol_str, const char *printf_str) : m_printf_str(printf_str)
+{
+  bool contains_aggregates = false;
+  LogFormat::parse_symbol_string(symbol_str, &m_fieldlist, &contains_aggregates);
+
+  LogField *field    = m_fieldlist.first();
+  int literal_offset = 0;
+  int printf_len     = static_cast<int>(m_printf_str.size());
+
+  for (int i = 0; i < printf_len; ++i) {
+    if (m_printf_str[i] != LOG_FIELD_MARKER) {
+      continue;
+    }
+    if (field == nullptr) {
+      // More field markers than fields, leave it to resolve_custom_entry() to complain.
+      return;
+    }
+
+    Step step{OP_FIELD, literal_offset, i - literal_offset, field, nullptr};
+    auto const &func = field->unmarshal_func();
+
+    if (auto f = std::get_if<LogField::UnmarshalFuncWithSlice>(&func);
+        f && *f == &LogAccess::unmarshal_str && !field->m_slice.m_enable) {
+      step.op = OP_STRING;
+    } else if (auto f = std::get_if<LogField::UnmarshalFunc>(&func); f && *f) {
+      step.op   = *f == &LogAccess::unmarshal_int_to_str ? OP_INT : OP_FUNC;
+      step.func = *f;
+    }
+    m_steps.push_back(step);
+
+    literal_offset = i + 1;
+    field          = m_fieldlist.next(field);
+  }
+
+  m_steps.push_back(Step{OP_LITERAL, literal_offset, printf_len - literal_offset, nullptr, nullptr});
+  m_valid = true;
+}
+
+/*-------------------------------------------------------------------------
+  LogRenderProgram::render
+
+  This does what resolve_custom_entry does for the same format, and gives
+  the same result.
+  -------------------------------------------------------------------------*/
+int
+LogRenderProgram::render(char *read_from, char *write_to, int write_to_len, LogEscapeType escape_type) const
+{
+  int bytes_written = 0;
+
+  for (auto const &step : m_steps) {
+    if (bytes_written + step.literal_len >= write_to_len) {
+      SiteThrottledNote("%s", buffer_size_exceeded_msg);
+      return 0;
+    }
+    memcpy(&write_to[bytes_written], &m_printf_str[step.literal_offset], step.literal_len);
+    bytes_written += step.literal_len;
+
+    char *to = &write_to[bytes_written];
+    int len  = write_to_len - bytes_written;
+    int res  = 0;
+
+    switch (step.op) {
+    case OP_LITERAL:
+      break;
+
+    case OP_STRING:
+      if (escape_type == LOG_ESCAPE_NONE) {
+        // Strings are stored as they are printed.
+        res = static_cast<int>(::strlen(read_from));
+        if (res < len) {
+          memcpy(to, read_from, res);
+        } else {
+          res = -1;
+        }
+        read_from += LogAccess::strlen(read_from);
+      } else {
+        res = LogAccess::unmarshal_str(&read_from, to, len, &step.field->m_slice, escape_type);
+      }
+      break;
+
+    case OP_INT: {
+      char val_buf[32];
+      res = LogAccess::unmarshal_itoa(LogAccess::unmarshal_int(&read_from), val_buf + sizeof(val_buf) - 1);
+      if (res < len) {
+        memcpy(to, val_buf + sizeof(val_buf) - res, res);
+      } else {
+        res = -1;
+      }
+      break;
+    }
+
+    case OP_FUNC:
+      res = (*step.func)(&read_from, to, len);
+      break;
+
+    case OP_FIELD:
+      res = static_cast<int>(step.field->unmarshal(&read_from, to, len, escape_type));
+      break;
+    }
+
+    if (res < 0) {
+      SiteThrottledNote("%s", buffer_size_exceeded_msg);
+      return 0;
+    }
+    bytes_written += res;
+  }
+
+  return bytes_written;
+}
+
 /*-------------------------------------------------------------------------
   LogBufferList
 
@@ -744,3 +903,64 @@ LogBufferIterator::next()
 
   return ret_val;
 }
+
+#if TS_HAS_TESTS
+#include "tscore/TestBox.h"
+
+REGRESSION_TEST(LogBuffer_RenderProgram)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  char *printf_str = nullptr;
+  char *symbol_str = nullptr;
+  LogFormat::parse_format_string("%<ttms> \"%<cqhm> %<{User-Agent}cqh>\" %<pssc> [%<crc>] %<ttms>", &printf_str, &symbol_str);
+
+  // Lay down an entry for the format the way LogAccess marshals it.
+  char entry[256];
+  char *p = entry;
+  auto put_int = [&p](int64_t val) {
+    LogAccess::marshal_int(p, val);
+    p += sizeof(int64_t);
+  };
+  auto put_str = [&p](const char *str) {
+    int padded_len = LogAccess::strlen(str);
+    LogAccess::marshal_str(p, str, padded_len);
+    p += padded_len;
+  };
+  put_int(1234);
+  put_str("GET");
+  put_str("agent \"quoted\"");
+  put_int(200);
+  put_int(0);
+  put_int(-5);
+
+  LogFieldList fieldlist;
+  bool contains_aggregates = false;
+  LogFormat::parse_symbol_string(symbol_str, &fieldlist, &contains_aggregates);
+
+  LogRenderProgram program(symbol_str, printf_str);
+  box.check(program.valid(), "The format did not compile");
+
+  for (LogEscapeType escape_type : {LOG_ESCAPE_NONE, LOG_ESCAPE_JSON}) {
+    char expected[256];
+    char actual[256];
+    int expected_len = LogBuffer::resolve_custom_entry(&fieldlist, printf_str, entry, expected, sizeof(expected), 0, 0,
+                                                       LOG_SEGMENT_VERSION, nullptr, nullptr, escape_type);
+    int actual_len   = program.render(entry, actual, sizeof(actual), escape_type);
+
+    box.check(expected_len > 0, "Resolving the entry failed");
+    box.check(actual_len == expected_len && memcmp(actual, expected, actual_len) == 0, "Rendered '%.*s', expected '%.*s'",
+              actual_len, actual, expected_len, expected);
+
+    // Entries that do not fit are dropped, as before.
+    box.check(program.render(entry, actual, expected_len, escape_type) == 0, "An entry that did not fit was rendered");
+    box.check(program.render(entry, actual, expected_len + 1, escape_type) == expected_len, "An entry that fit was not rendered");
+  }
+
+  box.check(!LogRenderProgram("ttms", "\377 \377").valid(), "A format with more markers than fields compiled");
+
+  ats_free(printf_str);
+  ats_free(symbol_str);
+}
+#endif
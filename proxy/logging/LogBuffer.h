@@ -23,6 +23,10 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "tscore/ink_platform.h"
 #include "tscore/Diags.h"
 #include "LogFormat.h"
@@ -113,6 +117,66 @@ union LB_State {
   } s;
 };
 
+/*-------------------------------------------------------------------------
+  LogRenderProgram
+
+  A custom format compiled for converting entries to ascii.  The printf
+  string is split up front into the literal text before each field, and
+  each field gets the cheapest way to unmarshal it: plain strings are
+  copied straight out of the entry, integers are converted in place, and
+  other fields call their unmarshal routine directly rather than through
+  the LogField.  Programs are compiled once per fieldlist and printf
+  string and then shared, see LogBuffer::render_program().
+  -------------------------------------------------------------------------*/
+
+class LogRenderProgram
+{
+public:
+  LogRenderProgram(const char *symbol_str, const char *printf_str);
+
+  /** Whether the format could be compiled; if not, entries have to go
+   * through LogBuffer::resolve_custom_entry().
+   */
+  bool
+  valid() const
+  {
+    return m_valid;
+  }
+
+  /** Convert the entry data at @a read_from to ascii.
+   *
+   * @return the number of bytes written, or 0 if the entry did not fit in
+   * @a write_to_len bytes (one of which is kept for a terminator).
+   */
+  int render(char *read_from, char *write_to, int write_to_len, LogEscapeType escape_type = LOG_ESCAPE_NONE) const;
+
+  // noncopyable
+  LogRenderProgram(const LogRenderProgram &) = delete;
+  LogRenderProgram &operator=(const LogRenderProgram &) = delete;
+
+private:
+  enum Op {
+    OP_LITERAL, // the text after the last field
+    OP_STRING,  // unmarshal_str() without a slice
+    OP_INT,     // unmarshal_int_to_str()
+    OP_FUNC,    // an UnmarshalFunc called directly
+    OP_FIELD,   // anything else, through LogField::unmarshal()
+  };
+
+  struct Step {
+    Op op;
+    int literal_offset; // into m_printf_str
+    int literal_len;
+    LogField *field;
+    LogField::UnmarshalFunc func;
+  };
+
+  LogFieldList m_fieldlist;
+  std::string m_printf_str;
+  std::vector<Step> m_steps;
+  bool m_valid = false;
+};
+
 /*-------------------------------------------------------------------------
   LogBuffer
   -------------------------------------------------------------------------*/
@@ -190,6 +254,7 @@ public:
   static size_t max_entry_bytes();
   static int to_ascii(LogEntryHeader *entry, LogFormatType type, char *buf, int max_len, const char *symbol_str, char *printf_str,
                       unsigned buffer_version, const char *alt_format = nullptr, LogEscapeType escape_type = LOG_ESCAPE_NONE);
+  static const LogRenderProgram *render_program(const char *symbol_str, const char *printf_str);
   static int resolve_custom_entry(LogFieldList *fieldlist, char *printf_str, char *read_from, char *write_to, int write_to_len,
                                   long timestamp, long timestamp_us, unsigned buffer_version, LogFieldList *alt_fieldlist = nullptr,
                                   char *alt_printf_str = nullptr, LogEscapeType escape_type = LOG_ESCAPE_NONE);
@@ -0,0 +1,660 @@
+/** @file
+
+  Streaming log output to a collector over a stream socket.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "tscore/ink_platform.h"
+#include "tscore/Diags.h"
+#include "P_EventSystem.h"
+
+#include "LogCollector.h"
+#include "LogConfig.h"
+
+namespace
+{
+// Frames gathered into one write.
+constexpr int BATCH_FRAMES = 64;
+// Longest the sender thread sleeps, bounding how late a reconnect is tried.
+constexpr int POLL_TIMEOUT_MS = 100;
+// How long a connect may stay in progress.
+constexpr std::chrono::seconds CONNECT_TIMEOUT{1};
+// Reconnect backoff.
+constexpr std::chrono::seconds RETRY_MIN{1};
+constexpr std::chrono::seconds RETRY_MAX{30};
+} // namespace
+
+/*-------------------------------------------------------------------------
+  LogCollectorSender
+
+  The [LOG_COLLECTOR] thread.  It is spawned on first use, like the flush
+  thread it serves, and polls the connections of every registered collector.
+  Collectors only touch their connection state from this thread, and only
+  while it holds s_mutex, so unregistering under s_mutex is enough to make
+  a collector safe to destroy.
+  -------------------------------------------------------------------------*/
+
+class LogCollectorSender : public Continuation
+{
+public:
+  LogCollectorSender() : Continuation(nullptr) { SET_HANDLER(&LogCollectorSender::mainEvent); }
+
+  int mainEvent(int event, void *data);
+
+  static void add(LogCollector *collector);
+  static void remove(LogCollector *collector);
+  static void wake();
+
+private:
+  static std::mutex s_mutex;
+  static std::vector<LogCollector *> s_collectors;
+  static uint64_t s_generation; // bumped whenever s_collectors changes
+  static int s_wake_fd[2];
+  static bool s_started;
+};
+
+std::mutex LogCollectorSender::s_mutex;
+std::vector<LogCollector *> LogCollectorSender::s_collectors;
+uint64_t LogCollectorSender::s_generation = 0;
+int LogCollectorSender::s_wake_fd[2]      = {-1, -1};
+bool LogCollectorSender::s_started        = false;
+
+void
+LogCollectorSender::add(LogCollector *collector)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+
+  if (!s_started) {
+    if (::pipe(s_wake_fd) < 0) {
+      Fatal("could not create the log collector wakeup pipe: %s", strerror(errno));
+    }
+    for (int fd : s_wake_fd) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    size_t stacksize;
+    REC_ReadConfigInteger(stacksize, "proxy.config.thread.default.stacksize");
+    eventProcessor.spawn_thread(new LogCollectorSender, "[LOG_COLLECTOR]", stacksize);
+    s_started = true;
+  }
+
+  s_collectors.push_back(collector);
+  ++s_generation;
+}
+
+void
+LogCollectorSender::remove(LogCollector *collector)
+{
+  // Have a poll in progress return, so that the thread moves on without it.
+  wake();
+
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_collectors.erase(std::remove(s_collectors.begin(), s_collectors.end(), collector), s_collectors.end());
+  ++s_generation;
+}
+
+void
+LogCollectorSender::wake()
+{
+  if (s_wake_fd[1] >= 0) {
+    ATS_UNUSED_RETURN(::write(s_wake_fd[1], "", 1));
+  }
+}
+
+int
+LogCollectorSender::mainEvent(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+{
+  std::vector<pollfd> pfds;
+  std::unique_lock<std::mutex> lock(s_mutex);
+
+  while (true) {
+    pfds.clear();
+    for (LogCollector *collector : s_collectors) {
+      short events = collector->prepare(LogCollector::Clock::now());
+      pfds.push_back(pollfd{collector->m_fd, events, 0});
+    }
+    pfds.push_back(pollfd{s_wake_fd[0], POLLIN, 0});
+    uint64_t generation = s_generation;
+
+    lock.unlock();
+    ::poll(pfds.data(), pfds.size(), POLL_TIMEOUT_MS);
+    lock.lock();
+
+    if (pfds.back().revents & POLLIN) {
+      char buf[64];
+      while (::read(s_wake_fd[0], buf, sizeof(buf)) > 0) {
+      }
+    }
+
+    // The results are only good for the collectors that were polled.
+    if (generation != s_generation) {
+      continue;
+    }
+
+    LogCollector::Clock::time_point now = LogCollector::Clock::now();
+    for (size_t i = 0; i < s_collectors.size(); ++i) {
+      s_collectors[i]->service(pfds[i].revents, now);
+    }
+  }
+
+  return EVENT_DONE;
+}
+
+/*-------------------------------------------------------------------------
+  LogCollector
+  -------------------------------------------------------------------------*/
+
+LogCollector::LogCollector(const char *name, const char *address, bool binary, size_t queue_size)
+  : m_name(name),
+    m_address(address),
+    m_frame_type(binary ? LOG_COLLECTOR_FRAME_BINARY : LOG_COLLECTOR_FRAME_ASCII),
+    m_queue_size(queue_size)
+{
+  ink_zero(m_unix_addr);
+  ink_zero(m_ip_addr);
+  m_valid = parse_address(address, &m_unix_addr, &m_ip_addr, &m_is_unix);
+  if (!m_valid) {
+    Error("invalid log collector address '%s' for %s", address, name);
+  }
+}
+
+LogCollector::~LogCollector()
+{
+  if (m_registered) {
+    LogCollectorSender::remove(this);
+  }
+  disconnect();
+
+  // Whatever the collector did not take is lost, as if the queue were full.
+  for (auto &frame : m_queue) {
+    RecIncrGlobalRawStatSum(log_rsb, log_stat_num_lost_before_sent_to_network_stat, frame.entries);
+    RecIncrGlobalRawStatSum(log_rsb, log_stat_bytes_lost_before_sent_to_network_stat, frame.len - sizeof(LogCollectorFrameHeader));
+    ats_free(frame.data);
+  }
+}
+
+bool
+LogCollector::parse_address(const char *address, sockaddr_un *unix_addr, IpEndpoint *ip_addr, bool *is_unix)
+{
+  std::string_view text{address};
+
+  if (text.substr(0, 5) == "unix:") {
+    text.remove_prefix(5);
+    if (text.empty() || text.size() >= sizeof(unix_addr->sun_path)) {
+      return false;
+    }
+    unix_addr->sun_family = AF_UNIX;
+    memcpy(unix_addr->sun_path, text.data(), text.size());
+    unix_addr->sun_path[text.size()] = '\0';
+    *is_unix                         = true;
+    return true;
+  }
+
+  *is_unix = false;
+  return ats_ip_pton(text, ip_addr) == 0 && ats_ip_port_cast(ip_addr) != 0;
+}
+
+bool
+LogCollector::valid_address(const char *address)
+{
+  sockaddr_un unix_addr;
+  IpEndpoint ip_addr;
+  bool is_unix;
+
+  return address && parse_address(address, &unix_addr, &ip_addr, &is_unix);
+}
+
+bool
+LogCollector::enqueue(const char *data, int len, int entries)
+{
+  LogCollectorFrameHeader header;
+  size_t frame_len = sizeof(header) + len;
+  bool first_use   = false;
+  bool was_empty;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Connect on first use, so that objects which are thrown away when the
+    // configuration is reloaded never open a connection.
+    if (m_valid && !m_registered) {
+      m_registered = true;
+      first_use    = true;
+    }
+
+    if (m_queued_bytes + frame_len > m_queue_size || !m_valid) {
+      Debug("log-collector", "queue for collector %s is full, dropping %d entries of %s", m_address.c_str(), entries,
+            m_name.c_str());
+      RecIncrGlobalRawStatSum(log_rsb, log_stat_num_lost_before_sent_to_network_stat, entries);
+      RecIncrGlobalRawStatSum(log_rsb, log_stat_bytes_lost_before_sent_to_network_stat, len);
+      if (first_use) {
+        LogCollectorSender::add(this);
+      }
+      return false;
+    }
+
+    header.length = htonl(len);
+    header.type   = htonl(m_frame_type);
+
+    char *frame = static_cast<char *>(ats_malloc(frame_len));
+    memcpy(frame, &header, sizeof(header));
+    memcpy(frame + sizeof(header), data, len);
+
+    was_empty = m_queue.empty();
+    m_queue.push_back(Frame{frame, frame_len, entries});
+    m_queued_bytes += frame_len;
+  }
+
+  if (first_use) {
+    LogCollectorSender::add(this);
+  } else if (was_empty) {
+    LogCollectorSender::wake();
+  }
+  return true;
+}
+
+/*-------------------------------------------------------------------------
+  Called by the sender thread, under its lock.
+  -------------------------------------------------------------------------*/
+
+short
+LogCollector::prepare(Clock::time_point now)
+{
+  if (m_fd < 0 && now >= m_retry_at) {
+    if (!start_connect()) {
+      connect_failed(now);
+    } else if (!m_connecting && !send_hello()) {
+      connect_failed(now);
+    }
+  }
+
+  if (m_fd < 0) {
+    return 0;
+  }
+  if (m_connecting) {
+    return POLLOUT;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return POLLIN | (m_credits > 0 && !m_queue.empty() ? POLLOUT : 0);
+}
+
+void
+LogCollector::service(short revents, Clock::time_point now)
+{
+  if (m_fd < 0) {
+    return;
+  }
+
+  if (m_connecting) {
+    if (revents) {
+      if (!finish_connect() || !send_hello()) {
+        connect_failed(now);
+      }
+    } else if (now >= m_connect_deadline) {
+      Debug("log-collector", "timed out connecting to collector %s for %s", m_address.c_str(), m_name.c_str());
+      connect_failed(now);
+    }
+    return;
+  }
+
+  // Pick up any credit the collector has sent, and notice if it went away.
+  // A lost connection is retried at once, only failed connects back off.
+  if ((revents & (POLLIN | POLLHUP | POLLERR)) && !read_credits()) {
+    disconnect();
+    return;
+  }
+  if (!send_frames()) {
+    Debug("log-collector", "lost connection to collector %s for %s: %s", m_address.c_str(), m_name.c_str(), strerror(errno));
+    disconnect();
+  }
+}
+
+bool
+LogCollector::start_connect()
+{
+  const sockaddr *addr = m_is_unix ? reinterpret_cast<const sockaddr *>(&m_unix_addr) : &m_ip_addr.sa;
+  socklen_t addr_len   = m_is_unix ? sizeof(m_unix_addr) : ats_ip_size(&m_ip_addr.sa);
+
+  m_fd = ::socket(addr->sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (m_fd < 0) {
+    Error("could not create a socket for log collector %s: %s", m_address.c_str(), strerror(errno));
+    return false;
+  }
+
+  if (::connect(m_fd, addr, addr_len) < 0) {
+    if (errno != EINPROGRESS) {
+      Debug("log-collector", "could not connect to collector %s for %s: %s", m_address.c_str(), m_name.c_str(), strerror(errno));
+      return false;
+    }
+    m_connecting       = true;
+    m_connect_deadline = Clock::now() + CONNECT_TIMEOUT;
+    return true;
+  }
+
+  return true;
+}
+
+bool
+LogCollector::finish_connect()
+{
+  int err       = 0;
+  socklen_t len = sizeof(err);
+
+  m_connecting = false;
+  if (getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+    Debug("log-collector", "could not connect to collector %s for %s: %s", m_address.c_str(), m_name.c_str(), strerror(err));
+    return false;
+  }
+  return true;
+}
+
+void
+LogCollector::connect_failed(Clock::time_point now)
+{
+  disconnect();
+  m_retry_at = now + m_retry;
+  m_retry    = std::min(m_retry * 2, RETRY_MAX);
+}
+
+void
+LogCollector::disconnect()
+{
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+  m_connecting = false;
+  // A frame that was cut short is sent again in full on the next connection.
+  m_sent           = 0;
+  m_credits        = 0;
+  m_credit_partial = 0;
+}
+
+bool
+LogCollector::send_hello()
+{
+  LogCollectorFrameHeader header;
+  header.length = htonl(m_name.size());
+  header.type   = htonl(LOG_COLLECTOR_FRAME_HELLO);
+
+  iovec iov[2] = {{&header, sizeof(header)}, {m_name.data(), m_name.size()}};
+  size_t total = sizeof(header) + m_name.size();
+  msghdr msg;
+  ink_zero(msg);
+  msg.msg_iov    = iov;
+  msg.msg_iovlen = 2;
+
+  // The socket buffer is empty on a new connection, this goes out at once.
+  if (::sendmsg(m_fd, &msg, MSG_NOSIGNAL) != static_cast<ssize_t>(total)) {
+    return false;
+  }
+
+  Note("connected to log collector %s for %s", m_address.c_str(), m_name.c_str());
+  m_retry = RETRY_MIN;
+  return true;
+}
+
+bool
+LogCollector::send_frames()
+{
+  // Gather as many frames as the credit allows into one write.  The frames
+  // stay at the front of the queue, which only this thread pops.
+  iovec iov[BATCH_FRAMES];
+  int n;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    n = std::min<size_t>({m_queue.size(), m_credits, BATCH_FRAMES});
+    for (int i = 0; i < n; ++i) {
+      size_t skip     = i == 0 ? m_sent : 0;
+      iov[i].iov_base = m_queue[i].data + skip;
+      iov[i].iov_len  = m_queue[i].len - skip;
+    }
+  }
+  if (n == 0) {
+    return true;
+  }
+
+  msghdr msg;
+  ink_zero(msg);
+  msg.msg_iov    = iov;
+  msg.msg_iovlen = n;
+
+  ssize_t written = ::sendmsg(m_fd, &msg, MSG_NOSIGNAL);
+  if (written < 0) {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+  }
+
+  // Retire the frames that went out completely.
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t done = m_sent + written;
+  while (!m_queue.empty() && done >= m_queue.front().len) {
+    Frame &frame = m_queue.front();
+    done -= frame.len;
+    m_queued_bytes -= frame.len;
+    --m_credits;
+    RecIncrGlobalRawStatSum(log_rsb, log_stat_num_sent_to_network_stat, frame.entries);
+    RecIncrGlobalRawStatSum(log_rsb, log_stat_bytes_sent_to_network_stat, frame.len - sizeof(LogCollectorFrameHeader));
+    ats_free(frame.data);
+    m_queue.pop_front();
+  }
+  m_sent = done;
+  return true;
+}
+
+bool
+LogCollector::read_credits()
+{
+  char buf[256];
+
+  while (true) {
+    ssize_t n = ::recv(m_fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n == 0) {
+      Debug("log-collector", "collector %s for %s closed the connection", m_address.c_str(), m_name.c_str());
+      return false;
+    }
+    if (n < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    for (ssize_t i = 0; i < n; ++i) {
+      m_credit_buf = (m_credit_buf << 8) | static_cast<uint8_t>(buf[i]);
+      if (++m_credit_partial == sizeof(uint32_t)) {
+        m_credits        = std::min<uint64_t>(static_cast<uint64_t>(m_credits) + m_credit_buf, UINT32_MAX);
+        m_credit_buf     = 0;
+        m_credit_partial = 0;
+      }
+    }
+  }
+}
+
+#if TS_HAS_TESTS
+#include "tscore/TestBox.h"
+
+namespace
+{
+// Read exactly @a len bytes, waiting at most @a timeout_ms for each part.
+bool
+test_read(int fd, void *buf, size_t len, int timeout_ms = 5000)
+{
+  char *p = static_cast<char *>(buf);
+
+  while (len > 0) {
+    pollfd pfd = {fd, POLLIN, 0};
+    if (::poll(&pfd, 1, timeout_ms) <= 0) {
+      return false;
+    }
+    ssize_t n = ::read(fd, p, len);
+    if (n <= 0) {
+      return false;
+    }
+    p   += n;
+    len -= n;
+  }
+  return true;
+}
+
+bool
+test_read_frame(int fd, uint32_t *type, std::string *payload)
+{
+  LogCollectorFrameHeader header;
+
+  if (!test_read(fd, &header, sizeof(header))) {
+    return false;
+  }
+  *type = ntohl(header.type);
+  payload->resize(ntohl(header.length));
+  return test_read(fd, payload->data(), payload->size());
+}
+
+// Check that nothing arrives for a while.
+bool
+test_quiet(int fd)
+{
+  pollfd pfd = {fd, POLLIN, 0};
+  return ::poll(&pfd, 1, 300) == 0;
+}
+
+int
+test_accept(int listen_fd)
+{
+  pollfd pfd = {listen_fd, POLLIN, 0};
+  return ::poll(&pfd, 1, 5000) > 0 ? ::accept(listen_fd, nullptr, nullptr) : -1;
+}
+
+void
+test_credit(int fd, uint32_t credits)
+{
+  credits = htonl(credits);
+  ATS_UNUSED_RETURN(::write(fd, &credits, sizeof(credits)));
+}
+
+int64_t
+test_stat(int id)
+{
+  int64_t value = 0;
+  RecGetGlobalRawStatSum(log_rsb, id, &value);
+  return value;
+}
+} // namespace
+
+REGRESSION_TEST(LogCollector_Stream)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  std::string path = "/tmp/trafficserver_log_collector_" + std::to_string(getpid()) + ".sock";
+  sockaddr_un addr;
+  ink_zero(addr);
+  addr.sun_family = AF_UNIX;
+  ink_strlcpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path));
+  ::unlink(path.c_str());
+
+  int listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd < 0 || ::bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || ::listen(listen_fd, 4) < 0) {
+    box.check(false, "could not listen on %s: %s", path.c_str(), strerror(errno));
+    ::close(listen_fd);
+    return;
+  }
+
+  // The queue has room for two frames of two bytes.
+  size_t frame_len            = sizeof(LogCollectorFrameHeader) + 2;
+  Ptr<LogCollector> collector = make_ptr(new LogCollector("collector_test", ("unix:" + path).c_str(), false, 2 * frame_len));
+  uint32_t type;
+  std::string payload;
+  int64_t lost_entries, lost_bytes, sent_entries, sent_bytes;
+
+  // The first frame connects, and the collector hears the name of the
+  // object but no data until it grants credit.
+  box.check(collector->enqueue("a\n", 2, 1), "the first frame was dropped");
+  int fd = test_accept(listen_fd);
+  if (fd < 0) {
+    box.check(false, "the collector was not connected to");
+    ::close(listen_fd);
+    ::unlink(path.c_str());
+    return;
+  }
+  box.check(test_read_frame(fd, &type, &payload) && type == LOG_COLLECTOR_FRAME_HELLO && payload == "collector_test",
+            "expected a HELLO frame naming the object");
+  box.check(test_quiet(fd), "data was sent without credit");
+
+  // A frame that does not fit the queue is dropped and counted.
+  lost_entries = test_stat(log_stat_num_lost_before_sent_to_network_stat);
+  lost_bytes   = test_stat(log_stat_bytes_lost_before_sent_to_network_stat);
+  box.check(collector->enqueue("b\n", 2, 1), "the second frame was dropped");
+  box.check(!collector->enqueue("c\n", 2, 3), "a frame beyond the queue size was accepted");
+  box.check(test_stat(log_stat_num_lost_before_sent_to_network_stat) == lost_entries + 3 &&
+              test_stat(log_stat_bytes_lost_before_sent_to_network_stat) == lost_bytes + 2,
+            "the dropped frame was not counted");
+
+  // Each credit lets one frame go, once it is used up the sender waits.
+  sent_entries = test_stat(log_stat_num_sent_to_network_stat);
+  sent_bytes   = test_stat(log_stat_bytes_sent_to_network_stat);
+  test_credit(fd, 1);
+  box.check(test_read_frame(fd, &type, &payload) && type == LOG_COLLECTOR_FRAME_ASCII && payload == "a\n",
+            "expected the first frame");
+  box.check(test_quiet(fd), "a frame was sent beyond the credit");
+  test_credit(fd, 5);
+  box.check(test_read_frame(fd, &type, &payload) && type == LOG_COLLECTOR_FRAME_ASCII && payload == "b\n",
+            "expected the second frame");
+  box.check(test_quiet(fd), "unexpected data after the second frame");
+  box.check(test_stat(log_stat_num_sent_to_network_stat) == sent_entries + 2 &&
+              test_stat(log_stat_bytes_sent_to_network_stat) == sent_bytes + 4,
+            "the sent frames were not counted");
+
+  // A lost connection is made again at once.  The new connection starts
+  // without credit, and the frame queued meanwhile goes out on it.
+  ::close(fd);
+  box.check(collector->enqueue("d\n", 2, 1), "the frame after the connection was lost was dropped");
+  fd = test_accept(listen_fd);
+  box.check(fd >= 0, "the collector was not connected to again");
+  if (fd >= 0) {
+    box.check(test_read_frame(fd, &type, &payload) && type == LOG_COLLECTOR_FRAME_HELLO && payload == "collector_test",
+              "expected a HELLO frame on the new connection");
+    box.check(test_quiet(fd), "credit was carried over to the new connection");
+    test_credit(fd, 1);
+    box.check(test_read_frame(fd, &type, &payload) && type == LOG_COLLECTOR_FRAME_ASCII && payload == "d\n",
+              "expected the queued frame on the new connection");
+  }
+
+  // Frames still queued when the collector goes away are lost.
+  box.check(collector->enqueue("e\n", 2, 2), "the last frame was dropped");
+  lost_entries = test_stat(log_stat_num_lost_before_sent_to_network_stat);
+  lost_bytes   = test_stat(log_stat_bytes_lost_before_sent_to_network_stat);
+  collector.clear();
+  box.check(test_stat(log_stat_num_lost_before_sent_to_network_stat) == lost_entries + 2 &&
+              test_stat(log_stat_bytes_lost_before_sent_to_network_stat) == lost_bytes + 2,
+            "the frames queued at destruction were not counted");
+
+  if (fd >= 0) {
+    ::close(fd);
+  }
+  ::close(listen_fd);
+  ::unlink(path.c_str());
+}
+#endif
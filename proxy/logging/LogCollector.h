@@ -0,0 +1,156 @@
+/** @file
+
+  Streaming log output to a collector over a stream socket.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include <sys/un.h>
+
+#include "tscore/ink_inet.h"
+#include "tscore/Ptr.h"
+
+/*-------------------------------------------------------------------------
+  Collector protocol
+
+  Every frame sent to the collector starts with a LogCollectorFrameHeader,
+  in network byte order, followed by length bytes of payload:
+
+    HELLO   sent first on each connection, the name of the log object.
+    BINARY  a LogBuffer, exactly as it would be written to a binary log.
+    ASCII   one or more newline terminated entries of an ascii log.
+
+  The collector paces the sender with credits.  It sends a stream of 32 bit
+  integers in network byte order, each of which allows that many more
+  BINARY or ASCII frames to be sent.  A new connection starts with no
+  credit.  While there is no credit, frames are queued in memory up to
+  proxy.config.log.collector.queue_size bytes, and frames that do not fit
+  are dropped and counted.
+  -------------------------------------------------------------------------*/
+
+enum LogCollectorFrameType {
+  LOG_COLLECTOR_FRAME_HELLO  = 1,
+  LOG_COLLECTOR_FRAME_BINARY = 2,
+  LOG_COLLECTOR_FRAME_ASCII  = 3,
+};
+
+struct LogCollectorFrameHeader {
+  uint32_t length; // payload bytes following the header
+  uint32_t type;   // LogCollectorFrameType
+};
+
+/*-------------------------------------------------------------------------
+  LogCollector
+
+  The sending side of a connection to a collector.  The flush thread hands
+  the data for a log object to enqueue(), which never blocks.  A single
+  [LOG_COLLECTOR] thread, shared by all collectors, connects, batches the
+  queued frames into as few writes as the credit allows, and reconnects
+  when the connection is lost.
+  -------------------------------------------------------------------------*/
+
+class LogCollector : public RefCountObj
+{
+public:
+  /** @a address is either "unix:<path>" or an IP address and port.
+   *
+   * @a binary selects BINARY or ASCII frames for the data.
+   */
+  LogCollector(const char *name, const char *address, bool binary, size_t queue_size);
+  ~LogCollector() override;
+
+  /// Check that @a address can be used for a collector.
+  static bool valid_address(const char *address);
+
+  /** Queue @a len bytes of @a data, holding @a entries log entries, as
+   * one frame.
+   *
+   * @return false if the frame was dropped because the queue is full.
+   */
+  bool enqueue(const char *data, int len, int entries);
+
+  const char *
+  address() const
+  {
+    return m_address.c_str();
+  }
+
+  // noncopyable
+  LogCollector(const LogCollector &) = delete;
+  LogCollector &operator=(const LogCollector &) = delete;
+
+private:
+  friend class LogCollectorSender;
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Frame {
+    char *data; // header and payload
+    size_t len;
+    int entries;
+  };
+
+  static bool parse_address(const char *address, sockaddr_un *unix_addr, IpEndpoint *ip_addr, bool *is_unix);
+
+  // Called by the sender thread.
+  short prepare(Clock::time_point now);
+  void service(short revents, Clock::time_point now);
+  bool start_connect();
+  bool finish_connect();
+  void connect_failed(Clock::time_point now);
+  void disconnect();
+  bool read_credits();
+  bool send_hello();
+  bool send_frames();
+
+  std::string m_name;
+  std::string m_address;
+  uint32_t m_frame_type;
+  size_t m_queue_size;
+
+  sockaddr_un m_unix_addr;
+  IpEndpoint m_ip_addr;
+  bool m_is_unix = false;
+  bool m_valid   = false;
+
+  // Shared with the flush thread, under m_mutex.
+  std::mutex m_mutex;
+  std::deque<Frame> m_queue;
+  size_t m_queued_bytes = 0;
+  bool m_registered     = false; // handed to the sender thread
+
+  // Owned by the sender thread.
+  int m_fd                = -1;
+  bool m_connecting       = false;
+  uint32_t m_credits      = 0;
+  size_t m_sent           = 0; // bytes of the first queued frame already sent
+  uint32_t m_credit_buf   = 0;
+  size_t m_credit_partial = 0;
+  std::chrono::seconds m_retry{1};
+  Clock::time_point m_retry_at;
+  Clock::time_point m_connect_deadline;
+};
@@ -0,0 +1,524 @@
+/** @file
+
+  Columnar, block compressed log files.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "tscore/ink_platform.h"
+#include "tscore/ink_memory.h"
+#include "fastlz/fastlz.h"
+
+#include "LogColumnar.h"
+#include "LogField.h"
+#include "LogFormat.h"
+#include "LogLimits.h"
+
+/*-------------------------------------------------------------------------
+  The payload of a block, before compression, is laid out as
+
+      uint32_t header_bytes
+      char     header[header_bytes]         LogBufferHeader and its strings
+      int64_t  timestamp[entry_count]       each one less the one before
+      int32_t  timestamp_usec[entry_count]
+      uint32_t entry_len[entry_count]
+      uint32_t column_bytes[column_count]
+      uint32_t width[column_count][entry_count]
+      char     column[column_count][column_bytes]
+
+  An entry is the concatenation of its values in each column, padded with
+  zeros to its entry_len.
+  -------------------------------------------------------------------------*/
+
+namespace
+{
+template <typename T>
+void
+put(std::vector<char> &out, const T *data, size_t count)
+{
+  const char *p = reinterpret_cast<const char *>(data);
+  out.insert(out.end(), p, p + sizeof(T) * count);
+}
+
+// Reads from the payload, refusing to run past its end.
+struct PayloadReader {
+  const char *pos;
+  const char *end;
+
+  template <typename T>
+  bool
+  get(T *data, size_t count)
+  {
+    if (static_cast<size_t>(end - pos) / sizeof(T) < count) {
+      return false;
+    }
+    memcpy(data, pos, sizeof(T) * count);
+    pos += sizeof(T) * count;
+    return true;
+  }
+
+  const char *
+  skip(size_t bytes)
+  {
+    if (static_cast<size_t>(end - pos) < bytes) {
+      return nullptr;
+    }
+    pos += bytes;
+    return pos - bytes;
+  }
+};
+} // namespace
+
+LogColumnarBlock::LogColumnarBlock() {}
+
+LogColumnarBlock::~LogColumnarBlock() {}
+
+bool
+LogColumnarBlock::same_format(LogBufferHeader *buffer_header) const
+{
+  const LogBufferHeader *h = reinterpret_cast<const LogBufferHeader *>(m_header.data());
+
+  if (h->format_type != buffer_header->format_type || h->log_object_signature != buffer_header->log_object_signature) {
+    return false;
+  }
+
+  const char *fieldlist = buffer_header->fmt_fieldlist();
+  const char *our_list  = h->fmt_fieldlist_offset ? m_header.data() + h->fmt_fieldlist_offset : nullptr;
+
+  if (fieldlist == nullptr || our_list == nullptr) {
+    return fieldlist == our_list;
+  }
+  return strcmp(fieldlist, our_list) == 0;
+}
+
+bool
+LogColumnarBlock::add(LogBufferHeader *buffer_header)
+{
+  if (m_header.empty()) {
+    const char *start = reinterpret_cast<const char *>(buffer_header);
+    m_header.assign(start, start + buffer_header->data_offset);
+
+    // Split custom formats into their fields, anything else is kept whole.
+    const char *fieldlist = buffer_header->fmt_fieldlist();
+    if (buffer_header->format_type == LOG_FORMAT_CUSTOM && fieldlist) {
+      bool contains_aggregates = false;
+      m_fields.reset(new LogFieldList);
+      if (LogFormat::parse_symbol_string(fieldlist, m_fields.get(), &contains_aggregates) <= 0) {
+        m_fields.reset();
+      }
+    }
+    size_t columns = (m_fields ? m_fields->count() : 0) + 1;
+    m_width.resize(columns);
+    m_column.resize(columns);
+    m_low_timestamp  = buffer_header->low_timestamp;
+    m_high_timestamp = buffer_header->high_timestamp;
+  } else if (!same_format(buffer_header)) {
+    return false;
+  }
+
+  m_low_timestamp  = std::min(m_low_timestamp, buffer_header->low_timestamp);
+  m_high_timestamp = std::max(m_high_timestamp, buffer_header->high_timestamp);
+
+  size_t rest = m_column.size() - 1;
+  std::vector<uint32_t> width(m_column.size());
+  char scratch[LOG_MAX_FORMATTED_LINE];
+  LogBufferIterator iter(buffer_header);
+  LogEntryHeader *entry_header;
+
+  while ((entry_header = iter.next())) {
+    char *data     = reinterpret_cast<char *>(entry_header) + sizeof(LogEntryHeader);
+    char *data_end = reinterpret_cast<char *>(entry_header) + entry_header->entry_len;
+    char *pos      = data;
+
+    // Unmarshal each field to find where it ends.
+    if (m_fields) {
+      size_t i    = 0;
+      LogField *f = m_fields->first();
+      for (; f && pos < data_end; f = m_fields->next(f), ++i) {
+        char *from = pos;
+        f->unmarshal(&pos, scratch, sizeof(scratch));
+        width[i] = pos - from;
+      }
+      if (f || pos > data_end) {
+        // The entry does not split into these fields, keep it whole.
+        std::fill(width.begin(), width.end(), 0);
+        pos = data;
+      }
+    }
+    width[rest] = data_end - pos;
+
+    pos = data;
+    for (size_t i = 0; i < m_column.size(); ++i) {
+      m_width[i].push_back(width[i]);
+      m_column[i].insert(m_column[i].end(), pos, pos + width[i]);
+      pos += width[i];
+    }
+
+    m_timestamp.push_back(entry_header->timestamp);
+    m_timestamp_usec.push_back(entry_header->timestamp_usec);
+    m_entry_len.push_back(entry_header->entry_len);
+    m_bytes += entry_header->entry_len;
+  }
+
+  return true;
+}
+
+LogColumnarHeader *
+LogColumnarBlock::encode()
+{
+  uint32_t n = entry_count();
+
+  if (n == 0) {
+    return nullptr;
+  }
+
+  std::vector<char> raw;
+  uint32_t header_bytes = m_header.size();
+  LogBufferHeader *h    = reinterpret_cast<LogBufferHeader *>(m_header.data());
+
+  h->low_timestamp  = m_low_timestamp;
+  h->high_timestamp = m_high_timestamp;
+
+  raw.reserve(m_bytes + header_bytes + n * (sizeof(uint32_t) * m_column.size() + 16));
+  put(raw, &header_bytes, 1);
+  put(raw, m_header.data(), header_bytes);
+
+  // Timestamps mostly repeat, deltas compress better.
+  int64_t last = 0;
+  for (auto &t : m_timestamp) {
+    int64_t delta = t - last;
+    last          = t;
+    t             = delta;
+  }
+  put(raw, m_timestamp.data(), n);
+  put(raw, m_timestamp_usec.data(), n);
+  put(raw, m_entry_len.data(), n);
+
+  for (auto const &column : m_column) {
+    uint32_t bytes = column.size();
+    put(raw, &bytes, 1);
+  }
+  for (auto const &width : m_width) {
+    put(raw, width.data(), n);
+  }
+  for (auto const &column : m_column) {
+    put(raw, column.data(), column.size());
+  }
+
+  // FastLZ needs 5% (and at least 66 bytes) of headroom.
+  size_t capacity           = raw.size() + raw.size() / 16 + 66;
+  LogColumnarHeader *header = static_cast<LogColumnarHeader *>(ats_malloc(sizeof(LogColumnarHeader) + capacity));
+  char *payload             = reinterpret_cast<char *>(header + 1);
+  int compressed            = 0;
+
+  if (raw.size() >= 16) {
+    compressed = fastlz_compress_level(2, raw.data(), raw.size(), payload);
+  }
+
+  header->cookie       = LOG_COLUMNAR_COOKIE;
+  header->version      = LOG_COLUMNAR_VERSION;
+  header->entry_count  = n;
+  header->column_count = m_column.size();
+  header->raw_bytes    = raw.size();
+  header->reserved     = 0;
+  if (compressed > 0 && static_cast<size_t>(compressed) < raw.size()) {
+    header->codec         = LOG_COLUMNAR_CODEC_FASTLZ;
+    header->payload_bytes = compressed;
+  } else {
+    header->codec         = LOG_COLUMNAR_CODEC_NONE;
+    header->payload_bytes = raw.size();
+    memcpy(payload, raw.data(), raw.size());
+  }
+
+  clear();
+  return header;
+}
+
+void
+LogColumnarBlock::clear()
+{
+  m_header.clear();
+  m_fields.reset();
+  m_timestamp.clear();
+  m_timestamp_usec.clear();
+  m_entry_len.clear();
+  m_width.clear();
+  m_column.clear();
+  m_low_timestamp  = 0;
+  m_high_timestamp = 0;
+  m_bytes          = 0;
+}
+
+LogBufferHeader *
+LogColumnarBlock::decode(const LogColumnarHeader *header, const char *payload)
+{
+  if (header->cookie != LOG_COLUMNAR_COOKIE || header->version != LOG_COLUMNAR_VERSION || header->column_count == 0) {
+    return nullptr;
+  }
+
+  ats_scoped_mem<char> raw;
+  PayloadReader in{payload, payload + header->payload_bytes};
+
+  switch (header->codec) {
+  case LOG_COLUMNAR_CODEC_NONE:
+    if (header->raw_bytes != header->payload_bytes) {
+      return nullptr;
+    }
+    break;
+  case LOG_COLUMNAR_CODEC_FASTLZ:
+    raw = static_cast<char *>(ats_malloc(header->raw_bytes));
+    if (fastlz_decompress(payload, header->payload_bytes, raw, header->raw_bytes) != static_cast<int>(header->raw_bytes)) {
+      return nullptr;
+    }
+    in = {raw, raw + header->raw_bytes};
+    break;
+  default:
+    return nullptr;
+  }
+
+  uint32_t n       = header->entry_count;
+  uint32_t columns = header->column_count;
+  uint32_t header_bytes;
+  const char *buffer_header;
+  std::vector<int64_t> timestamp(n);
+  std::vector<int32_t> timestamp_usec(n);
+  std::vector<uint32_t> entry_len(n);
+  std::vector<uint32_t> column_bytes(columns);
+  std::vector<uint32_t> width(static_cast<size_t>(columns) * n);
+  std::vector<const char *> column(columns);
+
+  if (!in.get(&header_bytes, 1) || header_bytes < sizeof(LogBufferHeader) || !(buffer_header = in.skip(header_bytes)) ||
+      !in.get(timestamp.data(), n) || !in.get(timestamp_usec.data(), n) || !in.get(entry_len.data(), n) ||
+      !in.get(column_bytes.data(), columns) || !in.get(width.data(), width.size())) {
+    return nullptr;
+  }
+  for (uint32_t c = 0; c < columns; ++c) {
+    if (!(column[c] = in.skip(column_bytes[c]))) {
+      return nullptr;
+    }
+  }
+
+  uint64_t byte_count = header_bytes;
+  for (uint32_t i = 0; i < n; ++i) {
+    byte_count += entry_len[i];
+  }
+  if (byte_count > UINT32_MAX) {
+    return nullptr;
+  }
+
+  char *buf = static_cast<char *>(ats_malloc(byte_count));
+  char *out = buf + header_bytes;
+  int64_t t = 0;
+
+  memcpy(buf, buffer_header, header_bytes);
+  for (uint32_t i = 0; i < n; ++i) {
+    LogEntryHeader entry_header;
+    char *entry_end = out + entry_len[i];
+
+    t += timestamp[i];
+    entry_header.timestamp      = t;
+    entry_header.timestamp_usec = timestamp_usec[i];
+    entry_header.entry_len      = entry_len[i];
+    if (entry_len[i] < sizeof(LogEntryHeader)) {
+      ats_free(buf);
+      return nullptr;
+    }
+    memcpy(out, &entry_header, sizeof(LogEntryHeader));
+    out += sizeof(LogEntryHeader);
+
+    for (uint32_t c = 0; c < columns; ++c) {
+      uint32_t w = width[static_cast<size_t>(c) * n + i];
+      if (w > static_cast<size_t>(entry_end - out) || w > column_bytes[c]) {
+        ats_free(buf);
+        return nullptr;
+      }
+      memcpy(out, column[c], w);
+      column[c] += w;
+      column_bytes[c] -= w;
+      out += w;
+    }
+    memset(out, 0, entry_end - out);
+    out = entry_end;
+  }
+
+  LogBufferHeader *h = reinterpret_cast<LogBufferHeader *>(buf);
+  h->entry_count     = n;
+  h->byte_count      = byte_count;
+  h->data_offset     = header_bytes;
+  return h;
+}
+
+#if TS_HAS_TESTS
+#include "LogBuffer.h"
+#include "LogAccess.h"
+#include "tscore/TestBox.h"
+
+REGRESSION_TEST(LogColumnar_RoundTrip)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  char *printf_str = nullptr;
+  char *symbol_str = nullptr;
+  LogFormat::parse_format_string("%<cqhm> \"%<{User-Agent}cqh>\" %<pssc> %<ttms>", &printf_str, &symbol_str);
+
+  // Lay down a LogBuffer image the way LogBuffer and LogAccess do.
+  alignas(LogBufferHeader) char image[2048] = {};
+  LogBufferHeader *header = reinterpret_cast<LogBufferHeader *>(image);
+  size_t len              = sizeof(LogBufferHeader);
+
+  header->cookie               = LOG_SEGMENT_COOKIE;
+  header->version              = LOG_SEGMENT_VERSION;
+  header->format_type          = LOG_FORMAT_CUSTOM;
+  header->low_timestamp        = 1000;
+  header->high_timestamp       = 1002;
+  header->fmt_fieldlist_offset = len;
+  len += ink_strlcpy(image + len, symbol_str, sizeof(image) - len) + 1;
+  header->fmt_printf_offset = len;
+  len += ink_strlcpy(image + len, printf_str, sizeof(image) - len) + 1;
+  header->data_offset = INK_ALIGN_DEFAULT(len);
+
+  char *p               = image + header->data_offset;
+  LogEntryHeader *entry = nullptr;
+
+  auto begin_entry = [&](int64_t timestamp) {
+    entry                 = reinterpret_cast<LogEntryHeader *>(p);
+    entry->timestamp      = timestamp;
+    entry->timestamp_usec = 100 * timestamp;
+    p += sizeof(LogEntryHeader);
+  };
+  auto put_int = [&p](int64_t val) {
+    LogAccess::marshal_int(p, val);
+    p += sizeof(int64_t);
+  };
+  auto put_str = [&p](const char *str) {
+    int padded_len = LogAccess::strlen(str);
+    LogAccess::marshal_str(p, str, padded_len);
+    p += padded_len;
+  };
+  auto end_entry = [&](size_t padding) {
+    p += padding;
+    entry->entry_len = p - reinterpret_cast<char *>(entry);
+    ++header->entry_count;
+  };
+
+  begin_entry(1000);
+  put_str("GET");
+  put_str("agent 1");
+  put_int(200);
+  put_int(15);
+  end_entry(0);
+
+  // Bytes after the last field are kept.
+  begin_entry(1001);
+  put_str("POST");
+  put_str("a much longer user agent string");
+  put_int(404);
+  put_int(1234);
+  end_entry(8);
+
+  // Ends before its last fields, which must not be read from the next entry.
+  begin_entry(1001);
+  put_str("GET");
+  put_str("agent 3");
+  end_entry(0);
+
+  begin_entry(1002);
+  put_str("HEAD");
+  put_str("");
+  put_int(200);
+  put_int(0);
+  end_entry(0);
+
+  header->byte_count = p - image;
+
+  LogColumnarBlock block;
+  box.check(block.add(header), "The first buffer was not added");
+  box.check(block.add(header), "A buffer with the same format was not added");
+  box.check(block.entry_count() == 2 * header->entry_count, "The block has %u entries, expected %u", block.entry_count(),
+            2 * header->entry_count);
+
+  header->format_type = LOG_FORMAT_TEXT;
+  box.check(!block.add(header), "A buffer with another format was added");
+  header->format_type = LOG_FORMAT_CUSTOM;
+
+  LogColumnarHeader *encoded = block.encode();
+  box.check(encoded != nullptr, "The block was not encoded");
+  box.check(block.entry_count() == 0, "The block was not emptied");
+  if (encoded == nullptr) {
+    ats_free(printf_str);
+    ats_free(symbol_str);
+    return;
+  }
+
+  LogBufferHeader *decoded = LogColumnarBlock::decode(encoded, reinterpret_cast<char *>(encoded + 1));
+  box.check(decoded != nullptr, "The block did not decode");
+  if (decoded) {
+    box.check(decoded->entry_count == 2 * header->entry_count, "Decoded %u entries, expected %u", decoded->entry_count,
+              2 * header->entry_count);
+    box.check(decoded->byte_count == header->data_offset + 2 * (header->byte_count - header->data_offset),
+              "Decoded %u bytes, expected %u", decoded->byte_count,
+              header->data_offset + 2 * (header->byte_count - header->data_offset));
+    box.check(decoded->low_timestamp == header->low_timestamp && decoded->high_timestamp == header->high_timestamp,
+              "The timestamp range changed");
+
+    LogBufferIterator decoded_iter(decoded);
+    for (int copy = 0; copy < 2; ++copy) {
+      LogBufferIterator iter(header);
+      LogEntryHeader *expected;
+      while ((expected = iter.next())) {
+        LogEntryHeader *actual = decoded_iter.next();
+        if (!actual) {
+          box.check(false, "Decoded too few entries");
+          break;
+        }
+        box.check(actual->timestamp == expected->timestamp && actual->timestamp_usec == expected->timestamp_usec,
+                  "Decoded timestamp %" PRId64 ".%d, expected %" PRId64 ".%d", actual->timestamp, actual->timestamp_usec,
+                  expected->timestamp, expected->timestamp_usec);
+        box.check(actual->entry_len == expected->entry_len && memcmp(actual, expected, expected->entry_len) == 0,
+                  "Decoded entry of %u bytes differs from the one of %u bytes", actual->entry_len, expected->entry_len);
+        if (expected->entry_len < sizeof(LogEntryHeader) + 4 * sizeof(int64_t)) {
+          continue; // the truncated entry does not render
+        }
+
+        char expected_ascii[256];
+        char actual_ascii[256];
+        int expected_len = LogBuffer::to_ascii(expected, LOG_FORMAT_CUSTOM, expected_ascii, sizeof(expected_ascii), symbol_str,
+                                               printf_str, LOG_SEGMENT_VERSION);
+        int actual_len   = LogBuffer::to_ascii(actual, LOG_FORMAT_CUSTOM, actual_ascii, sizeof(actual_ascii),
+                                             decoded->fmt_fieldlist(), decoded->fmt_printf(), decoded->version);
+        box.check(expected_len > 0 && actual_len == expected_len && memcmp(actual_ascii, expected_ascii, actual_len) == 0,
+                  "Decoded '%.*s', expected '%.*s'", actual_len, actual_ascii, expected_len, expected_ascii);
+      }
+    }
+    box.check(decoded_iter.next() == nullptr, "Decoded too many entries");
+    ats_free(decoded);
+  }
+
+  // A payload cut short is refused.
+  --encoded->payload_bytes;
+  box.check(LogColumnarBlock::decode(encoded, reinterpret_cast<char *>(encoded + 1)) == nullptr, "A truncated block decoded");
+
+  ats_free(encoded);
+  ats_free(printf_str);
+  ats_free(symbol_str);
+}
+#endif
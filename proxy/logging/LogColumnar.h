@@ -0,0 +1,134 @@
+/** @file
+
+  Columnar, block compressed log files.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "LogBuffer.h"
+
+class LogFieldList;
+
+#define LOG_COLUMNAR_COOKIE 0xc01face
+#define LOG_COLUMNAR_VERSION 1
+
+// Blocks are written out once they reach this many bytes, whatever the entry count.
+#define LOG_COLUMNAR_MAX_BLOCK_BYTES (16 * 1024 * 1024)
+
+enum LogColumnarCodec {
+  LOG_COLUMNAR_CODEC_NONE,
+  LOG_COLUMNAR_CODEC_FASTLZ,
+};
+
+/*-------------------------------------------------------------------------
+  LogColumnarHeader
+
+  This struct is laid down at the head of each block in a columnar log
+  file.  The cookie is at the same place as the one in a LogBufferHeader
+  so readers can tell the two apart.
+  -------------------------------------------------------------------------*/
+
+struct LogColumnarHeader {
+  uint32_t cookie;        // LOG_COLUMNAR_COOKIE
+  uint32_t version;       // LOG_COLUMNAR_VERSION
+  uint32_t codec;         // LogColumnarCodec of the payload
+  uint32_t entry_count;   // number of entries in the block
+  uint32_t column_count;  // number of columns in the payload
+  uint32_t raw_bytes;     // size of the payload before compression
+  uint32_t payload_bytes; // size of the payload following this header
+  uint32_t reserved;
+};
+
+/*-------------------------------------------------------------------------
+  LogColumnarBlock
+
+  Collects the entries of LogBuffers with the same format and writes them
+  out column by column, one column per field of the format, so that the
+  values of a field sit next to each other and compress well.  The entry
+  timestamps and lengths and the width of each value in each column are
+  columns of their own.  An entry whose fields can not be split is kept
+  whole in the last column.
+
+  Decoding a block gives back a LogBuffer image holding the same entries,
+  which is what the rest of the logging code reads.
+  -------------------------------------------------------------------------*/
+
+class LogColumnarBlock
+{
+public:
+  LogColumnarBlock();
+  ~LogColumnarBlock();
+
+  /** Add the entries of a buffer.
+   *
+   * @return false if the buffer has a different format than the entries
+   * already in the block, which then has to be written out first.
+   */
+  bool add(LogBufferHeader *buffer_header);
+
+  /** Lay down the block, compressed if that makes it smaller, and empty it.
+   *
+   * @return an ats_malloc() allocated LogColumnarHeader followed by the
+   * payload, or nullptr if the block is empty.
+   */
+  LogColumnarHeader *encode();
+
+  void clear();
+
+  uint32_t
+  entry_count() const
+  {
+    return m_timestamp.size();
+  }
+
+  size_t
+  byte_count() const
+  {
+    return m_bytes;
+  }
+
+  /** Rebuild the LogBuffer image of a block.
+   *
+   * @a payload holds the @a header->payload_bytes following @a header.
+   *
+   * @return an ats_malloc() allocated LogBufferHeader, or nullptr if the
+   * block is corrupt.
+   */
+  static LogBufferHeader *decode(const LogColumnarHeader *header, const char *payload);
+
+private:
+  bool same_format(LogBufferHeader *buffer_header) const;
+
+  std::vector<char> m_header;                 // LogBufferHeader of the first buffer, up to its data
+  std::unique_ptr<LogFieldList> m_fields;     // fields of the format, nullptr to keep entries whole
+  std::vector<int64_t> m_timestamp;           // LogEntryHeader::timestamp
+  std::vector<int32_t> m_timestamp_usec;      // LogEntryHeader::timestamp_usec
+  std::vector<uint32_t> m_entry_len;          // LogEntryHeader::entry_len
+  std::vector<std::vector<uint32_t>> m_width; // width of each value, per column
+  std::vector<std::vector<char>> m_column;    // values, per column
+  uint32_t m_low_timestamp  = 0;
+  uint32_t m_high_timestamp = 0;
+  size_t m_bytes            = 0; // entry bytes added
+};
@@ -96,6 +96,8 @@ LogConfig::setup_default_values()
   ascii_buffer_size         = 4 * 9216;
   max_line_size             = 9216; // size of pipe buffer for SunOS 5.6
   logbuffer_max_iobuf_index = BUFFER_SIZE_INDEX_32K;
+  columnar_block_entries    = 4096;
+  collector_queue_size      = 16 * LOG_MEGABYTE;
 }
 
 void LogConfig::reconfigure_mgmt_variables(ts::MemSpan<void>)
@@ -266,6 +268,16 @@ LogConfig::read_configuration_variables()
   if (val > 0) {
     max_line_size = val;
   }
+
+  val = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.columnar_block_entries"));
+  if (val > 0) {
+    columnar_block_entries = val;
+  }
+
+  int64_t queue_size = REC_ConfigReadInteger("proxy.config.log.collector.queue_size");
+  if (queue_size > 0) {
+    collector_queue_size = queue_size;
+  }
 }
 
 /*-------------------------------------------------------------------------
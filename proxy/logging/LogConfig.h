@@ -206,6 +206,8 @@ public:
   int ascii_buffer_size;
   int max_line_size;
   int logbuffer_max_iobuf_index;
+  int columnar_block_entries;
+  int64_t collector_queue_size;
 
   char *hostname           = nullptr;
   char *logfile_dir        = nullptr;
@@ -63,16 +63,17 @@
   -------------------------------------------------------------------------*/
 
 LogFile::LogFile(const char *name, const char *header, LogFileFormat format, uint64_t signature, size_t ascii_buffer_size,
-                 size_t max_line_size, int pipe_buffer_size, LogEscapeType escape_type)
+                 size_t max_line_size, int pipe_buffer_size, LogEscapeType escape_type, LogCollector *collector)
   : m_file_format(format),
     m_name(ats_strdup(name)),
     m_escape_type(escape_type),
     m_header(ats_strdup(header)),
     m_signature(signature),
     m_max_line_size(max_line_size),
-    m_pipe_buffer_size(pipe_buffer_size)
+    m_pipe_buffer_size(pipe_buffer_size),
+    m_collector(collector)
 {
-  if (m_file_format != LOG_FILE_PIPE) {
+  if (m_file_format != LOG_FILE_PIPE && !m_collector) {
     m_log = new BaseLogFile(name, m_signature);
     // Use Log::config->hostname rather than Machine::instance()->hostname
     // because the former is reloadable.
@@ -102,7 +103,8 @@ LogFile::LogFile(const LogFile &copy)
     m_ascii_buffer_size(copy.m_ascii_buffer_size),
     m_max_line_size(copy.m_max_line_size),
     m_pipe_buffer_size(copy.m_pipe_buffer_size),
-    m_fd(copy.m_fd)
+    m_fd(copy.m_fd),
+    m_collector(copy.m_collector)
 {
   ink_release_assert(m_ascii_buffer_size >= m_max_line_size);
 
@@ -171,7 +173,8 @@ LogFile::open_file()
   // whatever we want to open should have a name
   ink_assert(m_name != nullptr);
 
-  // is_open() takes into account if we're using BaseLogFile or a naked fd
+  // is_open() takes into account if we're using BaseLogFile or a naked fd,
+  // and a collector is always open
   if (is_open()) {
     return LOG_FILE_NO_ERROR;
   }
@@ -238,7 +241,7 @@ LogFile::open_file()
   // file.
   //
   if (!file_exists) {
-    if (m_file_format != LOG_FILE_BINARY && m_header && m_log) {
+    if (m_file_format != LOG_FILE_BINARY && m_file_format != LOG_FILE_COLUMNAR && m_header && m_log) {
       Debug("log-file", "writing header to LogFile %s", m_name);
       writeln(m_header, strlen(m_header), fileno(m_log->m_fp), m_name);
     }
@@ -259,7 +262,7 @@ LogFile::open_file()
 void
 LogFile::close_file()
 {
-  if (is_open()) {
+  if (is_open() && !m_collector) {
     if (m_file_format == LOG_FILE_PIPE) {
       if (::close(m_fd)) {
         Error("Error closing LogFile %s: %s.", m_name, strerror(errno));
@@ -410,7 +413,7 @@ LogFile::roll(long interval_start, long interval_end, bool reopen_after_rolling)
 bool
 LogFile::reopen_if_moved()
 {
-  if (!m_name) {
+  if (!m_name || m_collector) {
     return false;
   }
   if (LogFile::exists(m_name)) {
@@ -464,7 +467,7 @@ LogFile::preproc_and_try_delete(LogBuffer *lb)
     m_log->m_end_time = buffer_header->high_timestamp;
   }
 
-  if (m_file_format == LOG_FILE_BINARY) {
+  if (m_file_format == LOG_FILE_BINARY || m_file_format == LOG_FILE_COLUMNAR) {
     //
     // Ok, now we need to write the binary buffer to the file, and we
     // can do so in one swift write.  The question is, do we write the
@@ -473,6 +476,8 @@ LogFile::preproc_and_try_delete(LogBuffer *lb)
     // don't change between buffers), it's not worth trying to separate
     // out the buffer-dependent data from the buffer-independent data.
     //
+    // Columnar files collect the buffers into blocks in the flush thread.
+    //
     LogFlushData *flush_data = new LogFlushData(this, lb);
 
     ProxyMutex *mutex = this_thread()->mutex.get();
@@ -544,9 +549,19 @@ LogFile::write_ascii_logbuffer(LogBufferHeader *buffer_header, int fd, const cha
     return 0;
   }
 
+  const LogRenderProgram *program = nullptr;
+  if (format_type == LOG_FORMAT_CUSTOM && !alt_format) {
+    program = LogBuffer::render_program(fieldlist_str, printf_str);
+  }
+
   while ((entry_header = iter.next())) {
-    fmt_line_bytes = LogBuffer::to_ascii(entry_header, format_type, &fmt_line[0], LOG_MAX_FORMATTED_LINE, fieldlist_str, printf_str,
-                                         buffer_header->version, alt_format);
+    if (program) {
+      fmt_line_bytes = program->render(reinterpret_cast<char *>(entry_header) + sizeof(LogEntryHeader), &fmt_line[0],
+                                       LOG_MAX_FORMATTED_LINE);
+    } else {
+      fmt_line_bytes = LogBuffer::to_ascii(entry_header, format_type, &fmt_line[0], LOG_MAX_FORMATTED_LINE, fieldlist_str,
+                                           printf_str, buffer_header->version, alt_format);
+    }
     ink_assert(fmt_line_bytes > 0);
 
     if (fmt_line_bytes > 0) {
@@ -610,6 +625,12 @@ LogFile::write_ascii_logbuffer3(LogBufferHeader *buffer_header, const char *alt_
     return 0;
   }
 
+  // Look the compiled format up once for all the entries.
+  const LogRenderProgram *program = nullptr;
+  if (format_type == LOG_FORMAT_CUSTOM && !alt_format) {
+    program = LogBuffer::render_program(fieldlist_str, printf_str);
+  }
+
   while ((entry_header = iter.next())) {
     fmt_entry_count = 0;
     fmt_buf_bytes   = 0;
@@ -627,8 +648,14 @@ LogFile::write_ascii_logbuffer3(LogBufferHeader *buffer_header, const char *alt_
         Warning("Log is too long(%" PRIu32 "), it would be truncated. max_len:%zu", entry_header->entry_len, m_max_line_size);
       }
 
-      int bytes = LogBuffer::to_ascii(entry_header, format_type, &ascii_buffer[fmt_buf_bytes], m_max_line_size - 1, fieldlist_str,
-                                      printf_str, buffer_header->version, alt_format, get_escape_type());
+      int bytes;
+      if (program) {
+        bytes = program->render(reinterpret_cast<char *>(entry_header) + sizeof(LogEntryHeader), &ascii_buffer[fmt_buf_bytes],
+                                m_max_line_size - 1, get_escape_type());
+      } else {
+        bytes = LogBuffer::to_ascii(entry_header, format_type, &ascii_buffer[fmt_buf_bytes], m_max_line_size - 1, fieldlist_str,
+                                    printf_str, buffer_header->version, alt_format, get_escape_type());
+      }
 
       if (bytes > 0) {
         fmt_buf_bytes += bytes;
@@ -782,7 +809,9 @@ LogFile::display(FILE *fd)
 bool
 LogFile::is_open()
 {
-  if (m_file_format == LOG_FILE_PIPE) {
+  if (m_collector) {
+    return true;
+  } else if (m_file_format == LOG_FILE_PIPE) {
     return m_fd >= 0;
   } else {
     return m_log && m_log->is_open();
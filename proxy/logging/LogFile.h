@@ -28,6 +28,7 @@
 
 #include "tscore/ink_platform.h"
 #include "LogBufferSink.h"
+#include "LogCollector.h"
 
 class LogBuffer;
 struct LogBufferHeader;
@@ -43,7 +44,8 @@ class LogFile : public LogBufferSink, public RefCountObj
 {
 public:
   LogFile(const char *name, const char *header, LogFileFormat format, uint64_t signature, size_t ascii_buffer_size = 4 * 9216,
-          size_t max_line_size = 9216, int pipe_buffer_size = 0, LogEscapeType escape_type = LOG_ESCAPE_NONE);
+          size_t max_line_size = 9216, int pipe_buffer_size = 0, LogEscapeType escape_type = LOG_ESCAPE_NONE,
+          LogCollector *collector = nullptr);
   LogFile(const LogFile &);
   ~LogFile() override;
 
@@ -92,7 +94,16 @@ public:
   const char *
   get_format_name() const
   {
-    return (m_file_format == LOG_FILE_BINARY ? "binary" : (m_file_format == LOG_FILE_PIPE ? "ascii_pipe" : "ascii"));
+    switch (m_file_format) {
+    case LOG_FILE_BINARY:
+      return "binary";
+    case LOG_FILE_COLUMNAR:
+      return "columnar";
+    case LOG_FILE_PIPE:
+      return "ascii_pipe";
+    default:
+      return "ascii";
+    }
   }
 
   static int write_ascii_logbuffer(LogBufferHeader *buffer_header, int fd, const char *path, const char *alt_format = nullptr);
@@ -131,11 +142,12 @@ private:
 public:
   BaseLogFile *m_log; // BaseLogFile backs the actual file on disk
   char *m_header;
-  uint64_t m_signature;       // signature of log object stored
-  size_t m_ascii_buffer_size; // size of ascii buffer
-  size_t m_max_line_size;     // size of longest log line (record)
-  int m_pipe_buffer_size;     // this is the size of the pipe buffer set by fcntl
-  int m_fd;                   // this could back m_log or a pipe, depending on the situation
+  uint64_t m_signature;          // signature of log object stored
+  size_t m_ascii_buffer_size;    // size of ascii buffer
+  size_t m_max_line_size;        // size of longest log line (record)
+  int m_pipe_buffer_size;        // this is the size of the pipe buffer set by fcntl
+  int m_fd;                      // this could back m_log or a pipe, depending on the situation
+  Ptr<LogCollector> m_collector; // set when the data is streamed to a collector rather than written to a file
 
 public:
   Link<LogFile> link;
@@ -92,7 +92,7 @@ LogBufferManager::preproc_buffers(LogBufferSink *sink)
 LogObject::LogObject(LogConfig *cfg, const LogFormat *format, const char *log_dir, const char *basename, LogFileFormat file_format,
                      const char *header, Log::RollingEnabledValues rolling_enabled, int flush_threads, int rolling_interval_sec,
                      int rolling_offset_hr, int rolling_size_mb, bool auto_created, int rolling_max_count, int rolling_min_count,
-                     bool reopen_after_rolling, int pipe_buffer_size)
+                     bool reopen_after_rolling, int pipe_buffer_size, const char *collector)
   : m_alt_filename(nullptr),
     m_flags(0),
     m_signature(0),
@@ -113,17 +113,32 @@ LogObject::LogObject(LogConfig *cfg, const LogFormat *format, const char *log_di
 
   if (file_format == LOG_FILE_BINARY) {
     m_flags |= BINARY;
+  } else if (file_format == LOG_FILE_COLUMNAR) {
+    m_flags |= COLUMNAR;
   } else if (file_format == LOG_FILE_PIPE) {
     m_flags |= WRITES_TO_PIPE;
   }
 
+  if (collector) {
+    m_flags |= WRITES_TO_COLLECTOR;
+  }
+
   generate_filenames(log_dir, basename, file_format);
 
   // compute_signature is a static function
-  m_signature = compute_signature(m_format, m_basename, m_flags);
+  if (collector) {
+    // Objects streaming to different collectors are different objects.
+    std::string key = std::string(m_basename) + "@" + collector;
+    m_signature     = compute_signature(m_format, key.data(), m_flags);
+  } else {
+    m_signature = compute_signature(m_format, m_basename, m_flags);
+  }
 
   m_logFile = new LogFile(m_filename, header, file_format, m_signature, cfg->ascii_buffer_size, cfg->max_line_size,
-                          m_pipe_buffer_size, format->escape_type());
+                          m_pipe_buffer_size, format->escape_type(),
+                          collector ? new LogCollector(m_basename, collector, file_format == LOG_FILE_BINARY,
+                                                       cfg->collector_queue_size) :
+                                      nullptr);
 
   if (m_reopen_after_rolling) {
     m_logFile->open_file();
@@ -210,6 +225,10 @@ LogObject::generate_filenames(const char *log_dir, const char *basename, LogFile
       ext     = LOG_FILE_PIPE_OBJECT_FILENAME_EXTENSION;
       ext_len = 5;
       break;
+    case LOG_FILE_COLUMNAR:
+      ext     = LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION;
+      ext_len = 5;
+      break;
     default:
       ink_assert(!"unknown file format");
     }
@@ -276,7 +295,10 @@ LogObject::compute_signature(LogFormat *format, char *filename, unsigned int fla
     char *buffer = static_cast<char *>(ats_malloc(buf_size));
 
     ink_string_concatenate_strings(buffer, fl, ps, filename,
-                                   flags & LogObject::BINARY ? "B" : (flags & LogObject::WRITES_TO_PIPE ? "P" : "A"), NULL);
+                                   flags & LogObject::BINARY   ? "B" :
+                                   flags & LogObject::COLUMNAR ? "C" :
+                                   (flags & LogObject::WRITES_TO_PIPE ? "P" : "A"),
+                                   NULL);
 
     CryptoHash hash;
     CryptoContext().hash_immediate(hash, buffer, buf_size - 1);
@@ -487,7 +509,7 @@ LogObject::log(LogAccess *lad, std::string_view text_entry)
   // log to a pipe even if space is exhausted since pipe uses no space
   // likewise, send data to a remote client even if local space is exhausted
   // (if there is a remote client, m_logFile will be NULL
-  if (Log::config->logging_space_exhausted && !writes_to_pipe() && m_logFile) {
+  if (Log::config->logging_space_exhausted && !writes_to_pipe() && !writes_to_collector() && m_logFile) {
     Debug("log", "logging space exhausted, can't write to:%s, drop this entry", m_logFile->get_name());
     return Log::FULL;
   }
@@ -721,8 +743,8 @@ LogObject::_roll_files(long last_roll_time, long time_now)
   unsigned num_rolled = 0;
 
   if (m_logFile) {
-    // no need to roll if object writes to a pipe
-    if (!writes_to_pipe()) {
+    // no need to roll if object writes to a pipe or a collector
+    if (!writes_to_pipe() && !writes_to_collector()) {
       num_rolled += m_logFile->roll(last_roll_time, time_now, m_reopen_after_rolling);
 
       if (Log::config->auto_delete_rolled_files && m_max_rolled > 0) {
@@ -881,6 +903,11 @@ LogObjectManager::_solve_filename_conflicts(LogObject *log_object, int maxConfli
 {
   int retVal = NO_FILENAME_CONFLICTS;
 
+  // An object streaming to a collector has no file of its own to conflict with.
+  if (log_object->writes_to_collector()) {
+    return retVal;
+  }
+
   const char *filename = log_object->get_full_filename();
 
   if (access(filename, F_OK)) {
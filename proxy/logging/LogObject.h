@@ -48,6 +48,7 @@
 #define LOG_FILE_ASCII_OBJECT_FILENAME_EXTENSION ".log"
 #define LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION ".blog"
 #define LOG_FILE_PIPE_OBJECT_FILENAME_EXTENSION ".pipe"
+#define LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION ".clog"
 
 #define FLUSH_ARRAY_SIZE (512 * 4)
 
@@ -86,17 +87,22 @@ class LogObject : public RefCountObj
 public:
   enum LogObjectFlags {
     BINARY                   = 1,
+    COLUMNAR                 = 2,
     WRITES_TO_PIPE           = 4,
     LOG_OBJECT_FMT_TIMESTAMP = 8, // always format a timestamp into each log line (for raw text logs)
+    WRITES_TO_COLLECTOR      = 16,
   };
 
   // BINARY: log is written in binary format (rather than ascii)
+  // COLUMNAR: log is written in compressed blocks of binary entries
   // WRITES_TO_PIPE: object writes to a named pipe rather than to a file
+  // WRITES_TO_COLLECTOR: object streams to a collector socket rather than to a file
 
   LogObject(LogConfig *cfg, const LogFormat *format, const char *log_dir, const char *basename, LogFileFormat file_format,
             const char *header, Log::RollingEnabledValues rolling_enabled, int flush_threads, int rolling_interval_sec = 0,
             int rolling_offset_hr = 0, int rolling_size_mb = 0, bool auto_created = false, int rolling_max_count = 0,
-            int rolling_min_count = 0, bool reopen_after_rolling = false, int pipe_buffer_size = 0);
+            int rolling_min_count = 0, bool reopen_after_rolling = false, int pipe_buffer_size = 0,
+            const char *collector = nullptr);
   ~LogObject() override;
 
   void add_filter(LogFilter *filter, bool copy = true);
@@ -208,9 +214,14 @@ public:
     return (m_flags & WRITES_TO_PIPE) ? true : false;
   }
   inline bool
+  writes_to_collector() const
+  {
+    return (m_flags & WRITES_TO_COLLECTOR) ? true : false;
+  }
+  inline bool
   writes_to_disk()
   {
-    return (m_logFile && !(m_flags & WRITES_TO_PIPE) ? true : false);
+    return (m_logFile && !(m_flags & (WRITES_TO_PIPE | WRITES_TO_COLLECTOR)) ? true : false);
   }
 
   inline unsigned int
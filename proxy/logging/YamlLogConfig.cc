@@ -121,7 +121,8 @@ std::set<std::string> valid_log_object_keys = {"filename",
                                                "rolling_min_count",
                                                "rolling_max_count",
                                                "rolling_allow_empty",
-                                               "pipe_buffer_size"};
+                                               "pipe_buffer_size",
+                                               "collector"};
 
 LogObject *
 YamlLogConfig::decodeLogObject(const YAML::Node &node)
@@ -158,9 +159,13 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
   LogFileFormat file_type = LOG_FILE_ASCII; // default value
   if (node["mode"]) {
     std::string mode = node["mode"].as<std::string>();
-    file_type        = (0 == strncasecmp(mode.c_str(), "bin", 3) || (1 == mode.size() && mode[0] == 'b') ?
-                   LOG_FILE_BINARY :
-                   (0 == strcasecmp(mode.c_str(), "ascii_pipe") ? LOG_FILE_PIPE : LOG_FILE_ASCII));
+    if (0 == strncasecmp(mode.c_str(), "bin", 3) || (1 == mode.size() && mode[0] == 'b')) {
+      file_type = LOG_FILE_BINARY;
+    } else if (0 == strcasecmp(mode.c_str(), "columnar")) {
+      file_type = LOG_FILE_COLUMNAR;
+    } else if (0 == strcasecmp(mode.c_str(), "ascii_pipe")) {
+      file_type = LOG_FILE_PIPE;
+    }
   }
 
   int obj_rolling_enabled      = cfg->rolling_enabled;
@@ -216,11 +221,30 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
     }
   }
 
+  // stream to a collector rather than to a file
+  std::string collector;
+  if (node["collector"]) {
+    collector = node["collector"].as<std::string>();
+    if (!LogCollector::valid_address(collector.c_str())) {
+      Error("Collector address '%s' for %s is not 'unix:<path>' or an address and port; cannot create LogObject",
+            collector.c_str(), filename.c_str());
+      return nullptr;
+    }
+    if (file_type == LOG_FILE_COLUMNAR) {
+      Warning("Collector %s for %s takes binary rather than columnar data.", collector.c_str(), filename.c_str());
+      file_type = LOG_FILE_BINARY;
+    } else if (file_type == LOG_FILE_PIPE) {
+      Warning("Collector %s for %s takes ascii rather than ascii_pipe data.", collector.c_str(), filename.c_str());
+      file_type = LOG_FILE_ASCII;
+    }
+  }
+
   auto logObject = new LogObject(cfg, fmt, cfg->logfile_dir, filename.c_str(), file_type, header.c_str(),
                                  static_cast<Log::RollingEnabledValues>(obj_rolling_enabled), cfg->preproc_threads,
                                  obj_rolling_interval_sec, obj_rolling_offset_hr, obj_rolling_size_mb, /* auto_created */ false,
                                  /* rolling_max_count */ obj_rolling_max_count, /* rolling_min_count */ obj_rolling_min_count,
-                                 /* reopen_after_rolling */ obj_rolling_allow_empty > 0, pipe_buffer_size);
+                                 /* reopen_after_rolling */ obj_rolling_allow_empty > 0, pipe_buffer_size,
+                                 collector.empty() ? nullptr : collector.c_str());
 
   // Generate LogDeletingInfo entry for later use
   std::string ext;
@@ -234,6 +258,9 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
   case LOG_FILE_BINARY:
     ext = LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION;
     break;
+  case LOG_FILE_COLUMNAR:
+    ext = LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION;
+    break;
   default:
     break;
   }
@@ -41,6 +41,7 @@
 #include "LogObject.h"
 #include "LogConfig.h"
 #include "LogBuffer.h"
+#include "LogColumnar.h"
 #include "LogUtils.h"
 #include "Log.h"
 
@@ -114,6 +115,64 @@ follow_rotate(const char *input_file, ino_t old_inode_num)
   }
 }
 
+/*
+ * Reads exactly @a size bytes, allowing for partial reads
+ *
+ * @returns false on EOF or error when not following the file
+ */
+static bool
+read_fully(int in_fd, char *buf, size_t size)
+{
+  size_t nread = 0;
+
+  while (nread < size) {
+    ssize_t rc = read(in_fd, buf + nread, size - nread);
+
+    if (rc < 0 || (rc == 0 && !follow_flag)) {
+      return false;
+    }
+    nread += rc;
+  }
+  return true;
+}
+
+/*
+ * Converts a block of a columnar log file, whose first @a prefix_size bytes
+ * have already been read into @a header, to ascii entries
+ *
+ * @returns 0 on success, 1 on a bad block
+ */
+static int
+process_columnar_block(int in_fd, int out_fd, LogColumnarHeader *header, size_t prefix_size)
+{
+  if (!read_fully(in_fd, reinterpret_cast<char *>(header) + prefix_size, sizeof(LogColumnarHeader) - prefix_size)) {
+    fprintf(stderr, "Bad LogColumnarHeader read!\n");
+    return 1;
+  }
+  if (header->payload_bytes > LOG_COLUMNAR_MAX_BLOCK_BYTES * 2) {
+    fprintf(stderr, "Columnar block too large!\n");
+    return 1;
+  }
+
+  ats_scoped_mem<char> payload;
+  payload = static_cast<char *>(ats_malloc(header->payload_bytes));
+  if (!read_fully(in_fd, payload, header->payload_bytes)) {
+    fprintf(stderr, "Bad columnar block read!\n");
+    return 1;
+  }
+
+  LogBufferHeader *buffer_header = LogColumnarBlock::decode(header, payload);
+  if (!buffer_header) {
+    fprintf(stderr, "Bad columnar block!\n");
+    return 1;
+  }
+  if (buffer_header->fmt_fieldlist()) {
+    LogFile::write_ascii_logbuffer(buffer_header, out_fd, ".", nullptr);
+  }
+  ats_free(buffer_header);
+  return 0;
+}
+
 static int
 process_file(int in_fd, int out_fd)
 {
@@ -138,6 +197,16 @@ process_file(int in_fd, int out_fd)
       return 0;
     }
 
+    // columnar files hold compressed blocks of buffers
+    //
+    if (header->cookie == LOG_COLUMNAR_COOKIE) {
+      static_assert(sizeof(LogColumnarHeader) <= sizeof(buffer), "buffer too small for LogColumnarHeader");
+      if (process_columnar_block(in_fd, out_fd, reinterpret_cast<LogColumnarHeader *>(buffer), nread)) {
+        return 1;
+      }
+      continue;
+    }
+
     // ensure that this is a valid logbuffer header
     //
     if (header->cookie != LOG_SEGMENT_COOKIE) {
@@ -315,13 +384,14 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
         posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 #endif
         if (auto_filenames) {
-          // change .blog to .log
+          // change .blog or .clog to .log
           //
-          int n = strlen(file_arguments[i]);
-          int copy_len =
-            (n >= bin_ext_len ?
-               (strcmp(&file_arguments[i][n - bin_ext_len], LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION) == 0 ? n - bin_ext_len : n) :
-               n);
+          int n        = strlen(file_arguments[i]);
+          int copy_len = n;
+          if (n >= bin_ext_len && (strcmp(&file_arguments[i][n - bin_ext_len], LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION) == 0 ||
+                                   strcmp(&file_arguments[i][n - bin_ext_len], LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION) == 0)) {
+            copy_len = n - bin_ext_len;
+          }
 
           char *out_filename = (char *)ats_malloc(copy_len + ascii_ext_len + 1);
 
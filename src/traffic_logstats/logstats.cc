@@ -35,6 +35,7 @@
 #include "LogStandalone.cc"
 
 #include "LogObject.h"
+#include "LogColumnar.h"
 #include "hdrs/HTTP.h"
 
 #include <sys/utsname.h>
@@ -1760,6 +1761,56 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
   return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Process a block of a columnar log file, the first prefix_size bytes of
+// which have already been read into header.
+int
+process_columnar_block(int in_fd, LogColumnarHeader *header, size_t prefix_size, unsigned max_age)
+{
+  char *read_to  = reinterpret_cast<char *>(header) + prefix_size;
+  size_t to_read = sizeof(LogColumnarHeader) - prefix_size;
+
+  if (read(in_fd, read_to, to_read) != static_cast<ssize_t>(to_read)) {
+    Debug("logstats", "Read of columnar block header failed, errno=%d.", errno);
+    return 1;
+  }
+  if (header->payload_bytes > LOG_COLUMNAR_MAX_BLOCK_BYTES * 2) {
+    Debug("logstats", "Columnar block payload [%u] is too large.", header->payload_bytes);
+    return 1;
+  }
+
+  ats_scoped_mem<char> payload;
+  payload = static_cast<char *>(ats_malloc(header->payload_bytes));
+  size_t total_read = 0;
+  while (total_read < header->payload_bytes) {
+    ssize_t nread = read(in_fd, payload + total_read, header->payload_bytes - total_read);
+    if (nread <= 0) {
+      Debug("logstats", "Read failed while reading columnar block, wanted %zu bytes, errno=%d", header->payload_bytes - total_read,
+            errno);
+      return 1;
+    }
+    total_read += nread;
+  }
+
+  LogBufferHeader *buffer_header = LogColumnarBlock::decode(header, payload);
+  if (!buffer_header) {
+    Debug("logstats", "Failed to decode columnar block.");
+    return 1;
+  }
+
+  int result = 0;
+  if (buffer_header->high_timestamp >= max_age) {
+    if (parse_log_buff(buffer_header, cl.summary != 0, cl.report_per_user != 0) != 0) {
+      Debug("logstats", "Failed to parse columnar block.");
+      result = 1;
+    }
+  } else {
+    Debug("logstats", "Skipping old block (age=%d, max=%d)", buffer_header->high_timestamp, max_age);
+  }
+  ats_free(buffer_header);
+  return result;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Process a file (FD)
 int
@@ -1794,7 +1845,7 @@ process_file(int in_fd, off_t offset, unsigned max_age)
           return 0;
         }
         // ensure that this is a valid logbuffer header
-        if (header->cookie && (LOG_SEGMENT_COOKIE == header->cookie)) {
+        if (header->cookie && (LOG_SEGMENT_COOKIE == header->cookie || LOG_COLUMNAR_COOKIE == header->cookie)) {
           offset = 0;
           break;
         }
@@ -1810,12 +1861,20 @@ process_file(int in_fd, off_t offset, unsigned max_age)
       }
 
       // ensure that this is a valid logbuffer header
-      if (header->cookie != LOG_SEGMENT_COOKIE) {
+      if (header->cookie != LOG_SEGMENT_COOKIE && header->cookie != LOG_COLUMNAR_COOKIE) {
         Debug("logstats", "Invalid segment cookie (expected %d, got %d)", LOG_SEGMENT_COOKIE, header->cookie);
         return 1;
       }
     }
 
+    // Columnar files hold compressed blocks of buffers.
+    if (LOG_COLUMNAR_COOKIE == header->cookie) {
+      if (process_columnar_block(in_fd, reinterpret_cast<LogColumnarHeader *>(buffer), first_read_size, max_age) != 0) {
+        return 1;
+      }
+      continue;
+    }
+
     Debug("logstats", "LogBuffer version %d, current = %d", header->version, LOG_SEGMENT_VERSION);
     if (header->version != LOG_SEGMENT_VERSION) {
       return 1;
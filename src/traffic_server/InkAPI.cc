@@ -4362,6 +4362,19 @@ TSCacheKeyDestroy(TSCacheKey key)
   return TS_SUCCESS;
 }
 
+int
+TSCacheAdmissionEstimate(TSCacheKey key)
+{
+  sdk_assert(sdk_sanity_check_cachekey(key) == TS_SUCCESS);
+
+  CacheInfo *info = (CacheInfo *)key;
+
+  if (info->magic != CACHE_INFO_MAGIC_ALIVE) {
+    return -1;
+  }
+  return cacheProcessor.admission_estimate(&info->cache_key);
+}
+
 TSCacheHttpInfo
 TSCacheHttpInfoCopy(TSCacheHttpInfo infop)
 {
@@ -20,6 +20,7 @@
  */
 
 #include "tscore/ConsistentHash.h"
+#include <algorithm>
 #include <cstring>
 #include <string>
 #include <sstream>
@@ -27,6 +28,14 @@
 #include <climits>
 #include <cstdio>
 
+namespace
+{
+// Recent lookups counted for the load bound before the counts are halved.
+constexpr uint32_t LOAD_WINDOW = 1 << 16;
+// Most hash bits used to index the ring.
+constexpr int MAX_BUCKET_BITS = 20;
+} // namespace
+
 std::ostream &
 operator<<(std::ostream &os, ATSConsistentHashNode &thing)
 {
@@ -43,6 +52,7 @@ ATSConsistentHash::insert(ATSConsistentHashNode *node, float weight, ATSHash64 *
   ATSHash64 *thash;
   std::ostringstream string_stream;
   std::string std_string;
+  std::vector<std::pair<uint64_t, uint32_t>> added;
 
   if (h) {
     thash = h;
@@ -55,21 +65,110 @@ ATSConsistentHash::insert(ATSConsistentHashNode *node, float weight, ATSHash64 *
   string_stream << *node;
   std_string = string_stream.str();
 
+  uint32_t slot = std::find(nodes.begin(), nodes.end(), node) - nodes.begin();
+  if (slot == nodes.size()) {
+    nodes.push_back(node);
+    points.push_back(0);
+  }
+
   for (i = 0; i < static_cast<int>(roundf(replicas * weight)); i++) {
     snprintf(numstr, 256, "%d-", i);
     thash->update(numstr, strlen(numstr));
     thash->update(std_string.c_str(), strlen(std_string.c_str()));
     thash->final();
-    NodeMap.insert(std::pair<uint64_t, ATSConsistentHashNode *>(thash->get(), node));
+    added.emplace_back(thash->get(), slot);
     thash->clear();
   }
+
+  // A point already on the ring keeps its node, as does the first of several new points with the same hash.
+  std::stable_sort(added.begin(), added.end(), [](auto const &lhs, auto const &rhs) { return lhs.first < rhs.first; });
+  added.erase(std::unique(added.begin(), added.end(), [](auto const &lhs, auto const &rhs) { return lhs.first == rhs.first; }),
+              added.end());
+
+  std::vector<uint64_t> merged_keys;
+  std::vector<uint32_t> merged_slots;
+  merged_keys.reserve(keys.size() + added.size());
+  merged_slots.reserve(keys.size() + added.size());
+  size_t old_idx = 0;
+  for (auto const &[key, added_slot] : added) {
+    for (; old_idx < keys.size() && keys[old_idx] <= key; ++old_idx) {
+      merged_keys.push_back(keys[old_idx]);
+      merged_slots.push_back(slots[old_idx]);
+    }
+    if (merged_keys.empty() || merged_keys.back() != key) {
+      merged_keys.push_back(key);
+      merged_slots.push_back(added_slot);
+      ++points[added_slot];
+    }
+  }
+  merged_keys.insert(merged_keys.end(), keys.begin() + old_idx, keys.end());
+  merged_slots.insert(merged_slots.end(), slots.begin() + old_idx, slots.end());
+  keys.swap(merged_keys);
+  slots.swap(merged_slots);
+
+  // About two points per bucket.
+  int bits = 0;
+  while (bits < MAX_BUCKET_BITS && (size_t(4) << bits) <= keys.size()) {
+    ++bits;
+  }
+  bucket_shift = 64 - bits;
+  buckets.resize((size_t(1) << bits) + 1);
+  for (size_t b = 0; b + 1 < buckets.size(); ++b) {
+    uint64_t base = bits ? b << bucket_shift : 0;
+    buckets[b]    = std::lower_bound(keys.begin(), keys.end(), base) - keys.begin();
+  }
+  buckets.back() = keys.size();
+
+  loads.reset(new std::atomic<uint32_t>[nodes.size()]);
+  for (size_t n = 0; n < nodes.size(); ++n) {
+    loads[n].store(0, std::memory_order_relaxed);
+  }
+  total_load.store(0, std::memory_order_relaxed);
+}
+
+void
+ATSConsistentHash::set_load_bound(float epsilon)
+{
+  load_bound = std::max(epsilon, 0.0f);
+}
+
+size_t
+ATSConsistentHash::find(uint64_t hashval) const
+{
+  if (keys.empty()) {
+    return 0;
+  }
+  size_t b  = bucket_shift < 64 ? hashval >> bucket_shift : 0;
+  auto spot = std::lower_bound(keys.begin() + buckets[b], keys.begin() + buckets[b + 1], hashval);
+  return spot - keys.begin();
+}
+
+bool
+ATSConsistentHash::over_load(uint32_t slot) const
+{
+  // The node's share of the lookups, including this one, is capped in proportion to its share of the points.
+  double fair = double(total_load.load(std::memory_order_relaxed) + 1) * points[slot] / keys.size();
+  return loads[slot].load(std::memory_order_relaxed) >= std::ceil((1.0 + load_bound) * fair);
+}
+
+void
+ATSConsistentHash::add_load(uint32_t slot)
+{
+  loads[slot].fetch_add(1, std::memory_order_relaxed);
+  if (total_load.fetch_add(1, std::memory_order_relaxed) + 1 >= LOAD_WINDOW) {
+    // Age the counts so the bound follows recent traffic. Racing with other lookups only skews an estimate.
+    total_load.store(LOAD_WINDOW / 2, std::memory_order_relaxed);
+    for (size_t n = 0; n < nodes.size(); ++n) {
+      loads[n].store(loads[n].load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+    }
+  }
 }
 
 ATSConsistentHashNode *
 ATSConsistentHash::lookup(const char *url, ATSConsistentHashIter *i, bool *w, ATSHash64 *h)
 {
   uint64_t url_hash;
-  ATSConsistentHashIter NodeMapIterUp, *iter;
+  ATSConsistentHashIter NodeMapIterUp = 0, *iter;
   ATSHash64 *thash;
   bool *wptr, wrapped = false;
 
@@ -99,33 +198,33 @@ ATSConsistentHash::lookup(const char *url, ATSConsistentHashIter *i, bool *w, AT
     url_hash = thash->get();
     thash->clear();
 
-    *iter = NodeMap.lower_bound(url_hash);
+    *iter = this->find(url_hash);
 
-    if (*iter == NodeMap.end()) {
+    if (*iter == keys.size()) {
       *wptr = true;
-      *iter = NodeMap.begin();
+      *iter = 0;
     }
   } else {
     (*iter)++;
   }
 
-  if (!(*wptr) && *iter == NodeMap.end()) {
+  if (!(*wptr) && *iter >= keys.size()) {
     *wptr = true;
-    *iter = NodeMap.begin();
+    *iter = 0;
   }
 
-  if (*wptr && *iter == NodeMap.end()) {
+  if (*wptr && *iter >= keys.size()) {
     return nullptr;
   }
 
-  return (*iter)->second;
+  return nodes[slots[*iter]];
 }
 
 ATSConsistentHashNode *
 ATSConsistentHash::lookup_available(const char *url, ATSConsistentHashIter *i, bool *w, ATSHash64 *h)
 {
   uint64_t url_hash;
-  ATSConsistentHashIter NodeMapIterUp, *iter;
+  ATSConsistentHashIter NodeMapIterUp = 0, *iter;
   ATSHash64 *thash;
   bool *wptr, wrapped = false;
 
@@ -149,38 +248,42 @@ ATSConsistentHash::lookup_available(const char *url, ATSConsistentHashIter *i, b
     iter = &NodeMapIterUp;
   }
 
+  if (keys.empty()) {
+    return nullptr;
+  }
+
   if (url) {
     thash->update(url, strlen(url));
     thash->final();
     url_hash = thash->get();
     thash->clear();
 
-    *iter = NodeMap.lower_bound(url_hash);
+    *iter = this->find(url_hash);
   }
 
-  if (*iter == NodeMap.end()) {
+  if (*iter >= keys.size()) {
     *wptr = true;
-    *iter = NodeMap.begin();
+    *iter = 0;
   }
 
-  while (!(*iter)->second->available) {
+  while (!nodes[slots[*iter]]->available) {
     (*iter)++;
 
-    if (!(*wptr) && *iter == NodeMap.end()) {
+    if (!(*wptr) && *iter == keys.size()) {
       *wptr = true;
-      *iter = NodeMap.begin();
-    } else if (*wptr && *iter == NodeMap.end()) {
+      *iter = 0;
+    } else if (*wptr && *iter == keys.size()) {
       return nullptr;
     }
   }
 
-  return (*iter)->second;
+  return nodes[slots[*iter]];
 }
 
 ATSConsistentHashNode *
 ATSConsistentHash::lookup_by_hashval(uint64_t hashval, ATSConsistentHashIter *i, bool *w)
 {
-  ATSConsistentHashIter NodeMapIterUp, *iter;
+  ATSConsistentHashIter NodeMapIterUp = 0, *iter;
   bool *wptr, wrapped = false;
 
   if (w) {
@@ -195,14 +298,36 @@ ATSConsistentHash::lookup_by_hashval(uint64_t hashval, ATSConsistentHashIter *i,
     iter = &NodeMapIterUp;
   }
 
-  *iter = NodeMap.lower_bound(hashval);
+  if (keys.empty()) {
+    return nullptr;
+  }
+
+  *iter = this->find(hashval);
 
-  if (*iter == NodeMap.end()) {
+  if (*iter == keys.size()) {
     *wptr = true;
-    *iter = NodeMap.begin();
+    *iter = 0;
+  }
+
+  if (load_bound > 0) {
+    // Walk on to the first node under its bound. If every node is over, stay with the natural choice.
+    size_t pos       = *iter;
+    bool pos_wrapped = *wptr;
+    size_t n         = 0;
+    for (; n < keys.size() && this->over_load(slots[pos]); ++n) {
+      if (++pos == keys.size()) {
+        pos         = 0;
+        pos_wrapped = true;
+      }
+    }
+    if (n < keys.size()) {
+      *iter = pos;
+      *wptr = pos_wrapped;
+    }
+    this->add_load(slots[*iter]);
   }
 
-  return (*iter)->second;
+  return nodes[slots[*iter]];
 }
 
 ATSConsistentHash::~ATSConsistentHash()
@@ -0,0 +1,179 @@
+/** @file
+
+  Approximate, aging access frequency counter (TinyLFU).
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/FrequencySketch.h"
+
+#include <algorithm>
+
+namespace
+{
+// Seeds to derive the independent row hashes, from the fractional part of the golden ratio and friends.
+constexpr uint64_t SEED[] = {0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL};
+
+inline uint64_t
+mix(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  return h;
+}
+
+inline uint64_t
+round_up_pow2(uint64_t n)
+{
+  uint64_t p = 1;
+  while (p < n) {
+    p <<= 1;
+  }
+  return p;
+}
+} // namespace
+
+FrequencySketch::FrequencySketch(uint64_t capacity)
+{
+  // Keep at least one full word per row.
+  _width       = round_up_pow2(std::max<uint64_t>(capacity, COUNTERS_WORD));
+  _mask        = _width - 1;
+  _dk_mask     = _width * 8 - 1;
+  _sample_size = _width * 10;
+
+  uint64_t words = DEPTH * _width / COUNTERS_WORD;
+  _table.reset(new std::atomic<uint64_t>[words]);
+  for (uint64_t i = 0; i < words; ++i) {
+    _table[i].store(0, std::memory_order_relaxed);
+  }
+
+  words = (_dk_mask + 1) / 64;
+  _doorkeeper.reset(new std::atomic<uint64_t>[words]);
+  for (uint64_t i = 0; i < words; ++i) {
+    _doorkeeper[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+uint64_t
+FrequencySketch::index(uint64_t h1, uint64_t h2, int i) const
+{
+  return i * _width + (mix(h1 + SEED[i] * (h2 | 1)) & _mask);
+}
+
+int
+FrequencySketch::counter(uint64_t idx) const
+{
+  uint64_t word = _table[idx / COUNTERS_WORD].load(std::memory_order_relaxed);
+  return (word >> ((idx % COUNTERS_WORD) * COUNTER_BITS)) & MAX_COUNT;
+}
+
+void
+FrequencySketch::increment_counter(uint64_t idx)
+{
+  std::atomic<uint64_t> &slot = _table[idx / COUNTERS_WORD];
+  int shift                   = (idx % COUNTERS_WORD) * COUNTER_BITS;
+  uint64_t word               = slot.load(std::memory_order_relaxed);
+  // Saturate rather than carry into the neighbouring counter.
+  while (((word >> shift) & MAX_COUNT) < MAX_COUNT &&
+         !slot.compare_exchange_weak(word, word + (uint64_t(1) << shift), std::memory_order_relaxed)) {
+    ;
+  }
+}
+
+bool
+FrequencySketch::doorkeeper_test(uint64_t h1, uint64_t h2) const
+{
+  for (int i = 0; i < DOORKEEPER_HASH; ++i) {
+    uint64_t bit = (h1 + i * h2) & _dk_mask;
+    if (!(_doorkeeper[bit / 64].load(std::memory_order_relaxed) & (uint64_t(1) << (bit % 64)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+FrequencySketch::doorkeeper_test_and_set(uint64_t h1, uint64_t h2)
+{
+  bool present = true;
+  for (int i = 0; i < DOORKEEPER_HASH; ++i) {
+    uint64_t bit  = (h1 + i * h2) & _dk_mask;
+    uint64_t mask = uint64_t(1) << (bit % 64);
+    if (!(_doorkeeper[bit / 64].fetch_or(mask, std::memory_order_relaxed) & mask)) {
+      present = false;
+    }
+  }
+  return present;
+}
+
+void
+FrequencySketch::increment(uint64_t h1, uint64_t h2)
+{
+  if (doorkeeper_test_and_set(h1, h2)) {
+    uint64_t idx[DEPTH];
+    int min = MAX_COUNT;
+    for (int i = 0; i < DEPTH; ++i) {
+      idx[i] = index(h1, h2, i);
+      min    = std::min(min, counter(idx[i]));
+    }
+    // Conservative update, only the smallest counters are raised.
+    if (min < MAX_COUNT) {
+      for (int i = 0; i < DEPTH; ++i) {
+        if (counter(idx[i]) == min) {
+          increment_counter(idx[i]);
+        }
+      }
+    }
+  }
+
+  if (_additions.fetch_add(1, std::memory_order_relaxed) + 1 == _sample_size) {
+    this->age();
+  }
+}
+
+int
+FrequencySketch::estimate(uint64_t h1, uint64_t h2) const
+{
+  if (!doorkeeper_test(h1, h2)) {
+    return 0;
+  }
+  int min = MAX_COUNT;
+  for (int i = 0; i < DEPTH; ++i) {
+    min = std::min(min, counter(index(h1, h2, i)));
+  }
+  return min + 1;
+}
+
+void
+FrequencySketch::age()
+{
+  _additions.store(0, std::memory_order_relaxed);
+
+  uint64_t words = DEPTH * _width / COUNTERS_WORD;
+  for (uint64_t i = 0; i < words; ++i) {
+    uint64_t word = _table[i].load(std::memory_order_relaxed);
+    _table[i].store((word >> 1) & 0x7777777777777777ULL, std::memory_order_relaxed);
+  }
+
+  words = (_dk_mask + 1) / 64;
+  for (uint64_t i = 0; i < words; ++i) {
+    _doorkeeper[i].store(0, std::memory_order_relaxed);
+  }
+}
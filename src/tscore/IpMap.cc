@@ -581,6 +581,8 @@ namespace detail
       } else if (n->_min <= max) { // skew overlap different payload
         n->setMin(max_plus);
         break;
+      } else { // adjacent, different payload - done.
+        break;
       }
     }
 
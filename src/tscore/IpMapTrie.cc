@@ -0,0 +1,183 @@
+/** @file
+
+    Read optimized, immutable lookup structure compiled from an IpMap.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <unordered_map>
+
+#include "tscore/IpMapTrie.h"
+
+namespace ts
+{
+namespace detail
+{
+  namespace
+  {
+    /// Narrow [ @a first , @a last ) to the ranges that overlap [ @a min , @a max ].
+    template <typename Range, typename Key>
+    void
+    overlap(std::vector<Range> const &ranges, Key const &min, Key const &max, size_t &first, size_t &last)
+    {
+      while (first < last && ranges[first].max < min) {
+        ++first;
+      }
+      size_t end = first;
+      while (end < last && ranges[end].min <= max) {
+        ++end;
+      }
+      last = end;
+    }
+  } // namespace
+
+  /// @return The leaf for all of [ @a min , @a max ], or @c MIXED if there is more than one.
+  template <typename K>
+  uint32_t
+  IpTrie<K>::uniform(Key const &min, Key const &max, std::vector<Range> const &ranges, size_t first, size_t last) const
+  {
+    if (first == last) {
+      return 0;
+    }
+    if (last - first == 1 && ranges[first].min <= min && max <= ranges[first].max) {
+      return ranges[first].leaf;
+    }
+    return MIXED;
+  }
+
+  template <typename K>
+  void
+  IpTrie<K>::build(std::vector<Range> const &ranges)
+  {
+    _nodes.clear();
+    _leaves.clear();
+
+    // Enough direct entries that most of them split only a few ranges.
+    _direct_bits = DIRECT_MIN;
+    while (_direct_bits < DIRECT_MAX && (size_t(1) << _direct_bits) < ranges.size() * 4) {
+      ++_direct_bits;
+    }
+    _direct.assign(size_t(1) << _direct_bits, LEAF);
+
+    size_t first = 0;
+    for (unsigned d = 0; d < _direct.size(); ++d) {
+      Key min     = K::place(Key{}, d, 0, _direct_bits);
+      Key max     = K::fill(min, _direct_bits);
+      size_t last = ranges.size();
+
+      overlap(ranges, min, max, first, last);
+      uint32_t leaf = this->uniform(min, max, ranges, first, last);
+      if (leaf != MIXED) {
+        _direct[d] = LEAF | leaf;
+      } else {
+        uint32_t idx = _nodes.size();
+        _nodes.emplace_back();
+        this->build_node(idx, min, _direct_bits, ranges, first, last);
+        _direct[d] = idx;
+      }
+    }
+
+    _nodes.shrink_to_fit();
+    _leaves.shrink_to_fit();
+  }
+
+  /// Fill in the node at @a idx for the block of @a prefix, whose first @a depth bits are set.
+  template <typename K>
+  void
+  IpTrie<K>::build_node(uint32_t idx, Key const &prefix, int depth, std::vector<Range> const &ranges, size_t first, size_t last)
+  {
+    int n           = std::min(STRIDE, K::WIDTH - depth);
+    unsigned fanout = 1u << n;
+    Node node       = {0, 0, static_cast<uint32_t>(_leaves.size()), 0};
+    bool have_leaf  = false;
+    uint32_t prev   = 0;
+    size_t child_first[1 << STRIDE];
+    size_t child_last[1 << STRIDE];
+
+    for (unsigned c = 0; c < fanout; ++c) {
+      Key min = K::place(prefix, c, depth, n);
+      Key max = K::fill(min, depth + n);
+
+      child_last[c] = last;
+      overlap(ranges, min, max, first, child_last[c]);
+      child_first[c] = first;
+
+      uint32_t leaf = this->uniform(min, max, ranges, child_first[c], child_last[c]);
+      if (leaf == MIXED) {
+        node.vector |= uint64_t(1) << c;
+      } else if (!have_leaf || leaf != prev) {
+        // Equal leaves next to each other, not counting nodes between them, share an entry.
+        node.leafvec |= uint64_t(1) << c;
+        _leaves.push_back(leaf);
+        prev      = leaf;
+        have_leaf = true;
+      }
+    }
+
+    node.base1 = _nodes.size();
+    _nodes.resize(_nodes.size() + __builtin_popcountll(node.vector));
+    _nodes[idx] = node;
+
+    uint32_t child = node.base1;
+    for (unsigned c = 0; c < fanout; ++c) {
+      if (node.vector & (uint64_t(1) << c)) {
+        this->build_node(child++, K::place(prefix, c, depth, n), depth + n, ranges, child_first[c], child_last[c]);
+      }
+    }
+  }
+
+  template class IpTrie<Ip4TrieKey>;
+  template class IpTrie<Ip6TrieKey>;
+} // namespace detail
+} // namespace ts
+
+IpMapTrie::IpMapTrie(IpMap const &map)
+{
+  this->assign(map);
+}
+
+IpMapTrie &
+IpMapTrie::assign(IpMap const &map)
+{
+  using ts::detail::Ip4TrieKey;
+  using ts::detail::Ip6TrieKey;
+
+  std::vector<ts::detail::IpTrie<Ip4TrieKey>::Range> r4;
+  std::vector<ts::detail::IpTrie<Ip6TrieKey>::Range> r6;
+  std::unordered_map<void *, uint32_t> leaves;
+
+  _data.clear();
+  for (auto &spot : map) {
+    // Ranges with the same data share a leaf, which lets the trie merge them.
+    auto [it, added] = leaves.emplace(spot.data(), _data.size() + 1);
+    if (added) {
+      _data.push_back(spot.data());
+    }
+    if (ats_is_ip4(spot.min())) {
+      r4.push_back({Ip4TrieKey::key(spot.min()), Ip4TrieKey::key(spot.max()), it->second});
+    } else {
+      r6.push_back({Ip6TrieKey::key(spot.min()), Ip6TrieKey::key(spot.max()), it->second});
+    }
+  }
+
+  _t4.build(r4);
+  _t6.build(r6);
+  _count = r4.size() + r6.size();
+  return *this;
+}
@@ -19,6 +19,8 @@
   limitations under the License.
  */
 
+#include <algorithm>
+
 #include "tscore/ink_hw.h"
 #include "tscore/ink_platform.h"
 
@@ -68,3 +70,36 @@ ink_number_of_processors()
   return sysconf(_SC_NPROCESSORS_ONLN); // number of processing units (includes Hyper Threading)
 #endif
 }
+
+int
+ink_number_of_numa_nodes()
+{
+#if TS_USE_HWLOC
+  return std::max(hwloc_get_nbobjs_by_type(ink_get_topology(), HWLOC_OBJ_NODE), 1);
+#else
+  return 1;
+#endif
+}
+
+bool
+ink_numa_bind_area(void *addr, size_t len, int node)
+{
+#if TS_USE_HWLOC
+  hwloc_obj_t obj = hwloc_get_obj_by_type(ink_get_topology(), HWLOC_OBJ_NODE, node);
+  if (obj == nullptr) {
+    return false;
+  }
+  // Pages already touched, eg. by the allocator header of the chunk, are moved to the node too.
+#if HWLOC_API_VERSION >= 0x20000
+  return hwloc_set_area_membind(ink_get_topology(), addr, len, obj->nodeset, HWLOC_MEMBIND_BIND,
+                                HWLOC_MEMBIND_BYNODESET | HWLOC_MEMBIND_MIGRATE) == 0;
+#else
+  return hwloc_set_area_membind_nodeset(ink_get_topology(), addr, len, obj->nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_MIGRATE) == 0;
+#endif
+#else
+  (void)addr;
+  (void)len;
+  (void)node;
+  return false;
+#endif
+}
@@ -37,6 +37,7 @@
   ****************************************************************************/
 
 #include "tscore/ink_config.h"
+#include <algorithm>
 #include <cassert>
 #include <memory.h>
 #include <cstdlib>
@@ -50,6 +51,7 @@
 #include "tscore/ink_assert.h"
 #include "tscore/ink_align.h"
 #include "tscore/hugepages.h"
+#include "tscore/ink_hw.h"
 #include "tscore/Diags.h"
 #include "tscore/JeAllocator.h"
 
@@ -81,6 +83,8 @@ using ink_freelist_list = struct _ink_freelist_list {
 
 static void *freelist_new(InkFreeList *f);
 static void freelist_free(InkFreeList *f, void *item);
+static void freelist_push(InkFreeList *f, head_p *list, void *item);
+static bool freelist_reclaim(InkFreeList *f);
 static void freelist_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item);
 
 static void *malloc_new(InkFreeList *f);
@@ -94,6 +98,9 @@ static const ink_freelist_ops *default_ops = &freelist_ops;
 static ink_freelist_list *freelists                = nullptr;
 static const ink_freelist_ops *freelist_global_ops = default_ops;
 
+// NUMA node of the calling thread, set once the thread is bound to a single node.
+static thread_local int freelist_thread_node = -1;
+
 const InkFreeListOps *
 ink_freelist_malloc_ops()
 {
@@ -124,8 +131,9 @@ ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32
 
   /* its safe to add to this global list because ink_freelist_init()
      is only called from single-threaded initialization code. */
-  f = static_cast<InkFreeList *>(ats_memalign(alignment, sizeof(InkFreeList)));
+  f = static_cast<InkFreeList *>(ats_memalign(std::max<size_t>(alignment, alignof(InkFreeList)), sizeof(InkFreeList)));
   ink_zero(*f);
+  f->node = -1;
 
   fll       = static_cast<ink_freelist_list *>(ats_malloc(sizeof(ink_freelist_list)));
   fll->fl   = f;
@@ -152,6 +160,7 @@ ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32
   }
   Debug(DEBUG_TAG "_init", "<%s> Chunk Size request/actual (%" PRIu32 "/%" PRIu32 ")", name, chunk_size, f->chunk_size);
   SET_FREELIST_POINTER_VERSION(f->head, FROM_PTR(0), 0);
+  SET_FREELIST_POINTER_VERSION(f->remote, FROM_PTR(0), 0);
 
   *fl = f;
 }
@@ -164,6 +173,26 @@ ink_freelist_madvise_init(InkFreeList **fl, const char *name, uint32_t type_size
   (*fl)->advice = advice;
 }
 
+void
+ink_freelist_bind_node(InkFreeList *f, int node)
+{
+  // Only chunks allocated from now on are bound, this should be called right after ink_freelist_init().
+  ink_assert(f->allocated == 0);
+  f->node = node;
+}
+
+int
+ink_freelist_thread_node()
+{
+  return freelist_thread_node;
+}
+
+void
+ink_freelist_set_thread_node(int node)
+{
+  freelist_thread_node = node;
+}
+
 InkFreeList *
 ink_freelist_create(const char *name, uint32_t type_size, uint32_t chunk_size, uint32_t alignment)
 {
@@ -201,6 +230,11 @@ freelist_new(InkFreeList *f)
   do {
     INK_QUEUE_LD(item, f->head);
     if (TO_PTR(FREELIST_POINTER(item)) == nullptr) {
+      // Take back what other NUMA nodes have freed before growing.
+      if (freelist_reclaim(f)) {
+        continue;
+      }
+
       uint32_t i;
       void *newp        = nullptr;
       size_t alloc_size = f->chunk_size * f->type_size;
@@ -216,6 +250,9 @@ freelist_new(InkFreeList *f)
         newp      = ats_memalign(alignment, INK_ALIGN(alloc_size, alignment));
       }
 
+      if (f->node >= 0 && !ink_numa_bind_area(newp, INK_ALIGN(alloc_size, alignment), f->node)) {
+        Debug(DEBUG_TAG, "<%s> could not bind a chunk to NUMA node %d", f->name, f->node);
+      }
       if (f->advice) {
         ats_madvise(static_cast<caddr_t>(newp), INK_ALIGN(alloc_size, alignment), f->advice);
       }
@@ -283,8 +320,29 @@ ink_freelist_free(InkFreeList *f, void *item)
   }
 }
 
+void
+ink_freelist_free_remote(InkFreeList *f, void *item)
+{
+  if (likely(item != nullptr)) {
+    ink_assert(f->used != 0);
+    if (freelist_global_ops == &freelist_ops) {
+      freelist_push(f, &f->remote, item);
+      ink_atomic_increment(reinterpret_cast<int *>(&f->remote_freed), 1);
+    } else {
+      freelist_global_ops->fl_free(f, item);
+    }
+    ink_atomic_decrement(reinterpret_cast<int *>(&f->used), 1);
+  }
+}
+
 static void
 freelist_free(InkFreeList *f, void *item)
+{
+  freelist_push(f, &f->head, item);
+}
+
+static void
+freelist_push(InkFreeList *f, head_p *list, void *item)
 {
   void **adr_of_next = ADDRESS_OF_NEXT(item, 0);
   head_p h;
@@ -305,7 +363,7 @@ freelist_free(InkFreeList *f, void *item)
 #endif /* DEADBEEF */
 
   while (!result) {
-    INK_QUEUE_LD(h, f->head);
+    INK_QUEUE_LD(h, *list);
 #ifdef SANITY
     if (TO_PTR(FREELIST_POINTER(h)) == item) {
       ink_abort("ink_freelist_free: trying to free item twice");
@@ -320,10 +378,45 @@ freelist_free(InkFreeList *f, void *item)
     *adr_of_next = FREELIST_POINTER(h);
     SET_FREELIST_POINTER_VERSION(item_pair, FROM_PTR(item), FREELIST_VERSION(h));
     INK_MEMORY_BARRIER;
-    result = ink_atomic_cas(&f->head.data, h.data, item_pair.data);
+    result = ink_atomic_cas(&list->data, h.data, item_pair.data);
   }
 }
 
+// Move the items freed by other NUMA nodes onto the freelist, @return false if there were none.
+static bool
+freelist_reclaim(InkFreeList *f)
+{
+  head_p item;
+  head_p empty;
+  head_p h;
+  head_p item_pair;
+
+  do {
+    INK_QUEUE_LD(item, f->remote);
+    if (TO_PTR(FREELIST_POINTER(item)) == nullptr) {
+      return false;
+    }
+    SET_FREELIST_POINTER_VERSION(empty, FROM_PTR(nullptr), FREELIST_VERSION(item) + 1);
+  } while (!ink_atomic_cas(&f->remote.data, item.data, empty.data));
+
+  // The items are linked the same way as on the freelist, splice them on whole.
+  void *first = TO_PTR(FREELIST_POINTER(item));
+  void *tail  = first;
+  while (TO_PTR(*ADDRESS_OF_NEXT(tail, 0)) != nullptr) {
+    tail = TO_PTR(*ADDRESS_OF_NEXT(tail, 0));
+  }
+
+  void **adr_of_next = ADDRESS_OF_NEXT(tail, 0);
+  do {
+    INK_QUEUE_LD(h, f->head);
+    *adr_of_next = FREELIST_POINTER(h);
+    SET_FREELIST_POINTER_VERSION(item_pair, FROM_PTR(first), FREELIST_VERSION(h));
+    INK_MEMORY_BARRIER;
+  } while (!ink_atomic_cas(&f->head.data, h.data, item_pair.data));
+
+  return true;
+}
+
 static void
 malloc_free(InkFreeList *f, void *item)
 {
@@ -468,6 +561,23 @@ ink_freelists_dump(FILE *f)
   }
   fprintf(f, " %18" PRIu64 " | %18" PRIu64 " |            | TOTAL\n", total_allocated, total_used);
   fprintf(f, "-----------------------------------------------------------------------------------------\n");
+
+  // Per NUMA node pools, with the items the other nodes have handed back.
+  bool numa = false;
+  for (fll = freelists; fll; fll = fll->next) {
+    if (fll->fl->node >= 0) {
+      if (!numa) {
+        fprintf(f, "   Remote Frees     |  Node  |   Free List Name\n");
+        fprintf(f, "--------------------|--------|----------------------------------\n");
+        numa = true;
+      }
+      fprintf(f, " %18" PRIu32 " | %6d | memory/%s\n", fll->fl->remote_freed, fll->fl->node,
+              fll->fl->name ? fll->fl->name : "<unknown>");
+    }
+  }
+  if (numa) {
+    fprintf(f, "-----------------------------------------------------------------------------------------\n");
+  }
 }
 
 void
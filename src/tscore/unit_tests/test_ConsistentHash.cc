@@ -0,0 +1,164 @@
+/** @file
+
+  ATSConsistentHash unit tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ConsistentHash.h"
+#include "tscore/HashSip.h"
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+
+namespace
+{
+struct Node : ATSConsistentHashNode {
+  std::string label;
+  explicit Node(std::string const &s) : label(s) { name = const_cast<char *>(label.c_str()); }
+};
+
+// The ring as it was built before it was flattened, as the reference for lookups.
+void
+reference_insert(std::map<uint64_t, ATSConsistentHashNode *> &ring, ATSConsistentHashNode *node, float weight, int replicas)
+{
+  ATSHash64Sip24 hash;
+  char numstr[256];
+  for (int i = 0; i < static_cast<int>(roundf(replicas * weight)); i++) {
+    snprintf(numstr, 256, "%d-", i);
+    hash.update(numstr, strlen(numstr));
+    hash.update(node->name, strlen(node->name));
+    hash.final();
+    ring.insert(std::make_pair(hash.get(), node));
+    hash.clear();
+  }
+}
+} // namespace
+
+TEST_CASE("ConsistentHash matches the tree ring", "[libts][ConsistentHash]")
+{
+  std::vector<std::unique_ptr<Node>> nodes;
+  std::map<uint64_t, ATSConsistentHashNode *> reference;
+  ATSConsistentHash ring;
+  ATSHash64Sip24 hash;
+
+  for (int n = 0; n < 8; ++n) {
+    nodes.emplace_back(new Node("parent" + std::to_string(n) + ".example.com"));
+    float weight = n % 3 ? 1.0 : 0.5;
+    ring.insert(nodes.back().get(), weight, &hash);
+    reference_insert(reference, nodes.back().get(), weight, 1024);
+  }
+  REQUIRE(ring.size() == reference.size());
+
+  std::mt19937_64 rng(42);
+  for (int k = 0; k < 10000; ++k) {
+    uint64_t hashval = rng();
+    auto spot        = reference.lower_bound(hashval);
+    bool ref_wrapped = spot == reference.end();
+    if (ref_wrapped) {
+      spot = reference.begin();
+    }
+
+    ATSConsistentHashIter iter;
+    bool wrapped                = false;
+    ATSConsistentHashNode *node = ring.lookup_by_hashval(hashval, &iter, &wrapped);
+    REQUIRE(node == spot->second);
+    REQUIRE(wrapped == ref_wrapped);
+
+    // Walking on from the first choice visits the ring in the same order.
+    for (int step = 0; step < 4; ++step) {
+      if (++spot == reference.end()) {
+        spot        = reference.begin();
+        ref_wrapped = true;
+      }
+      node = ring.lookup(nullptr, &iter, &wrapped, &hash);
+      REQUIRE(node == spot->second);
+      REQUIRE(wrapped == ref_wrapped);
+    }
+  }
+
+  SECTION("Edges of the hash space")
+  {
+    REQUIRE(ring.lookup_by_hashval(0) == reference.begin()->second);
+    REQUIRE(ring.lookup_by_hashval(reference.rbegin()->first) == reference.rbegin()->second);
+    bool wrapped = false;
+    REQUIRE(ring.lookup_by_hashval(UINT64_MAX, nullptr, &wrapped) == reference.begin()->second);
+    REQUIRE(wrapped == (reference.rbegin()->first != UINT64_MAX));
+  }
+
+  SECTION("Unavailable nodes are skipped")
+  {
+    nodes[0]->available = false;
+    nodes[1]->available = false;
+    for (int k = 0; k < 1000; ++k) {
+      std::string url = "/object/" + std::to_string(k);
+      auto node       = ring.lookup_available(url.c_str(), nullptr, nullptr, &hash);
+      REQUIRE(node != nullptr);
+      REQUIRE(node->available);
+    }
+  }
+}
+
+TEST_CASE("ConsistentHash empty ring", "[libts][ConsistentHash]")
+{
+  ATSConsistentHash ring;
+  ATSHash64Sip24 hash;
+  bool wrapped = false;
+
+  REQUIRE(ring.lookup_by_hashval(12345) == nullptr);
+  REQUIRE(ring.lookup("/a", nullptr, &wrapped, &hash) == nullptr);
+  REQUIRE(ring.lookup_available("/a", nullptr, nullptr, &hash) == nullptr);
+}
+
+TEST_CASE("ConsistentHash bounded load", "[libts][ConsistentHash]")
+{
+  constexpr int NODES   = 4;
+  constexpr int LOOKUPS = 4000;
+  std::vector<std::unique_ptr<Node>> nodes;
+  ATSConsistentHash ring;
+  ATSHash64Sip24 hash;
+
+  for (int n = 0; n < NODES; ++n) {
+    nodes.emplace_back(new Node("parent" + std::to_string(n) + ".example.com"));
+    ring.insert(nodes.back().get(), 1.0, &hash);
+  }
+
+  // Every request for the same hot key.
+  auto count = [&]() {
+    std::map<ATSConsistentHashNode *, int> hits;
+    for (int k = 0; k < LOOKUPS; ++k) {
+      ++hits[ring.lookup_by_hashval(0x1234567890ABCDEFULL)];
+    }
+    return hits;
+  };
+
+  auto unbounded = count();
+  REQUIRE(unbounded.size() == 1);
+
+  ring.set_load_bound(0.25);
+  auto bounded = count();
+  REQUIRE(bounded.size() == NODES);
+  for (auto const &[node, n] : bounded) {
+    REQUIRE(n <= 1.25 * LOOKUPS / NODES + 1);
+  }
+}
@@ -0,0 +1,119 @@
+/** @file
+
+  FrequencySketch unit tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/FrequencySketch.h"
+#include "tscore/CryptoHash.h"
+#include "catch.hpp"
+
+#include <string>
+
+namespace
+{
+CryptoHash
+key_for(int n)
+{
+  CryptoHash hash;
+  std::string s = "http://example.com/object/" + std::to_string(n);
+  CryptoContext().hash_immediate(hash, s.data(), s.size());
+  return hash;
+}
+} // namespace
+
+TEST_CASE("FrequencySketch", "[libts][FrequencySketch]")
+{
+  FrequencySketch sketch(1024);
+
+  REQUIRE(sketch.width() == 1024);
+  REQUIRE(sketch.sample_size() == 10240);
+
+  SECTION("doorkeeper")
+  {
+    CryptoHash k = key_for(1);
+    CHECK(sketch.estimate(k.u64[0], k.u64[1]) == 0);
+    sketch.increment(k.u64[0], k.u64[1]);
+    CHECK(sketch.estimate(k.u64[0], k.u64[1]) == 1);
+    sketch.increment(k.u64[0], k.u64[1]);
+    CHECK(sketch.estimate(k.u64[0], k.u64[1]) == 2);
+  }
+
+  SECTION("saturation")
+  {
+    CryptoHash k = key_for(2);
+    for (int i = 0; i < 100; ++i) {
+      sketch.increment(k.u64[0], k.u64[1]);
+    }
+    CHECK(sketch.estimate(k.u64[0], k.u64[1]) == FrequencySketch::MAX_COUNT + 1);
+  }
+
+  SECTION("popular keys stand out")
+  {
+    // Many keys seen once, a few keys seen often.
+    for (int n = 0; n < 2000; ++n) {
+      CryptoHash k = key_for(n);
+      sketch.increment(k.u64[0], k.u64[1]);
+      if (n % 100 == 0) {
+        for (int i = 0; i < 5; ++i) {
+          sketch.increment(k.u64[0], k.u64[1]);
+        }
+      }
+    }
+    int one_hit_admitted = 0;
+    for (int n = 0; n < 2000; ++n) {
+      CryptoHash k = key_for(n);
+      int est      = sketch.estimate(k.u64[0], k.u64[1]);
+      if (n % 100 == 0) {
+        CHECK(est >= 6);
+      } else if (est >= 2) {
+        ++one_hit_admitted;
+      }
+    }
+    // Only the occasional collision makes a one hit wonder look popular.
+    CHECK(one_hit_admitted < 100);
+  }
+
+  SECTION("aging")
+  {
+    CryptoHash k = key_for(3);
+    for (int i = 0; i < 9; ++i) {
+      sketch.increment(k.u64[0], k.u64[1]);
+    }
+    CHECK(sketch.estimate(k.u64[0], k.u64[1]) == 9);
+    sketch.age();
+    CHECK(sketch.estimate(k.u64[0], k.u64[1]) == 0);
+    sketch.increment(k.u64[0], k.u64[1]);
+    CHECK(sketch.estimate(k.u64[0], k.u64[1]) == 5);
+  }
+
+  SECTION("automatic aging")
+  {
+    CryptoHash k = key_for(4);
+    for (int i = 0; i < 5; ++i) {
+      sketch.increment(k.u64[0], k.u64[1]);
+    }
+    for (uint64_t n = 0; n < sketch.sample_size(); ++n) {
+      CryptoHash other = key_for(100000 + n);
+      sketch.increment(other.u64[0], other.u64[1]);
+    }
+    CHECK(sketch.estimate(k.u64[0], k.u64[1]) < 5);
+  }
+}
@@ -631,3 +631,33 @@ TEST_CASE("IpMap CloseIntersection", "[libts][ipmap]")
   std::cout << w.print("{::x}", m2).view() << std::endl;
 #endif
 };
+
+TEST_CASE("IpMap Adjacent", "[libts][ipmap]")
+{
+  IpMap map;
+  void *const markA = reinterpret_cast<void *>(1);
+  void *const markB = reinterpret_cast<void *>(2);
+  IpEndpoint a_10_0, a_10_255, a_11_0, a_11_255;
+  IpEndpoint a6_1, a6_1_max, a6_2, a6_2_max;
+
+  ats_ip_pton("10.0.0.0", &a_10_0);
+  ats_ip_pton("10.255.255.255", &a_10_255);
+  ats_ip_pton("11.0.0.0", &a_11_0);
+  ats_ip_pton("11.255.255.255", &a_11_255);
+  ats_ip_pton("fe80:0:0:1::", &a6_1);
+  ats_ip_pton("fe80:0:0:1:ffff:ffff:ffff:ffff", &a6_1_max);
+  ats_ip_pton("fe80:0:0:2::", &a6_2);
+  ats_ip_pton("fe80:0:0:2:ffff:ffff:ffff:ffff", &a6_2_max);
+
+  // Mark a range that ends just before an existing range with different data.
+  map.mark(a_11_0, a_11_255, markB);
+  map.mark(a_10_0, a_10_255, markA);
+  map.mark(a6_2, a6_2_max, markB);
+  map.mark(a6_1, a6_1_max, markA);
+
+  CHECK(map.count() == 4);
+  CHECK_THAT(map, IsMarkedWith(a_10_255, markA));
+  CHECK_THAT(map, IsMarkedWith(a_11_0, markB));
+  CHECK_THAT(map, IsMarkedWith(a6_1_max, markA));
+  CHECK_THAT(map, IsMarkedWith(a6_2, markB));
+}
@@ -0,0 +1,227 @@
+/** @file
+
+    IpMapTrie unit tests.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tscore/IpMapTrie.h"
+#include <random>
+#include <catch.hpp>
+
+namespace
+{
+IpEndpoint
+addr(const char *text)
+{
+  IpEndpoint addr;
+  ats_ip_pton(text, &addr);
+  return addr;
+}
+
+IpEndpoint
+ip4(uint32_t host_order)
+{
+  IpEndpoint addr;
+  ats_ip4_set(&addr, htonl(host_order));
+  return addr;
+}
+
+IpEndpoint
+ip6(uint64_t hi, uint64_t lo)
+{
+  in6_addr a;
+  for (int i = 0; i < 8; ++i) {
+    a.s6_addr[i]     = hi >> (56 - 8 * i);
+    a.s6_addr[i + 8] = lo >> (56 - 8 * i);
+  }
+  IpEndpoint addr;
+  ats_ip6_set(&addr, a);
+  return addr;
+}
+
+// The trie and the map agree about @a addr.
+void
+check(IpMap const &map, IpMapTrie const &trie, IpEndpoint const &addr)
+{
+  void *map_mark  = nullptr;
+  void *trie_mark = nullptr;
+  bool in_map     = map.contains(&addr, &map_mark);
+  bool in_trie    = trie.contains(&addr, &trie_mark);
+
+  if (in_map != in_trie || map_mark != trie_mark) {
+    ip_text_buffer b;
+    FAIL("mismatch at " << ats_ip_ntop(&addr.sa, b, sizeof(b)) << ": map " << in_map << " " << map_mark << ", trie " << in_trie
+                        << " " << trie_mark);
+  }
+}
+
+// Check the addresses at and next to each edge of every range in @a map.
+void
+check_edges(IpMap const &map, IpMapTrie const &trie)
+{
+  for (auto &spot : map) {
+    if (ats_is_ip4(spot.min())) {
+      uint32_t min = ntohl(ats_ip4_addr_cast(spot.min()));
+      uint32_t max = ntohl(ats_ip4_addr_cast(spot.max()));
+      for (uint32_t a : {min - 1, min, min + 1, max - 1, max, max + 1}) {
+        check(map, trie, ip4(a));
+      }
+    } else {
+      IpEndpoint addr;
+      ats_ip_copy(&addr, spot.min());
+      check(map, trie, addr);
+      ats_ip_copy(&addr, spot.max());
+      check(map, trie, addr);
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("IpMapTrie Empty", "[libts][ipmap][trie]")
+{
+  IpMap map;
+  IpMapTrie trie(map);
+
+  REQUIRE(trie.count() == 0);
+  REQUIRE(!trie.contains(addr("0.0.0.0")));
+  REQUIRE(!trie.contains(addr("10.1.2.3")));
+  REQUIRE(!trie.contains(addr("255.255.255.255")));
+  REQUIRE(!trie.contains(addr("::")));
+  REQUIRE(!trie.contains(addr("2001:db8::1")));
+
+  IpMapTrie unbuilt;
+  REQUIRE(!unbuilt.contains(addr("10.1.2.3")));
+  REQUIRE(!unbuilt.contains(addr("2001:db8::1")));
+}
+
+TEST_CASE("IpMapTrie Basic", "[libts][ipmap][trie]")
+{
+  IpMap map;
+  void *const markA = reinterpret_cast<void *>(1);
+  void *const markB = reinterpret_cast<void *>(2);
+  void *const markC = reinterpret_cast<void *>(3);
+  void *mark        = nullptr;
+
+  map.mark(addr("10.0.0.0"), addr("10.255.255.255"), markA);
+  map.mark(addr("10.28.56.4"), addr("10.28.56.4"), markB);
+  map.mark(addr("192.168.1.0"), addr("192.168.1.127"), nullptr);
+  map.mark(addr("255.255.255.255"), addr("255.255.255.255"), markC);
+  map.mark(addr("2001:db8::"), addr("2001:db8::ffff:ffff:ffff:ffff"), markA);
+  map.mark(addr("fe80::221:9bff:fe10:9d90"), addr("fe80::221:9bff:fe10:9d9d"), markB);
+  map.mark(addr("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"), addr("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"), markC);
+
+  IpMapTrie trie(map);
+  REQUIRE(trie.count() == map.count());
+
+  REQUIRE(trie.contains(addr("10.0.0.0"), &mark));
+  REQUIRE(mark == markA);
+  REQUIRE(trie.contains(addr("10.28.56.4"), &mark));
+  REQUIRE(mark == markB);
+  REQUIRE(trie.contains(addr("10.28.56.5"), &mark));
+  REQUIRE(mark == markA);
+  REQUIRE(!trie.contains(addr("9.255.255.255")));
+  REQUIRE(!trie.contains(addr("11.0.0.0")));
+
+  // Membership without data.
+  mark = markA;
+  REQUIRE(trie.contains(addr("192.168.1.127"), &mark));
+  REQUIRE(mark == nullptr);
+  REQUIRE(!trie.contains(addr("192.168.1.128")));
+
+  REQUIRE(trie.contains(addr("255.255.255.255"), &mark));
+  REQUIRE(mark == markC);
+  REQUIRE(!trie.contains(addr("0.0.0.0")));
+
+  REQUIRE(trie.contains(addr("2001:db8::1"), &mark));
+  REQUIRE(mark == markA);
+  REQUIRE(!trie.contains(addr("2001:db8:0:1::")));
+  REQUIRE(trie.contains(addr("fe80::221:9bff:fe10:9d95"), &mark));
+  REQUIRE(mark == markB);
+  REQUIRE(!trie.contains(addr("fe80::221:9bff:fe10:9d9e")));
+  REQUIRE(trie.contains(addr("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"), &mark));
+  REQUIRE(mark == markC);
+  REQUIRE(!trie.contains(addr("::")));
+
+  // The IPv4 convenience overload takes network order.
+  REQUIRE(trie.contains(htonl(0x0a1c3804), &mark));
+  REQUIRE(mark == markB);
+
+  check_edges(map, trie);
+}
+
+TEST_CASE("IpMapTrie Full", "[libts][ipmap][trie]")
+{
+  IpMap map;
+  void *const markA = reinterpret_cast<void *>(1);
+
+  map.mark(addr("0.0.0.0"), addr("255.255.255.255"), markA);
+  map.mark(addr("::"), addr("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"), markA);
+  IpMapTrie trie(map);
+
+  REQUIRE(trie.contains(addr("0.0.0.0")));
+  REQUIRE(trie.contains(addr("128.0.0.1")));
+  REQUIRE(trie.contains(addr("255.255.255.255")));
+  REQUIRE(trie.contains(addr("::")));
+  REQUIRE(trie.contains(addr("8000::1")));
+  REQUIRE(trie.contains(addr("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff")));
+}
+
+TEST_CASE("IpMapTrie Random", "[libts][ipmap][trie]")
+{
+  std::mt19937_64 rng(0x1bad5eed);
+  IpMap map;
+  void *const marks[] = {nullptr, reinterpret_cast<void *>(1), reinterpret_cast<void *>(2), reinterpret_cast<void *>(3)};
+  // A few IPv6 prefixes, so that the ranges are close enough to split each other's nodes.
+  uint64_t const prefixes[] = {0x20010db800000000, 0x20010db800010000, 0x2a00145040000000, 0xfe80000000000000};
+
+  for (int i = 0; i < 20000; ++i) {
+    void *mark = marks[rng() % 4];
+    if (i % 4 == 0) {
+      // A prefix, like an ip_allow entry.
+      int bits      = 8 + rng() % 25;
+      uint32_t base = static_cast<uint32_t>(rng()) & (~uint32_t(0) << (32 - bits));
+      map.mark(ip4(base), ip4(base | (~uint32_t(0) >> bits)), mark);
+    } else if (i % 4 == 1) {
+      uint32_t base = static_cast<uint32_t>(rng()) >> 1;
+      map.fill(ip4(base), ip4(base + rng() % 4096), mark);
+    } else if (i % 4 == 2) {
+      uint64_t hi = prefixes[rng() % 4] | (rng() & 0xffff);
+      uint64_t lo = rng() >> 1;
+      map.mark(ip6(hi, lo), ip6(hi, lo + rng() % 100000), mark);
+    } else {
+      uint64_t hi = prefixes[rng() % 4] | (rng() & 0xff);
+      map.mark(ip6(hi, 0), ip6(hi, ~uint64_t(0)), mark);
+    }
+  }
+  // Holes.
+  for (int i = 0; i < 500; ++i) {
+    uint32_t base = static_cast<uint32_t>(rng()) >> 1;
+    map.unmark(ip4(base), ip4(base + rng() % 256));
+  }
+
+  IpMapTrie trie(map);
+  REQUIRE(trie.count() == map.count());
+
+  check_edges(map, trie);
+  for (int i = 0; i < 100000; ++i) {
+    check(map, trie, ip4(static_cast<uint32_t>(rng())));
+    check(map, trie, ip6(prefixes[rng() % 4] | (rng() & 0xffff), rng()));
+  }
+}
@@ -21,6 +21,10 @@
   limitations under the License.
  */
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 #include "catch.hpp"
 
 #include "tscore/List.h"
@@ -57,3 +61,56 @@ TEST_CASE("test list", "[libts][List]")
   }
   REQUIRE(tot == 4957);
 }
+
+TEST_CASE("test mpsc queue", "[libts][List]")
+{
+  MPSCQ(Foo, slink) mq;
+
+  REQUIRE(mq.empty());
+  REQUIRE(mq.push(new Foo(1)));
+  REQUIRE(!mq.push(new Foo(2)));
+  REQUIRE(!mq.push(new Foo(3)));
+
+  // Oldest first.
+  SList(Foo, slink) l = mq.popall();
+  REQUIRE(mq.empty());
+  for (int i = 1; i <= 3; i++) {
+    Foo *foo = l.pop();
+    REQUIRE(foo->x == i);
+    delete foo;
+  }
+  REQUIRE(l.empty());
+  REQUIRE(mq.popall().empty());
+
+  // Each producer's elements stay in order while the consumer takes them.
+  constexpr int PRODUCERS = 4;
+  constexpr int COUNT     = 100000;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < PRODUCERS; p++) {
+    producers.emplace_back([&mq, p]() {
+      for (int i = 0; i < COUNT; i++) {
+        mq.push(new Foo(p * COUNT + i));
+      }
+    });
+  }
+
+  int last[PRODUCERS];
+  int seen     = 0;
+  bool ordered = true;
+  std::fill(last, last + PRODUCERS, -1);
+  while (seen < PRODUCERS * COUNT) {
+    SList(Foo, slink) batch = mq.popall();
+    while (Foo *foo = batch.pop()) {
+      int p = foo->x / COUNT;
+      ordered &= foo->x % COUNT > last[p];
+      last[p] = foo->x % COUNT;
+      ++seen;
+      delete foo;
+    }
+  }
+  for (auto &t : producers) {
+    t.join();
+  }
+  REQUIRE(ordered);
+  REQUIRE(mq.empty());
+}
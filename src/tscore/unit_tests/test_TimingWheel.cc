@@ -0,0 +1,220 @@
+/** @file
+
+    TimingWheel unit tests.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tscore/TimingWheel.h"
+#include <random>
+#include <vector>
+#include <catch.hpp>
+
+namespace
+{
+struct Timer {
+  int64_t due   = 0;
+  uint32_t slot = 0;
+  bool fired    = false;
+
+  LINK(Timer, link);
+
+  struct Descriptor {
+    static int64_t
+    due_of(Timer const *t)
+    {
+      return t->due;
+    }
+    static uint32_t
+    slot_of(Timer const *t)
+    {
+      return t->slot;
+    }
+    static void
+    set_slot(Timer *t, uint32_t slot)
+    {
+      t->slot = slot;
+    }
+  };
+};
+
+using Wheel = TimingWheel<Timer, Timer::Link_link, Timer::Descriptor>;
+
+// When @a t is due, rounded up to a tick.
+int64_t
+due_tick(Timer const &t, int64_t tick)
+{
+  return t.due == INT64_MAX ? t.due : (t.due + tick - 1) / tick * tick;
+}
+
+// Advance to @a now and check that exactly the timers due by then fire.
+void
+check_advance(Wheel &wheel, std::vector<Timer> &timers, int64_t now, int64_t tick = 1)
+{
+  wheel.advance(now);
+  while (Timer *t = wheel.pop_expired()) {
+    REQUIRE(!t->fired);
+    t->fired = true;
+  }
+  for (auto &t : timers) {
+    if (t.fired != (due_tick(t, tick) <= now)) {
+      FAIL("timer due at " << t.due << " fired " << t.fired << " at " << now);
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("TimingWheel Basic", "[libts][TimingWheel]")
+{
+  Wheel wheel(10, 1000);
+  Timer a, b, c, d;
+
+  REQUIRE(wheel.empty());
+  REQUIRE(wheel.next_due() == INT64_MAX);
+
+  a.due = 1005;
+  b.due = 1700;
+  c.due = 900; // Already due.
+  d.due = 1000 + 10 * 64 * 64 * 3;
+  for (Timer *t : {&a, &b, &c, &d}) {
+    wheel.insert(t);
+    REQUIRE(wheel.in(t));
+  }
+  REQUIRE(wheel.count() == 4);
+
+  // c is due now, then a at the next tick.
+  REQUIRE(wheel.next_due() == 1000);
+  REQUIRE(wheel.pop_expired() == &c);
+  REQUIRE(!wheel.in(&c));
+  REQUIRE(wheel.next_due() == 1010);
+
+  // Never early.
+  wheel.advance(1009);
+  REQUIRE(wheel.pop_expired() == nullptr);
+  wheel.advance(1010);
+  REQUIRE(wheel.pop_expired() == &a);
+
+  // The bound for b, in level 1, is when it is cascaded.
+  REQUIRE(wheel.next_due() <= 1700);
+  wheel.remove(&b);
+  REQUIRE(!wheel.in(&b));
+  wheel.advance(2000);
+  REQUIRE(wheel.pop_expired() == nullptr);
+
+  REQUIRE(wheel.next_due() <= d.due);
+  wheel.advance(d.due - 1);
+  REQUIRE(wheel.pop_expired() == nullptr);
+  wheel.advance(d.due);
+  REQUIRE(wheel.pop_expired() == &d);
+  REQUIRE(wheel.empty());
+}
+
+TEST_CASE("TimingWheel Order", "[libts][TimingWheel]")
+{
+  Wheel wheel(1, 0);
+  std::vector<Timer> timers(200);
+
+  for (size_t i = 0; i < timers.size(); ++i) {
+    timers[i].due = 1 + (i * 37) % timers.size();
+    wheel.insert(&timers[i]);
+  }
+  wheel.advance(1000);
+  int64_t last = 0;
+  while (Timer *t = wheel.pop_expired()) {
+    REQUIRE(t->due >= last);
+    last = t->due;
+  }
+  REQUIRE(wheel.empty());
+}
+
+TEST_CASE("TimingWheel Far", "[libts][TimingWheel]")
+{
+  // Beyond the top level the timers wait and are placed again.
+  Wheel wheel(1, 0);
+  std::vector<Timer> timers(3);
+
+  timers[0].due = Wheel::MAX_TICKS + 10;
+  timers[1].due = 3 * Wheel::MAX_TICKS;
+  timers[2].due = INT64_MAX / 2;
+  for (auto &t : timers) {
+    wheel.insert(&t);
+  }
+  check_advance(wheel, timers, Wheel::MAX_TICKS);
+  check_advance(wheel, timers, Wheel::MAX_TICKS + 10);
+  check_advance(wheel, timers, 2 * Wheel::MAX_TICKS);
+  check_advance(wheel, timers, 3 * Wheel::MAX_TICKS);
+  REQUIRE(wheel.count() == 1);
+  REQUIRE(wheel.next_due() > 3 * Wheel::MAX_TICKS);
+}
+
+TEST_CASE("TimingWheel Drop", "[libts][TimingWheel]")
+{
+  Wheel wheel(1, 0);
+  Timer keep, drop;
+
+  keep.due = 5000;
+  drop.due = 5000;
+  wheel.insert(&keep);
+  wheel.insert(&drop);
+
+  // Both are in level 2, and are looked at when it cascades.
+  wheel.advance(4096, [&](Timer *t) { return t == &drop; });
+  REQUIRE(!wheel.in(&drop));
+  REQUIRE(wheel.in(&keep));
+  REQUIRE(wheel.count() == 1);
+}
+
+TEST_CASE("TimingWheel Random", "[libts][TimingWheel]")
+{
+  std::mt19937_64 rng(0x7133e1);
+  int64_t const tick = 100;
+  int64_t now        = 123456789;
+  Wheel wheel(tick, now);
+  std::vector<Timer> timers(5000);
+
+  for (auto &t : timers) {
+    // Mostly near, some far.
+    int64_t span = rng() % 4 == 0 ? tick * 64 * 64 * 64 * 8 : tick * 500;
+    t.due        = now + static_cast<int64_t>(rng() % span);
+    wheel.insert(&t);
+  }
+  // Cancel some.
+  for (size_t i = 0; i < timers.size(); i += 7) {
+    wheel.remove(&timers[i]);
+    timers[i].due = INT64_MAX;
+  }
+
+  int64_t end = now + tick * 64 * 64 * 64 * 8;
+  while (now < end) {
+    // Small steps and big jumps.
+    now += rng() % 8 == 0 ? static_cast<int64_t>(rng() % (tick * 64 * 64 * 20)) : static_cast<int64_t>(rng() % (tick * 3));
+    int64_t bound = wheel.next_due();
+    check_advance(wheel, timers, now, tick);
+    for (auto &t : timers) {
+      if (!t.fired && t.due != INT64_MAX && due_tick(t, tick) < bound) {
+        FAIL("next due " << bound << " is after timer due at " << t.due);
+      }
+    }
+  }
+  check_advance(wheel, timers, end, tick);
+  for (size_t i = 0; i < timers.size(); i += 7) {
+    REQUIRE(!timers[i].fired);
+  }
+  REQUIRE(wheel.empty());
+}
@@ -0,0 +1,94 @@
+/** @file
+
+    Freelist unit tests.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "tscore/Allocator.h"
+#include "catch.hpp"
+
+TEST_CASE("Freelist remote free", "[libts][freelist][numa]")
+{
+  InkFreeList *fl = ink_freelist_create("test_remote", 64, 16, 8);
+  ink_freelist_bind_node(fl, 0);
+
+  std::vector<void *> items;
+  for (uint32_t i = 0; i < fl->chunk_size; ++i) {
+    items.push_back(ink_freelist_new(fl));
+  }
+  uint32_t allocated = fl->allocated;
+  REQUIRE(fl->used == items.size());
+
+  // Freed from another node, the items are parked and no longer in use.
+  std::thread([&]() {
+    ink_freelist_set_thread_node(1);
+    for (void *item : items) {
+      ink_freelist_free_remote(fl, item);
+    }
+  }).join();
+  REQUIRE(fl->used == 0);
+  REQUIRE(fl->remote_freed == items.size());
+
+  // Running dry takes them back rather than allocating another chunk.
+  std::set<void *> freed(items.begin(), items.end());
+  std::set<void *> again;
+  for (size_t i = 0; i < items.size(); ++i) {
+    again.insert(ink_freelist_new(fl));
+  }
+  REQUIRE(again == freed);
+  REQUIRE(fl->allocated == allocated);
+
+  for (void *item : again) {
+    ink_freelist_free(fl, item);
+  }
+  REQUIRE(fl->used == 0);
+}
+
+TEST_CASE("NumaAllocator", "[libts][freelist][numa]")
+{
+  NumaAllocator a;
+  int node = 0;
+
+  a.re_init("test_numa", 128, 16, 8, 0, 2);
+
+  // Threads not bound to a node use the unbound pool.
+  void *p = a.alloc_void_numa(node);
+  REQUIRE(node == -1);
+  a.free_void_numa(p, node);
+
+  std::thread([&]() {
+    ink_freelist_set_thread_node(1);
+    p = a.alloc_void_numa(node);
+  }).join();
+  REQUIRE(node == 1);
+  REQUIRE(ink_freelist_thread_node() == -1);
+  a.free_void_numa(p, node);
+
+  std::thread([&]() {
+    ink_freelist_set_thread_node(5);
+    p = a.alloc_void_numa(node);
+  }).join();
+  REQUIRE(node == -1);
+  a.free_void_numa(p, node);
+}
@@ -0,0 +1,204 @@
+'''
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+import os
+import time
+Test.Summary = '''
+regex_revalidate plugin test, rule order with overlapping rules and rules with verbs
+'''
+
+# Test description:
+# Rules are matched in groups through one combined regex. The first rule
+# in config order has to decide the result, even when a later rule matches
+# further left in the URL. A rule with a backtracking verb must neither
+# hide the rules after it nor stop matching itself.
+
+Test.SkipUnless(
+    Condition.PluginExists('regex_revalidate.so'),
+    Condition.PluginExists('xdebug.so')
+)
+Test.ContinueOnFail = False
+
+# configure origin server
+server = Test.MakeOriginServer("server")
+
+# Define ATS and configure
+ts = Test.MakeATSProcess("ts", command="traffic_manager")
+
+Test.testName = "regex_revalidate_order"
+
+# cache item /a/foo
+request_header_0 = {"headers":
+                    "GET /a/foo HTTP/1.1\r\n" +
+                    "Host: www.example.com\r\n" +
+                    "\r\n",
+                    "timestamp": "1469733493.993",
+                    "body": ""
+                    }
+response_header_0 = {"headers":
+                     "HTTP/1.1 200 OK\r\n" +
+                     "Connection: close\r\n" +
+                     'Etag: "foo"\r\n' +
+                     "Cache-Control: max-age=600,public\r\n" +
+                     "\r\n",
+                     "timestamp": "1469733493.993",
+                     "body": "abc"
+                     }
+
+server.addResponse("sessionlog.json", request_header_0, response_header_0)
+
+# Configure ATS server
+ts.Disk.plugin_config.AddLine('xdebug.so')
+ts.Disk.plugin_config.AddLine(
+    'regex_revalidate.so -d -c regex_revalidate.conf -l revalidate.log'
+)
+
+regex_revalidate_conf_path = os.path.join(ts.Variables.CONFIGDIR, 'regex_revalidate.conf')
+
+expiry = int(time.time()) + 600
+
+# Define first revision for when trafficserver starts
+ts.Disk.File(regex_revalidate_conf_path, typename="ats:config").AddLine(
+    "# Empty"
+)
+
+ts.Disk.remap_config.AddLine(
+    'map http://ats/ http://127.0.0.1:{}'.format(server.Variables.Port)
+)
+
+# minimal configuration
+ts.Disk.records_config.update({
+    'proxy.config.diags.debug.enabled': 1,
+    'proxy.config.diags.debug.tags': 'regex_revalidate',
+    'proxy.config.http.insert_age_in_response': 0,
+    'proxy.config.http.response_via_str': 3,
+    'proxy.config.http.cache.http': 1,
+    'proxy.config.http.wait_for_cache': 1,
+})
+
+curl_and_args = 'curl -s -D /dev/stdout -o /dev/stderr -x http://127.0.0.1:{}'.format(ts.Variables.port) + ' -H "x-debug: x-cache"'
+
+# 0 Test - Load cache (miss)
+tr = Test.AddTestRun("Cache miss /a/foo")
+ps = tr.Processes.Default
+ps.StartBefore(server, ready=When.PortOpen(server.Variables.Port))
+ps.StartBefore(Test.Processes.ts)
+ps.Command = curl_and_args + ' http://ats/a/foo'
+ps.ReturnCode = 0
+ps.Streams.stdout.Content = Testers.ContainsExpression("X-Cache: miss", "expected cache miss response")
+tr.StillRunningAfter = ts
+
+# 1 Test - Cache hit
+tr = Test.AddTestRun("Cache hit fresh /a/foo")
+ps = tr.Processes.Default
+ps.Command = curl_and_args + ' http://ats/a/foo'
+ps.ReturnCode = 0
+ps.Streams.stdout.Content = Testers.ContainsExpression("X-Cache: hit-fresh", "expected cache hit fresh response")
+tr.StillRunningAfter = ts
+
+# 2 Stage - Two rules which both match /a/foo. The second one matches
+# further left in the URL, the first one comes first in the config.
+tr = Test.AddTestRun("Reload config with overlapping rules")
+ps = tr.Processes.Default
+tr.Disk.File(regex_revalidate_conf_path, typename="ats:config").AddLines([
+    'foo$ {} MISS'.format(expiry),
+    '/a {} STALE'.format(expiry),
+])
+tr.StillRunningAfter = ts
+tr.StillRunningAfter = server
+ps.Command = 'traffic_ctl config reload'
+# Need to copy over the environment so traffic_ctl knows where to find the unix domain socket
+ps.Env = ts.Env
+ps.ReturnCode = 0
+ps.TimeOut = 5
+tr.TimeOut = 5
+
+# 3 Test - The first rule (MISS) wins over the leftmost match (STALE)
+tr = Test.AddTestRun("First rule in config order decides")
+ps = tr.Processes.Default
+tr.DelayStart = 5
+ps.Command = curl_and_args + ' http://ats/a/foo'
+ps.ReturnCode = 0
+ps.Streams.stdout.Content = Testers.ContainsExpression("X-Cache: miss", "expected cache miss response from the first rule")
+tr.StillRunningAfter = ts
+
+# 4 Test - Cache hit on the object fetched by the first rule
+tr = Test.AddTestRun("Cache hit fresh /a/foo after the reload")
+ps = tr.Processes.Default
+ps.Command = curl_and_args + ' http://ats/a/foo'
+ps.ReturnCode = 0
+ps.Streams.stdout.Content = Testers.ContainsExpression("X-Cache: hit-fresh", "expected cache hit fresh response")
+tr.StillRunningAfter = ts
+
+# 5 Stage - A rule with (*COMMIT) which fails on /a/foo after matching "/a",
+# and a rule after it which matches. Combined into one alternation, the
+# verb would fail the match for the rule after it too.
+tr = Test.AddTestRun("Reload config with a verb ahead of a matching rule")
+ps = tr.Processes.Default
+tr.Disk.File(regex_revalidate_conf_path, typename="ats:config").AddLines([
+    '/a(*COMMIT)x {} MISS'.format(expiry),
+    'oo$ {} MISS'.format(expiry),
+])
+tr.StillRunningAfter = ts
+tr.StillRunningAfter = server
+ps.Command = 'traffic_ctl config reload'
+ps.Env = ts.Env
+ps.ReturnCode = 0
+ps.TimeOut = 5
+tr.TimeOut = 5
+
+# 6 Test - The rule after the verb still invalidates
+tr = Test.AddTestRun("Rule after a verb decides")
+ps = tr.Processes.Default
+tr.DelayStart = 5
+ps.Command = curl_and_args + ' http://ats/a/foo'
+ps.ReturnCode = 0
+ps.Streams.stdout.Content = Testers.ContainsExpression("X-Cache: miss", "expected cache miss response from the rule after the verb")
+tr.StillRunningAfter = ts
+
+# 7 Test - Cache hit on the refetched object
+tr = Test.AddTestRun("Cache hit fresh /a/foo after the verb reload")
+ps = tr.Processes.Default
+ps.Command = curl_and_args + ' http://ats/a/foo'
+ps.ReturnCode = 0
+ps.Streams.stdout.Content = Testers.ContainsExpression("X-Cache: hit-fresh", "expected cache hit fresh response")
+tr.StillRunningAfter = ts
+
+# 8 Stage - A matching rule with a verb, behind a rule which does not match
+tr = Test.AddTestRun("Reload config with a matching rule using a verb")
+ps = tr.Processes.Default
+tr.Disk.File(regex_revalidate_conf_path, typename="ats:config").AddLines([
+    '/b/ {} MISS'.format(expiry),
+    '/a/f(*COMMIT)oo {} MISS'.format(expiry),
+])
+tr.StillRunningAfter = ts
+tr.StillRunningAfter = server
+ps.Command = 'traffic_ctl config reload'
+ps.Env = ts.Env
+ps.ReturnCode = 0
+ps.TimeOut = 5
+tr.TimeOut = 5
+
+# 9 Test - The rule with the verb invalidates
+tr = Test.AddTestRun("Rule with a verb decides")
+ps = tr.Processes.Default
+tr.DelayStart = 5
+ps.Command = curl_and_args + ' http://ats/a/foo'
+ps.ReturnCode = 0
+ps.Streams.stdout.Content = Testers.ContainsExpression("X-Cache: miss", "expected cache miss response from the rule with a verb")
+tr.StillRunningAfter = ts